@@ -5,6 +5,7 @@ local sk_input = require('sk_input')
 local sk_math = require('sk_math')
 local sk_transform = require('sk_transform')
 local sk_definition_writer = require('sk_definition_writer')
+local sk_animation_compression = require('sk_animation_compression')
 
 local node_order = {}
 local current_node_index = 1
@@ -138,26 +139,38 @@ local function build_quat_pose(quat)
     end
 end
 
-local function build_armature_pose(armature, node_pose, result)
+local function build_bone_frame(sample)
+    local pos = sample.position
+
+    return {
+        sk_math.vector3(math.floor(pos.x + 0.5), math.floor(pos.y + 0.5), math.floor(pos.z + 0.5)),
+        build_quat_pose(sample.rotation)
+    }
+end
+
+local function build_armature_pose(armature, node_pose)
+    local result = {}
+
     for _, node in pairs(armature.nodes) do
         local pose = build_node_pose(armature, node, node_pose)
 
         local pos, rot = pose:decompose()
 
-        pos = pos * sk_input.settings.fixed_point_scale
-
         table.insert(result, {
-            sk_math.vector3(math.floor(pos.x + 0.5), math.floor(pos.y + 0.5), math.floor(pos.z + 0.5)),
-            build_quat_pose(rot)
+            position = pos * sk_input.settings.fixed_point_scale,
+            rotation = rot,
         })
     end
+
+    return result
 end
 
 local function build_animation(armature, animation)
     -- Don't stop at the last frame, include it
     local ticks_to_include = animation.duration + 1
 
-    local n_frames = math.ceil(ticks_to_include * sk_input.settings.ticks_per_second / animation.ticks_per_second)
+    -- a clip always has at least its first frame so the constant pose has something to read
+    local n_frames = math.max(1, math.ceil(ticks_to_include * sk_input.settings.ticks_per_second / animation.ticks_per_second))
 
     local node_pose = {}
 
@@ -172,18 +185,12 @@ local function build_animation(armature, animation)
         -- populate node_pose from animation
         evaluate_animation_at(node_pose, animation, time)
         -- generate frame for armature
-        build_armature_pose(armature, node_pose, frames)
+        table.insert(frames, build_armature_pose(armature, node_pose))
     end
 
     return frames, n_frames
 end
 
---- @table Clip
---- @tfield number nFrames
---- @tfield number nBones
---- @tfield sk_definition_writer.RefType frames
---- @tfield number fps
-
 --- @function build_animation_clip
 --- @tparam sk_scene.Animation animation
 --- @tparam Armature armature
@@ -191,16 +198,65 @@ end
 --- @treturn Clip the exported clip object use sk_definition_writer.reference_to(clip) to reference in other data
 local function build_animation_clip(animation, armature, animation_file_suffix)
     local animation_frames, n_frames = build_animation(armature, animation)
-    
-    sk_definition_writer.add_definition(animation.name .. '_frames', 'struct SKAnimationBoneFrame[]', animation_file_suffix, animation_frames)
+    local n_bones = #armature.nodes
+
+    local compressed = sk_animation_compression.compress_animation(animation_frames, n_bones)
+
+    local constant_pose = {}
+
+    for _, sample in pairs(animation_frames[1]) do
+        table.insert(constant_pose, build_bone_frame(sample))
+    end
+
+    sk_definition_writer.add_definition(animation.name .. '_keyframes', 'unsigned short[]', animation_file_suffix, compressed.keyframes)
+    sk_definition_writer.add_definition(animation.name .. '_keyframe_times', 'unsigned short[]', '_geo', compressed.keyframe_times)
+    sk_definition_writer.add_definition(animation.name .. '_bone_flags', 'unsigned char[]', '_geo', compressed.bone_flags)
+    sk_definition_writer.add_definition(animation.name .. '_constant_pose', 'struct SKAnimationBoneFrame[]', '_geo', constant_pose)
+
+    local compression = {
+        nKeyframes = #compressed.keyframe_times,
+        keyframeSize = compressed.keyframe_size,
+        keyframes = sk_definition_writer.reference_to(compressed.keyframes, 1),
+        keyframeTimes = sk_definition_writer.reference_to(compressed.keyframe_times, 1),
+        boneFlags = sk_definition_writer.reference_to(compressed.bone_flags, 1),
+        constantPose = sk_definition_writer.reference_to(constant_pose, 1),
+    }
+
+    sk_definition_writer.add_definition(animation.name .. '_compression', 'struct SKAnimationCompression', '_geo', compression)
 
     local clip = {
         nFrames = n_frames,
-        nBones = #armature.nodes,
-        frames = sk_definition_writer.reference_to(animation_frames, 1),
-        fps = sk_input.settings.ticks_per_second
+        nBones = n_bones,
+        frames = sk_definition_writer.null_value,
+        fps = sk_input.settings.ticks_per_second,
+        compression = sk_definition_writer.reference_to(compression),
     }
 
+    if sk_input.settings.verbose then
+        local uncompressed_size = n_frames * n_bones * 12
+        local compressed_size = #compressed.keyframe_times * compressed.keyframe_size
+        local duration = n_frames / sk_input.settings.ticks_per_second
+        local streamed = ''
+
+        if duration > 0 then
+            streamed = string.format(
+                ', %d -> %d bytes streamed per second',
+                math.floor(uncompressed_size / duration),
+                math.floor(compressed_size / duration)
+            )
+        end
+
+        print(string.format(
+            'Animation %s: %d/%d keyframes, %d -> %d ROM bytes%s',
+            animation.name,
+            #compressed.keyframe_times,
+            n_frames,
+            uncompressed_size,
+            compressed_size,
+            streamed
+        ))
+    end
+
     return clip
 end
 
@@ -0,0 +1,261 @@
+--- @module sk_animation_compression
+
+local sk_math = require('sk_math')
+
+-- error allowed when dropping keyframes or treating a track as constant
+-- position is in fixed point units and rotation is in radians
+local POSITION_TOLERANCE = 1
+local ROTATION_TOLERANCE = 0.01
+
+-- must match the packed rotation format in skeletool_clip.h
+local PACKED_ROTATION_BITS = 10
+local PACKED_ROTATION_MASK = (1 << PACKED_ROTATION_BITS) - 1
+local PACKED_ROTATION_CENTER = PACKED_ROTATION_MASK >> 1
+local PACKED_ROTATION_RANGE = 0.70710678
+
+local BONE_TRACK_CONSTANT_POSITION = 1
+local BONE_TRACK_CONSTANT_ROTATION = 2
+
+local function pack_rotation(rotation)
+    local components = {rotation.x, rotation.y, rotation.z, rotation.w}
+    local largest_index = 1
+
+    for i = 2,4 do
+        if math.abs(components[i]) > math.abs(components[largest_index]) then
+            largest_index = i
+        end
+    end
+
+    -- q and -q are the same rotation so the largest component is always positive
+    local sign = components[largest_index] < 0 and -1 or 1
+
+    local result = (largest_index - 1) << 30
+    local shift = PACKED_ROTATION_BITS * 2
+
+    for i = 1,4 do
+        if i ~= largest_index then
+            local quantized = math.floor(components[i] * sign * (PACKED_ROTATION_CENTER / PACKED_ROTATION_RANGE) + 0.5) + PACKED_ROTATION_CENTER
+            quantized = math.max(0, math.min(PACKED_ROTATION_MASK, quantized))
+
+            result = result | (quantized << shift)
+            shift = shift - PACKED_ROTATION_BITS
+        end
+    end
+
+    return result
+end
+
+local function unpack_rotation(packed)
+    local components = {}
+    local largest_index = (packed >> 30) + 1
+    local shift = PACKED_ROTATION_BITS * 2
+    local length_sqrd = 0
+
+    for i = 1,4 do
+        if i ~= largest_index then
+            local quantized = ((packed >> shift) & PACKED_ROTATION_MASK) - PACKED_ROTATION_CENTER
+            components[i] = quantized * (PACKED_ROTATION_RANGE / PACKED_ROTATION_CENTER)
+            length_sqrd = length_sqrd + components[i] * components[i]
+            shift = shift - PACKED_ROTATION_BITS
+        end
+    end
+
+    components[largest_index] = length_sqrd >= 1 and 0 or math.sqrt(1 - length_sqrd)
+
+    return sk_math.quaternion(components[1], components[2], components[3], components[4])
+end
+
+local function quat_dot(a, b)
+    return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w
+end
+
+local function rotation_error(a, b)
+    return 2 * math.acos(math.min(1, math.abs(quat_dot(a, b))))
+end
+
+local function is_position_within_tolerance(a, b)
+    return math.abs(a.x - b.x) <= POSITION_TOLERANCE and
+        math.abs(a.y - b.y) <= POSITION_TOLERANCE and
+        math.abs(a.z - b.z) <= POSITION_TOLERANCE
+end
+
+-- matches the blending done in skAnimatorBlendBone
+local function nlerp_rotation(from, to, lerp)
+    local sign = quat_dot(from, to) < 0 and -1 or 1
+
+    local x = from.x * (1 - lerp) + to.x * lerp * sign
+    local y = from.y * (1 - lerp) + to.y * lerp * sign
+    local z = from.z * (1 - lerp) + to.z * lerp * sign
+    local w = from.w * (1 - lerp) + to.w * lerp * sign
+
+    local length = math.sqrt(x * x + y * y + z * z + w * w)
+
+    if length == 0 then
+        return sk_math.quaternion(0, 0, 0, 1)
+    end
+
+    return sk_math.quaternion(x / length, y / length, z / length, w / length)
+end
+
+local function can_interpolate_frames(frames, decoded, bone_flags, from, to)
+    for frame = from + 1,to - 1 do
+        local lerp = (frame - from) / (to - from)
+
+        for bone_index, flags in pairs(bone_flags) do
+            local expected = frames[frame][bone_index]
+
+            if flags & BONE_TRACK_CONSTANT_POSITION == 0 then
+                local position = decoded[from][bone_index].position:lerp(decoded[to][bone_index].position, lerp)
+
+                if not is_position_within_tolerance(position, expected.position) then
+                    return false
+                end
+            end
+
+            if flags & BONE_TRACK_CONSTANT_ROTATION == 0 then
+                local rotation = nlerp_rotation(decoded[from][bone_index].rotation, decoded[to][bone_index].rotation, lerp)
+
+                if rotation_error(rotation, expected.rotation) > ROTATION_TOLERANCE then
+                    return false
+                end
+            end
+        end
+    end
+
+    return true
+end
+
+local function to_unsigned_short(value)
+    return value & 0xFFFF
+end
+
+--- Reduces a clip to its keyframes and packs the rotations
+--- @function compress_animation
+--- @tparam {{{position=sk_math.Vector3,rotation=sk_math.Quaternion},...},...} frames each frame has one sample per bone
+--- @tparam number n_bones
+--- @treturn table bone_flags, keyframe_times, keyframes and keyframe_size matching SKAnimationCompression
+local function compress_animation(frames, n_bones)
+    local n_frames = #frames
+    local bone_flags = {}
+    local keyframe_shorts = 0
+
+    -- tracks that never move past the tolerance are stored once in the constant pose
+    for bone_index = 1,n_bones do
+        local flags = BONE_TRACK_CONSTANT_POSITION | BONE_TRACK_CONSTANT_ROTATION
+        for frame = 2,n_frames do
+            local first = frames[1][bone_index]
+            local sample = frames[frame][bone_index]
+
+            if not is_position_within_tolerance(sample.position, first.position) then
+                flags = flags & ~BONE_TRACK_CONSTANT_POSITION
+            end
+
+            if rotation_error(sample.rotation, first.rotation) > ROTATION_TOLERANCE then
+                flags = flags & ~BONE_TRACK_CONSTANT_ROTATION
+            end
+        end
+
+        table.insert(bone_flags, flags)
+
+        if flags & BONE_TRACK_CONSTANT_POSITION == 0 then
+            keyframe_shorts = keyframe_shorts + 3
+        end
+
+        if flags & BONE_TRACK_CONSTANT_ROTATION == 0 then
+            keyframe_shorts = keyframe_shorts + 2
+        end
+    end
+
+    -- an empty clip has a single keyframe at the start and every track constant
+    if n_frames == 0 then
+        return {
+            bone_flags = bone_flags,
+            keyframe_times = {0},
+            keyframes = {0},
+            keyframe_size = keyframe_shorts * 2,
+        }
+    end
+
+    -- the values the runtime will see after quantization
+    local decoded = {}
+
+    for frame = 1,n_frames do
+        local decoded_frame = {}
+
+        for bone_index = 1,n_bones do
+            local sample = frames[frame][bone_index]
+            local packed = pack_rotation(sample.rotation)
+
+            table.insert(decoded_frame, {
+                position = sk_math.vector3(
+                    math.floor(sample.position.x + 0.5),
+                    math.floor(sample.position.y + 0.5),
+                    math.floor(sample.position.z + 0.5)
+                ),
+                rotation = unpack_rotation(packed),
+                packed_rotation = packed,
+            })
+        end
+
+        table.insert(decoded, decoded_frame)
+    end
+
+    -- greedily extend each keyframe span as long as interpolating stays within tolerance
+    local keyframe_indices = {1}
+    local from = 1
+
+    while from < n_frames do
+        local to = from + 1
+
+        while to < n_frames and can_interpolate_frames(frames, decoded, bone_flags, from, to + 1) do
+            to = to + 1
+        end
+
+        table.insert(keyframe_indices, to)
+        from = to
+    end
+
+    local keyframe_times = {}
+    local keyframes = {}
+
+    for _, frame in pairs(keyframe_indices) do
+        table.insert(keyframe_times, frame - 1)
+
+        for bone_index, flags in pairs(bone_flags) do
+            local bone = decoded[frame][bone_index]
+
+            if flags & BONE_TRACK_CONSTANT_POSITION == 0 then
+                table.insert(keyframes, to_unsigned_short(math.tointeger(bone.position.x)))
+                table.insert(keyframes, to_unsigned_short(math.tointeger(bone.position.y)))
+                table.insert(keyframes, to_unsigned_short(math.tointeger(bone.position.z)))
+            end
+
+            if flags & BONE_TRACK_CONSTANT_ROTATION == 0 then
+                table.insert(keyframes, bone.packed_rotation >> 16)
+                table.insert(keyframes, bone.packed_rotation & 0xFFFF)
+            end
+        end
+    end
+
+    -- C doesn't allow empty arrays so a clip where every track is constant keeps one unused value
+    if #keyframes == 0 then
+        table.insert(keyframes, 0)
+    end
+
+    return {
+        bone_flags = bone_flags,
+        keyframe_times = keyframe_times,
+        keyframes = keyframes,
+        keyframe_size = keyframe_shorts * 2,
+    }
+end
+
+return {
+    POSITION_TOLERANCE = POSITION_TOLERANCE,
+    ROTATION_TOLERANCE = ROTATION_TOLERANCE,
+    BONE_TRACK_CONSTANT_POSITION = BONE_TRACK_CONSTANT_POSITION,
+    BONE_TRACK_CONSTANT_ROTATION = BONE_TRACK_CONSTANT_ROTATION,
+    pack_rotation = pack_rotation,
+    unpack_rotation = unpack_rotation,
+    compress_animation = compress_animation,
+}
@@ -104,6 +104,21 @@ end
 
 exports.is_comment = is_comment
 
+--- marks a raw value as a pointer into the data of its file so it is
+--- included in relocation tables the same way references are
+---@function relocatable
+---@tparam RawType value
+---@treturn RawType result
+local function relocatable(value)
+    if (not is_raw(value)) then
+        error("relocatable expects a raw value got " .. tostring(value), 2)
+    end
+
+    return setmetatable({ value = value.value, relocatable = true }, RawType)
+end
+
+exports.relocatable = relocatable
+
 --- alias for raw("'\n")
 --- @table newline
 exports.newline = raw('\n')
@@ -227,7 +242,35 @@ end
 
 exports.add_definition = add_definition
 
-local function populate_name_mapping(path, object, result)
+local pending_relocation_tables = {}
+
+--- Outputs a NULL terminated array with the address of every pointer
+--- in the file at location that points to other data in the same file.
+--- Adding an offset to each of those pointers moves the data for that
+--- file to a new address. Pointers need to be in named fields to be
+--- included since only those have an address that can be written in c.
+---@function add_relocation_table
+---@tparam string nameHint
+---@tparam string location the file suffix to build the table for
+---@treturn table the table data, use reference_to to point to it
+local function add_relocation_table(nameHint, location)
+    local relocations = {}
+
+    if (not add_definition(nameHint, "void*[]", location, relocations)) then
+        return nil
+    end
+
+    table.insert(pending_relocation_tables, {
+        location = location,
+        data = relocations,
+    })
+
+    return relocations
+end
+
+exports.add_relocation_table = add_relocation_table
+
+local function populate_name_mapping(path, object, result, location, location_mapping)
     if (type(object) ~= "table") then
         return
     end
@@ -241,21 +284,38 @@ local function populate_name_mapping(path, object, result)
     end
 
     result[object] = path
+    location_mapping[object] = location
 
     for k, v in pairs(object) do
         if type(k) == "number" then
-            populate_name_mapping(path .. "[" .. (k - 1) .. "]", v, result)
+            populate_name_mapping(path .. "[" .. (k - 1) .. "]", v, result, location, location_mapping)
         else
-            populate_name_mapping(path .. "." .. k, v, result)
+            populate_name_mapping(path .. "." .. k, v, result, location, location_mapping)
         end
     end
 end
 
-local function replace_references(object, name_mapping, name_path)
+local function add_relocation(relocation_context, name_path)
+    if (relocation_context.macro_path) then
+        error("The pointer '" .. name_path .. "' can't be relocated since it is passed to the macro '" .. relocation_context.macro_path .. "'")
+    end
+
+    table.insert(relocation_context.relocations, {
+        definition_index = relocation_context.definition_index,
+        path = name_path,
+    })
+end
+
+local function replace_references(object, name_mapping, name_path, relocation_context)
     if type(object) ~= "table" then
         return object
     end
 
+    if (is_raw(object) and object.relocatable and relocation_context) then
+        add_relocation(relocation_context, name_path)
+        return object
+    end
+
     if (is_reference_type(object)) then
         if (object.value == nil) then
             return null_value
@@ -267,6 +327,10 @@ local function replace_references(object, name_mapping, name_path)
             error("A reference '" .. name_path .. "' was used on an object not exported in a definition")
         end
 
+        if (relocation_context and relocation_context.location_mapping[object.value] == relocation_context.location) then
+            add_relocation(relocation_context, name_path)
+        end
+
         if object.index then
             reference_name = reference_name .. '[' .. (object.index - 1) .. ']'
         end
@@ -274,6 +338,10 @@ local function replace_references(object, name_mapping, name_path)
         return raw("&" .. reference_name)
     end
 
+    if (is_macro(object) and relocation_context) then
+        relocation_context = setmetatable({ macro_path = name_path }, { __index = relocation_context })
+    end
+
     local changes = {}
     local hasChange = {}
     local hasChanges = false
@@ -287,7 +355,7 @@ local function replace_references(object, name_mapping, name_path)
             name = name_path .. "." .. k
         end
 
-        local replacement = replace_references(v, name_mapping, name)
+        local replacement = replace_references(v, name_mapping, name, relocation_context)
 
         if (replacement ~= v) then
             changes[k] = replacement
@@ -325,7 +393,7 @@ end
 ---@treturn {PendingDefinition,...} result
 local function consume_pending_definitions()
     local result = pending_definitions
-    consume_pending_definitions = {}
+    pending_definitions = {}
     return result
 end
 
@@ -337,14 +405,54 @@ exports.consume_pending_definitions = consume_pending_definitions
 ---@tparam {PendingDefinition,...} definitions
 local function process_definitions(definitions)
     local name_mapping = {}
+    local location_mapping = {}
     
     for k, v in pairs(definitions) do
-        populate_name_mapping(v.name, v.data, name_mapping)
+        populate_name_mapping(v.name, v.data, name_mapping, v.location, location_mapping)
     end
 
-    for k, v in pairs(definitions) do
-        v.data = replace_references(v.data, name_mapping, v.name)
+    local relocations_by_location = {}
+
+    for _, relocation_table in pairs(pending_relocation_tables) do
+        relocations_by_location[relocation_table.location] = {}
+    end
+
+    for k, v in ipairs(definitions) do
+        local relocation_context = nil
+
+        if (relocations_by_location[v.location]) then
+            relocation_context = {
+                location = v.location,
+                location_mapping = location_mapping,
+                relocations = relocations_by_location[v.location],
+                definition_index = k,
+            }
+        end
+
+        v.data = replace_references(v.data, name_mapping, v.name, relocation_context)
     end
+
+    for _, relocation_table in pairs(pending_relocation_tables) do
+        local relocations = relocations_by_location[relocation_table.location]
+
+        -- keep the output stable between runs since pairs
+        -- visits named fields in no particular order
+        table.sort(relocations, function(a, b)
+            if (a.definition_index ~= b.definition_index) then
+                return a.definition_index < b.definition_index
+            end
+
+            return a.path < b.path
+        end)
+
+        for _, relocation in ipairs(relocations) do
+            table.insert(relocation_table.data, raw("&" .. relocation.path))
+        end
+
+        table.insert(relocation_table.data, null_value)
+    end
+
+    pending_relocation_tables = {}
 end
 
 exports.process_definitions = process_definitions
@@ -50,6 +50,7 @@ bool parseMaterials(const std::string& filename, DisplayListSettings& output) {
     parseResult.mTargetCIBuffer = output.mTargetCIBuffer;
     parseMaterialFile(file, parseResult);
     output.mMaterials.insert(parseResult.mMaterialFile.mMaterials.begin(), parseResult.mMaterialFile.mMaterials.end());
+    output.mTmemPacking = output.mTmemPacking || parseResult.mMaterialFile.mTmemPacking;
 
     for (auto err : parseResult.mErrors) {
         std::cerr << "Error parsing file " << filename << std::endl;
@@ -116,6 +117,8 @@ int main(int argc, char *argv[]) {
     settings.mTargetCIBuffer = args.mTargetCIBuffer;
     settings.mTicksPerSecond = args.mFPS;
     settings.mSortDirection = args.mSortDirection;
+    settings.mExportRelocations = args.mExportRelocations;
+    settings.mVerbose = args.mVerbose;
 
     bool hasError = false;
 
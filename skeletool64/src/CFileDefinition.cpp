@@ -228,6 +228,22 @@ void CFileDefinition::AddMacro(const std::string& name, const std::string& value
     mMacros.push_back(name + " " + value);
 }
 
+void CFileDefinition::AddRelocations(const std::vector<std::string>& relocations) {
+    mRelocations.insert(mRelocations.end(), relocations.begin(), relocations.end());
+}
+
+std::string CFileDefinition::AddRelocationTable(const std::string& nameHint, const std::string& location) {
+    std::unique_ptr<StructureDataChunk> table(new StructureDataChunk());
+
+    for (auto& relocation : mRelocations) {
+        table->AddPrimitive(relocation);
+    }
+
+    table->AddPrimitive<const char*>("NULL");
+
+    return AddDataDefinition(nameHint, "void*", true, location, std::move(table));
+}
+
 void CFileDefinition::AddHeader(const std::string& name) {
     mHeaders.insert(name);
 }
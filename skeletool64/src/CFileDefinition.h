@@ -35,6 +35,10 @@ public:
     std::string AddDataDefinition(const std::string& nameHint, const std::string& dataType, bool isArray, const std::string& location, std::unique_ptr<DataChunk> data);
     void AddMacro(const std::string& name, const std::string& value);
 
+    void AddRelocations(const std::vector<std::string>& relocations);
+    // A NULL terminated list of every pointer added with AddRelocations
+    std::string AddRelocationTable(const std::string& nameHint, const std::string& location);
+
     void AddHeader(const std::string& name);
 
     std::string GetVertexBuffer(std::shared_ptr<ExtendedMesh> mesh, VertexType vertexType, int textureWidth, int textureHeight, const std::string& modelSuffix, const PixelRGBAu8& defaultVertexColor);
@@ -68,6 +72,7 @@ private:
     std::map<std::string, VertexBufferDefinition> mVertexBuffers;
     std::vector<std::unique_ptr<FileDefinition>> mDefinitions;
     std::vector<std::string> mMacros;
+    std::vector<std::string> mRelocations;
     std::map<const void*, std::string> mResourceNames;
     std::map<aiMesh*, std::shared_ptr<ExtendedMesh>> mMeshes;
     BoneHierarchy mBoneHierarchy;
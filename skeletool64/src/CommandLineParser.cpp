@@ -28,6 +28,8 @@ bool parseCommandLineArguments(int argc, char *argv[], struct CommandLineArgumen
     output.mDefaultMaterial = "default";
     output.mForceMaterialName = "";
     output.mProcessAsModel = false;
+    output.mExportRelocations = false;
+    output.mVerbose = false;
     output.mFPS = 30.0f;
 
     std::string lastParameter = "";
@@ -115,8 +117,14 @@ bool parseCommandLineArguments(int argc, char *argv[], struct CommandLineArgumen
             output.mTargetCIBuffer = true;
         } else if (strcmp(curr, "--model") == 0) {
             output.mProcessAsModel = true;
+        } else if (strcmp(curr, "--relocations") == 0) {
+            output.mExportRelocations = true;
         } else if (strcmp(curr, "--fps") == 0) {
             lastParameter = "fps";
+        } else if (
+            strcmp(curr, "-v") == 0 ||
+            strcmp(curr, "--verbose") == 0) {
+            output.mVerbose = true;
         } else {
             if (curr[0] == '-') {
                 hasError = true;
@@ -32,6 +32,8 @@ struct CommandLineArguments {
     bool mBonesAsVertexGroups;
     bool mTargetCIBuffer;
     bool mProcessAsModel;
+    bool mExportRelocations;
+    bool mVerbose;
     aiVector3D mEulerAngles;
     aiVector3D mSortDirection;
 };
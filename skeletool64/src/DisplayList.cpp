@@ -1,7 +1,6 @@
 #include "./DisplayList.h"
 
-#include "./CFileDefinition.h"
-
+#include <cctype>
 #include <sstream>
 
 DisplayListCommand::DisplayListCommand(DisplayListCommandType type): mType(type) {}
@@ -224,9 +223,84 @@ const std::string& DisplayList::GetName() {
     return mName;
 }
 
+const std::vector<std::string>& DisplayList::GetRelocations() {
+    return mRelocations;
+}
+
+// Most macros are a single command, these expand to several
+int gfxCommandCount(const std::string& macroName) {
+    if (macroName == "gsDPLoadTLUT_pal16" || macroName == "gsDPLoadTLUT_pal256") {
+        return 6;
+    }
+
+    return 1;
+}
+
+bool isCIdentifier(const std::string& value) {
+    if (value.empty() || isdigit(value[0])) {
+        return false;
+    }
+
+    for (auto curr : value) {
+        if (!isalnum(curr) && curr != '_') {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Checks if the first command of a macro points into the same file
+bool hasRelocatedAddress(MacroDataChunk& macro) {
+    const std::string& macroName = macro.GetMacroName();
+
+    if (macroName == "gsSPVertex" ||
+        macroName == "gsDPSetTextureImage" ||
+        macroName == "gsDPLoadTLUT_pal16" ||
+        macroName == "gsDPLoadTLUT_pal256") {
+        return true;
+    }
+
+    if (macroName == "gsSPDisplayList") {
+        // display lists called by name are defined in the same file
+        // anything else is a segmented address like a bone attachment
+        auto target = dynamic_cast<PrimitiveDataChunk<std::string>*>(macro.GetParameter(0));
+        return target && isCIdentifier(target->GetValue());
+    }
+
+    return false;
+}
+
+void DisplayList::FindRelocations() {
+    int gfxIndex = 0;
+
+    for (auto& chunk : mDataChunk->GetChildren()) {
+        // comments and nops don't take up any space
+        if (dynamic_cast<CommentDataChunk*>(chunk.get()) || dynamic_cast<DataChunkNop*>(chunk.get())) {
+            continue;
+        }
+
+        MacroDataChunk* macro = dynamic_cast<MacroDataChunk*>(chunk.get());
+
+        // raw content is a single command
+        if (!macro) {
+            ++gfxIndex;
+            continue;
+        }
+
+        if (hasRelocatedAddress(*macro)) {
+            mRelocations.push_back("&" + mName + "[" + std::to_string(gfxIndex) + "].words.w1");
+        }
+
+        gfxIndex += gfxCommandCount(macro->GetMacroName());
+    }
+}
+
 std::unique_ptr<FileDefinition> DisplayList::Generate(const std::string& fileSuffix) {
     mDataChunk->Add(std::unique_ptr<DataChunk>(new MacroDataChunk("gsSPEndDisplayList")));
 
+    FindRelocations();
+
     std::unique_ptr<FileDefinition> result(new DataFileDefinition(
         std::string("Gfx"), 
         mName, 
@@ -145,9 +145,15 @@ public:
 
     const std::string& GetName();
     std::unique_ptr<FileDefinition> Generate(const std::string& fileSuffix);
+
+    // The address of every pointer in the display list, filled in by Generate
+    const std::vector<std::string>& GetRelocations();
 private:
+    void FindRelocations();
+
     std::string mName;
     std::unique_ptr<StructureDataChunk> mDataChunk;
+    std::vector<std::string> mRelocations;
 };
 
 #endif
\ No newline at end of file
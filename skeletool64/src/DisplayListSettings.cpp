@@ -15,7 +15,10 @@ DisplayListSettings::DisplayListSettings():
     mExportAnimation(true),
     mExportGeometry(true),
     mIncludeCulling(true),
-    mTargetCIBuffer(false) {
+    mTargetCIBuffer(false),
+    mTmemPacking(false),
+    mExportRelocations(false),
+    mVerbose(false) {
 }
 
 aiMatrix4x4 DisplayListSettings::CreateGlobalTransform() const {
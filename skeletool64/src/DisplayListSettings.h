@@ -32,6 +32,9 @@ struct DisplayListSettings {
     bool mIncludeCulling;
     bool mBonesAsVertexGroups;
     bool mTargetCIBuffer;
+    bool mTmemPacking;
+    bool mExportRelocations;
+    bool mVerbose;
 
     aiVector3D mSortDirection;
 
@@ -70,6 +70,7 @@ void MaterialCollector::GenerateMaterials(DisplayListSettings& settings, CFileDe
             auto dl = materialDL.Generate(fileSuffix);
 
             fileDefinition.AddDefinition(std::move(dl));
+            fileDefinition.AddRelocations(materialDL.GetRelocations());
         }
     }
 }
@@ -149,6 +150,7 @@ std::string generateMesh(const aiScene* scene, CFileDefinition& fileDefinition,
     }
 
     fileDefinition.AddDefinition(std::move(dlResult));
+    fileDefinition.AddRelocations(displayList.GetRelocations());
 
     return displayList.GetName();
 }
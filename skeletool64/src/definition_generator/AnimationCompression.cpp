@@ -0,0 +1,216 @@
+#include "AnimationCompression.h"
+
+#include <algorithm>
+#include <cmath>
+
+// must match the packed rotation format in skeletool_clip.h
+#define PACKED_ROTATION_BITS            10
+#define PACKED_ROTATION_MASK            ((1 << PACKED_ROTATION_BITS) - 1)
+#define PACKED_ROTATION_CENTER          (PACKED_ROTATION_MASK >> 1)
+#define PACKED_ROTATION_RANGE           0.70710678f
+
+unsigned packRotation(const aiQuaternion& rotation) {
+    float components[4] = {rotation.x, rotation.y, rotation.z, rotation.w};
+
+    int largestIndex = 0;
+
+    for (int i = 1; i < 4; ++i) {
+        if (fabs(components[i]) > fabs(components[largestIndex])) {
+            largestIndex = i;
+        }
+    }
+
+    // q and -q are the same rotation so the largest component is always positive
+    float sign = components[largestIndex] < 0.0f ? -1.0f : 1.0f;
+
+    unsigned result = (unsigned)largestIndex << 30;
+    int shift = PACKED_ROTATION_BITS * 2;
+
+    for (int i = 0; i < 4; ++i) {
+        if (i == largestIndex) {
+            continue;
+        }
+
+        int quantized = (int)floor(components[i] * sign * (PACKED_ROTATION_CENTER / PACKED_ROTATION_RANGE) + 0.5f) + PACKED_ROTATION_CENTER;
+        quantized = std::max(0, std::min(PACKED_ROTATION_MASK, quantized));
+
+        result |= (unsigned)quantized << shift;
+        shift -= PACKED_ROTATION_BITS;
+    }
+
+    return result;
+}
+
+aiQuaternion unpackRotation(unsigned packed) {
+    float components[4];
+    int largestIndex = packed >> 30;
+    int shift = PACKED_ROTATION_BITS * 2;
+    float lengthSqrd = 0.0f;
+
+    for (int i = 0; i < 4; ++i) {
+        if (i == largestIndex) {
+            continue;
+        }
+
+        int quantized = (int)((packed >> shift) & PACKED_ROTATION_MASK) - PACKED_ROTATION_CENTER;
+        components[i] = quantized * (PACKED_ROTATION_RANGE / PACKED_ROTATION_CENTER);
+        lengthSqrd += components[i] * components[i];
+        shift -= PACKED_ROTATION_BITS;
+    }
+
+    components[largestIndex] = lengthSqrd >= 1.0f ? 0.0f : sqrtf(1.0f - lengthSqrd);
+
+    return aiQuaternion(components[3], components[0], components[1], components[2]);
+}
+
+float rotationError(const aiQuaternion& a, const aiQuaternion& b) {
+    float dot = fabs(a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w);
+    return 2.0f * acos(std::min(1.0f, dot));
+}
+
+bool isPositionWithinTolerance(const aiVector3D& a, const aiVector3D& b) {
+    return fabs(a.x - b.x) <= ANIMATION_POSITION_TOLERANCE &&
+        fabs(a.y - b.y) <= ANIMATION_POSITION_TOLERANCE &&
+        fabs(a.z - b.z) <= ANIMATION_POSITION_TOLERANCE;
+}
+
+aiVector3D roundPosition(const aiVector3D& position) {
+    return aiVector3D(floor(position.x + 0.5f), floor(position.y + 0.5f), floor(position.z + 0.5f));
+}
+
+// matches the blending done in skAnimatorBlendBone
+aiQuaternion nlerpRotation(const aiQuaternion& from, const aiQuaternion& to, float lerp) {
+    float sign = (from.x * to.x + from.y * to.y + from.z * to.z + from.w * to.w) < 0.0f ? -1.0f : 1.0f;
+
+    aiQuaternion result(
+        from.w * (1.0f - lerp) + to.w * lerp * sign,
+        from.x * (1.0f - lerp) + to.x * lerp * sign,
+        from.y * (1.0f - lerp) + to.y * lerp * sign,
+        from.z * (1.0f - lerp) + to.z * lerp * sign
+    );
+
+    return result.Normalize();
+}
+
+bool canInterpolateFrames(const std::vector<std::vector<FrameData>>& frames, const std::vector<std::vector<FrameData>>& decoded, const std::vector<int>& boneFlags, int from, int to) {
+    for (int frame = from + 1; frame < to; ++frame) {
+        float lerp = (float)(frame - from) / (float)(to - from);
+
+        for (unsigned boneIndex = 0; boneIndex < boneFlags.size(); ++boneIndex) {
+            const FrameData& expected = frames[frame][boneIndex];
+
+            if (!(boneFlags[boneIndex] & BoneTrackFlagsConstantPosition)) {
+                aiVector3D position = decoded[from][boneIndex].position * (1.0f - lerp) + decoded[to][boneIndex].position * lerp;
+
+                if (!isPositionWithinTolerance(position, expected.position)) {
+                    return false;
+                }
+            }
+
+            if (!(boneFlags[boneIndex] & BoneTrackFlagsConstantRotation)) {
+                aiQuaternion rotation = nlerpRotation(decoded[from][boneIndex].rotation, decoded[to][boneIndex].rotation, lerp);
+
+                if (rotationError(rotation, expected.rotation) > ANIMATION_ROTATION_TOLERANCE) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+CompressedAnimation compressAnimation(const std::vector<std::vector<FrameData>>& frames, unsigned boneCount) {
+    CompressedAnimation result;
+    int nFrames = frames.size();
+    int keyframeShorts = 0;
+
+    // tracks that never move past the tolerance are stored once in the constant pose
+    for (unsigned boneIndex = 0; boneIndex < boneCount; ++boneIndex) {
+        int flags = BoneTrackFlagsConstantPosition | BoneTrackFlagsConstantRotation;
+
+        for (int frame = 1; frame < nFrames; ++frame) {
+            if (!isPositionWithinTolerance(frames[frame][boneIndex].position, frames[0][boneIndex].position)) {
+                flags &= ~BoneTrackFlagsConstantPosition;
+            }
+
+            if (rotationError(frames[frame][boneIndex].rotation, frames[0][boneIndex].rotation) > ANIMATION_ROTATION_TOLERANCE) {
+                flags &= ~BoneTrackFlagsConstantRotation;
+            }
+        }
+
+        result.boneFlags.push_back(flags);
+
+        if (!(flags & BoneTrackFlagsConstantPosition)) {
+            keyframeShorts += 3;
+        }
+
+        if (!(flags & BoneTrackFlagsConstantRotation)) {
+            keyframeShorts += 2;
+        }
+    }
+
+    result.keyframeSize = keyframeShorts * sizeof(unsigned short);
+
+    // an empty clip has a single keyframe at the start and every track constant
+    if (nFrames == 0) {
+        result.keyframeTimes.push_back(0);
+        result.keyframes.push_back(0);
+        return result;
+    }
+
+    // the values the runtime will see after quantization
+    std::vector<std::vector<FrameData>> decoded(nFrames);
+
+    for (int frame = 0; frame < nFrames; ++frame) {
+        for (unsigned boneIndex = 0; boneIndex < boneCount; ++boneIndex) {
+            FrameData decodedBone;
+            decodedBone.position = roundPosition(frames[frame][boneIndex].position);
+            decodedBone.rotation = unpackRotation(packRotation(frames[frame][boneIndex].rotation));
+            decoded[frame].push_back(decodedBone);
+        }
+    }
+
+    // greedily extend each keyframe span as long as interpolating stays within tolerance
+    std::vector<int> keyframeIndices;
+    keyframeIndices.push_back(0);
+
+    int from = 0;
+
+    while (from < nFrames - 1) {
+        int to = from + 1;
+
+        while (to + 1 < nFrames && canInterpolateFrames(frames, decoded, result.boneFlags, from, to + 1)) {
+            ++to;
+        }
+
+        keyframeIndices.push_back(to);
+        from = to;
+    }
+
+    for (auto frame : keyframeIndices) {
+        result.keyframeTimes.push_back((unsigned short)frame);
+
+        for (unsigned boneIndex = 0; boneIndex < boneCount; ++boneIndex) {
+            const FrameData& bone = decoded[frame][boneIndex];
+
+            if (!(result.boneFlags[boneIndex] & BoneTrackFlagsConstantPosition)) {
+                result.keyframes.push_back((unsigned short)(short)bone.position.x);
+                result.keyframes.push_back((unsigned short)(short)bone.position.y);
+                result.keyframes.push_back((unsigned short)(short)bone.position.z);
+            }
+
+            if (!(result.boneFlags[boneIndex] & BoneTrackFlagsConstantRotation)) {
+                unsigned packed = packRotation(frames[frame][boneIndex].rotation);
+                result.keyframes.push_back((unsigned short)(packed >> 16));
+                result.keyframes.push_back((unsigned short)(packed & 0xFFFF));
+            }
+        }
+    }
+
+    if (result.keyframes.empty()) {
+        result.keyframes.push_back(0);
+    }
+
+    return result;
+}
@@ -0,0 +1,37 @@
+#ifndef __ANIMATION_COMPRESSION_H__
+#define __ANIMATION_COMPRESSION_H__
+
+#include <assimp/vector3.h>
+#include <assimp/quaternion.h>
+#include <vector>
+
+// error allowed when dropping keyframes or treating a track as constant
+// position is in fixed point units and rotation is in radians
+#define ANIMATION_POSITION_TOLERANCE    1.0f
+#define ANIMATION_ROTATION_TOLERANCE    0.01f
+
+enum BoneTrackFlags {
+    BoneTrackFlagsConstantPosition = (1 << 0),
+    BoneTrackFlagsConstantRotation = (1 << 1),
+};
+
+struct FrameData {
+    aiVector3D position;
+    aiQuaternion rotation;
+};
+
+struct CompressedAnimation {
+    std::vector<int> boneFlags;
+    std::vector<unsigned short> keyframeTimes;
+    // never empty so it can be written as a C array even when every track is constant
+    std::vector<unsigned short> keyframes;
+    int keyframeSize;
+};
+
+unsigned packRotation(const aiQuaternion& rotation);
+aiQuaternion unpackRotation(unsigned packed);
+float rotationError(const aiQuaternion& a, const aiQuaternion& b);
+
+CompressedAnimation compressAnimation(const std::vector<std::vector<FrameData>>& frames, unsigned boneCount);
+
+#endif
@@ -1,9 +1,13 @@
 #include "AnimationGenerator.h"
 
 #include "./DefinitionGenerator.h"
+#include "./AnimationCompression.h"
 #include <set>
+#include <algorithm>
+#include <cmath>
 #include <string>
 #include <map>
+#include <iostream>
 #include "../StringUtils.h"
 
 std::shared_ptr<NodeAnimationInfo> findNodesForWithAnimation(const aiScene* scene, const std::vector<aiNode*>& usedNodes, float modelScale) {
@@ -72,10 +76,29 @@ std::shared_ptr<NodeAnimationInfo> findNodesForWithAnimation(const aiScene* scen
     return result;
 }
 
-struct FrameData {
-    aiVector3D position;
-    aiQuaternion rotation;
-};
+std::unique_ptr<StructureDataChunk> generateBoneFrame(const FrameData& frameBone) {
+    std::unique_ptr<StructureDataChunk> posData(new StructureDataChunk());
+    std::unique_ptr<StructureDataChunk> rotData(new StructureDataChunk());
+
+    posData->AddPrimitive((short)(frameBone.position.x));
+    posData->AddPrimitive((short)(frameBone.position.y));
+    posData->AddPrimitive((short)(frameBone.position.z));
+
+    if (frameBone.rotation.w < 0.0f) {
+        rotData->AddPrimitive((short)(-frameBone.rotation.x * std::numeric_limits<short>::max()));
+        rotData->AddPrimitive((short)(-frameBone.rotation.y * std::numeric_limits<short>::max()));
+        rotData->AddPrimitive((short)(-frameBone.rotation.z * std::numeric_limits<short>::max()));
+    } else {
+        rotData->AddPrimitive((short)(frameBone.rotation.x * std::numeric_limits<short>::max()));
+        rotData->AddPrimitive((short)(frameBone.rotation.y * std::numeric_limits<short>::max()));
+        rotData->AddPrimitive((short)(frameBone.rotation.z * std::numeric_limits<short>::max()));
+    }
+
+    std::unique_ptr<StructureDataChunk> frameData(new StructureDataChunk());
+    frameData->Add(std::move(posData));
+    frameData->Add(std::move(rotData));
+    return frameData;
+}
 
 template <typename T>
 void findStartValue(const T* keys, unsigned keyCount, double at, unsigned& startValue, double& lerp) {
@@ -156,7 +179,8 @@ std::string generateanimationV2(const aiAnimation& animation, int index, BoneHie
     // Don't stop at the last frame, include it
     int ticksToInclude = animation.mDuration + 1;
 
-    int nFrames = ceil(ticksToInclude * settings.mTicksPerSecond / animation.mTicksPerSecond);
+    // a clip always has at least its first frame so the constant pose has something to read
+    int nFrames = std::max(1, (int)ceil(ticksToInclude * settings.mTicksPerSecond / animation.mTicksPerSecond));
 
     std::vector<std::vector<FrameData>> allFrameData(nFrames);
 
@@ -199,42 +223,66 @@ std::string generateanimationV2(const aiAnimation& animation, int index, BoneHie
         }
     }
 
-    std::unique_ptr<StructureDataChunk> frames(new StructureDataChunk());
+    CompressedAnimation compressed = compressAnimation(allFrameData, bones.GetBoneCount());
+    std::string animationName = animation.mName.C_Str();
 
-    for (int frame = 0; frame < nFrames; ++frame) {
-        for (auto& frameBone : allFrameData[frame]) {
-            std::unique_ptr<StructureDataChunk> posData(new StructureDataChunk());
-            std::unique_ptr<StructureDataChunk> rotData(new StructureDataChunk());
+    std::unique_ptr<StructureDataChunk> keyframes(new StructureDataChunk());
 
-            posData->AddPrimitive((short)(frameBone.position.x));
-            posData->AddPrimitive((short)(frameBone.position.y));
-            posData->AddPrimitive((short)(frameBone.position.z));
+    for (auto value : compressed.keyframes) {
+        keyframes->AddPrimitive(value);
+    }
 
-            if (frameBone.rotation.w < 0.0f) {
-                rotData->AddPrimitive((short)(-frameBone.rotation.x * std::numeric_limits<short>::max()));
-                rotData->AddPrimitive((short)(-frameBone.rotation.y * std::numeric_limits<short>::max()));
-                rotData->AddPrimitive((short)(-frameBone.rotation.z * std::numeric_limits<short>::max()));
-            } else {
-                rotData->AddPrimitive((short)(frameBone.rotation.x * std::numeric_limits<short>::max()));
-                rotData->AddPrimitive((short)(frameBone.rotation.y * std::numeric_limits<short>::max()));
-                rotData->AddPrimitive((short)(frameBone.rotation.z * std::numeric_limits<short>::max()));
-            }
+    std::unique_ptr<StructureDataChunk> keyframeTimes(new StructureDataChunk());
 
-            std::unique_ptr<StructureDataChunk> frameData(new StructureDataChunk());
-            frameData->Add(std::move(posData));
-            frameData->Add(std::move(rotData));
-            frames->Add(std::move(frameData));
-        }
+    for (auto value : compressed.keyframeTimes) {
+        keyframeTimes->AddPrimitive(value);
+    }
+
+    std::unique_ptr<StructureDataChunk> boneFlags(new StructureDataChunk());
+    std::unique_ptr<StructureDataChunk> constantPose(new StructureDataChunk());
+
+    for (unsigned boneIndex = 0; boneIndex < bones.GetBoneCount(); ++boneIndex) {
+        boneFlags->AddPrimitive(compressed.boneFlags[boneIndex]);
+        constantPose->Add(generateBoneFrame(allFrameData[0][boneIndex]));
     }
 
-    std::string framesName = fileDef.AddDataDefinition(std::string(animation.mName.C_Str()) + "_data", "struct SKAnimationBoneFrame", true, "_anim", std::move(frames));
+    std::string keyframesName = fileDef.AddDataDefinition(animationName + "_keyframes", "unsigned short", true, "_anim", std::move(keyframes));
+    std::string keyframeTimesName = fileDef.AddDataDefinition(animationName + "_keyframe_times", "unsigned short", true, "_geo", std::move(keyframeTimes));
+    std::string boneFlagsName = fileDef.AddDataDefinition(animationName + "_bone_flags", "unsigned char", true, "_geo", std::move(boneFlags));
+    std::string constantPoseName = fileDef.AddDataDefinition(animationName + "_constant_pose", "struct SKAnimationBoneFrame", true, "_geo", std::move(constantPose));
+
+    std::unique_ptr<StructureDataChunk> compression(new StructureDataChunk());
+    compression->AddPrimitive((int)compressed.keyframeTimes.size());
+    compression->AddPrimitive(compressed.keyframeSize);
+    compression->AddPrimitive(keyframesName);
+    compression->AddPrimitive(keyframeTimesName);
+    compression->AddPrimitive(boneFlagsName);
+    compression->AddPrimitive(constantPoseName);
+    std::string compressionName = fileDef.AddDataDefinition(animationName + "_compression", "struct SKAnimationCompression", false, "_geo", std::move(compression));
 
     std::unique_ptr<StructureDataChunk> clip(new StructureDataChunk());
     clip->AddPrimitive(nFrames);
     clip->AddPrimitive(bones.GetBoneCount());
-    clip->AddPrimitive(framesName);
+    clip->AddPrimitive(std::string("NULL"));
     clip->AddPrimitive(settings.mTicksPerSecond);
-    std::string result = fileDef.AddDataDefinition(std::string(animation.mName.C_Str()) + "_clip", "struct SKAnimationClip", false, "_geo", std::move(clip));
+    clip->AddPrimitive("&" + compressionName);
+    std::string result = fileDef.AddDataDefinition(animationName + "_clip", "struct SKAnimationClip", false, "_geo", std::move(clip));
+
+    if (settings.mVerbose) {
+        int uncompressedSize = nFrames * bones.GetBoneCount() * sizeof(short) * 6;
+        int compressedSize = compressed.keyframeTimes.size() * compressed.keyframeSize;
+        float duration = nFrames / settings.mTicksPerSecond;
+
+        std::cout << "Animation " << animationName << ": " <<
+            compressed.keyframeTimes.size() << "/" << nFrames << " keyframes, " <<
+            uncompressedSize << " -> " << compressedSize << " ROM bytes";
+
+        if (duration > 0.0f) {
+            std::cout << ", " << (int)(uncompressedSize / duration) << " -> " << (int)(compressedSize / duration) << " bytes streamed per second";
+        }
+
+        std::cout << std::endl;
+    }
 
     std::string animationMacroName = fileDef.GetUniqueName(std::string(animation.mName.C_Str()) + "_clip_index");
     std::transform(animationMacroName.begin(), animationMacroName.end(), animationMacroName.begin(), ::toupper);
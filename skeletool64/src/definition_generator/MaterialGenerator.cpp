@@ -1,5 +1,7 @@
 #include "MaterialGenerator.h"
 
+#include <iostream>
+
 #include "../StringUtils.h"
 #include "../materials/RenderMode.h"
 
@@ -10,28 +12,6 @@ bool MaterialGenerator::ShouldIncludeNode(aiNode* node) {
     return false;
 }
 
-#define OPAQUE_ORDER        0
-#define DECAL_ORDER         1
-#define TRANSPARENT_ORDER   2
-
-int sortOrderForMaterial(const Material& material) {
-    // assume opaque
-    if (!material.mState.hasRenderMode) {
-        return OPAQUE_ORDER;
-    }
-
-    if (material.mState.cycle1RenderMode.GetZMode() == ZMODE_DEC ||
-        material.mState.cycle2RenderMode.GetZMode() == ZMODE_DEC) {
-        return DECAL_ORDER;
-    }
-
-    if ((material.mState.cycle1RenderMode.data | material.mState.cycle2RenderMode.data) & FORCE_BL) {
-        return TRANSPARENT_ORDER;
-    }
-
-    return OPAQUE_ORDER;
-}
-
 void MaterialGenerator::GenerateDefinitions(const aiScene* scene, CFileDefinition& fileDefinition) {
     std::set<std::shared_ptr<TextureDefinition>> textures;
     std::set<std::shared_ptr<PaletteDefinition>> palettes;
@@ -67,6 +47,9 @@ void MaterialGenerator::GenerateDefinitions(const aiScene* scene, CFileDefinitio
 
     std::unique_ptr<StructureDataChunk> materialList(new StructureDataChunk());
     std::unique_ptr<StructureDataChunk> revertList(new StructureDataChunk());
+    std::unique_ptr<StructureDataChunk> tileOnlyList(new StructureDataChunk());
+    std::unique_ptr<StructureDataChunk> tmemGroupList(new StructureDataChunk());
+    std::unique_ptr<StructureDataChunk> tmemTextureList(new StructureDataChunk());
 
     std::vector<std::shared_ptr<Material>> materialsAsVector;
 
@@ -78,28 +61,57 @@ void MaterialGenerator::GenerateDefinitions(const aiScene* scene, CFileDefinitio
         materialsAsVector.push_back(entry.second);
     }
 
-    std::sort(materialsAsVector.begin(), materialsAsVector.end(), [&](const std::shared_ptr<Material>& a, const std::shared_ptr<Material>& b) -> bool {
-        int aOrder = sortOrderForMaterial(*a);
-        int bOrder = sortOrderForMaterial(*b);
+    sortMaterialsForOutput(materialsAsVector);
 
-        if (aOrder != bOrder) {
-            return aOrder < bOrder;
-        }
-
-        return a->mSortOrder < b->mSortOrder;
-    });
+    int unpackedTextureLoads = 0;
+    int packedTextureLoads = 0;
+    int loadedGroup = -1;
+    uint32_t loadedTextures = 0;
 
     for (auto& entry : materialsAsVector) {
         std::string name = fileDefinition.GetUniqueName(entry->mName);
 
         DisplayList dl(name);
-        if (entry->mName == mSettings.mDefaultMaterialName) {
-            entry->Write(fileDefinition, MaterialState(), dl.GetDataChunk(), mSettings.mTargetCIBuffer);
-        } else {
-            entry->Write(fileDefinition, mSettings.mDefaultMaterialState, dl.GetDataChunk(), mSettings.mTargetCIBuffer);
-        }
+        const MaterialState& fromState = entry->mName == mSettings.mDefaultMaterialName ? MaterialState() : mSettings.mDefaultMaterialState;
+        entry->Write(fileDefinition, fromState, dl.GetDataChunk(), mSettings.mTargetCIBuffer);
         std::unique_ptr<FileDefinition> material = dl.Generate("_mat");
         materialList->AddPrimitive(material->GetName());
+
+        if (mSettings.mTmemPacking) {
+            if (entry->mTmemGroup == -1) {
+                tileOnlyList->AddPrimitive(material->GetName());
+            } else {
+                DisplayList tileOnlyDL(fileDefinition.GetUniqueName(entry->mName + "_tile_only"));
+                entry->Write(fileDefinition, StateWithTexturesLoaded(fromState, entry->mState), tileOnlyDL.GetDataChunk(), mSettings.mTargetCIBuffer);
+                std::unique_ptr<FileDefinition> tileOnly = tileOnlyDL.Generate("_mat");
+                tileOnlyList->AddPrimitive(tileOnly->GetName());
+                fileDefinition.AddDefinition(std::move(tileOnly));
+            }
+
+            tmemGroupList->AddPrimitive(entry->mTmemGroup);
+            tmemTextureList->AddPrimitive(entry->mTmemTextures);
+
+            // same bookkeeping as levelMaterialWithTmem() drawing every material once in index order
+            if (entry->mTmemTextures) {
+                ++unpackedTextureLoads;
+
+                bool isLoaded = entry->mTmemGroup != -1 && entry->mTmemGroup == loadedGroup && (loadedTextures & entry->mTmemTextures) == entry->mTmemTextures;
+
+                if (!isLoaded) {
+                    if (entry->mTmemGroup != loadedGroup) {
+                        loadedGroup = entry->mTmemGroup;
+                        loadedTextures = 0;
+                    }
+
+                    if (entry->mTmemGroup != -1) {
+                        loadedTextures |= entry->mTmemTextures;
+                    }
+
+                    ++packedTextureLoads;
+                }
+            }
+        }
+
         fileDefinition.AddDefinition(std::move(material));
 
         std::string revertName = fileDefinition.GetUniqueName(entry->mName + "_revert");
@@ -125,6 +137,44 @@ void MaterialGenerator::GenerateDefinitions(const aiScene* scene, CFileDefinitio
 
     fileDefinition.AddDefinition(std::unique_ptr<FileDefinition>(new DataFileDefinition("Gfx*", fileDefinition.GetUniqueName("material_list"), true, "_mat", std::move(materialList))));
     fileDefinition.AddDefinition(std::unique_ptr<FileDefinition>(new DataFileDefinition("Gfx*", fileDefinition.GetUniqueName("material_revert_list"), true, "_mat", std::move(revertList))));
+
+    if (mSettings.mTmemPacking) {
+        std::cout << "TMEM packing: drawing every material once loads " << packedTextureLoads << " textures instead of " << unpackedTextureLoads << std::endl;
+
+        fileDefinition.AddDefinition(std::unique_ptr<FileDefinition>(new DataFileDefinition("Gfx*", fileDefinition.GetUniqueName("material_tile_only_list"), true, "_mat", std::move(tileOnlyList))));
+        fileDefinition.AddDefinition(std::unique_ptr<FileDefinition>(new DataFileDefinition("short", fileDefinition.GetUniqueName("material_tmem_group"), true, "_mat", std::move(tmemGroupList))));
+        fileDefinition.AddDefinition(std::unique_ptr<FileDefinition>(new DataFileDefinition("u32", fileDefinition.GetUniqueName("material_tmem_textures"), true, "_mat", std::move(tmemTextureList))));
+    }
+}
+
+MaterialState MaterialGenerator::StateWithTexturesLoaded(const MaterialState& from, const MaterialState& material) {
+    MaterialState result = from;
+
+    // Record the material's textures as already loaded in tiles it doesn't use
+    // so generating the material only updates the tile descriptors. The tiles
+    // are generated in order so the marker has to come after the tile it's for
+    int freeTile = MAX_TILE_COUNT - 1;
+
+    for (int i = 0; i < MAX_TILE_COUNT; ++i) {
+        const TileState& tile = material.tiles[i];
+
+        if (!tile.isOn || !tile.texture) {
+            continue;
+        }
+
+        while (freeTile >= 0 && (material.tiles[freeTile].isOn || result.tiles[freeTile].texture)) {
+            --freeTile;
+        }
+
+        if (freeTile <= i) {
+            break;
+        }
+
+        result.tiles[freeTile].texture = tile.texture;
+        result.tiles[freeTile].tmem = tile.tmem;
+    }
+
+    return result;
 }
 
 std::string MaterialGenerator::MaterialIndexMacroName(const std::string& materialName) {
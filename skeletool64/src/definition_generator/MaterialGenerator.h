@@ -13,6 +13,8 @@ public:
 
     static std::string MaterialIndexMacroName(const std::string& materialName);
 private:
+    static MaterialState StateWithTexturesLoaded(const MaterialState& from, const MaterialState& material);
+
     DisplayListSettings mSettings;
 };
 
@@ -183,6 +183,10 @@ MeshDefinitionResults MeshDefinitionGenerator::GenerateDefinitionsWithResults(co
 
         fileDefinition.AddDataDefinition("armature", "struct SKArmatureDefinition", false, "_geo", std::move(armatureDef));
     }
+
+    if (mSettings.mExportRelocations) {
+        fileDefinition.AddRelocationTable("model_relocations", "_geo");
+    }
     
     return result;
 }
\ No newline at end of file
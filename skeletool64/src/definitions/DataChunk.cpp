@@ -115,6 +115,10 @@ void StructureDataChunk::AddNewlineHint() {
     mChildren.push_back(std::unique_ptr<DataChunk>(new NewlineHintChunk()));
 }
 
+const std::vector<std::unique_ptr<DataChunk>>& StructureDataChunk::GetChildren() const {
+    return mChildren;
+}
+
 #define MAX_CHARS_PER_LINE  80
 #define SPACES_PER_INDENT   4
 
@@ -198,6 +202,14 @@ void MacroDataChunk::Add(std::unique_ptr<DataChunk> entry) {
     mParameters.push_back(std::move(entry));
 }
 
+const std::string& MacroDataChunk::GetMacroName() const {
+    return mMacroName;
+}
+
+DataChunk* MacroDataChunk::GetParameter(size_t index) const {
+    return index < mParameters.size() ? mParameters[index].get() : nullptr;
+}
+
 bool MacroDataChunk::Output(std::ostream& output, int indentLevel, int linePrefix) {
     output << mMacroName << '(';
 
@@ -42,6 +42,10 @@ public:
         output << mValue;
         return true;
     }
+
+    const T& GetValue() const {
+        return mValue;
+    }
 protected:
     virtual int CalculateEstimatedLength() {
         std::ostringstream tmp;
@@ -98,6 +102,8 @@ public:
 
     void AddNewlineHint();
 
+    const std::vector<std::unique_ptr<DataChunk>>& GetChildren() const;
+
     virtual bool Output(std::ostream& output, int indentLevel, int linePrefix);
     
     static void OutputIndent(std::ostream& output, int indentLevel);
@@ -121,6 +127,9 @@ public:
         Add(std::unique_ptr<DataChunk>(new PrimitiveDataChunk<T>(primitive)));
     }
 
+    const std::string& GetMacroName() const;
+    DataChunk* GetParameter(size_t index) const;
+
     virtual bool Output(std::ostream& output, int indentLevel, int linePrefix);
 protected:
     virtual int CalculateEstimatedLength();
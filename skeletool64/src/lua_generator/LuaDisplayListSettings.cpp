@@ -64,6 +64,8 @@ void fromLua(lua_State* L, DisplayListSettings& result, const DisplayListSetting
  @tfield sk_transform.Transform fixed_point_transform
  @tfield number model_scale
  @tfield number fixed_point_scale
+ @tfield number ticks_per_second
+ @tfield boolean verbose
  */
 
 /***
@@ -93,6 +95,9 @@ int luaInputModuleLoader(lua_State* L) {
     toLua(L, defaults->mTicksPerSecond);
     lua_setfield(L, -2, "ticks_per_second");
 
+    lua_pushboolean(L, defaults->mVerbose);
+    lua_setfield(L, -2, "verbose");
+
     lua_setfield(L, -2, "settings");
 
     lua_pushstring(L, levelFilename);
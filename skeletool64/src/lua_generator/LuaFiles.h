@@ -1,4 +1,5 @@
 EMIT(sk_definition_writer)
 EMIT(sk_math)
 EMIT(sk_scene)
+EMIT(sk_animation_compression)
 EMIT(sk_animation)
\ No newline at end of file
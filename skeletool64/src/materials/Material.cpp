@@ -1,10 +1,44 @@
 
 #include "Material.h"
 
+#include <algorithm>
+
 #include "../StringUtils.h"
 #include "../CFileDefinition.h"
+#include "RenderMode.h"
+
+Material::Material(const std::string& name): mName(name), mNormalSource(NormalSource::Normal), mExcludeFromOutut(false), mSortOrder(0), mTmemGroup(-1), mTmemTextures(0) {}
+
+int sortOrderForMaterial(const Material& material) {
+    // assume opaque
+    if (!material.mState.hasRenderMode) {
+        return OPAQUE_ORDER;
+    }
 
-Material::Material(const std::string& name): mName(name), mNormalSource(NormalSource::Normal), mExcludeFromOutut(false), mSortOrder(0) {}
+    if (material.mState.cycle1RenderMode.GetZMode() == ZMODE_DEC ||
+        material.mState.cycle2RenderMode.GetZMode() == ZMODE_DEC) {
+        return DECAL_ORDER;
+    }
+
+    if ((material.mState.cycle1RenderMode.data | material.mState.cycle2RenderMode.data) & FORCE_BL) {
+        return TRANSPARENT_ORDER;
+    }
+
+    return OPAQUE_ORDER;
+}
+
+void sortMaterialsForOutput(std::vector<std::shared_ptr<Material>>& materials) {
+    std::stable_sort(materials.begin(), materials.end(), [&](const std::shared_ptr<Material>& a, const std::shared_ptr<Material>& b) -> bool {
+        int aOrder = sortOrderForMaterial(*a);
+        int bOrder = sortOrderForMaterial(*b);
+
+        if (aOrder != bOrder) {
+            return aOrder < bOrder;
+        }
+
+        return a->mSortOrder < b->mSortOrder;
+    });
+}
 
 void Material::Write(CFileDefinition& fileDef, const MaterialState& from, StructureDataChunk& output, bool targetCIBuffer) {
     generateMaterial(fileDef, from, mState, output, targetCIBuffer);
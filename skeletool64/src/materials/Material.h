@@ -34,6 +34,11 @@ public:
     bool mExcludeFromOutut;
     int mSortOrder;
     PixelRGBAu8 mDefaultVertexColor;
+    // Index of the group of textures that share TMEM with this material
+    // or -1 if the material's textures are not packed
+    int mTmemGroup;
+    // Bit for each texture in the TMEM group used by this material
+    uint32_t mTmemTextures;
 
     void Write(CFileDefinition& fileDef, const MaterialState& from, StructureDataChunk& output, bool targetCIBuffer);
 
@@ -43,4 +48,12 @@ public:
     static VertexType GetVertexType(Material* material);
 };
 
+#define OPAQUE_ORDER        0
+#define DECAL_ORDER         1
+#define TRANSPARENT_ORDER   2
+
+int sortOrderForMaterial(const Material& material);
+// Sorts materials into the order MaterialGenerator gives them their indices
+void sortMaterialsForOutput(std::vector<std::shared_ptr<Material>>& materials);
+
 #endif
\ No newline at end of file
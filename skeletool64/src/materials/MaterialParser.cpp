@@ -21,6 +21,8 @@ ParseError::ParseError(const std::string& message) :
 
 ParseResult::ParseResult(const std::string& insideFolder) : mInsideFolder(insideFolder) {}
 
+MaterialFile::MaterialFile() : mTmemPacking(false) {}
+
 std::string formatError(const std::string& message, const YAML::Mark& mark) {
     std::stringstream output;
     output << "error at line " << mark.line + 1 << ", column "
@@ -824,6 +826,115 @@ std::shared_ptr<Material> parseMaterial(const std::string& name, const YAML::Nod
 
 }
 
+#define TMEM_LINE_COUNT             512
+#define TMEM_GROUP_MAX_TEXTURES     32
+
+// Materials without packed textures that still load something into TMEM
+#define TMEM_UNPACKED_TEXTURES      0xFFFFFFFF
+
+struct TmemGroup {
+    TmemGroup();
+    int usedLines;
+    // textures in the order they were added paired with their TMEM line
+    std::vector<std::pair<std::shared_ptr<TextureDefinition>, int>> textures;
+};
+
+TmemGroup::TmemGroup() : usedLines(0) {}
+
+TileState* singlePackableTile(Material& material, bool& loadsTextures) {
+    TileState* result = nullptr;
+    int textureCount = 0;
+
+    for (int i = 0; i < MAX_TILE_COUNT; ++i) {
+        TileState& tile = material.mState.tiles[i];
+
+        if (!tile.isOn || !tile.texture) {
+            continue;
+        }
+
+        ++textureCount;
+        result = &tile;
+    }
+
+    loadsTextures = textureCount > 0;
+
+    // Only single textured materials at the default address are packed. Palettes
+    // live in the upper half of TMEM so those textures are excluded too
+    if (textureCount != 1 || result->tmem != 0 || result->texture->GetPalette()) {
+        return nullptr;
+    }
+
+    // 32 bit textures are split across both halves of TMEM so a texture
+    // packed next to one would overlap the other half of its neighbour
+    if (result->texture->Size() == G_IM_SIZ::G_IM_SIZ_32b) {
+        return nullptr;
+    }
+
+    return result;
+}
+
+// Assigns each texture a TMEM address so materials sorted near each other can
+// keep their textures loaded at the same time. Switching between materials in
+// the same group then only needs a tile change while their textures are still
+// resident. Groups are filled in the order the material indices are generated
+// in, which is the order the renderer draws them, so neighbouring materials
+// end up in the same group. The assignment only depends on the material file
+// so every model using these materials agrees on where each texture lives.
+void packTmem(MaterialFile& materialFile) {
+    std::vector<std::shared_ptr<Material>> materials;
+
+    for (auto& it : materialFile.mMaterials) {
+        it.second->mTmemGroup = -1;
+        it.second->mTmemTextures = 0;
+
+        if (!it.second->mExcludeFromOutut) {
+            materials.push_back(it.second);
+        }
+    }
+
+    sortMaterialsForOutput(materials);
+
+    int groupIndex = 0;
+    TmemGroup group;
+
+    for (auto& it : materials) {
+        Material& material = *it;
+        bool loadsTextures;
+        TileState* tile = singlePackableTile(material, loadsTextures);
+
+        if (!tile) {
+            material.mTmemTextures = loadsTextures ? TMEM_UNPACKED_TEXTURES : 0;
+            continue;
+        }
+
+        int lineCount = (tile->texture->NBytes() + 7) / 8;
+
+        if (lineCount > TMEM_LINE_COUNT) {
+            material.mTmemTextures = TMEM_UNPACKED_TEXTURES;
+            continue;
+        }
+
+        auto existing = std::find_if(group.textures.begin(), group.textures.end(), [&](const std::pair<std::shared_ptr<TextureDefinition>, int>& entry) {
+            return entry.first == tile->texture;
+        });
+
+        if (existing == group.textures.end()) {
+            if (group.usedLines + lineCount > TMEM_LINE_COUNT || group.textures.size() == TMEM_GROUP_MAX_TEXTURES) {
+                group = TmemGroup();
+                ++groupIndex;
+            }
+
+            group.textures.push_back(std::make_pair(tile->texture, group.usedLines));
+            group.usedLines += lineCount;
+            existing = group.textures.end() - 1;
+        }
+
+        tile->tmem = existing->second;
+        material.mTmemGroup = groupIndex;
+        material.mTmemTextures = 1u << (existing - group.textures.begin());
+    }
+}
+
 void parseMaterialFile(std::istream& input, ParseResult& output) {
     try {
         YAML::Node doc = YAML::Load(input);
@@ -834,6 +945,13 @@ void parseMaterialFile(std::istream& input, ParseResult& output) {
             std::string name = it->first.as<std::string>();
             output.mMaterialFile.mMaterials[name] = parseMaterial(name, it->second, output);
         }
+
+        auto tmemPacking = doc["tmemPacking"];
+        output.mMaterialFile.mTmemPacking = tmemPacking.IsDefined() && tmemPacking.as<bool>();
+
+        if (output.mMaterialFile.mTmemPacking) {
+            packTmem(output.mMaterialFile);
+        }
     } catch (YAML::ParserException& e) {
         output.mErrors.push_back(ParseError(e.what()));
     }
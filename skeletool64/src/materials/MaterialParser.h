@@ -9,7 +9,9 @@
 
 struct MaterialFile {
 public:
+    MaterialFile();
     std::map<std::string, std::shared_ptr<Material>> mMaterials;
+    bool mTmemPacking;
 };
 
 struct ParseError {
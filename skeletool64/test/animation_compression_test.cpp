@@ -0,0 +1,362 @@
+// Compresses synthetic clips with both the C++ and the Lua exporter and
+// decodes every frame the same way skAnimatorBlendCompressedTransform does
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <lua.h>
+#include <lauxlib.h>
+#include <lualib.h>
+}
+
+#include "../src/definition_generator/AnimationCompression.h"
+#include "../../src/sk64/skeletool_clip.h"
+
+// constant tracks are stored like generateBoneFrame() does which truncates the
+// position and allow for 10 bit quantization of packed rotations
+#define DECODE_POSITION_TOLERANCE   (ANIMATION_POSITION_TOLERANCE + 1.0f)
+#define DECODE_ROTATION_TOLERANCE   (ANIMATION_ROTATION_TOLERANCE + 0.005f)
+
+typedef std::vector<std::vector<FrameData>> Clip;
+
+static int gFailures = 0;
+
+#define CHECK(condition, message) do { \
+    if (!(condition)) { \
+        std::cerr << name << ": " << message << std::endl; \
+        ++gFailures; \
+        return; \
+    } \
+} while (0)
+
+aiQuaternion unpackRuntimeRotation(unsigned packed) {
+    float components[4];
+    int largestIndex = packed >> 30;
+    int shift = SK_PACKED_ROTATION_BITS * 2;
+    float lengthSqrd = 0.0f;
+
+    for (int i = 0; i < 4; ++i) {
+        if (i == largestIndex) {
+            continue;
+        }
+
+        int quantized = (int)((packed >> shift) & SK_PACKED_ROTATION_MASK) - SK_PACKED_ROTATION_CENTER;
+        components[i] = quantized * (SK_PACKED_ROTATION_RANGE / SK_PACKED_ROTATION_CENTER);
+        lengthSqrd += components[i] * components[i];
+        shift -= SK_PACKED_ROTATION_BITS;
+    }
+
+    components[largestIndex] = lengthSqrd >= 1.0f ? 0.0f : sqrtf(1.0f - lengthSqrd);
+
+    return aiQuaternion(components[3], components[0], components[1], components[2]);
+}
+
+SKAnimationBoneFrame constantBone(const FrameData& frame) {
+    float sign = frame.rotation.w < 0.0f ? -1.0f : 1.0f;
+
+    SKAnimationBoneFrame result;
+    result.position.x = (short)frame.position.x;
+    result.position.y = (short)frame.position.y;
+    result.position.z = (short)frame.position.z;
+    result.rotation.x = (short)(frame.rotation.x * sign * 32767);
+    result.rotation.y = (short)(frame.rotation.y * sign * 32767);
+    result.rotation.z = (short)(frame.rotation.z * sign * 32767);
+    return result;
+}
+
+FrameData extractConstantBone(const SKAnimationBoneFrame& bone) {
+    FrameData result;
+    result.position = aiVector3D(bone.position.x, bone.position.y, bone.position.z);
+
+    float x = bone.rotation.x * (1.0f / 32767.0f);
+    float y = bone.rotation.y * (1.0f / 32767.0f);
+    float z = bone.rotation.z * (1.0f / 32767.0f);
+    float wSqrd = 1.0f - (x * x + y * y + z * z);
+    result.rotation = aiQuaternion(wSqrd <= 0.0f ? 0.0f : sqrtf(wSqrd), x, y, z);
+
+    return result;
+}
+
+std::vector<FrameData> decodeKeyframe(const CompressedAnimation& compressed, const std::vector<SKAnimationBoneFrame>& constantPose, int keyframeIndex) {
+    std::vector<FrameData> result;
+    const unsigned short* keyframe = &compressed.keyframes[keyframeIndex * compressed.keyframeSize / sizeof(unsigned short)];
+
+    for (unsigned boneIndex = 0; boneIndex < compressed.boneFlags.size(); ++boneIndex) {
+        int flags = compressed.boneFlags[boneIndex];
+        FrameData bone = extractConstantBone(constantPose[boneIndex]);
+
+        if (!(flags & SKBoneTrackFlagsConstantPosition)) {
+            bone.position = aiVector3D((short)keyframe[0], (short)keyframe[1], (short)keyframe[2]);
+            keyframe += 3;
+        }
+
+        if (!(flags & SKBoneTrackFlagsConstantRotation)) {
+            bone.rotation = unpackRuntimeRotation(((unsigned)keyframe[0] << 16) | keyframe[1]);
+            keyframe += 2;
+        }
+
+        result.push_back(bone);
+    }
+
+    return result;
+}
+
+// same accumulation as skAnimatorBlendBone followed by skAnimatorNormalize
+std::vector<FrameData> blendKeyframes(const std::vector<FrameData>& prev, const std::vector<FrameData>& next, float lerp) {
+    std::vector<FrameData> result;
+
+    for (unsigned boneIndex = 0; boneIndex < prev.size(); ++boneIndex) {
+        const aiQuaternion& a = prev[boneIndex].rotation;
+        const aiQuaternion& b = next[boneIndex].rotation;
+        float sign = (a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w) < 0.0f ? -1.0f : 1.0f;
+
+        FrameData bone;
+        bone.position = prev[boneIndex].position * (1.0f - lerp) + next[boneIndex].position * lerp;
+        bone.rotation = aiQuaternion(
+            a.w * (1.0f - lerp) + b.w * lerp * sign,
+            a.x * (1.0f - lerp) + b.x * lerp * sign,
+            a.y * (1.0f - lerp) + b.y * lerp * sign,
+            a.z * (1.0f - lerp) + b.z * lerp * sign
+        );
+        bone.rotation.Normalize();
+        result.push_back(bone);
+    }
+
+    return result;
+}
+
+void checkRoundTrip(const std::string& name, const Clip& clip, unsigned boneCount, const CompressedAnimation& compressed) {
+    int nFrames = clip.size();
+    int nKeyframes = compressed.keyframeTimes.size();
+
+    CHECK(compressed.boneFlags.size() == boneCount, "bone flag count " << compressed.boneFlags.size());
+    CHECK(nKeyframes > 0, "no keyframes");
+    CHECK(!compressed.keyframes.empty(), "empty keyframe data");
+    CHECK(compressed.keyframeTimes[0] == 0, "first keyframe at " << compressed.keyframeTimes[0]);
+    CHECK(compressed.keyframes.size() * sizeof(unsigned short) >= (size_t)(nKeyframes * compressed.keyframeSize), "keyframe data too small");
+
+    if (nFrames == 0) {
+        return;
+    }
+
+    CHECK(compressed.keyframeTimes.back() == nFrames - 1, "last keyframe at " << compressed.keyframeTimes.back());
+
+    std::vector<SKAnimationBoneFrame> constantPose;
+
+    for (unsigned boneIndex = 0; boneIndex < boneCount; ++boneIndex) {
+        constantPose.push_back(constantBone(clip[0][boneIndex]));
+    }
+
+    int keyframeIndex = 0;
+
+    for (int frame = 0; frame < nFrames; ++frame) {
+        while (keyframeIndex + 1 < nKeyframes && compressed.keyframeTimes[keyframeIndex + 1] <= frame) {
+            ++keyframeIndex;
+        }
+
+        int nextIndex = keyframeIndex + 1 < nKeyframes ? keyframeIndex + 1 : keyframeIndex;
+        int prevTime = compressed.keyframeTimes[keyframeIndex];
+        int nextTime = compressed.keyframeTimes[nextIndex];
+        float lerp = nextTime == prevTime ? 0.0f : (float)(frame - prevTime) / (float)(nextTime - prevTime);
+
+        std::vector<FrameData> decoded = blendKeyframes(
+            decodeKeyframe(compressed, constantPose, keyframeIndex),
+            decodeKeyframe(compressed, constantPose, nextIndex),
+            lerp
+        );
+
+        for (unsigned boneIndex = 0; boneIndex < boneCount; ++boneIndex) {
+            const FrameData& expected = clip[frame][boneIndex];
+            const FrameData& actual = decoded[boneIndex];
+
+            CHECK(
+                fabs(actual.position.x - expected.position.x) <= DECODE_POSITION_TOLERANCE &&
+                fabs(actual.position.y - expected.position.y) <= DECODE_POSITION_TOLERANCE &&
+                fabs(actual.position.z - expected.position.z) <= DECODE_POSITION_TOLERANCE,
+                "frame " << frame << " bone " << boneIndex << " position off by " << (actual.position - expected.position).Length()
+            );
+
+            float error = rotationError(actual.rotation, expected.rotation);
+            CHECK(error <= DECODE_ROTATION_TOLERANCE, "frame " << frame << " bone " << boneIndex << " rotation off by " << error);
+        }
+    }
+}
+
+void pushVector3(lua_State* L, const aiVector3D& vector) {
+    lua_getfield(L, -1, "vector3");
+    lua_pushnumber(L, vector.x);
+    lua_pushnumber(L, vector.y);
+    lua_pushnumber(L, vector.z);
+    lua_call(L, 3, 1);
+}
+
+void pushQuaternion(lua_State* L, const aiQuaternion& quaternion) {
+    lua_getfield(L, -1, "quaternion");
+    lua_pushnumber(L, quaternion.x);
+    lua_pushnumber(L, quaternion.y);
+    lua_pushnumber(L, quaternion.z);
+    lua_pushnumber(L, quaternion.w);
+    lua_call(L, 4, 1);
+}
+
+std::vector<int> readIntegerList(lua_State* L, int index, const char* field) {
+    std::vector<int> result;
+    lua_getfield(L, index, field);
+    lua_Integer length = luaL_len(L, -1);
+
+    for (lua_Integer i = 1; i <= length; ++i) {
+        lua_geti(L, -1, i);
+        result.push_back((int)lua_tointeger(L, -1));
+        lua_pop(L, 1);
+    }
+
+    lua_pop(L, 1);
+    return result;
+}
+
+bool compressAnimationWithLua(lua_State* L, const Clip& clip, unsigned boneCount, CompressedAnimation& result) {
+    lua_getglobal(L, "require");
+    lua_pushstring(L, "sk_animation_compression");
+    lua_call(L, 1, 1);
+    lua_getfield(L, -1, "compress_animation");
+
+    lua_getglobal(L, "require");
+    lua_pushstring(L, "sk_math");
+    lua_call(L, 1, 1);
+
+    lua_newtable(L);
+
+    for (unsigned frame = 0; frame < clip.size(); ++frame) {
+        lua_newtable(L);
+
+        for (unsigned boneIndex = 0; boneIndex < boneCount; ++boneIndex) {
+            lua_newtable(L);
+            // sk_math is below the frame and bone tables
+            lua_pushvalue(L, -4);
+            pushVector3(L, clip[frame][boneIndex].position);
+            lua_setfield(L, -3, "position");
+            pushQuaternion(L, clip[frame][boneIndex].rotation);
+            lua_setfield(L, -3, "rotation");
+            lua_pop(L, 1);
+            lua_seti(L, -2, boneIndex + 1);
+        }
+
+        lua_seti(L, -2, frame + 1);
+    }
+
+    // replace sk_math with the frames
+    lua_remove(L, -2);
+    lua_pushinteger(L, boneCount);
+
+    if (lua_pcall(L, 2, 1, 0) != LUA_OK) {
+        std::cerr << lua_tostring(L, -1) << std::endl;
+        lua_pop(L, 2);
+        return false;
+    }
+
+    result.boneFlags = readIntegerList(L, -1, "bone_flags");
+
+    for (int value : readIntegerList(L, -1, "keyframe_times")) {
+        result.keyframeTimes.push_back((unsigned short)value);
+    }
+
+    for (int value : readIntegerList(L, -1, "keyframes")) {
+        result.keyframes.push_back((unsigned short)value);
+    }
+
+    lua_getfield(L, -1, "keyframe_size");
+    result.keyframeSize = (int)lua_tointeger(L, -1);
+    lua_pop(L, 3);
+
+    return true;
+}
+
+aiQuaternion axisAngle(const aiVector3D& axis, float angle) {
+    return aiQuaternion(axis, angle);
+}
+
+Clip buildClip(int nFrames, unsigned boneCount, bool isMoving) {
+    Clip result(nFrames);
+
+    for (int frame = 0; frame < nFrames; ++frame) {
+        float time = frame / 30.0f;
+
+        for (unsigned boneIndex = 0; boneIndex < boneCount; ++boneIndex) {
+            FrameData bone;
+            bone.position = aiVector3D(boneIndex * 100.0f, 20.0f, -50.0f);
+            bone.rotation = axisAngle(aiVector3D(0.0f, 1.0f, 0.0f), 0.5f * boneIndex);
+
+            if (isMoving) {
+                switch (boneIndex % 3) {
+                    case 0:
+                        // linear then oscillating so some frames can be dropped and some can't
+                        bone.position.x += frame < nFrames / 2 ? frame * 8.0f : 200.0f * sinf(time * 6.0f);
+                        break;
+                    case 1:
+                        bone.rotation = axisAngle(aiVector3D(0.0f, 0.0f, 1.0f), time * 3.0f);
+                        break;
+                    case 2:
+                        bone.position.y += 40.0f * sinf(time * 2.0f);
+                        bone.rotation = axisAngle(aiVector3D(0.6f, 0.8f, 0.0f), 2.5f * sinf(time * 4.0f));
+                        break;
+                }
+            }
+
+            result[frame].push_back(bone);
+        }
+    }
+
+    return result;
+}
+
+int main() {
+    lua_State* L = luaL_newstate();
+    luaL_openlibs(L);
+
+    lua_getglobal(L, "package");
+    lua_pushstring(L, SKELETOOL_LUA_DIR "/?.lua");
+    lua_setfield(L, -2, "path");
+    lua_pop(L, 1);
+
+    struct TestClip {
+        const char* name;
+        int nFrames;
+        unsigned boneCount;
+        bool isMoving;
+    };
+
+    TestClip clips[] = {
+        {"empty", 0, 3, false},
+        {"single frame", 1, 3, true},
+        {"all constant", 40, 4, false},
+        {"moving", 90, 6, true},
+    };
+
+    for (auto& testClip : clips) {
+        Clip clip = buildClip(testClip.nFrames, testClip.boneCount, testClip.isMoving);
+
+        checkRoundTrip(std::string("c++ ") + testClip.name, clip, testClip.boneCount, compressAnimation(clip, testClip.boneCount));
+
+        CompressedAnimation luaCompressed;
+
+        if (compressAnimationWithLua(L, clip, testClip.boneCount, luaCompressed)) {
+            checkRoundTrip(std::string("lua ") + testClip.name, clip, testClip.boneCount, luaCompressed);
+        } else {
+            std::cerr << "lua " << testClip.name << ": compress_animation failed" << std::endl;
+            ++gFailures;
+        }
+    }
+
+    lua_close(L);
+
+    if (gFailures) {
+        std::cerr << gFailures << " failures" << std::endl;
+        return 1;
+    }
+
+    std::cout << "animation compression round trip passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,241 @@
+-- Checks the relocation tables built by sk_definition_writer against an
+-- independent walk of the same definitions
+
+local sk_definition_writer = require('sk_definition_writer')
+
+local function walk_data(data, callback)
+    if (type(data) ~= "table") then
+        return
+    end
+
+    if (callback(data)) then
+        return
+    end
+
+    for _, value in pairs(data) do
+        walk_data(value, callback)
+    end
+end
+
+-- every table that ends up in a file at location
+local function data_in_location(definitions, location)
+    local result = {}
+
+    for _, definition in ipairs(definitions) do
+        if (definition.location == location) then
+            walk_data(definition.data, function(data)
+                if (sk_definition_writer.is_reference_type(data) or sk_definition_writer.is_raw(data) or sk_definition_writer.is_macro(data)) then
+                    return true
+                end
+
+                result[data] = true
+            end)
+        end
+    end
+
+    return result
+end
+
+local function expected_relocations(definitions, location)
+    local local_data = data_in_location(definitions, location)
+    local result = {}
+
+    local function visit(data, path)
+        if (type(data) ~= "table") then
+            return
+        end
+
+        if (sk_definition_writer.is_raw(data)) then
+            if (data.relocatable) then
+                result[path] = true
+            end
+
+            return
+        end
+
+        if (sk_definition_writer.is_reference_type(data)) then
+            if (data.value ~= nil and local_data[data.value]) then
+                result[path] = true
+            end
+
+            return
+        end
+
+        for key, value in pairs(data) do
+            if (type(key) == "number") then
+                visit(value, path .. "[" .. (key - 1) .. "]")
+            else
+                visit(value, path .. "." .. key)
+            end
+        end
+    end
+
+    for _, definition in ipairs(definitions) do
+        if (definition.location == location) then
+            visit(definition.data, definition.name)
+        end
+    end
+
+    return result
+end
+
+-- run the writer the same way dumpDefinitions in LuaDefinitionWriter.cpp does
+local function process()
+    local definitions = sk_definition_writer.consume_pending_definitions()
+
+    for _, definition in ipairs(definitions) do
+        definition.name = definition.nameHint
+    end
+
+    -- the expected table is worked out before the writer replaces references
+    local expected = {}
+
+    for _, definition in ipairs(definitions) do
+        if (definition.dataType == "void*[]" and not expected[definition.location]) then
+            expected[definition.location] = expected_relocations(definitions, definition.location)
+        end
+    end
+
+    sk_definition_writer.process_definitions(definitions)
+
+    return definitions, expected
+end
+
+local function check_table(name, relocations, expected)
+    local found = {}
+
+    assert(#relocations > 0, name .. " is empty")
+    assert(relocations[#relocations] == sk_definition_writer.null_value, name .. " is not NULL terminated")
+
+    for index = 1, #relocations - 1 do
+        local entry = relocations[index]
+        assert(sk_definition_writer.is_raw(entry), name .. "[" .. index .. "] is not a raw value")
+
+        local path = entry.value:match("^&(.*)$")
+        assert(path, name .. "[" .. index .. "] '" .. entry.value .. "' is not an address")
+        -- must be something c can take the address of
+        assert(path:match("^[%a_][%w_]*[%w_%.%[%]]*$"), name .. " has an invalid path '" .. path .. "'")
+        assert(not found[path], name .. " lists '" .. path .. "' twice")
+        assert(expected[path], name .. " has '" .. path .. "' which is not a pointer into the same file")
+
+        found[path] = true
+    end
+
+    for path in pairs(expected) do
+        assert(found[path], name .. " is missing '" .. path .. "'")
+    end
+end
+
+local function test_level_layout()
+    local vertices = {1, 2, 3}
+    local quads = {
+        {edgeA = 1, edgeB = 2},
+        {edgeA = 3, edgeB = 4},
+    }
+    local colliders = {
+        {collider = sk_definition_writer.reference_to(quads, 2), next = sk_definition_writer.null_value},
+        {collider = sk_definition_writer.reference_to(quads, 1), next = sk_definition_writer.reference_to(nil)},
+    }
+    local animation_keyframes = {0, 1, 2}
+    local other_file = {4, 5, 6}
+
+    local relocations = sk_definition_writer.add_relocation_table("level_relocations", "_geo")
+
+    sk_definition_writer.add_definition("vertices", "Vtx[]", "_geo", vertices)
+    sk_definition_writer.add_definition("quads", "struct CollisionQuad[]", "_geo", quads)
+    sk_definition_writer.add_definition("colliders", "struct ColliderTypeData[]", "_geo", colliders)
+    sk_definition_writer.add_definition("keyframes", "unsigned short[]", "_anim", animation_keyframes)
+    sk_definition_writer.add_definition("other", "int[]", "_other", other_file)
+    sk_definition_writer.add_definition("level", "struct LevelDefinition", "_geo", {
+        collisionQuads = sk_definition_writer.reference_to(quads, 1),
+        colliders = sk_definition_writer.reference_to(colliders),
+        rooms = {
+            {vertices = sk_definition_writer.reference_to(vertices, 2), count = 3},
+            {vertices = sk_definition_writer.relocatable(sk_definition_writer.raw("(Vtx*)vertices")), count = 1},
+        },
+        -- pointers out of the segment are left alone
+        keyframes = sk_definition_writer.reference_to(animation_keyframes),
+        other = sk_definition_writer.reference_to(other_file, 2),
+        relocations = sk_definition_writer.reference_to(relocations),
+    })
+
+    -- pointers from other files into the segment don't move with it
+    sk_definition_writer.add_definition("anim_clip", "struct SKAnimationClip", "_anim", {
+        level = sk_definition_writer.reference_to(quads),
+    })
+
+    local _, expected = process()
+
+    check_table("level_relocations", relocations, expected["_geo"])
+
+    local entries = {}
+
+    for index = 1, #relocations - 1 do
+        table.insert(entries, relocations[index].value)
+    end
+
+    -- sorted by definition order then by path so output is stable
+    local expected_order = {
+        "&colliders[0].collider",
+        "&colliders[1].collider",
+        "&level.colliders",
+        "&level.collisionQuads",
+        "&level.relocations",
+        "&level.rooms[0].vertices",
+        "&level.rooms[1].vertices",
+    }
+
+    assert(#entries == #expected_order, "expected " .. #expected_order .. " relocations got " .. #entries .. ": " .. table.concat(entries, ", "))
+
+    for index, entry in ipairs(expected_order) do
+        assert(entries[index] == entry, "relocation " .. index .. " is " .. tostring(entries[index]) .. " expected " .. entry)
+    end
+end
+
+local function test_tables_per_location()
+    local geo_data = {1, 2}
+    local anim_data = {3, 4}
+
+    local geo_relocations = sk_definition_writer.add_relocation_table("geo_relocations", "_geo")
+    local anim_relocations = sk_definition_writer.add_relocation_table("anim_relocations", "_anim")
+
+    sk_definition_writer.add_definition("geo_data", "int[]", "_geo", geo_data)
+    sk_definition_writer.add_definition("anim_data", "int[]", "_anim", anim_data)
+    sk_definition_writer.add_definition("geo_pointers", "int*[]", "_geo", {
+        sk_definition_writer.reference_to(geo_data, 1),
+        sk_definition_writer.reference_to(anim_data, 1),
+    })
+    sk_definition_writer.add_definition("anim_pointers", "int*[]", "_anim", {
+        sk_definition_writer.reference_to(geo_data, 2),
+        sk_definition_writer.reference_to(anim_data, 2),
+    })
+
+    local _, expected = process()
+
+    check_table("geo_relocations", geo_relocations, expected["_geo"])
+    check_table("anim_relocations", anim_relocations, expected["_anim"])
+
+    assert(#geo_relocations == 2 and geo_relocations[1].value == "&geo_pointers[0]")
+    assert(#anim_relocations == 2 and anim_relocations[1].value == "&anim_pointers[1]")
+end
+
+local function test_pointer_in_macro()
+    local data = {1, 2}
+
+    sk_definition_writer.add_relocation_table("relocations", "_geo")
+    sk_definition_writer.add_definition("data", "int[]", "_geo", data)
+    sk_definition_writer.add_definition("commands", "Gfx[]", "_geo", {
+        sk_definition_writer.macro("gsSPVertex", sk_definition_writer.reference_to(data), 2, 0),
+    })
+
+    -- a macro argument has no address so the pointer can't be relocated
+    local success, message = pcall(process)
+    assert(not success, "a pointer passed to a macro was added to the relocation table")
+    assert(tostring(message):find("commands[0]", 1, true), "unexpected error: " .. tostring(message))
+end
+
+test_level_layout()
+test_tables_per_location()
+test_pointer_in_macro()
+
+print("definition writer relocations passed")
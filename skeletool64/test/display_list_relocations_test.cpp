@@ -0,0 +1,120 @@
+// Checks the relocation entries DisplayList::Generate finds
+// against display lists with known command layouts
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../src/DisplayList.h"
+
+static int gFailures = 0;
+
+void checkRelocations(const std::string& name, DisplayList& displayList, const std::vector<int>& expectedIndices) {
+    std::unique_ptr<FileDefinition> definition = displayList.Generate("_geo");
+    const std::vector<std::string>& relocations = displayList.GetRelocations();
+
+    std::vector<std::string> expected;
+
+    for (int index : expectedIndices) {
+        expected.push_back("&" + displayList.GetName() + "[" + std::to_string(index) + "].words.w1");
+    }
+
+    if (relocations == expected) {
+        return;
+    }
+
+    std::cerr << name << ": expected";
+
+    for (auto& entry : expected) {
+        std::cerr << " " << entry;
+    }
+
+    std::cerr << std::endl << name << ": got";
+
+    for (auto& entry : relocations) {
+        std::cerr << " " << entry;
+    }
+
+    std::cerr << std::endl;
+    ++gFailures;
+}
+
+std::unique_ptr<DataChunk> loadTlut(const std::string& macroName, const std::string& palette) {
+    std::unique_ptr<MacroDataChunk> result(new MacroDataChunk(macroName));
+    result->AddPrimitive(0);
+    result->AddPrimitive(palette);
+    return std::move(result);
+}
+
+std::unique_ptr<DataChunk> setTextureImage(const std::string& image) {
+    std::unique_ptr<MacroDataChunk> result(new MacroDataChunk("gsDPSetTextureImage"));
+    result->AddPrimitive<const char*>("G_IM_FMT_RGBA");
+    result->AddPrimitive<const char*>("G_IM_SIZ_16b");
+    result->AddPrimitive(32);
+    result->AddPrimitive(image);
+    return std::move(result);
+}
+
+void testMesh() {
+    DisplayList displayList("model_gfx");
+
+    // 0
+    displayList.AddCommand(std::unique_ptr<DisplayListCommand>(new CommentCommand("Material")));
+    displayList.AddCommand(std::unique_ptr<DisplayListCommand>(new CallDisplayListByNameCommand("model_material")));
+    // 1 to 6
+    displayList.GetDataChunk().Add(loadTlut("gsDPLoadTLUT_pal16", "model_palette"));
+    // 7
+    displayList.AddCommand(std::unique_ptr<DisplayListCommand>(new VTXCommand(3, 0, "model_vtx", 4)));
+    // generates nothing
+    displayList.AddCommand(std::unique_ptr<DisplayListCommand>(new PopMatrixCommand(0)));
+    // 8
+    displayList.AddCommand(std::unique_ptr<DisplayListCommand>(new TRI1Command(0, 1, 2)));
+    // 9, a bone attachment is a segmented address
+    displayList.AddCommand(std::unique_ptr<DisplayListCommand>(new CallDisplayListByNameCommand("(Gfx*)BONE_ATTACHMENT_SEGMENT_ADDRESS + 1")));
+    // 10
+    displayList.AddCommand(std::unique_ptr<DisplayListCommand>(new VTXCommand(3, 0, "model_vtx", 7)));
+    // 11
+    displayList.AddCommand(std::unique_ptr<DisplayListCommand>(new TRI2Command(0, 1, 2, 0, 2, 1)));
+    // 12
+    displayList.AddCommand(std::unique_ptr<DisplayListCommand>(new PopMatrixCommand(1)));
+
+    checkRelocations("mesh", displayList, {0, 1, 7, 10});
+}
+
+void testMaterial() {
+    DisplayList displayList("model_material");
+
+    // 0 to 5
+    displayList.GetDataChunk().Add(loadTlut("gsDPLoadTLUT_pal256", "model_palette"));
+    // 6
+    displayList.AddCommand(std::unique_ptr<DisplayListCommand>(new RawContentCommand("gsDPPipeSync()")));
+    // 7
+    displayList.GetDataChunk().Add(setTextureImage("model_texture"));
+    // 8, a call through a segment register
+    displayList.AddCommand(std::unique_ptr<DisplayListCommand>(new CallDisplayListByNameCommand("0x08000000")));
+    // 9
+    displayList.GetDataChunk().Add(setTextureImage("model_texture_2"));
+
+    checkRelocations("material", displayList, {0, 7, 9});
+}
+
+void testEmpty() {
+    DisplayList displayList("empty_gfx");
+    displayList.AddCommand(std::unique_ptr<DisplayListCommand>(new CommentCommand("Nothing")));
+
+    checkRelocations("empty", displayList, {});
+}
+
+int main() {
+    testMesh();
+    testMaterial();
+    testEmpty();
+
+    if (gFailures) {
+        return 1;
+    }
+
+    std::cout << "display list relocations passed" << std::endl;
+    return 0;
+}
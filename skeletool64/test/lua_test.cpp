@@ -0,0 +1,36 @@
+// Runs a lua test script with the skeletool lua modules on the
+// package path. The test fails if the script raises an error
+
+#include <iostream>
+
+extern "C" {
+#include <lua.h>
+#include <lauxlib.h>
+#include <lualib.h>
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::cerr << "usage: lua_test script.lua" << std::endl;
+        return 1;
+    }
+
+    lua_State* L = luaL_newstate();
+    luaL_openlibs(L);
+
+    lua_getglobal(L, "package");
+    lua_pushstring(L, SKELETOOL_LUA_DIR "/?.lua");
+    lua_setfield(L, -2, "path");
+    lua_pop(L, 1);
+
+    int result = 0;
+
+    if (luaL_dofile(L, argv[1]) != LUA_OK) {
+        std::cerr << lua_tostring(L, -1) << std::endl;
+        result = 1;
+    }
+
+    lua_close(L);
+
+    return result;
+}
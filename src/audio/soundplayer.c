@@ -4,10 +4,20 @@
 #include "math/mathf.h"
 #include "savefile/savefile.h"
 #include "util/frame_time.h"
+#include "util/memory.h"
 
 #define MAX_SOUND_LISTENERS     3
 
 #define SOUND_FLAGS_3D          (1 << 0)
+#define SOUND_FLAGS_LOOPED      (1 << 1)
+// Tracked without holding a voice. Only looped sounds can be virtual
+// since a voice can't start partway through a clip
+#define SOUND_FLAGS_VIRTUAL     (1 << 2)
+#define SOUND_FLAGS_PAUSED      (1 << 3)
+#define SOUND_FLAGS_STOPPED     (1 << 4)
+
+// A virtual sound takes the voice of a looped sound this many times quieter
+#define SOUND_STEAL_MARGIN      2.0f
 
 #define VOLUME_FADE_THRESHOLD   0.055f
 #define VOLUME_FADE_LENGTH      3.5f
@@ -26,12 +36,14 @@
 struct Sound {
     SoundId soundId;
     VoiceId voiceId;
+    short soundClipId;
     uint8_t flags;
     struct Vector3 pos3D;
     struct Vector3 velocity3D;
     float originalVolume;
     float volumePercent;
     float basePitch;
+    float audibility;
     enum SoundType type;
 };
 
@@ -41,8 +53,10 @@ struct SoundListener {
     struct Vector3 velocity;
 };
 
-static struct Sound sSounds[MAX_ACTIVE_SOUNDS];
+static struct Sound sSounds[MAX_TRACKED_SOUNDS];
 static int sActiveSoundCount = 0;
+static int sVoiceCount = 0;
+static struct SoundPlayerStats sSoundPlayerStats;
 
 static struct SoundListener sSoundListeners[MAX_SOUND_LISTENERS];
 static int sActiveListenerCount = 0;
@@ -144,12 +158,157 @@ static void soundPlayerCalc3DSoundParams(struct Sound* sound, float* volume, flo
     );
 }
 
+static float soundPlayerCalcAudibility(struct Sound* sound) {
+    float volume = sound->originalVolume;
+
+    if (sound->flags & SOUND_FLAGS_3D) {
+        float pitch;
+        float pan;
+        float echo;
+        soundPlayerCalc3DSoundParams(sound, &volume, &pitch, &pan, &echo);
+    }
+
+    return volume * sound->volumePercent;
+}
+
+static int soundPlayerStartVoice(struct Sound* sound) {
+    float volume = sound->originalVolume;
+    float pitch = sound->basePitch;
+    float pan = 0.5f;
+    float echo = 0.0f;
+
+    if (sound->flags & SOUND_FLAGS_3D) {
+        float pitchBend;
+        soundPlayerCalc3DSoundParams(sound, &volume, &pitchBend, &pan, &echo);
+        pitch *= pitchBend;
+    } else if (sound->type == SoundTypeVoice) {
+        echo = ECHO_VOICE_AMOUNT;
+    } else if (sound->type == SoundTypeAll) {
+        echo = ECHO_DEFAULT_AMOUNT;
+    }
+
+    sound->voiceId = audioPlaySound(
+        sound->soundClipId,
+        volume * sound->volumePercent,
+        pitch,
+        pan,
+        echo
+    );
+
+    if (sound->voiceId == VOICE_ID_NONE) {
+        return 0;
+    }
+
+    ++sVoiceCount;
+    return 1;
+}
+
+static void soundPlayerVirtualize(struct Sound* sound) {
+    // the voice is released once it has stopped
+    sound->flags |= SOUND_FLAGS_VIRTUAL;
+    audioStopSound(sound->voiceId);
+    ++sSoundPlayerStats.virtualizeCount;
+}
+
+static void soundPlayerRevive(struct Sound* sound) {
+    if (soundPlayerStartVoice(sound)) {
+        sound->flags &= ~SOUND_FLAGS_VIRTUAL;
+        ++sSoundPlayerStats.reviveCount;
+    }
+}
+
+static struct Sound* soundPlayerFindQuietestLoop() {
+    struct Sound* result = NULL;
+
+    for (int i = 0; i < sActiveSoundCount; ++i) {
+        struct Sound* sound = &sSounds[i];
+
+        // sounds that aren't 3D don't change loudness so
+        // stealing from them would just swap voices back and forth
+        if ((sound->flags & (SOUND_FLAGS_3D | SOUND_FLAGS_LOOPED | SOUND_FLAGS_VIRTUAL)) != (SOUND_FLAGS_3D | SOUND_FLAGS_LOOPED) ||
+            audioIsSoundPaused(sound->voiceId)) {
+            continue;
+        }
+
+        if (!result || sound->audibility < result->audibility) {
+            result = sound;
+        }
+    }
+
+    return result;
+}
+
+static struct Sound* soundPlayerFindLoudestVirtual() {
+    struct Sound* result = NULL;
+
+    for (int i = 0; i < sActiveSoundCount; ++i) {
+        struct Sound* sound = &sSounds[i];
+
+        if (!(sound->flags & SOUND_FLAGS_VIRTUAL) ||
+            (sound->flags & (SOUND_FLAGS_PAUSED | SOUND_FLAGS_STOPPED)) ||
+            sound->voiceId != VOICE_ID_NONE ||
+            sound->audibility <= 0.0f) {
+            continue;
+        }
+
+        if (!result || sound->audibility > result->audibility) {
+            result = sound;
+        }
+    }
+
+    return result;
+}
+
+static void soundPlayerAssignVoices(int stoppingCount) {
+    int voiceBudget = audioVoiceBudget();
+
+    // the mixer can't keep up, give up the quietest loop
+    // one at a time until it fits
+    if (sVoiceCount - stoppingCount > voiceBudget) {
+        struct Sound* victim = soundPlayerFindQuietestLoop();
+
+        if (victim) {
+            soundPlayerVirtualize(victim);
+        }
+
+        return;
+    }
+
+    struct Sound* sound = soundPlayerFindLoudestVirtual();
+
+    // loudest first so a sound that just lost its voice
+    // doesn't take it back from the one that stole it
+    while (sound && sVoiceCount < voiceBudget) {
+        soundPlayerRevive(sound);
+
+        if (sound->flags & SOUND_FLAGS_VIRTUAL) {
+            return;
+        }
+
+        sound = soundPlayerFindLoudestVirtual();
+    }
+
+    if (!sound) {
+        return;
+    }
+
+    // a stolen voice takes a frame or two to free up
+    // so only steal one at a time
+    struct Sound* victim = soundPlayerFindQuietestLoop();
+
+    if (victim && victim->audibility * SOUND_STEAL_MARGIN < sound->audibility) {
+        soundPlayerVirtualize(victim);
+    }
+}
+
 void* soundPlayerInit(void* memoryEnd) {
-    for (int i = 0; i < MAX_ACTIVE_SOUNDS; ++i) {
+    for (int i = 0; i < MAX_TRACKED_SOUNDS; ++i) {
         sSounds[i].soundId = SOUND_ID_NONE;
     }
 
     sActiveSoundCount = 0;
+    sVoiceCount = 0;
+    zeroMemory(&sSoundPlayerStats, sizeof(sSoundPlayerStats));
     sActiveListenerCount = 0;
     sSoundDamping = 0.0f;
     soundPlayerUpdateVolumeLevels();
@@ -167,18 +326,34 @@ void soundPlayerUpdate() {
 
     int writeIndex = 0;
     int isVoiceActive = 0;
+    int virtualCount = 0;
+    int stoppingCount = 0;
 
     for (int i = 0; i < sActiveSoundCount; ++i) {
         struct Sound* sound = &sSounds[i];
 
-        if (!audioIsSoundPlaying(sound->voiceId)) {
+        if (sound->voiceId != VOICE_ID_NONE && !audioIsSoundPlaying(sound->voiceId)) {
             audioReleaseVoice(sound->voiceId);
             sound->voiceId = VOICE_ID_NONE;
+            --sVoiceCount;
+        }
+
+        if (sound->voiceId == VOICE_ID_NONE && (!(sound->flags & SOUND_FLAGS_VIRTUAL) || (sound->flags & SOUND_FLAGS_STOPPED))) {
             sound->soundId = SOUND_ID_NONE;
             continue;
         }
 
-        if (!audioIsSoundPaused(sound->voiceId)) {
+        if (sound->flags & SOUND_FLAGS_VIRTUAL) {
+            ++virtualCount;
+
+            if (sound->voiceId != VOICE_ID_NONE) {
+                ++stoppingCount;
+            }
+
+            if (!(sound->flags & SOUND_FLAGS_PAUSED)) {
+                sound->audibility = soundPlayerCalcAudibility(sound);
+            }
+        } else if (!audioIsSoundPaused(sound->voiceId)) {
             if (sound->type == SoundTypeVoice) {
                 isVoiceActive = 1;
             }
@@ -190,11 +365,20 @@ void soundPlayerUpdate() {
                 float echo;
                 soundPlayerCalc3DSoundParams(sound, &volume, &pitch, &pan, &echo);
 
+                sound->audibility = volume * sound->volumePercent;
+
                 if (sound->type != SoundTypeVoice) {
                     volume *= sSoundDamping;
                 }
 
-                audioSetSoundParams(sound->voiceId, volume * sound->volumePercent, sound->basePitch * pitch, pan, echo);
+                if ((sound->flags & SOUND_FLAGS_LOOPED) && sound->audibility <= 0.0f) {
+                    soundPlayerVirtualize(sound);
+                    ++stoppingCount;
+                } else {
+                    audioSetSoundParams(sound->voiceId, volume * sound->volumePercent, sound->basePitch * pitch, pan, echo);
+                }
+            } else {
+                sound->audibility = sound->originalVolume * sound->volumePercent;
             }
         }
 
@@ -211,53 +395,51 @@ void soundPlayerUpdate() {
         FIXED_DELTA_TIME
     );
     sActiveSoundCount = writeIndex;
+
+    soundPlayerAssignVoices(stoppingCount);
+
+    sSoundPlayerStats.voiceCount = sVoiceCount;
+    sSoundPlayerStats.virtualCount = virtualCount;
 }
 
 SoundId soundPlayerPlay(int soundClipId, float volume, float pitch, struct Vector3* position, struct Vector3* velocity, enum SoundType type) {
-    if (sActiveSoundCount >= MAX_ACTIVE_SOUNDS ||
-        (sActiveSoundCount >= MAX_SKIPPABLE_SOUNDS && clipsCheckSoundSkippable(soundClipId))
-    ) {
+    if (sActiveSoundCount >= MAX_TRACKED_SOUNDS) {
+        ++sSoundPlayerStats.droppedCount;
         return SOUND_ID_NONE;
     }
 
     struct Sound* sound = &sSounds[sActiveSoundCount];
-    sound->flags = 0;
+    sound->voiceId = VOICE_ID_NONE;
+    sound->soundClipId = soundClipId;
+    sound->flags = audioIsSoundClipLooped(soundClipId) ? SOUND_FLAGS_LOOPED : 0;
     sound->originalVolume = volume;
     sound->basePitch = pitch;
     sound->type = type;
     soundPlayerSetVolumePercent(sound);
 
-    float pan = 0.5f;
-    float echo = 0.0f;
-    volume = sound->originalVolume;
-
     if (position) {
         sound->flags |= SOUND_FLAGS_3D;
         sound->pos3D = *position;
         sound->velocity3D = *velocity;
-
-        float pitchBend;
-        soundPlayerCalc3DSoundParams(sound, &volume, &pitchBend, &pan, &echo);
-        pitch *= pitchBend;
-    } else if (type == SoundTypeVoice) {
-        echo = ECHO_VOICE_AMOUNT;
-    } else if (type == SoundTypeAll) {
-        echo = ECHO_DEFAULT_AMOUNT;
     }
 
-    VoiceId voiceId = audioPlaySound(
-        soundClipId,
-        volume * sound->volumePercent,
-        pitch,
-        pan,
-        echo
-    );
-    if (voiceId == VOICE_ID_NONE) {
-        return SOUND_ID_NONE;
+    sound->audibility = soundPlayerCalcAudibility(sound);
+
+    int needsVoice = sVoiceCount < audioVoiceBudget() &&
+        !(sVoiceCount >= MAX_SKIPPABLE_SOUNDS && clipsCheckSoundSkippable(soundClipId)) &&
+        // out of earshot loops start virtual
+        !((sound->flags & SOUND_FLAGS_LOOPED) && sound->audibility <= 0.0f);
+
+    if (!needsVoice || !soundPlayerStartVoice(sound)) {
+        if (!(sound->flags & SOUND_FLAGS_LOOPED)) {
+            ++sSoundPlayerStats.droppedCount;
+            return SOUND_ID_NONE;
+        }
+
+        sound->flags |= SOUND_FLAGS_VIRTUAL;
     }
 
     sound->soundId = sNextSoundId;
-    sound->voiceId = voiceId;
 
     // Skip -1 and avoid UB for overflow
     if (sNextSoundId == 0x7FFF) {
@@ -272,11 +454,21 @@ SoundId soundPlayerPlay(int soundClipId, float volume, float pitch, struct Vecto
 
 int soundPlayerIsPlaying(SoundId soundId) {
     struct Sound* sound = soundPlayerFindActiveSound(soundId);
+
+    if (sound && (sound->flags & SOUND_FLAGS_VIRTUAL)) {
+        return !(sound->flags & SOUND_FLAGS_STOPPED);
+    }
+
     return sound && audioIsSoundPlaying(sound->voiceId);
 }
 
 int soundPlayerIsLooped(SoundId soundId) {
     struct Sound* sound = soundPlayerFindActiveSound(soundId);
+
+    if (sound && (sound->flags & SOUND_FLAGS_VIRTUAL)) {
+        return 1;
+    }
+
     return sound && audioIsSoundLooped(sound->voiceId);
 }
 
@@ -305,15 +497,23 @@ void soundPlayerSetVolume(SoundId soundId, float newVolume) {
     sound->originalVolume = newVolume;
 
     // 3D sound volume will be updated in next call to soundPlayerUpdate()
-    if (!(sound->flags & SOUND_FLAGS_3D)) {
+    if (!(sound->flags & (SOUND_FLAGS_3D | SOUND_FLAGS_VIRTUAL))) {
         audioSetSoundParams(sound->voiceId, sound->originalVolume * sound->volumePercent, -1.0f, -1.0f, -1.0f);
     }
 }
 
+static void soundPlayerStopSound(struct Sound* sound) {
+    if (sound->flags & SOUND_FLAGS_VIRTUAL) {
+        sound->flags |= SOUND_FLAGS_STOPPED;
+    } else {
+        audioStopSound(sound->voiceId);
+    }
+}
+
 void soundPlayerStop(SoundId soundId) {
     struct Sound* sound = soundPlayerFindActiveSound(soundId);
     if (sound) {
-        audioStopSound(sound->voiceId);
+        soundPlayerStopSound(sound);
     }
 }
 
@@ -321,7 +521,7 @@ void soundPlayerStopAll() {
     for (int i = 0; i < sActiveSoundCount; ++i) {
         struct Sound* sound = &sSounds[i];
         if (sound->soundId != SOUND_ID_NONE) {
-            audioStopSound(sound->voiceId);
+            soundPlayerStopSound(sound);
         }
     }
 }
@@ -329,7 +529,13 @@ void soundPlayerStopAll() {
 void soundPlayerPause() {
     for (int i = 0; i < sActiveSoundCount; ++i) {
         struct Sound* sound = &sSounds[i];
-        if (sound->soundId != SOUND_ID_NONE) {
+        if (sound->soundId == SOUND_ID_NONE) {
+            continue;
+        }
+
+        if (sound->flags & SOUND_FLAGS_VIRTUAL) {
+            sound->flags |= SOUND_FLAGS_PAUSED;
+        } else {
             audioPauseSound(sound->voiceId);
         }
     }
@@ -338,7 +544,13 @@ void soundPlayerPause() {
 void soundPlayerResume() {
     for (int i = 0; i < sActiveSoundCount; ++i) {
         struct Sound* sound = &sSounds[i];
-        if (sound->soundId != SOUND_ID_NONE && audioIsSoundPaused(sound->voiceId)) {
+        if (sound->soundId == SOUND_ID_NONE) {
+            continue;
+        }
+
+        if (sound->flags & SOUND_FLAGS_VIRTUAL) {
+            sound->flags &= ~SOUND_FLAGS_PAUSED;
+        } else if (audioIsSoundPaused(sound->voiceId)) {
             audioResumeSound(sound->voiceId);
         }
     }
@@ -380,6 +592,10 @@ void soundPlayerUpdateVolumeLevels() {
 
         soundPlayerSetVolumePercent(sound);
 
+        if (sound->flags & SOUND_FLAGS_VIRTUAL) {
+            continue;
+        }
+
         float volume = sound->originalVolume;
 
         // Don't wait for soundPlayerUpdate(), to avoid harsh transitions on config change
@@ -398,6 +614,10 @@ int soundPlayerSoundCount() {
     return sActiveSoundCount;
 }
 
+struct SoundPlayerStats* soundPlayerStats() {
+    return &sSoundPlayerStats;
+}
+
 void soundListenerUpdate(int listenerIndex, struct Vector3* position, struct Vector3* right, struct Vector3* velocity) {
     struct SoundListener* listener = &sSoundListeners[listenerIndex];
     listener->worldPos = *position;
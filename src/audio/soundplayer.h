@@ -5,7 +5,11 @@
 #include "system/audio.h"
 
 #define MAX_SKIPPABLE_SOUNDS    18
+// Voices available for playback
 #define MAX_ACTIVE_SOUNDS       24
+// Looped sounds that are out of earshot or lost their voice to
+// a louder sound are still tracked, just without a voice
+#define MAX_TRACKED_SOUNDS      32
 #define SOUND_ID_NONE           -1
 
 enum SoundType {
@@ -18,6 +22,14 @@ enum SoundType {
 
 typedef int16_t SoundId;
 
+struct SoundPlayerStats {
+    short voiceCount;
+    short virtualCount;
+    int virtualizeCount;
+    int reviveCount;
+    int droppedCount;
+};
+
 void* soundPlayerInit(void* memoryEnd);
 void soundPlayerUpdate();
 void soundPlayerDestroy();
@@ -36,6 +48,7 @@ void soundPlayerResume();
 void soundPlayerFadeOutsideRadius(float volumePercent, struct Vector3* origin, float radius, int persistent);
 void soundPlayerUpdateVolumeLevels();
 int soundPlayerSoundCount();
+struct SoundPlayerStats* soundPlayerStats();
 
 void soundListenerUpdate(int listenerIndex, struct Vector3* position, struct Vector3* right, struct Vector3* velocity);
 void soundListenerSetCount(int count);
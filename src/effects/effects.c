@@ -1,11 +1,39 @@
 #include "effects.h"
 
 void effectsInit(struct Effects* effects) {
+    particlePoolInit(&effects->particlePool);
+
+    for (int i = 0; i < MAX_ACTIVE_PARTICLE_EFFECTS; ++i) {
+        particleEffectInit(&effects->particleEffects[i], &effects->particlePool);
+    }
+}
+
+static struct ParticleEffect* effectsFreeParticleEffect(struct Effects* effects) {
     for (int i = 0; i < MAX_ACTIVE_PARTICLE_EFFECTS; ++i) {
-        particleEffectInit(&effects->particleEffects[i]);
+        if (!effects->particleEffects[i].definition) {
+            return &effects->particleEffects[i];
+        }
     }
 
-    effects->nextParticleEffect = 0;
+    return NULL;
+}
+
+static struct ParticleEffect* effectsOldestParticleEffect(struct Effects* effects, struct ParticleEffect* exclude) {
+    struct ParticleEffect* result = NULL;
+
+    for (int i = 0; i < MAX_ACTIVE_PARTICLE_EFFECTS; ++i) {
+        struct ParticleEffect* effect = &effects->particleEffects[i];
+
+        if (effect == exclude || !effect->definition) {
+            continue;
+        }
+
+        if (!result || effect->time > result->time) {
+            result = effect;
+        }
+    }
+
+    return result;
 }
 
 void effectsParticlePlay(
@@ -15,15 +43,22 @@ void effectsParticlePlay(
     struct Vector3* normal,
     struct Transform* parent
 ) {
-    particleEffectPlay(
-        &effects->particleEffects[effects->nextParticleEffect],
-        definition,
-        origin,
-        normal,
-        parent
-    );
-
-    effects->nextParticleEffect = (effects->nextParticleEffect + 1) % MAX_ACTIVE_PARTICLE_EFFECTS;
+    struct ParticleEffect* effect = effectsFreeParticleEffect(effects);
+
+    if (!effect) {
+        effect = effectsOldestParticleEffect(effects, NULL);
+    }
+
+    // stop the oldest effects until there are enough particles
+    while (!particleEffectPlay(effect, definition, origin, normal, parent)) {
+        struct ParticleEffect* oldest = effectsOldestParticleEffect(effects, effect);
+
+        if (!oldest) {
+            return;
+        }
+
+        particleEffectStop(oldest);
+    }
 }
 
 void effectsUpdate(struct Effects* effects) {
@@ -31,3 +66,7 @@ void effectsUpdate(struct Effects* effects) {
         particleEffectUpdate(&effects->particleEffects[i]);
     }
 }
+
+int effectsActiveParticleCount(struct Effects* effects) {
+    return effects->particlePool.usedCount;
+}
@@ -3,11 +3,13 @@
 
 #include "particle_effect.h"
 
-#define MAX_ACTIVE_PARTICLE_EFFECTS 16
+// effects share the particle pool so this only limits how many can play
+// at once, it has to stay below PARTICLE_POOL_MAX_SPANS
+#define MAX_ACTIVE_PARTICLE_EFFECTS 32
 
 struct Effects {
     struct ParticleEffect particleEffects[MAX_ACTIVE_PARTICLE_EFFECTS];
-    short nextParticleEffect;
+    struct ParticlePool particlePool;
 };
 
 void effectsInit(struct Effects* effects);
@@ -19,5 +21,6 @@ void effectsParticlePlay(
     struct Transform* parent
 );
 void effectsUpdate(struct Effects* effects);
+int effectsActiveParticleCount(struct Effects* effects);
 
 #endif
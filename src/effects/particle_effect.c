@@ -6,10 +6,21 @@
 #include "scene/dynamic_scene.h"
 #include "util/frame_time.h"
 
+static void particleEffectSetVtxAttributes(Vtx* vtx, int corner, struct Coloru8* color) {
+    vtx->v.flag = 0;
+    vtx->v.tc[0] = (corner & 0x1) ? 0 : (32 << 5);
+    vtx->v.tc[1] = (corner >> 1) ? 0 : (32 << 5);
+
+    vtx->v.cn[0] = color->r;
+    vtx->v.cn[1] = color->g;
+    vtx->v.cn[2] = color->b;
+    vtx->v.cn[3] = color->a;
+}
+
 static Vtx* particleEffectBuildQuad(
     Vtx* vtx,
-    struct Particle* particle,
     struct Vector3* position,
+    struct Vector3* widthOffset,
     struct Coloru8* color,
     float widthScalar
 ) {
@@ -20,7 +31,7 @@ static Vtx* particleEffectBuildQuad(
 
         vector3AddScaled(
             &position[posIndex],
-            &particle->widthOffset,
+            widthOffset,
             widthSign ? widthScalar : -widthScalar,
             &finalPos
         );
@@ -29,19 +40,18 @@ static Vtx* particleEffectBuildQuad(
         vtx->v.ob[1] = finalPos.y * SCENE_SCALE;
         vtx->v.ob[2] = finalPos.z * SCENE_SCALE;
 
-        vtx->v.flag = 0;
-        vtx->v.tc[0] = widthSign ? 0 : (32 << 5);
-        vtx->v.tc[1] = posIndex ? 0 : (32 << 5);
-
-        vtx->v.cn[0] = color->r;
-        vtx->v.cn[1] = color->g;
-        vtx->v.cn[2] = color->b;
-        vtx->v.cn[3] = color->a;
+        particleEffectSetVtxAttributes(vtx, i, color);
     }
 
     return vtx;
 }
 
+static void particleEffectGetPosition(s32 position[3][PARTICLE_POOL_SIZE], int index, struct Vector3* output) {
+    output->x = position[0][index] * (1.0f / PARTICLE_FIXED_SCALE);
+    output->y = position[1][index] * (1.0f / PARTICLE_FIXED_SCALE);
+    output->z = position[2][index] * (1.0f / PARTICLE_FIXED_SCALE);
+}
+
 static void particleEffectBuildVerticesBillboarded(
     Vtx* vtx,
     struct ParticleEffect* effect,
@@ -49,37 +59,57 @@ static void particleEffectBuildVerticesBillboarded(
     float widthScalar,
     struct Vector3* cameraPosition
 ) {
-    for (int pidx = 0; pidx < effect->definition->count; ++pidx) {
-        struct Particle* particle = &effect->particles[pidx];
+    struct ParticlePool* pool = effect->pool;
+    int lastParticle = effect->firstParticle + effect->definition->count;
 
+    for (int pidx = effect->firstParticle; pidx < lastParticle; ++pidx) {
         struct Vector3 tmp;
         struct Vector3 heightOffset;
+        struct Vector3 widthOffset;
+        struct Vector3 head;
         struct Vector3 position[2];
 
-        vector3Sub(&particle->position[0], &particle->position[1], &position[0]);   // Offset
-        vector3AddScaled(&particle->position[1], &position[0], 0.5f, &position[1]); // Center
+        particleEffectGetPosition(pool->head, pidx, &head);
+        particleEffectGetPosition(pool->tail, pidx, &position[1]);
+
+        vector3Sub(&head, &position[1], &position[0]);                  // Offset
+        vector3AddScaled(&position[1], &position[0], 0.5f, &position[1]); // Center
 
         // Determine camera-facing basis for billboard
         vector3Sub(&position[1], cameraPosition, &tmp);
-        vector3Cross(&tmp, &position[0], &particle->widthOffset);
-        vector3Scale(&particle->widthOffset, &particle->widthOffset, effect->definition->halfWidth / sqrtf(vector3MagSqrd(&particle->widthOffset)));
+        vector3Cross(&tmp, &position[0], &widthOffset);
+        vector3Scale(&widthOffset, &widthOffset, effect->definition->halfWidth / sqrtf(vector3MagSqrd(&widthOffset)));
 
-        vector3Cross(&tmp, &particle->widthOffset, &heightOffset);
+        vector3Cross(&tmp, &widthOffset, &heightOffset);
         vector3Scale(&heightOffset, &heightOffset, 0.5f * sqrtf(vector3MagSqrd(&position[0])) / sqrtf(vector3MagSqrd(&heightOffset)));
 
         // Start/end relative to center
         vector3Sub(&position[1], &heightOffset, &position[0]);
         vector3Add(&position[1], &heightOffset, &position[1]);
 
-        vtx = particleEffectBuildQuad(vtx, particle, position, color, widthScalar);
+        vtx = particleEffectBuildQuad(vtx, position, &widthOffset, color, widthScalar);
     }
 }
 
 static void particleEffectBuildVertices(Vtx* vtx, struct ParticleEffect* effect, struct Coloru8* color, float widthScalar) {
-    for (int pidx = 0; pidx < effect->definition->count; ++pidx) {
-        struct Particle* particle = &effect->particles[pidx];
+    struct ParticlePool* pool = effect->pool;
+    int lastParticle = effect->firstParticle + effect->definition->count;
+    int width = (int)(widthScalar * 0x100);
+
+    for (int pidx = effect->firstParticle; pidx < lastParticle; ++pidx) {
+        for (int i = 0; i < 4; ++i, ++vtx) {
+            s32 (*position)[PARTICLE_POOL_SIZE] = (i >> 1) ? pool->tail : pool->head;
+            int widthSign = i & 0x1;
+
+            for (int axis = 0; axis < 3; ++axis) {
+                s32 widthOffset = (pool->widthOffset[axis][pidx] * width) >> 8;
+                s32 finalPos = position[axis][pidx] + (widthSign ? widthOffset : -widthOffset);
+
+                vtx->v.ob[axis] = finalPos >> PARTICLE_FIXED_SHIFT;
+            }
 
-        vtx = particleEffectBuildQuad(vtx, particle, particle->position, color, widthScalar);
+            particleEffectSetVtxAttributes(vtx, i, color);
+        }
     }
 }
 
@@ -190,18 +220,50 @@ static void particleEffectRenderBillboarded(void* data, struct RenderScene* rend
     );
 }
 
-void particleEffectInit(struct ParticleEffect* effect) {
+void particleEffectInit(struct ParticleEffect* effect, struct ParticlePool* pool) {
+    effect->definition = NULL;
+    effect->pool = pool;
+    effect->firstParticle = PARTICLE_POOL_NONE;
+    effect->dynamicId = INVALID_DYNAMIC_OBJECT;
+}
+
+void particleEffectStop(struct ParticleEffect* effect) {
+    if (!effect->definition) {
+        return;
+    }
+
+    particlePoolFree(effect->pool, effect->firstParticle, effect->definition->count);
+    effect->firstParticle = PARTICLE_POOL_NONE;
     effect->definition = NULL;
+
+    dynamicSceneRemove(effect->dynamicId);
     effect->dynamicId = INVALID_DYNAMIC_OBJECT;
 }
 
-void particleEffectPlay(
+static void particleEffectSetVector(s32 output[3][PARTICLE_POOL_SIZE], int index, struct Vector3* value) {
+    output[0][index] = (s32)(value->x * PARTICLE_FIXED_SCALE);
+    output[1][index] = (s32)(value->y * PARTICLE_FIXED_SCALE);
+    output[2][index] = (s32)(value->z * PARTICLE_FIXED_SCALE);
+}
+
+int particleEffectPlay(
     struct ParticleEffect* effect,
     struct ParticleEffectDefinition* definition,
     struct Vector3* origin,
     struct Vector3* normal,
     struct Transform* parent
 ) {
+    particleEffectStop(effect);
+
+    struct ParticlePool* pool = effect->pool;
+    int firstParticle = particlePoolAlloc(pool, definition->count);
+
+    if (firstParticle == PARTICLE_POOL_NONE) {
+        return 0;
+    }
+
+    effect->firstParticle = firstParticle;
+
     struct Vector3 right;
     struct Vector3 up;
     vector3Perp(normal, &right);
@@ -209,7 +271,7 @@ void particleEffectPlay(
     vector3Cross(normal, &right, &up);
 
     for (int i = 0; i < definition->count; ++i) {
-        struct Particle* particle = &effect->particles[i];
+        int pidx = effect->firstParticle + i;
 
         // Compute initial velocity and position
         struct Vector2 tangentDir;
@@ -217,23 +279,31 @@ void particleEffectPlay(
         float tangentMag = randomInRangef(definition->minTangentVelocity, definition->maxTangentVelocity);
         float normalMag = randomInRangef(definition->minNormalVelocity, definition->maxNormalVelocity);
 
-        vector3Scale(normal, &particle->velocity, normalMag);
-        vector3AddScaled(&particle->velocity, &right, tangentDir.x * tangentMag, &particle->velocity);
-        vector3AddScaled(&particle->velocity, &up, tangentDir.y * tangentMag, &particle->velocity);
+        struct Vector3 velocity;
+        vector3Scale(normal, &velocity, normalMag);
+        vector3AddScaled(&velocity, &right, tangentDir.x * tangentMag, &velocity);
+        vector3AddScaled(&velocity, &up, tangentDir.y * tangentMag, &velocity);
+
+        struct Vector3 head;
+        vector3AddScaled(origin, &velocity, definition->tailDelay, &head);
 
-        particle->position[1] = *origin;
-        vector3AddScaled(&particle->position[1], &particle->velocity, definition->tailDelay, &particle->position[0]);
+        particleEffectSetVector(pool->velocity, pidx, &velocity);
+        particleEffectSetVector(pool->tail, pidx, origin);
+        particleEffectSetVector(pool->head, pidx, &head);
 
         // Compute width direction (billboarded particles do this every frame)
         if (!(definition->flags & ParticleFlagsBillboarded)) {
-            vector3Cross(&particle->velocity, &gUp, &particle->widthOffset);
+            struct Vector3 widthOffset;
+            vector3Cross(&velocity, &gUp, &widthOffset);
 
-            float widthMag = vector3MagSqrd(&particle->widthOffset);
+            float widthMag = vector3MagSqrd(&widthOffset);
             if (widthMag < 0.00001f) {
-                vector3Scale(&gRight, &particle->widthOffset, definition->halfWidth);
+                vector3Scale(&gRight, &widthOffset, definition->halfWidth);
             } else {
-                vector3Scale(&particle->widthOffset, &particle->widthOffset, definition->halfWidth / sqrtf(widthMag));
+                vector3Scale(&widthOffset, &widthOffset, definition->halfWidth / sqrtf(widthMag));
             }
+
+            particleEffectSetVector(pool->widthOffset, pidx, &widthOffset);
         }
     }
 
@@ -243,10 +313,6 @@ void particleEffectPlay(
     effect->startPosition = *origin;
     effect->position = (effect->parent) ? &effect->parent->position : &effect->startPosition;
 
-    if (effect->dynamicId != INVALID_DYNAMIC_OBJECT) {
-        dynamicSceneRemove(effect->dynamicId);
-    }
-
     if (effect->definition->flags & ParticleFlagsBillboarded) {
         effect->dynamicId = dynamicSceneAddViewDependent(
             effect,
@@ -262,6 +328,8 @@ void particleEffectPlay(
             3.0f
         );
     }
+
+    return 1;
 }
 
 void particleEffectUpdate(struct ParticleEffect* effect) {
@@ -269,32 +337,45 @@ void particleEffectUpdate(struct ParticleEffect* effect) {
         return;
     }
 
-    for (int i = 0; i < effect->definition->count; ++i) {
-        struct Particle* particle = &effect->particles[i];
-
-        vector3AddScaled(&particle->position[0], &particle->velocity, FIXED_DELTA_TIME, &particle->position[0]);
-        vector3AddScaled(&particle->position[1], &particle->velocity, FIXED_DELTA_TIME, &particle->position[1]);
-
-        if (!(effect->definition->flags & ParticleFlagsNoGravity)) {
-            // This line simulates tracking the y-velocity of the tail
-            // separately without needing to actually do so.
-            //
-            // tailYVelocity = yVelocity - effect->definition->tailDelay * GRAVITY_CONSTANT
-            // tailPos.y = tailPos.y + tailYVelocity * FIXED_DELTA_TIME
-            // tailPos.y = tailPos.y + (yVelocity - effect->definition->tailDelay * GRAVITY_CONSTANT) * FIXED_DELTA_TIME
-            // tailPos.y = tailPos.y + yVelocity * FIXED_DELTA_TIME - effect->definition->tailDelay * GRAVITY_CONSTANT * FIXED_DELTA_TIME
-            particle->position[1].y -= effect->definition->tailDelay * (GRAVITY_CONSTANT * FIXED_DELTA_TIME);
-
-            particle->velocity.y += FIXED_DELTA_TIME * GRAVITY_CONSTANT;
+    struct ParticlePool* pool = effect->pool;
+    int firstParticle = effect->firstParticle;
+    int lastParticle = firstParticle + effect->definition->count;
+    s32 deltaTime = (s32)(FIXED_DELTA_TIME * 0x10000);
+
+    for (int axis = 0; axis < 3; ++axis) {
+        s32* head = pool->head[axis];
+        s32* tail = pool->tail[axis];
+        s32* velocity = pool->velocity[axis];
+
+        for (int i = firstParticle; i < lastParticle; ++i) {
+            s32 step = (velocity[i] * deltaTime) >> 16;
+            head[i] += step;
+            tail[i] += step;
+        }
+    }
+
+    if (!(effect->definition->flags & ParticleFlagsNoGravity)) {
+        s32 gravityStep = (s32)((GRAVITY_CONSTANT * PARTICLE_FIXED_SCALE) * FIXED_DELTA_TIME);
+        // This simulates tracking the y-velocity of the tail
+        // separately without needing to actually do so.
+        //
+        // tailYVelocity = yVelocity - effect->definition->tailDelay * GRAVITY_CONSTANT
+        // tailPos.y = tailPos.y + tailYVelocity * FIXED_DELTA_TIME
+        // tailPos.y = tailPos.y + (yVelocity - effect->definition->tailDelay * GRAVITY_CONSTANT) * FIXED_DELTA_TIME
+        // tailPos.y = tailPos.y + yVelocity * FIXED_DELTA_TIME - effect->definition->tailDelay * GRAVITY_CONSTANT * FIXED_DELTA_TIME
+        s32 tailStep = (s32)(effect->definition->tailDelay * gravityStep);
+        s32* tailY = pool->tail[1];
+        s32* velocityY = pool->velocity[1];
+
+        for (int i = firstParticle; i < lastParticle; ++i) {
+            tailY[i] -= tailStep;
+            velocityY[i] += gravityStep;
         }
     }
 
     effect->time += FIXED_DELTA_TIME;
 
     if (effect->time >= effect->definition->lifetime) {
-        effect->definition = NULL;
-
-        dynamicSceneRemove(effect->dynamicId);
-        effect->dynamicId = INVALID_DYNAMIC_OBJECT;
+        particleEffectStop(effect);
     }
 }
@@ -2,9 +2,14 @@
 #define __PARTICLE_EFFECT_H__
 
 #include "graphics/color.h"
+#include "graphics/renderstate.h"
 #include "math/vector3.h"
+#include "particle_pool.h"
 
-#define MAX_PARTICLES   16
+// Particles are simulated in fixed point scene units so
+// building vertices doesn't need any float conversions
+#define PARTICLE_FIXED_SHIFT    4
+#define PARTICLE_FIXED_SCALE    (SCENE_SCALE << PARTICLE_FIXED_SHIFT)
 
 enum ParticleFlags {
     ParticleFlagsBillboarded = (1 << 0),
@@ -28,15 +33,10 @@ struct ParticleEffectDefinition {
     enum ParticleFlags flags;
 };
 
-struct Particle {
-    struct Vector3 position[2];
-    struct Vector3 velocity;
-    struct Vector3 widthOffset;
-};
-
 struct ParticleEffect {
     struct ParticleEffectDefinition* definition;
-    struct Particle particles[MAX_PARTICLES];
+    struct ParticlePool* pool;
+    short firstParticle;
     struct Vector3 startPosition;
     struct Vector3* position;
     struct Transform* parent;
@@ -44,14 +44,16 @@ struct ParticleEffect {
     short dynamicId;
 };
 
-void particleEffectInit(struct ParticleEffect* effect);
-void particleEffectPlay(
+void particleEffectInit(struct ParticleEffect* effect, struct ParticlePool* pool);
+// returns 0 if the pool doesn't have room for the particles
+int particleEffectPlay(
     struct ParticleEffect* effect,
     struct ParticleEffectDefinition* definition,
     struct Vector3* origin,
     struct Vector3* normal,
     struct Transform* parent
 );
+void particleEffectStop(struct ParticleEffect* effect);
 void particleEffectUpdate(struct ParticleEffect* effect);
 
 #endif
@@ -0,0 +1,84 @@
+#include "particle_pool.h"
+
+void particlePoolInit(struct ParticlePool* pool) {
+    pool->freeSpans[0].firstParticle = 0;
+    pool->freeSpans[0].count = PARTICLE_POOL_SIZE;
+    pool->freeSpanCount = 1;
+    pool->usedCount = 0;
+}
+
+static void particlePoolRemoveSpan(struct ParticlePool* pool, int index) {
+    --pool->freeSpanCount;
+
+    for (int i = index; i < pool->freeSpanCount; ++i) {
+        pool->freeSpans[i] = pool->freeSpans[i + 1];
+    }
+}
+
+int particlePoolAlloc(struct ParticlePool* pool, int count) {
+    for (int i = 0; i < pool->freeSpanCount; ++i) {
+        struct ParticlePoolSpan* span = &pool->freeSpans[i];
+
+        if (span->count < count) {
+            continue;
+        }
+
+        int result = span->firstParticle;
+        span->firstParticle += count;
+        span->count -= count;
+
+        if (span->count == 0) {
+            particlePoolRemoveSpan(pool, i);
+        }
+
+        pool->usedCount += count;
+
+        return result;
+    }
+
+    return PARTICLE_POOL_NONE;
+}
+
+void particlePoolFree(struct ParticlePool* pool, int firstParticle, int count) {
+    int index = 0;
+
+    while (index < pool->freeSpanCount && pool->freeSpans[index].firstParticle < firstParticle) {
+        ++index;
+    }
+
+    struct ParticlePoolSpan* prev = index > 0 ? &pool->freeSpans[index - 1] : NULL;
+    struct ParticlePoolSpan* next = index < pool->freeSpanCount ? &pool->freeSpans[index] : NULL;
+
+    pool->usedCount -= count;
+
+    if (prev && prev->firstParticle + prev->count == firstParticle) {
+        prev->count += count;
+
+        if (next && firstParticle + count == next->firstParticle) {
+            prev->count += next->count;
+            particlePoolRemoveSpan(pool, index);
+        }
+
+        return;
+    }
+
+    if (next && firstParticle + count == next->firstParticle) {
+        next->firstParticle = firstParticle;
+        next->count += count;
+        return;
+    }
+
+    if (pool->freeSpanCount == PARTICLE_POOL_MAX_SPANS) {
+        // can't happen while there are fewer effects than spans
+        // but losing the particles is better than overwriting memory
+        return;
+    }
+
+    for (int i = pool->freeSpanCount; i > index; --i) {
+        pool->freeSpans[i] = pool->freeSpans[i - 1];
+    }
+
+    pool->freeSpans[index].firstParticle = firstParticle;
+    pool->freeSpans[index].count = count;
+    ++pool->freeSpanCount;
+}
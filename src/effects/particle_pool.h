@@ -0,0 +1,39 @@
+#ifndef __EFFECTS_PARTICLE_POOL_H__
+#define __EFFECTS_PARTICLE_POOL_H__
+
+#include <ultra64.h>
+
+#define PARTICLE_POOL_SIZE  256
+
+// Each effect takes a contiguous range of particles so there is at
+// most one more free span than there are effects playing
+#define PARTICLE_POOL_MAX_SPANS 33
+
+#define PARTICLE_POOL_NONE  -1
+
+struct ParticlePoolSpan {
+    short firstParticle;
+    short count;
+};
+
+// Each array is indexed by axis then particle so
+// updates run straight down each component
+struct ParticlePool {
+    s32 head[3][PARTICLE_POOL_SIZE];
+    s32 tail[3][PARTICLE_POOL_SIZE];
+    s32 velocity[3][PARTICLE_POOL_SIZE];
+    s32 widthOffset[3][PARTICLE_POOL_SIZE];
+
+    // sorted by firstParticle with no two spans touching
+    struct ParticlePoolSpan freeSpans[PARTICLE_POOL_MAX_SPANS];
+    short freeSpanCount;
+    short usedCount;
+};
+
+void particlePoolInit(struct ParticlePool* pool);
+// returns the first particle of count contiguous particles or
+// PARTICLE_POOL_NONE if no free span is big enough
+int particlePoolAlloc(struct ParticlePool* pool, int count);
+void particlePoolFree(struct ParticlePool* pool, int firstParticle, int count);
+
+#endif
@@ -1,4 +1,5 @@
 #include "font.h"
+#include "../strings/translations.h"
 #include "../util/memory.h"
 
 #define TEXTURE_IMAGE_INDEX_TO_MASK(index) (1 << (index))
@@ -18,7 +19,8 @@ int fontDetermineKerning(struct Font* font, short first, short second) {
             return kerning->amount;
         }
         
-        ++index;
+        // font_converter.js wraps collisions around to the start
+        index = (index + 1) & (unsigned)font->kerningMask;
         --maxIterations;
     } while (maxIterations >= 0);
 
@@ -40,7 +42,7 @@ struct FontSymbol* fontFindSymbol(struct Font* font, short id) {
             return symbol;
         }
         
-        ++index;
+        index = (index + 1) & (unsigned)font->symbolMask;
         --maxIterations;
     } while (maxIterations >= 0);
 
@@ -166,6 +168,31 @@ void fontRendererLayout(struct FontRenderer* renderer, struct Font* font, char*
     renderer->height = y + font->charHeight;
 }
 
+struct FontLayoutCacheEntry {
+    struct FontRenderer renderer;
+    struct Font* font;
+    short stringId;
+    short language;
+    short maxWidth;
+};
+
+static struct FontLayoutCacheEntry sFontLayoutCache;
+
+struct FontRenderer* fontRendererLayoutString(struct Font* font, int stringId, int maxWidth) {
+    int language = translationsCurrentLanguage();
+    struct FontLayoutCacheEntry* entry = &sFontLayoutCache;
+
+    if (entry->font != font || entry->stringId != stringId || entry->language != language || entry->maxWidth != maxWidth) {
+        fontRendererLayout(&entry->renderer, font, translationsGet(stringId), maxWidth);
+        entry->font = font;
+        entry->stringId = stringId;
+        entry->language = language;
+        entry->maxWidth = maxWidth;
+    }
+
+    return &entry->renderer;
+}
+
 Gfx* fontRendererBuildSingleGfx(struct FontRenderer* renderer, int imageIndex, int x, int y, Gfx* gfx) {
     for (int i = 0; i < renderer->currentSymbol; ++i) {
         struct SymbolLocation* target = &renderer->symbols[i];
@@ -222,7 +249,7 @@ void fontRendererInitPrerender(struct FontRenderer* renderer, struct Prerendered
         ++imageIndex;
     }
 
-    prerender->displayLists = malloc(sizeof(Gfx*) * imageIndex);
+    prerender->displayLists = mallocTagged(sizeof(Gfx*) * imageIndex, MemoryTagUI);
 
     prerender->usedImageIndices = renderer->usedImageIndices;
     prerender->x = 0;
@@ -247,7 +274,7 @@ void fontRendererInitPrerender(struct FontRenderer* renderer, struct Prerendered
 
             if (symbolCount) {
                 // 3 gfx per symbol, + 2 for color change + 1 for end display list
-                prerender->displayLists[imageIndex] = malloc(sizeof(Gfx) * (symbolCount * 3 + 3));
+                prerender->displayLists[imageIndex] = mallocTagged(sizeof(Gfx) * (symbolCount * 3 + 3), MemoryTagUI);
             } else {
                 prerender->displayLists[imageIndex] = NULL;
             }
@@ -261,13 +288,13 @@ void fontRendererInitPrerender(struct FontRenderer* renderer, struct Prerendered
 }
 
 struct PrerenderedText* prerenderedTextNew(struct FontRenderer* renderer) {
-    struct PrerenderedText* result = malloc(sizeof(struct PrerenderedText*));
+    struct PrerenderedText* result = mallocTagged(sizeof(struct PrerenderedText), MemoryTagUI);
     fontRendererInitPrerender(renderer, result);
     return result;
 }
 
 struct PrerenderedText* prerenderedTextCopy(struct PrerenderedText* text) {
-    struct PrerenderedText* result = malloc(sizeof(struct PrerenderedText));
+    struct PrerenderedText* result = mallocTagged(sizeof(struct PrerenderedText), MemoryTagUI);
 
     int imageIndex = 0;
     int imageMask = text->usedImageIndices;
@@ -277,7 +304,7 @@ struct PrerenderedText* prerenderedTextCopy(struct PrerenderedText* text) {
         ++imageIndex;
     }
 
-    result->displayLists = malloc(sizeof(Gfx*) * imageIndex);
+    result->displayLists = mallocTagged(sizeof(Gfx*) * imageIndex, MemoryTagUI);
     result->usedImageIndices = text->usedImageIndices;
     result->x = text->x;
     result->y = text->y;
@@ -300,7 +327,7 @@ struct PrerenderedText* prerenderedTextCopy(struct PrerenderedText* text) {
 
             int size = (src - text->displayLists[imageIndex]) * sizeof(Gfx);
 
-            result->displayLists[imageIndex] = malloc(size);
+            result->displayLists[imageIndex] = mallocTagged(size, MemoryTagUI);
 
             Gfx* dest = result->displayLists[imageIndex];
             src = text->displayLists[imageIndex];
@@ -60,6 +60,19 @@ struct FontRenderer {
 };
 
 void fontRendererLayout(struct FontRenderer* renderer, struct Font* font, char* message, int maxWidth);
+
+// Lays out a translated string. The layout is kept and reused while the
+// same string, language and width keep being drawn. There is one layout
+// kept so only the hud subtitle uses it and the result is replaced by
+// the next call
+//
+// Menus and button prompts are left uncached on purpose. Menu text is
+// laid out once into PrerenderedText and only again when the language
+// changes, which is also when a cached layout would stop matching.
+// Prompts are a few words, laying them out costs about as much as a
+// subtitle line and they would evict the subtitle from the one entry.
+// tests/font_layout_test.c times both
+struct FontRenderer* fontRendererLayoutString(struct Font* font, int stringId, int maxWidth);
 Gfx* fontRendererBuildGfx(struct FontRenderer* renderer, Gfx** fontImages, int x, int y, struct Coloru8* color, Gfx* gfx);
 
 struct PrerenderedText {
@@ -13,6 +13,7 @@ struct RenderScene* renderSceneNew(struct Transform* cameraTransform, struct Ren
     planeInitWithNormalAndPoint(&result->forwardPlane, &cameraForward, &cameraTransform->position);
     
     result->currentRenderPart = 0;
+    result->textureLoadCount = 0;
 
     int capacity = MAX_RENDER_PART_COUNT;
     result->renderParts = stackMalloc(sizeof(struct RenderPart) * capacity);
@@ -44,7 +45,7 @@ int renderSceneSortKey(int materialIndex, float distance) {
     return (materialIndex << 23) | (distanceScaled & 0x7FFFFF);
 }
 
-void renderSceneAdd(struct RenderScene* renderScene, Gfx* geometry, Mtx* matrix, int materialIndex, struct Vector3* at, Mtx* armature) {
+static void renderSceneAddPart(struct RenderScene* renderScene, Gfx* geometry, Mtx* matrix, int materialIndex, struct Vector3* at, Mtx* armature, u8 flags) {
     if (renderScene->currentRenderPart == MAX_RENDER_PART_COUNT) {
         return;
     }
@@ -53,12 +54,21 @@ void renderSceneAdd(struct RenderScene* renderScene, Gfx* geometry, Mtx* matrix,
     part->geometry = geometry;
     part->matrix = matrix;
     part->armature = armature;
+    part->flags = flags;
     renderScene->materials[renderScene->currentRenderPart] = materialIndex;
     renderScene->sortKeys[renderScene->currentRenderPart] = renderSceneSortKey(materialIndex, planePointDistance(&renderScene->forwardPlane, at));
 
     ++renderScene->currentRenderPart;
 }
 
+void renderSceneAdd(struct RenderScene* renderScene, Gfx* geometry, Mtx* matrix, int materialIndex, struct Vector3* at, Mtx* armature) {
+    renderSceneAddPart(renderScene, geometry, matrix, materialIndex, at, armature, 0);
+}
+
+void renderSceneAddStatic(struct RenderScene* renderScene, Gfx* geometry, Mtx* matrix, int materialIndex, struct Vector3* at) {
+    renderSceneAddPart(renderScene, geometry, matrix, materialIndex, at, NULL, RenderPartFlagsPreservesTmem);
+}
+
 void renderSceneSort(struct RenderScene* renderScene, int min, int max) {
     if (min + 1 >= max) {
         return;
@@ -115,6 +125,9 @@ void renderSceneGenerate(struct RenderScene* renderScene, struct RenderState* re
 
     int prevMaterial = -1;
 
+    struct MaterialTmemState tmemState;
+    levelMaterialTmemInit(&tmemState);
+
     gSPDisplayList(renderState->dl++, levelMaterialDefault());
     
     for (int i = 0; i < renderScene->currentRenderPart; ++i) {
@@ -127,13 +140,17 @@ void renderSceneGenerate(struct RenderScene* renderScene, struct RenderState* re
                 gSPDisplayList(renderState->dl++, levelMaterialRevert(prevMaterial));
             }
 
-            gSPDisplayList(renderState->dl++, levelMaterial(materialIndex));
+            gSPDisplayList(renderState->dl++, levelMaterialWithTmem(materialIndex, &tmemState));
 
             prevMaterial = materialIndex;
         }
 
         struct RenderPart* renderPart = &renderScene->renderParts[renderIndex];
 
+        if (!(renderPart->flags & RenderPartFlagsPreservesTmem)) {
+            levelMaterialTmemInvalidate(&tmemState);
+        }
+
         if (renderPart->matrix) {
             gSPMatrix(renderState->dl++, renderPart->matrix, G_MTX_MODELVIEW | G_MTX_PUSH | G_MTX_MUL);
         }
@@ -152,4 +169,6 @@ void renderSceneGenerate(struct RenderScene* renderScene, struct RenderState* re
     if (prevMaterial != -1) {
         gSPDisplayList(renderState->dl++, levelMaterialRevert(prevMaterial));
     }
+
+    renderScene->textureLoadCount = tmemState.textureLoads;
 }
@@ -9,10 +9,16 @@
 
 #define MAX_RENDER_PART_COUNT 256
 
+enum RenderPartFlags {
+    // Geometry only uses the material it was added with and never loads textures
+    RenderPartFlagsPreservesTmem = (1 << 0),
+};
+
 struct RenderPart {
     Mtx* matrix;
     Gfx* geometry;
     Mtx* armature;
+    u8 flags;
 };
 
 struct RenderScene {
@@ -24,12 +30,14 @@ struct RenderScene {
     short* renderOrder;
     short* renderOrderCopy;
     int currentRenderPart;
+    u16 textureLoadCount;
     struct RenderState *renderState;
 };
 
 struct RenderScene* renderSceneNew(struct Transform* cameraTransform, struct RenderState *renderState, u64 visibleRooms);
 void renderSceneFree(struct RenderScene* renderScene);
 void renderSceneAdd(struct RenderScene* renderScene, Gfx* geometry, Mtx* matrix, int materialIndex, struct Vector3* at, Mtx* armature);
+void renderSceneAddStatic(struct RenderScene* renderScene, Gfx* geometry, Mtx* matrix, int materialIndex, struct Vector3* at);
 void renderSceneGenerate(struct RenderScene* renderScene, struct RenderState* renderState);
 
 #endif
@@ -4,6 +4,7 @@
 #include "effects/effect_definitions.h"
 #include "levels/levels.h"
 #include "locales/locales.h"
+#include "math/mathf.h"
 #include "savefile/checkpoint.h"
 #include "scene/scene.h"
 #include "scene/signals.h"
@@ -44,6 +45,16 @@ s16 gCutsceneCurrentSoundId[CH_COUNT];
 u16 gCutsceneCurrentSubtitleId[CH_COUNT];
 float   gCutsceneCurrentVolume[CH_COUNT];
 
+// runners waiting on a delay, sorted by wakeFrame
+struct CutsceneRunner* gCutsceneTimerQueue;
+struct CutsceneRunner* gCutsceneChannelQueues[CH_COUNT];
+struct CutsceneRunner* gCutsceneSignalQueue;
+// advances by one at the end of each cutscenesUpdate. Counting frames
+// instead of adding up FIXED_DELTA_TIME keeps long delays exact
+u32 gCutsceneFrame;
+
+struct CutsceneStats gCutsceneStats;
+
 void cutsceneRunnerCancel(struct CutsceneRunner* runner);
 
 void cutsceneRunnerReset() {
@@ -56,7 +67,12 @@ void cutsceneRunnerReset() {
 
     gCutsceneNextFreeSound = &gCutsceneSoundNodes[0];
 
+    gCutsceneTimerQueue = NULL;
+    gCutsceneSignalQueue = NULL;
+    gCutsceneFrame = 0;
+
     for (int i = 0; i < CH_COUNT; ++i) {
+        gCutsceneChannelQueues[i] = NULL;
         gCutsceneSoundQueues[i] = NULL;
         gCutsceneCurrentSound[i] = SOUND_ID_NONE;
         gCutsceneCurrentSoundId[i] = SOUND_ID_NONE;
@@ -89,13 +105,126 @@ struct CutsceneRunner* cutsceneRunnerNew() {
     }
 
     result->nextRunner = NULL;
+    result->nextWaiting = NULL;
     result->currentCutscene = NULL;
     result->currentStep = 0;
+    result->waitType = CutsceneWaitTypeNone;
 
     return result;
 }
 
+struct CutsceneRunner** cutsceneRunnerWaitQueue(struct CutsceneRunner* runner) {
+    struct CutsceneStep* step = &runner->currentCutscene->steps[runner->currentStep];
+
+    switch (runner->waitType) {
+        case CutsceneWaitTypeTimer:
+            return &gCutsceneTimerQueue;
+        case CutsceneWaitTypeChannel:
+            return &gCutsceneChannelQueues[step->waitForChannel.channel];
+        case CutsceneWaitTypeSignal:
+            return &gCutsceneSignalQueue;
+        default:
+            return NULL;
+    }
+}
+
+void cutsceneRunnerWait(struct CutsceneRunner* runner, enum CutsceneWaitType waitType) {
+    runner->waitType = waitType;
+
+    struct CutsceneRunner** queue = cutsceneRunnerWaitQueue(runner);
+
+    if (waitType == CutsceneWaitTypeTimer) {
+        // keeping timers sorted means only the front of the queue is checked each frame
+        while (*queue && (*queue)->wakeFrame <= runner->wakeFrame) {
+            queue = &(*queue)->nextWaiting;
+        }
+    }
+
+    runner->nextWaiting = *queue;
+    *queue = runner;
+}
+
+void cutsceneRunnerWake(struct CutsceneRunner* runner) {
+    runner->waitType = CutsceneWaitTypeNone;
+    runner->nextWaiting = NULL;
+}
+
+void cutsceneRunnerStopWaiting(struct CutsceneRunner* runner) {
+    struct CutsceneRunner** queue = cutsceneRunnerWaitQueue(runner);
+
+    if (!queue) {
+        return;
+    }
+
+    while (*queue) {
+        if (*queue == runner) {
+            *queue = runner->nextWaiting;
+            break;
+        }
+
+        queue = &(*queue)->nextWaiting;
+    }
+
+    cutsceneRunnerWake(runner);
+}
+
+void cutscenesWakeQueue(struct CutsceneRunner** queue) {
+    struct CutsceneRunner* current = *queue;
+
+    while (current) {
+        struct CutsceneRunner* next = current->nextWaiting;
+        cutsceneRunnerWake(current);
+        current = next;
+    }
+
+    *queue = NULL;
+}
+
+void cutscenesWakeTimers() {
+    while (gCutsceneTimerQueue && gCutsceneTimerQueue->wakeFrame <= gCutsceneFrame) {
+        struct CutsceneRunner* runner = gCutsceneTimerQueue;
+        gCutsceneTimerQueue = runner->nextWaiting;
+        cutsceneRunnerWake(runner);
+    }
+}
+
+void cutscenesWakeSignals() {
+    // every signal is sent before cutscenes update so a waiting
+    // runner only needs to look again once its signal changes
+    for (int signalIndex = signalsNextChanged(-1);
+        signalIndex != -1 && gCutsceneSignalQueue;
+        signalIndex = signalsNextChanged(signalIndex)) {
+        struct CutsceneRunner** queue = &gCutsceneSignalQueue;
+
+        while (*queue) {
+            struct CutsceneRunner* runner = *queue;
+
+            if (runner->currentCutscene->steps[runner->currentStep].waitForSignal.signalIndex == signalIndex) {
+                *queue = runner->nextWaiting;
+                cutsceneRunnerWake(runner);
+            } else {
+                queue = &runner->nextWaiting;
+            }
+        }
+    }
+}
+
+void cutsceneRunnerStartDelay(struct CutsceneRunner* runner, float delay) {
+    // a delay that is a whole number of frames shouldn't gain
+    // one from rounding error in the division
+    int frames = (int)ceilf(delay * (1.0f / FIXED_DELTA_TIME) - 0.01f);
+
+    if (frames < 1) {
+        frames = 1;
+    }
+
+    // the frame the delay starts on counts towards it
+    runner->wakeFrame = gCutsceneFrame + frames - 1;
+}
+
 void cutsceneRunnerCancel(struct CutsceneRunner* runner) {
+    cutsceneRunnerStopWaiting(runner);
+
     struct CutsceneStep* step = &runner->currentCutscene->steps[runner->currentStep];
 
     switch (step->type) {
@@ -158,6 +287,10 @@ void cutsceneRunnerResetChannel(int channel) {
         gCutsceneCurrentSubtitleId[channel] = StringIdNone;
         gCutsceneCurrentVolume[channel] = 0.0f;
     }
+
+    if (!cutsceneRunnerIsChannelPlaying(channel)) {
+        cutscenesWakeQueue(&gCutsceneChannelQueues[channel]);
+    }
 }
 
 float cutsceneRunnerConvertPlaybackSpeed(s8 asInt) {
@@ -227,10 +360,10 @@ void cutsceneRunnerStartStep(struct CutsceneRunner* runner) {
             break;
         }
         case CutsceneStepTypeDelay:
-            runner->state.delay = step->delay;
+            cutsceneRunnerStartDelay(runner, step->delay);
             break;
         case CutsceneStepTypeDelayRandom:
-            runner->state.delay = randomInRangef(step->delayRandom.min, step->delayRandom.max);
+            cutsceneRunnerStartDelay(runner, randomInRangef(step->delayRandom.min, step->delayRandom.max));
             break;
         case CutsceneStepTypeWaitForSignal:
             runner->state.waitForSignal.currentFrame = step->waitForSignal.forFrames;
@@ -408,14 +541,20 @@ int cutsceneRunnerUpdateCurrentStep(struct CutsceneRunner* runner) {
             return !soundPlayerIsPlaying(soundId) || soundPlayerIsLooped(soundId);
         }
         case CutsceneStepTypeWaitForChannel:
-        {
-            int result = !cutsceneRunnerIsChannelPlaying(step->waitForChannel.channel);
-            return result;
-        }
+            if (cutsceneRunnerIsChannelPlaying(step->waitForChannel.channel)) {
+                cutsceneRunnerWait(runner, CutsceneWaitTypeChannel);
+                return 0;
+            }
+
+            return 1;
         case CutsceneStepTypeDelay:
         case CutsceneStepTypeDelayRandom:
-            runner->state.delay -= FIXED_DELTA_TIME;
-            return runner->state.delay <= 0.0f;
+            if (runner->wakeFrame > gCutsceneFrame) {
+                cutsceneRunnerWait(runner, CutsceneWaitTypeTimer);
+                return 0;
+            }
+
+            return 1;
         case CutsceneStepTypeWaitForSignal:
             if (signalsRead(step->waitForSignal.signalIndex)) {
                 if (runner->state.waitForSignal.currentFrame > 0) {
@@ -425,6 +564,7 @@ int cutsceneRunnerUpdateCurrentStep(struct CutsceneRunner* runner) {
                 }
             } else {
                 runner->state.waitForSignal.currentFrame = step->waitForSignal.forFrames;
+                cutsceneRunnerWait(runner, CutsceneWaitTypeSignal);
             }
 
             return 0;
@@ -547,18 +687,38 @@ void cutscenesUpdateSounds() {
                 gCutsceneCurrentVolume[i] = 0.0f;
             }
         }
+
+        if (gCutsceneChannelQueues[i] && !cutsceneRunnerIsChannelPlaying(i)) {
+            cutscenesWakeQueue(&gCutsceneChannelQueues[i]);
+        }
     }
 }
 
 void cutscenesUpdate() {
+    Time start = timeGetTime();
+
     struct CutsceneRunner* previousCutscene = NULL;
     struct CutsceneRunner* current = gRunningCutscenes;
 
     cutscenesUpdateSounds();
+    cutscenesWakeTimers();
+    cutscenesWakeSignals();
+
+    gCutsceneStats.runningCount = 0;
+    gCutsceneStats.waitingCount = 0;
 
     while (current) {
         if (cutsceneRunnerIsRunning(current)) {
-            cutsceneRunnerUpdate(current);
+            if (current->waitType == CutsceneWaitTypeNone) {
+                cutsceneRunnerUpdate(current);
+            }
+
+            ++gCutsceneStats.runningCount;
+
+            if (current->waitType != CutsceneWaitTypeNone) {
+                ++gCutsceneStats.waitingCount;
+            }
+
             previousCutscene = current;
             current = current->nextRunner;
         } else {
@@ -575,6 +735,13 @@ void cutscenesUpdate() {
             gUnusedRunners = toRemove;            
         } 
     }
+
+    ++gCutsceneFrame;
+    gCutsceneStats.updateTime = timeGetTime() - start;
+}
+
+struct CutsceneStats* cutscenesStats() {
+    return &gCutsceneStats;
 }
 
 int cutsceneTrigger(int cutsceneIndex, int triggerIndex) {
@@ -602,6 +769,11 @@ void cutsceneSerialize(struct CutsceneRunner* runner, struct CutsceneSerialized*
         case CutsceneStepTypeStartSound:
             result->state.playSound.soundId = SOUND_ID_NONE;
             break;
+        case CutsceneStepTypeDelay:
+        case CutsceneStepTypeDelayRandom:
+            // checkpoints store the time left on the delay
+            result->state.delay = (runner->wakeFrame - gCutsceneFrame + 1) * FIXED_DELTA_TIME;
+            break;
         default:
             result->state = runner->state;
             break;
@@ -616,6 +788,14 @@ void cutsceneStartSerialized(struct CutsceneSerialized* serialized) {
     runner->currentCutscene = &gCurrentLevel->cutscenes[serialized->cutsceneIndex];
     runner->currentStep = serialized->currentStep;
     runner->state = serialized->state;
+
+    if (runner->currentStep < runner->currentCutscene->stepCount) {
+        struct CutsceneStep* step = &runner->currentCutscene->steps[runner->currentStep];
+
+        if (step->type == CutsceneStepTypeDelay || step->type == CutsceneStepTypeDelayRandom) {
+            cutsceneRunnerStartDelay(runner, serialized->state.delay);
+        }
+    }
 }
 
 int cutsceneGetCount() {
@@ -7,6 +7,7 @@
 #include "audio/soundplayer.h"
 #include "level_definition.h"
 #include "savefile/serializer.h"
+#include "system/time.h"
 
 union CutsceneStepState {
     struct {
@@ -24,12 +25,30 @@ struct CutsceneSerialized {
     union CutsceneStepState state;
 };
 
+enum CutsceneWaitType {
+    CutsceneWaitTypeNone,
+    CutsceneWaitTypeTimer,
+    CutsceneWaitTypeChannel,
+    CutsceneWaitTypeSignal,
+};
+
 struct CutsceneRunner {
     struct Cutscene* currentCutscene;
     u16 currentStep;
+    // a runner that is waiting isn't updated until its wait queue wakes it up
+    u16 waitType;
     union CutsceneStepState state;
+    // cutscene frame a delay step finishes on
+    u32 wakeFrame;
 
     struct CutsceneRunner* nextRunner;
+    struct CutsceneRunner* nextWaiting;
+};
+
+struct CutsceneStats {
+    Time updateTime;
+    short runningCount;
+    short waitingCount;
 };
 
 void cutsceneRunnerReset();
@@ -37,6 +56,7 @@ void cutsceneStart(struct Cutscene* cutscene);
 void cutsceneStop(struct Cutscene* cutscene);
 int cutsceneIsRunning(struct Cutscene* cutscene);
 void cutscenesUpdate();
+struct CutsceneStats* cutscenesStats();
 
 int cutsceneTrigger(int cutsceneIndex, int triggerIndex);
 
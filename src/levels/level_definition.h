@@ -432,6 +432,10 @@ struct LevelDefinition {
     struct SecurityCameraDefinition* securityCameras;
     struct TurretDefinition* turrets;
     struct IncineratorDefinition* incinerators;
+    // dynamic models the level's entities use, loaded ahead of time
+    short* dynamicModelHints;
+    // NULL terminated addresses of every pointer in the level segment
+    void** relocations;
     short collisionQuadCount;
     short namedColliderCount;
     short staticContentCount;
@@ -459,6 +463,7 @@ struct LevelDefinition {
     short securityCameraCount;
     short turretCount;
     short incineratorCount;
+    short dynamicModelHintCount;
     short startLocation;
     short playerAnimatorIndex;
 };
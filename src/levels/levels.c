@@ -4,7 +4,7 @@
 #include "physics/collision_scene.h"
 #include "player/player.h"
 #include "savefile/checkpoint.h"
-#include "system/cartridge.h"
+#include "util/compressed_segment.h"
 #include "util/memory.h"
 
 #include "codegen/assets/materials/static.h"
@@ -12,6 +12,20 @@
 
 #define ADJUST_POINTER_POS(ptr, offset) (void*)((ptr) ? (char*)(ptr) + (offset) : 0)
 
+#define LEVEL_PREFETCH_DECOMPRESS_BYTES (8 * 1024)
+#define LEVEL_PREFETCH_RELOCATIONS      512
+
+// The next level's segment, streamed in and then relocated
+// a piece per frame while the current level is running
+struct LevelPrefetch {
+    int index;
+    char* memory;
+    struct CompressedSegmentStream stream;
+    void** nextRelocation;
+    short isLoaded;
+    short isRelocated;
+};
+
 struct LevelDefinition* gCurrentLevel;
 int gCurrentLevelIndex;
 
@@ -23,91 +37,25 @@ static struct Transform sRelativeTransform = {
 };
 static struct Vector3 sRelativeVelocity = { 0 };
 static int sLoadedFromTransition = 0;
+static struct LevelPrefetch sPrefetch = { .index = NO_QUEUED_LEVEL };
+static Time sLastTransitionTime;
 
-static struct LevelDefinition* levelFixPointers(struct LevelDefinition* from, int pointerOffset) {
-    struct LevelDefinition* result = ADJUST_POINTER_POS(from, pointerOffset);
-
-    result->collisionQuads = ADJUST_POINTER_POS(result->collisionQuads, pointerOffset);
-
-    for (int i = 0; i < result->collisionQuadCount; ++i) {
-        result->collisionQuads[i].collider = ADJUST_POINTER_POS(result->collisionQuads[i].collider, pointerOffset);
-        result->collisionQuads[i].collider->data = ADJUST_POINTER_POS(result->collisionQuads[i].collider->data, pointerOffset);
-        result->collisionQuads[i].body = ADJUST_POINTER_POS(result->collisionQuads[i].body, pointerOffset);
-        result->collisionQuads[i].data = ADJUST_POINTER_POS(result->collisionQuads[i].data, pointerOffset);
-    }
-
-    result->namedColliderIndices = ADJUST_POINTER_POS(result->namedColliderIndices, pointerOffset);
-
-    result->staticContent = ADJUST_POINTER_POS(result->staticContent, pointerOffset);
-    result->staticBoundingBoxes = ADJUST_POINTER_POS(result->staticBoundingBoxes, pointerOffset);
-    result->roomStaticMapping = ADJUST_POINTER_POS(result->roomStaticMapping, pointerOffset);
-    result->signalToStaticRanges = ADJUST_POINTER_POS(result->signalToStaticRanges, pointerOffset);
-    result->signalToStaticIndices = ADJUST_POINTER_POS(result->signalToStaticIndices, pointerOffset);
-    result->portalSurfaces = ADJUST_POINTER_POS(result->portalSurfaces, pointerOffset);
-
-    for (int i = 0; i < result->portalSurfaceCount; ++i) {
-        result->portalSurfaces[i].vertices = ADJUST_POINTER_POS(result->portalSurfaces[i].vertices, pointerOffset);
-        result->portalSurfaces[i].edges = ADJUST_POINTER_POS(result->portalSurfaces[i].edges, pointerOffset);
-        result->portalSurfaces[i].gfxVertices = ADJUST_POINTER_POS(result->portalSurfaces[i].gfxVertices, pointerOffset);
-    }
-
-    result->portalSurfaceMappingRange = ADJUST_POINTER_POS(result->portalSurfaceMappingRange, pointerOffset);
-    result->portalSurfaceDynamicMappingRange = ADJUST_POINTER_POS(result->portalSurfaceDynamicMappingRange, pointerOffset);
-    result->portalSurfaceMappingIndices = ADJUST_POINTER_POS(result->portalSurfaceMappingIndices, pointerOffset);
-    result->triggers = ADJUST_POINTER_POS(result->triggers, pointerOffset);
-
-    for (int i = 0; i < result->triggerCount; ++i) {
-        result->triggers[i].triggers = ADJUST_POINTER_POS(result->triggers[i].triggers, pointerOffset);
-    }
-
-    result->cutscenes = ADJUST_POINTER_POS(result->cutscenes, pointerOffset);
-
-    for (int i = 0; i < result->cutsceneCount; ++i) {
-        result->cutscenes[i].steps = ADJUST_POINTER_POS(result->cutscenes[i].steps, pointerOffset);
-    }
-
-    result->locations = ADJUST_POINTER_POS(result->locations, pointerOffset);
-    result->roomBvhList = ADJUST_POINTER_POS(result->roomBvhList, pointerOffset);
-    result->world.rooms = ADJUST_POINTER_POS(result->world.rooms, pointerOffset);
-    result->world.doorways = ADJUST_POINTER_POS(result->world.doorways, pointerOffset);
-
-    for (int i = 0; i < result->world.roomCount; ++i) {
-        result->world.rooms[i].quadIndices = ADJUST_POINTER_POS(result->world.rooms[i].quadIndices, pointerOffset);
-        result->world.rooms[i].cellContents = ADJUST_POINTER_POS(result->world.rooms[i].cellContents, pointerOffset);
-        result->world.rooms[i].doorwayIndices = ADJUST_POINTER_POS(result->world.rooms[i].doorwayIndices, pointerOffset);
-
-        result->roomBvhList[i].boxIndex = ADJUST_POINTER_POS(result->roomBvhList[i].boxIndex, pointerOffset);
-        result->roomBvhList[i].animatedBoxes = ADJUST_POINTER_POS(result->roomBvhList[i].animatedBoxes, pointerOffset);
-    }
+static void** levelRelocations(struct LevelMetadata* metadata, int pointerOffset) {
+    struct LevelDefinition* definition = ADJUST_POINTER_POS(metadata->levelDefinition, pointerOffset);
+    return ADJUST_POINTER_POS(definition->relocations, pointerOffset);
+}
 
-    result->doors = ADJUST_POINTER_POS(result->doors, pointerOffset);
-    result->doorwayCovers = ADJUST_POINTER_POS(result->doorwayCovers, pointerOffset);
-    result->buttons = ADJUST_POINTER_POS(result->buttons, pointerOffset);
-    result->signalOperators = ADJUST_POINTER_POS(result->signalOperators, pointerOffset);
-    result->decor = ADJUST_POINTER_POS(result->decor, pointerOffset);
-    result->fizzlers = ADJUST_POINTER_POS(result->fizzlers, pointerOffset);
-    result->elevators = ADJUST_POINTER_POS(result->elevators, pointerOffset);
-    result->pedestals = ADJUST_POINTER_POS(result->pedestals, pointerOffset);
-    result->signage = ADJUST_POINTER_POS(result->signage, pointerOffset);
-    result->boxDroppers = ADJUST_POINTER_POS(result->boxDroppers, pointerOffset);
-    result->switches = ADJUST_POINTER_POS(result->switches, pointerOffset);
-    result->dynamicBoxes = ADJUST_POINTER_POS(result->dynamicBoxes, pointerOffset);
-    result->ballLaunchers = ADJUST_POINTER_POS(result->ballLaunchers, pointerOffset);
-    result->ballCatchers = ADJUST_POINTER_POS(result->ballCatchers, pointerOffset);
-    result->clocks = ADJUST_POINTER_POS(result->clocks, pointerOffset);
-    result->securityCameras = ADJUST_POINTER_POS(result->securityCameras, pointerOffset);
-    result->turrets = ADJUST_POINTER_POS(result->turrets, pointerOffset);
-    result->incinerators = ADJUST_POINTER_POS(result->incinerators, pointerOffset);
-
-    result->animations = ADJUST_POINTER_POS(result->animations, pointerOffset);
-
-    for (int i = 0; i < result->animationInfoCount; ++i) {
-        result->animations[i].clips = ADJUST_POINTER_POS(result->animations[i].clips, pointerOffset);
-        result->animations[i].armature.boneParentIndex = ADJUST_POINTER_POS(result->animations[i].armature.boneParentIndex, pointerOffset);
-        result->animations[i].armature.pose = ADJUST_POINTER_POS(result->animations[i].armature.pose, pointerOffset);
+// Applies up to maxCount relocations and returns where to continue
+// from, or NULL once the end of the table is reached
+static void** levelApplyRelocations(void** relocation, int pointerOffset, int maxCount) {
+    while (*relocation && maxCount > 0) {
+        void** target = (void**)((char*)*relocation + pointerOffset);
+        *target = ADJUST_POINTER_POS(*target, pointerOffset);
+        ++relocation;
+        --maxCount;
     }
 
-    return result;
+    return *relocation ? relocation : NULL;
 }
 
 void levelQueueLoad(int index, struct Transform* relativeTransform, struct Vector3* relativeVelocity, int useCheckpoint) {
@@ -155,6 +103,70 @@ void levelClearQueued() {
     sQueuedLevel = NO_QUEUED_LEVEL;
 }
 
+static void levelPrefetchRelocate(int maxCount) {
+    struct LevelMetadata* metadata = &gLevels[sPrefetch.index];
+    int pointerOffset = sPrefetch.memory - metadata->segmentStart;
+
+    if (!sPrefetch.nextRelocation) {
+        sPrefetch.nextRelocation = levelRelocations(metadata, pointerOffset);
+    }
+
+    sPrefetch.nextRelocation = levelApplyRelocations(sPrefetch.nextRelocation, pointerOffset, maxCount);
+    sPrefetch.isRelocated = !sPrefetch.nextRelocation;
+}
+
+void levelPrefetch(int index) {
+    if (index == NEXT_LEVEL) {
+        index = gCurrentLevelIndex + 1;
+    }
+
+    if (index < 0 || index >= LEVEL_COUNT || sPrefetch.index != NO_QUEUED_LEVEL) {
+        return;
+    }
+
+    struct LevelMetadata* metadata = &gLevels[index];
+    int size = compressedSegmentMemorySize(metadata->segmentRomStart, metadata->segmentRomEnd, NULL);
+
+    // needs to be a heap block so heapInitKeep can carry
+    // it over into the next level
+    char* memory = mallocTagged(size, MemoryTagLevel);
+
+    if (!memory) {
+        // not enough room, the level loads the slow way
+        return;
+    }
+
+    sPrefetch.index = index;
+    sPrefetch.memory = memory;
+    sPrefetch.nextRelocation = NULL;
+    sPrefetch.isLoaded = 0;
+    sPrefetch.isRelocated = 0;
+
+    compressedSegmentStreamInit(&sPrefetch.stream, metadata->segmentRomStart, metadata->segmentRomEnd, memory);
+}
+
+void levelPrefetchUpdate() {
+    if (sPrefetch.index == NO_QUEUED_LEVEL) {
+        return;
+    }
+
+    if (!sPrefetch.isLoaded) {
+        sPrefetch.isLoaded = compressedSegmentStreamUpdate(&sPrefetch.stream, LEVEL_PREFETCH_DECOMPRESS_BYTES);
+    } else if (!sPrefetch.isRelocated) {
+        levelPrefetchRelocate(LEVEL_PREFETCH_RELOCATIONS);
+    }
+}
+
+void* levelPrefetchedMemory(int index) {
+    if (sPrefetch.index == NO_QUEUED_LEVEL || sPrefetch.index != index) {
+        // anything prefetched goes away with the heap
+        sPrefetch.index = NO_QUEUED_LEVEL;
+        return NULL;
+    }
+
+    return sPrefetch.memory;
+}
+
 void levelLoad(int index) {
     if (index < 0 || index >= LEVEL_COUNT) {
         return;
@@ -162,12 +174,30 @@ void levelLoad(int index) {
 
     struct LevelMetadata* metadata = &gLevels[index];
 
-    void* memory = malloc(metadata->segmentRomEnd - metadata->segmentRomStart);
-    romCopy(metadata->segmentRomStart, memory, metadata->segmentRomEnd - metadata->segmentRomStart);
+    void* memory;
 
-    gLevelSegment = memory;
+    if (sPrefetch.index == index) {
+        // finish whatever the prefetch didn't get to
+        compressedSegmentStreamFinish(&sPrefetch.stream);
+
+        while (!sPrefetch.isRelocated) {
+            levelPrefetchRelocate(LEVEL_PREFETCH_RELOCATIONS);
+        }
+
+        memory = sPrefetch.memory;
+    } else {
+        memory = arenaMalloc(&gLevelArena, compressedSegmentMemorySize(metadata->segmentRomStart, metadata->segmentRomEnd, NULL));
+        compressedSegmentLoad(metadata->segmentRomStart, metadata->segmentRomEnd, memory);
+
+        int pointerOffset = (char*)memory - metadata->segmentStart;
+        levelApplyRelocations(levelRelocations(metadata, pointerOffset), pointerOffset, 0x7FFFFFFF);
+    }
 
-    gCurrentLevel = levelFixPointers(metadata->levelDefinition, (char*)memory - metadata->segmentStart);
+    gCurrentLevel = ADJUST_POINTER_POS(metadata->levelDefinition, (char*)memory - metadata->segmentStart);
+
+    sPrefetch.index = NO_QUEUED_LEVEL;
+
+    gLevelSegment = memory;
     gCurrentLevelIndex = index;
 
     collisionSceneInit(&gCollisionScene, gCurrentLevel->collisionQuads, gCurrentLevel->collisionQuadCount, &gCurrentLevel->world);
@@ -186,6 +216,14 @@ int levelLoadedFromTransition() {
     return sLoadedFromTransition;
 }
 
+void levelRecordTransitionTime(Time time) {
+    sLastTransitionTime = time;
+}
+
+Time levelLastTransitionTime() {
+    return sLastTransitionTime;
+}
+
 int levelCount() {
     return LEVEL_COUNT;
 }
@@ -304,6 +342,49 @@ Gfx* levelMaterialRevert(int index) {
     return static_material_revert_list[index];
 }
 
+#define NO_TMEM_GROUP   -1
+
+void levelMaterialTmemInit(struct MaterialTmemState* tmemState) {
+    levelMaterialTmemInvalidate(tmemState);
+    tmemState->textureLoads = 0;
+}
+
+void levelMaterialTmemInvalidate(struct MaterialTmemState* tmemState) {
+    tmemState->group = NO_TMEM_GROUP;
+    tmemState->loadedTextures = 0;
+}
+
+Gfx* levelMaterialWithTmem(int index, struct MaterialTmemState* tmemState) {
+    if (index < 0 || index >= STATIC_MATERIAL_COUNT) {
+        return NULL;
+    }
+
+    short group = static_material_tmem_group[index];
+    u32 textures = static_material_tmem_textures[index];
+
+    if (!textures) {
+        return static_material_list[index];
+    }
+
+    if (group != NO_TMEM_GROUP && group == tmemState->group && (tmemState->loadedTextures & textures) == textures) {
+        return static_material_tile_only_list[index];
+    }
+
+    if (group != tmemState->group) {
+        tmemState->group = group;
+        tmemState->loadedTextures = 0;
+    }
+
+    // Unpacked materials can load anywhere in TMEM
+    if (group != NO_TMEM_GROUP) {
+        tmemState->loadedTextures |= textures;
+    }
+
+    ++tmemState->textureLoads;
+
+    return static_material_list[index];
+}
+
 int levelQuadIndex(struct CollisionObject* pointer) {
     if (pointer < gCollisionScene.quads || pointer >= gCollisionScene.quads + gCollisionScene.quadCount) {
         return -1;
@@ -2,6 +2,7 @@
 #define __LEVELS_H__
 
 #include "level_definition.h"
+#include "system/time.h"
 
 #define CREDITS_MENU    -5
 #define INTRO_MENU      -4
@@ -9,6 +10,14 @@
 #define NO_QUEUED_LEVEL -2
 #define NEXT_LEVEL      -1
 
+// Tracks which textures of a packed TMEM group are loaded so that
+// materials can skip reloading them
+struct MaterialTmemState {
+    short group;
+    u32 loadedTextures;
+    u16 textureLoads;
+};
+
 extern struct LevelDefinition* gCurrentLevel;
 extern int gCurrentLevelIndex;
 
@@ -17,10 +26,21 @@ void levelQueueReload();
 int levelGetQueued();
 void levelClearQueued();
 
+// Starts streaming a level's segment so the transition to it
+// doesn't have to wait on the copy and pointer fixups
+void levelPrefetch(int index);
+void levelPrefetchUpdate();
+// The memory the queued level was prefetched into. Must be kept
+// by heapInitKeep when resetting the heap before levelLoad
+void* levelPrefetchedMemory(int index);
+
 void levelLoad(int index);
 void levelGetStartLocationAndVelocity(struct Location* location, struct Vector3* velocity);
 int levelLoadedFromTransition();
 
+void levelRecordTransitionTime(Time time);
+Time levelLastTransitionTime();
+
 int levelCount();
 int getChamberIndexFromLevelIndex(int levelIndex, int roomIndex);
 int getLevelIndexFromChamberIndex(int chamberIndex);
@@ -31,6 +51,10 @@ Gfx* levelMaterial(int index);
 Gfx* levelMaterialDefault();
 Gfx* levelMaterialRevert(int index);
 
+void levelMaterialTmemInit(struct MaterialTmemState* tmemState);
+void levelMaterialTmemInvalidate(struct MaterialTmemState* tmemState);
+Gfx* levelMaterialWithTmem(int index, struct MaterialTmemState* tmemState);
+
 int levelQuadIndex(struct CollisionObject* pointer);
 struct Location* levelGetLocation(short index);
 
@@ -40,13 +40,12 @@ void staticRenderTraverseIndex(
                 continue;
             }
 
-            renderSceneAdd(
+            renderSceneAddStatic(
                 renderScene, 
                 staticContent[i].displayList, 
                 NULL, 
                 staticContent[i].materialIndex, 
-                &staticContent[i].center, 
-                NULL
+                &staticContent[i].center
             );
         }
 
@@ -98,13 +97,12 @@ void staticRenderPopulateRooms(struct FrustumCullingInformation* cullingInfo, Mt
                 struct Vector3 center;
                 vector3AddScaled(&staticElement->center, &transform->position, 1.0f / SCENE_SCALE, &center);
 
-                renderSceneAdd(
+                renderSceneAddStatic(
                     renderScene, 
                     staticElement->displayList, 
                     &staticMatrices[staticElement->transformIndex], 
                     staticElement->materialIndex, 
-                    &center, 
-                    NULL
+                    &center
                 );
             }
         }
@@ -191,6 +189,7 @@ void staticRender(struct RenderProps* renderStage, struct DynamicRenderDataList*
     renderSceneGenerate(renderScene, renderState);
 
     renderStage->renderPartCount = renderScene->currentRenderPart;
+    renderStage->textureLoadCount = renderScene->textureLoadCount;
 
     renderSceneFree(renderScene);
 }
@@ -201,23 +200,20 @@ u8 gSignalMaterialMapping[] = {
 };
 
 void staticRenderCheckSignalMaterials() {
-    for (int signal = 0; signal < gCurrentLevel->signalToStaticCount; ++signal) {
+    for (int signal = signalsNextChanged(-1); signal != -1 && signal < gCurrentLevel->signalToStaticCount; signal = signalsNextChanged(signal)) {
         int currentSignal = signalsRead(signal);
+        struct Rangeu16* range = &gCurrentLevel->signalToStaticRanges[signal];
 
-        if (currentSignal != signalsReadPrevious(signal)) {
-            struct Rangeu16* range = &gCurrentLevel->signalToStaticRanges[signal];
+        int toIndex = currentSignal ? 1 : 0;
+        int fromIndex = currentSignal ? 0 : 1;
 
-            int toIndex = currentSignal ? 1 : 0;
-            int fromIndex = currentSignal ? 0 : 1;
+        for (int index = range->min; index < range->max; ++index) {
+            struct StaticContentElement* element = &gCurrentLevel->staticContent[gCurrentLevel->signalToStaticIndices[index]];
 
-            for (int index = range->min; index < range->max; ++index) {
-                struct StaticContentElement* element = &gCurrentLevel->staticContent[gCurrentLevel->signalToStaticIndices[index]];
-
-                for (int materialIndex = 0; materialIndex < sizeof(gSignalMaterialMapping) / sizeof(*gSignalMaterialMapping); materialIndex += 2) {
-                    if (element->materialIndex == gSignalMaterialMapping[materialIndex + fromIndex]) {
-                        element->materialIndex = gSignalMaterialMapping[materialIndex + toIndex];
-                        break;
-                    }
+            for (int materialIndex = 0; materialIndex < sizeof(gSignalMaterialMapping) / sizeof(*gSignalMaterialMapping); materialIndex += 2) {
+                if (element->materialIndex == gSignalMaterialMapping[materialIndex + fromIndex]) {
+                    element->materialIndex = gSignalMaterialMapping[materialIndex + toIndex];
+                    break;
                 }
             }
         }
@@ -146,13 +146,17 @@ int main() {
 
                 if (levelGetQueued() != NO_QUEUED_LEVEL) {
                     if (pendingGFX == 0) {
+                        Time transitionStart = timeGetTime();
                         soundPlayerStopAll();
                         dynamicSceneInit();
                         contactSolverInit(&gContactSolver);
                         portalSurfaceRevert(1);
                         portalSurfaceRevert(0);
                         portalSurfaceCleanupQueueInit();
-                        heapInit(_heapStart, memoryEnd);
+                        // don't let streaming animation data land in the new heap
+                        romCopyAsyncDrain();
+                        heapInitKeep(_heapStart, memoryEnd, levelPrefetchedMemory(levelGetQueued()));
+                        stackMallocResetPeak();
                         profileClearAddressMap();
                         translationsLoad(gSaveData.video.textLanguage);
                         levelLoadWithCallbacks(levelGetQueued());
@@ -163,17 +167,14 @@ int main() {
                         // don't fire portals until it is released
                         controllerActionMuteActive();
                         gSceneCallbacks->initCallback(gSceneCallbacks->data);
+                        levelRecordTransitionTime(timeGetTime() - transitionStart);
                     }
 
                     break;
                 }
 
                 if (translationsCurrentLanguage() != gGameMenu.currentRenderedLanguage) {
-                    if (pendingGFX == 0) {
-                        gameMenuRebuildText(&gGameMenu);
-                    }
-
-                    break;
+                    gameMenuRebuildText(&gGameMenu);
                 }
 
                 Time startTime = timeGetTime();
@@ -189,7 +190,9 @@ int main() {
                 controllersPoll();
                 rumblePakClipUpdate();
                 controllerActionUpdate();
-                romCopyAsyncDrain();
+                romCopyAsyncUpdate();
+                dynamicAssetsUpdate();
+                savefileUpdate();
                 
                 if (inputIgnore) {
                     --inputIgnore;
@@ -219,6 +222,7 @@ int main() {
                 --pendingGFX;
                 portalSurfaceCheckCleanupQueue();
                 menuTickDeferredQueue();
+                dynamicAssetsFrameDone();
 
                 if (gScene.checkpointState == SceneCheckpointStatePendingRender) {
                     gScene.checkpointState = SceneCheckpointStateReady;
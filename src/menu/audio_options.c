@@ -128,7 +128,7 @@ void audioOptionsAction(void* data, int selection, struct MenuAction* action) {
 
             struct MenuBuilderElement* element = &audioOptions->menuBuilder.elements[AUDIO_LANGUAGE_TEXT_INDEX];
             element->params->params.text.message = AudioLanguages[gSaveData.audio.audioLanguage];
-            element->callbacks->rebuildText(element, 1 /* deferFree */);
+            element->callbacks->rebuildText(element, 0 /* stage */);
 
             break;
     }
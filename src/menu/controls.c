@@ -374,22 +374,29 @@ void controlsMenuInit(struct ControlsMenu* controlsMenu) {
 }
 
 void controlsMenuRebuildText(struct ControlsMenu* controlsMenu) {
+    int currentHeader = 0;
+
     for (int i = 0; i < ControllerActionCount; ++i) {
-        prerenderedTextFree(controlsMenu->actionRows[i].actionText);
-    }
+        if (sControllerDataRows[i].headerId != StringIdNone && currentHeader < MAX_CONTROLS_SECTIONS) {
+            menuStageText(
+                &controlsMenu->headers[currentHeader].headerText,
+                menuBuildPrerenderedText(&gDejaVuSansFont, translationsGet(sControllerDataRows[i].headerId), 0, 0, SCREEN_WD)
+            );
+            ++currentHeader;
+        }
 
-    for (int i = 0; i < MAX_CONTROLS_SECTIONS; ++i) {
-        prerenderedTextFree(controlsMenu->headers[i].headerText);
+        menuStageText(
+            &controlsMenu->actionRows[i].actionText,
+            menuBuildPrerenderedText(&gDejaVuSansFont, translationsGet(sControllerDataRows[i].nameId), 0, 0, ROW_TEXT_MAX_WIDTH)
+        );
     }
 
-    controlsMenuInitText(controlsMenu);
+    menuStageButtonText(&controlsMenu->useDefaults, &gDejaVuSansFont, translationsGet(GAMEUI_USEDEFAULTS));
+}
+
+void controlsMenuLayoutText(struct ControlsMenu* controlsMenu) {
     controlsMenuLayout(controlsMenu);
-    menuRebuildButtonText(
-        &controlsMenu->useDefaults,
-        &gDejaVuSansFont,
-        translationsGet(GAMEUI_USEDEFAULTS),
-        1
-    );
+    menuLayoutButtonText(&controlsMenu->useDefaults, 1);
 }
 
 enum InputCapture controlsMenuUpdate(struct ControlsMenu* controlsMenu) {
@@ -587,11 +594,14 @@ void controlsMenuRender(struct ControlsMenu* controlsMenu, struct RenderState* r
     gDPSetScissor(renderState->dl++, G_SC_NON_INTERLACE, 0, 0, SCREEN_WD, SCREEN_HT);
 }
 
-void controlsRenderPrompt(enum ControllerAction action, char* message, float opacity, struct RenderState* renderState) {
+void controlsRenderPrompt(enum ControllerAction action, enum StringId promptId, float opacity, struct RenderState* renderState) {
+    char* message = translationsGet(promptId);
+
     if (message == NULL || *message == '\0') {
         return;
     }
     
+    // prompts are a few words so they aren't worth a cached layout
     struct FontRenderer* fontRender = stackMalloc(sizeof(struct FontRenderer));
     fontRendererLayout(fontRender, &gDejaVuSansFont, message, SCREEN_WD - (PROMPT_MARGIN_X + (PROMPT_PADDING * 2)));
     
@@ -36,11 +36,13 @@ struct ControlsMenu {
 };
 
 void controlsMenuInit(struct ControlsMenu* controlsMenu);
+// Stages the menu text, call controlsMenuLayoutText once it is committed
 void controlsMenuRebuildText(struct ControlsMenu* controlsMenu);
+void controlsMenuLayoutText(struct ControlsMenu* controlsMenu);
 enum InputCapture controlsMenuUpdate(struct ControlsMenu* controlsMenu);
 void controlsMenuRender(struct ControlsMenu* controlsMenu, struct RenderState* renderState, struct GraphicsTask* task);
 
-void controlsRenderPrompt(enum ControllerAction action, char* message, float opacity, struct RenderState* renderState);
+void controlsRenderPrompt(enum ControllerAction action, enum StringId promptId, float opacity, struct RenderState* renderState);
 void controlsRenderInputIcon(enum ControllerActionInput input, int x, int y, struct RenderState* renderState);
 
 #endif
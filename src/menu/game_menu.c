@@ -20,15 +20,45 @@ void gameMenuInit(struct GameMenu* gameMenu, struct LandingMenuOption* options,
 
     gameMenu->state = GameMenuStateLanding;
     gameMenu->currentRenderedLanguage = translationsCurrentLanguage();
+    gameMenu->rebuildLanguage = gameMenu->currentRenderedLanguage;
+    gameMenu->rebuildStep = 0;
 }
 
+#define GAME_MENU_REBUILD_STEPS     (OPTIONS_MENU_REBUILD_STEPS + 2)
+
 void gameMenuRebuildText(struct GameMenu* gameMenu) {
-    if (gameMenu->currentRenderedLanguage != translationsCurrentLanguage()) {
+    int language = translationsCurrentLanguage();
+
+    if (gameMenu->currentRenderedLanguage == language) {
+        return;
+    }
+
+    // start over if the language changed again part way through
+    if (gameMenu->rebuildLanguage != language) {
+        menuDiscardStagedText();
+        gameMenu->rebuildLanguage = language;
+        gameMenu->rebuildStep = 0;
+    }
+
+    if (gameMenu->rebuildStep == 0) {
         newGameRebuildText(&gameMenu->newGameMenu);
+    } else if (gameMenu->rebuildStep == 1) {
         landingMenuRebuildText(&gameMenu->landingMenu);
-        optionsMenuRebuildText(&gameMenu->optionsMenu);
-        gameMenu->currentRenderedLanguage = translationsCurrentLanguage();
+    } else if (gameMenu->rebuildStep < GAME_MENU_REBUILD_STEPS) {
+        optionsMenuRebuildTextStep(&gameMenu->optionsMenu, gameMenu->rebuildStep - 2);
+    } else {
+        // everything is built, swap it all in at once so
+        // the menu never shows two languages
+        menuCommitStagedText();
+        newGameLayoutText(&gameMenu->newGameMenu);
+        optionsMenuLayoutText(&gameMenu->optionsMenu);
+
+        gameMenu->currentRenderedLanguage = language;
+        gameMenu->rebuildStep = 0;
+        return;
     }
+
+    ++gameMenu->rebuildStep;
 }
 
 enum GameMenuState gameInputCaptureToState(enum InputCapture direction, enum GameMenuState currentState) {
@@ -32,9 +32,14 @@ struct GameMenu {
     struct OptionsMenu optionsMenu;
     struct ConfirmationDialog confirmationDialog;
     short currentRenderedLanguage;
+    short rebuildLanguage;
+    short rebuildStep;
 };
 
 void gameMenuInit(struct GameMenu* gameMenu, struct LandingMenuOption* options, int optionCount, int darkenBackground);
+// Builds part of the menu text each call after the language changes.
+// The old text is drawn until the last call swaps the new text in
+// and currentRenderedLanguage catches up
 void gameMenuRebuildText(struct GameMenu* gameMenu);
 void gameMenuUpdate(struct GameMenu* gameMenu);
 void gameMenuRender(struct GameMenu* gameMenu, struct RenderState* renderState, struct GraphicsTask* task);
@@ -65,17 +65,17 @@ Gfx portal_logo_gfx[] = {
     gsSPEndDisplayList(),
 };
 
-void landingMenuInitText(struct LandingMenu* landingMenu) {
-    int y = LANDING_MENU_TEXT_START_Y;
-    int stride = getCurrentStrideValue(landingMenu);
+static struct PrerenderedText* landingMenuBuildOptionText(struct LandingMenu* landingMenu, int index) {
+    return menuBuildPrerenderedText(&gDejaVuSansFont,
+        translationsGet(landingMenu->options[index].messageId),
+        LANDING_MENU_TEXT_START_X,
+        LANDING_MENU_TEXT_START_Y + getCurrentStrideValue(landingMenu) * index,
+        SCREEN_WD);
+}
 
+void landingMenuInitText(struct LandingMenu* landingMenu) {
     for (int i = 0; i < landingMenu->optionCount; ++i) {
-        landingMenu->optionText[i] = menuBuildPrerenderedText(&gDejaVuSansFont,
-            translationsGet(landingMenu->options[i].messageId),
-            LANDING_MENU_TEXT_START_X,
-            y,
-            SCREEN_WD);
-        y += stride;
+        landingMenu->optionText[i] = landingMenuBuildOptionText(landingMenu, i);
     }
 
     landingMenu->versionText = menuBuildPrerenderedText(&gDejaVuSansFont, GAME_VERSION, 0, 0, SCREEN_WD);
@@ -87,7 +87,7 @@ void landingMenuInitText(struct LandingMenu* landingMenu) {
 }
 
 void landingMenuInit(struct LandingMenu* landingMenu, struct LandingMenuOption* options, int optionCount, int darkenBackground) {
-    landingMenu->optionText = malloc(sizeof(struct PrerenderedText*) * optionCount);
+    landingMenu->optionText = mallocTagged(sizeof(struct PrerenderedText*) * optionCount, MemoryTagUI);
     landingMenu->options = options;
     landingMenu->versionText = NULL;
     landingMenu->selectedItem = 0;
@@ -97,12 +97,10 @@ void landingMenuInit(struct LandingMenu* landingMenu, struct LandingMenuOption*
 }
 
 void landingMenuRebuildText(struct LandingMenu* landingMenu) {
+    // the version string isn't translated so only the options change
     for (int i = 0; i < landingMenu->optionCount; ++i) {
-        prerenderedTextFree(landingMenu->optionText[i]);
+        menuStageText(&landingMenu->optionText[i], landingMenuBuildOptionText(landingMenu, i));
     }
-    prerenderedTextFree(landingMenu->versionText);
-
-    landingMenuInitText(landingMenu);
 }
 
 struct LandingMenuOption* landingMenuUpdate(struct LandingMenu* landingMenu) {
@@ -20,6 +20,7 @@ struct LandingMenu {
 };
 
 void landingMenuInit(struct LandingMenu* landingMenu, struct LandingMenuOption* options, int optionCount, int darkenBackground);
+// Stages new option text, see menuStageText
 void landingMenuRebuildText(struct LandingMenu* landingMenu);
 struct LandingMenuOption* landingMenuUpdate(struct LandingMenu* landingMenu);
 void landingMenuRender(struct LandingMenu* landingMenu, struct RenderState* renderState, struct GraphicsTask* task);
@@ -85,7 +85,7 @@ Gfx* menuRerenderBorder(int x, int y, int width, int height, Gfx* dl) {
 }
 
 Gfx* menuBuildBorder(int x, int y, int width, int height) {
-    Gfx* result = malloc(sizeof(Gfx) * 7 * 3 + 1);
+    Gfx* result = mallocTagged(sizeof(Gfx) * 7 * 3 + 1, MemoryTagUI);
     Gfx* dl = menuRerenderBorder(x, y, width, height, result);
 
     gSPEndDisplayList(dl++);
@@ -94,7 +94,7 @@ Gfx* menuBuildBorder(int x, int y, int width, int height) {
 }
 
 Gfx* menuBuildHorizontalLine(int x, int y, int width) {
-    Gfx* result = malloc(sizeof(Gfx) * 7);
+    Gfx* result = mallocTagged(sizeof(Gfx) * 7, MemoryTagUI);
 
     Gfx* dl = result;
     gDPPipeSync(dl++);
@@ -117,7 +117,7 @@ Gfx* menuRerenderSolidBorder(int x, int y, int w, int h, int nx, int ny, int nw,
 }
 
 Gfx* menuBuildSolidBorder(int x, int y, int w, int h, int nx, int ny, int nw, int nh) {
-    Gfx* result = malloc(sizeof(Gfx) * 5);
+    Gfx* result = mallocTagged(sizeof(Gfx) * 5, MemoryTagUI);
     Gfx* dl = menuRerenderSolidBorder(x, y, w, h, nx, ny, nw, nh, result);
 
     gSPEndDisplayList(dl++);
@@ -147,7 +147,7 @@ Gfx* menuRenderOutline(int x, int y, int width, int height, int invert, Gfx* dl)
 }
 
 Gfx* menuBuildOutline(int x, int y, int width, int height, int invert) {
-    Gfx* result = malloc(sizeof(Gfx) * 9);
+    Gfx* result = mallocTagged(sizeof(Gfx) * 9, MemoryTagUI);
     Gfx* dl = menuRenderOutline(x, y, width, height, invert, result);
     gSPEndDisplayList(dl++);
     return result;
@@ -186,6 +186,17 @@ void menuRebuildButtonText(struct MenuButton* button, struct Font* font, char* m
 
     button->text = menuBuildPrerenderedText(font, message, button->x + BUTTON_LEFT_PADDING, button->y + BUTTON_TOP_PADDING, SCREEN_HT);
 
+    menuLayoutButtonText(button, rightAlign);
+}
+
+void menuStageButtonText(struct MenuButton* button, struct Font* font, char* message) {
+    menuStageText(
+        &button->text,
+        menuBuildPrerenderedText(font, message, button->x + BUTTON_LEFT_PADDING, button->y + BUTTON_TOP_PADDING, SCREEN_HT)
+    );
+}
+
+void menuLayoutButtonText(struct MenuButton* button, int rightAlign) {
     int newWidth = button->text->width + BUTTON_LEFT_PADDING + BUTTON_RIGHT_PADDING;
 
     if (rightAlign) {
@@ -224,7 +235,7 @@ struct MenuCheckbox menuBuildCheckbox(struct Font* font, char* message, int x, i
     result.x = x;
     result.y = y;
 
-    result.outline = malloc(sizeof(Gfx) * 12);
+    result.outline = mallocTagged(sizeof(Gfx) * 12, MemoryTagUI);
 
     Gfx* dl = result.outline;
 
@@ -271,7 +282,7 @@ struct MenuSlider menuBuildSlider(int x, int y, int w, int tickCount) {
     result.y = y;
     result.w = w;
 
-    result.back = malloc(sizeof(Gfx) * (12 + tickCount));
+    result.back = mallocTagged(sizeof(Gfx) * (12 + tickCount), MemoryTagUI);
 
     Gfx* dl = result.back;
 
@@ -328,7 +339,9 @@ Gfx* menuSliderRender(struct MenuSlider* slider, Gfx* dl) {
     return dl;
 }
 
-#define MAX_DEFERRED_RELEASE_SIZE   20
+#define MAX_STAGED_TEXT             64
+// committing staged text releases everything it replaced at once
+#define MAX_DEFERRED_RELEASE_SIZE   (20 + MAX_STAGED_TEXT)
 #define RELEASE_DEFER_COUNT         2
 #define NEXT_ENTRY(curr)        ((curr) + 1 == MAX_DEFERRED_RELEASE_SIZE ? 0 : (curr) + 1)
 
@@ -378,6 +391,19 @@ void menuTickDeferredQueue() {
     } while (curr != gDeferredPTRelease.insertPos);
 }
 
+struct StagedText {
+    struct PrerenderedText** target;
+    struct PrerenderedText* previous;
+    struct PrerenderedText* text;
+};
+
+struct StagedTextQueue {
+    struct StagedText entries[MAX_STAGED_TEXT];
+    short count;
+};
+
+struct StagedTextQueue gStagedText;
+
 void menuResetDeferredQueue() {
     for (int i = 0; i < MAX_DEFERRED_RELEASE_SIZE; ++i) {
         gDeferredPTRelease.queue[i] = NULL;
@@ -385,4 +411,45 @@ void menuResetDeferredQueue() {
     }
     gDeferredPTRelease.insertPos = 0;
     gDeferredPTRelease.readPos = 0;
+    gStagedText.count = 0;
+}
+
+void menuStageText(struct PrerenderedText** target, struct PrerenderedText* text) {
+    if (gStagedText.count == MAX_STAGED_TEXT) {
+        // out of room, swap it in now
+        menuFreePrerenderedDeferred(*target);
+        *target = text;
+        return;
+    }
+
+    struct StagedText* entry = &gStagedText.entries[gStagedText.count];
+    entry->target = target;
+    entry->previous = *target;
+    entry->text = text;
+    ++gStagedText.count;
+}
+
+void menuCommitStagedText() {
+    for (int i = 0; i < gStagedText.count; ++i) {
+        struct StagedText* entry = &gStagedText.entries[i];
+
+        if (*entry->target != entry->previous) {
+            // rebuilt after it was staged so it's already up to date
+            prerenderedTextFree(entry->text);
+            continue;
+        }
+
+        menuFreePrerenderedDeferred(entry->previous);
+        *entry->target = entry->text;
+    }
+
+    gStagedText.count = 0;
+}
+
+void menuDiscardStagedText() {
+    for (int i = 0; i < gStagedText.count; ++i) {
+        prerenderedTextFree(gStagedText.entries[i].text);
+    }
+
+    gStagedText.count = 0;
 }
\ No newline at end of file
@@ -58,6 +58,9 @@ Gfx* menuBuildOutline(int x, int y, int width, int height, int invert);
 struct MenuButton menuBuildButton(struct Font* font, char* message, int x, int y, int height, int rightAlign);
 void menuSetRenderColor(struct RenderState* renderState, int isSelected, struct Coloru8* selected, struct Coloru8* defaultColor);
 void menuRebuildButtonText(struct MenuButton* button, struct Font* font, char* message, int rightAlign);
+// Stages new button text, call menuLayoutButtonText once it is committed
+void menuStageButtonText(struct MenuButton* button, struct Font* font, char* message);
+void menuLayoutButtonText(struct MenuButton* button, int rightAlign);
 void menuRelocateButton(struct MenuButton* button, int x, int y, int rightAlign);
 
 struct MenuCheckbox menuBuildCheckbox(struct Font* font, char* message, int x, int y);
@@ -70,4 +73,10 @@ void menuFreePrerenderedDeferred(struct PrerenderedText* text);
 void menuTickDeferredQueue();
 void menuResetDeferredQueue();
 
+// Text built ahead of a language change is staged so the menu keeps
+// drawing the old text until menuCommitStagedText swaps it all in
+void menuStageText(struct PrerenderedText** target, struct PrerenderedText* text);
+void menuCommitStagedText();
+void menuDiscardStagedText();
+
 #endif
\ No newline at end of file
@@ -19,7 +19,7 @@
 #define PADDING_X 2
 #define TABWIDTH 232
 
-void textMenuItemInit(struct MenuBuilderElement* element) {
+static struct PrerenderedText* textMenuItemBuildText(struct MenuBuilderElement* element) {
     char* message = element->params->params.text.message;
 
     if (!message) {
@@ -38,17 +38,22 @@ void textMenuItemInit(struct MenuBuilderElement* element) {
         prerenderedTextRelocate(text, text->x - text->width, text->y);
     }
 
-    element->data = text;
+    return text;
 }
 
-void textMenuItemRebuildText(struct MenuBuilderElement* element, int deferFree) {
-    if (deferFree) {
-        menuFreePrerenderedDeferred(element->data);
+void textMenuItemInit(struct MenuBuilderElement* element) {
+    element->data = textMenuItemBuildText(element);
+}
+
+void textMenuItemRebuildText(struct MenuBuilderElement* element, int stage) {
+    struct PrerenderedText* text = textMenuItemBuildText(element);
+
+    if (stage) {
+        menuStageText((struct PrerenderedText**)&element->data, text);
     } else {
-        prerenderedTextFree(element->data);
+        menuFreePrerenderedDeferred(element->data);
+        element->data = text;
     }
-
-    textMenuItemInit(element);
 }
 
 void textMenuItemRender(struct MenuBuilderElement* element, int selection, int materialIndex, struct PrerenderedTextBatch* textBatch, struct RenderState* renderState) {
@@ -71,7 +76,7 @@ void textMenuItemRender(struct MenuBuilderElement* element, int selection, int m
 }
 
 void checkboxMenuItemInit(struct MenuBuilderElement* element) {
-    struct MenuCheckbox* checkbox = malloc(sizeof(struct MenuCheckbox));
+    struct MenuCheckbox* checkbox = mallocTagged(sizeof(struct MenuCheckbox), MemoryTagUI);
     *checkbox = menuBuildCheckbox(
         element->params->params.checkbox.font,
         translationsGet(element->params->params.checkbox.messageId),
@@ -97,22 +102,23 @@ enum InputCapture checkboxMenuItemUpdate(struct MenuBuilderElement* element, Men
     return InputCapturePass;
 }
 
-void checkboxMenuItemRebuildText(struct MenuBuilderElement* element, int deferFree) {
+void checkboxMenuItemRebuildText(struct MenuBuilderElement* element, int stage) {
     struct MenuCheckbox* checkbox = (struct MenuCheckbox*)element->data;
 
-    if (deferFree) {
-        menuFreePrerenderedDeferred(checkbox->prerenderedText);
-    } else {
-        prerenderedTextFree(checkbox->prerenderedText);
-    }
-
-    checkbox->prerenderedText = menuBuildPrerenderedText(
+    struct PrerenderedText* text = menuBuildPrerenderedText(
         element->params->params.checkbox.font, 
         translationsGet(element->params->params.checkbox.messageId),
         element->params->x + CHECKBOX_SIZE + 6,
         element->params->y,
         SCREEN_WD
     );
+
+    if (stage) {
+        menuStageText(&checkbox->prerenderedText, text);
+    } else {
+        menuFreePrerenderedDeferred(checkbox->prerenderedText);
+        checkbox->prerenderedText = text;
+    }
 }
 
 void checkboxMenuItemRender(struct MenuBuilderElement* element, 
@@ -143,7 +149,7 @@ void checkboxMenuItemRender(struct MenuBuilderElement* element,
 }
 
 void sliderMenuItemInit(struct MenuBuilderElement* element) {
-    struct MenuSlider* slider = malloc(sizeof(struct MenuSlider));
+    struct MenuSlider* slider = mallocTagged(sizeof(struct MenuSlider), MemoryTagUI);
 
     short steps = element->params->params.slider.numberOfTicks;
 
@@ -280,7 +286,7 @@ void menuBuilderInit(
     MenuActionCalback actionCallback, 
     void* data
 ) {
-    menuBuilder->elements = malloc(sizeof(struct MenuBuilderElement) * elementCount);
+    menuBuilder->elements = mallocTagged(sizeof(struct MenuBuilderElement) * elementCount, MemoryTagUI);
     menuBuilder->elementCount = elementCount;
     menuBuilder->selection = 0;
     menuBuilder->maxSelection = maxSelection;
@@ -339,7 +345,7 @@ enum InputCapture menuBuilderUpdate(struct MenuBuilder* menuBuilder) {
 void menuBuilderRebuildText(struct MenuBuilder* menuBuilder) {
     for (int i = 0; i < menuBuilder->elementCount; ++i) {
         if (menuBuilder->elements[i].callbacks->rebuildText) {
-            menuBuilder->elements[i].callbacks->rebuildText(&menuBuilder->elements[i], 0 /* deferFree */);
+            menuBuilder->elements[i].callbacks->rebuildText(&menuBuilder->elements[i], 1 /* stage */);
         }
     }
 }
@@ -34,7 +34,9 @@ typedef void (*MenuActionCalback)(void* data, int selection, struct MenuAction*
 
 typedef void (*MenuItemInit)(struct MenuBuilderElement* element);
 typedef enum InputCapture (*MenuItemUpdate)(struct MenuBuilderElement* element, MenuActionCalback actionCallback, void* data);
-typedef void (*MenuItemRebuildText)(struct MenuBuilderElement* element, int deferFree);
+// stage holds the new text for menuCommitStagedText, otherwise it
+// replaces the old text right away and the old text is freed deferred
+typedef void (*MenuItemRebuildText)(struct MenuBuilderElement* element, int stage);
 typedef void (*MenuItemRender)(struct MenuBuilderElement* element, int selection, int materialIndex, struct PrerenderedTextBatch* textBatch, struct RenderState* renderState);
 
 struct MenuBuilderCallbacks {
@@ -96,6 +98,7 @@ void menuBuilderInit(
     void* data
 );
 enum InputCapture menuBuilderUpdate(struct MenuBuilder* menuBuilder);
+// Stages new text for every element, see menuStageText
 void menuBuilderRebuildText(struct MenuBuilder* menuBuilder);
 void menuBuilderRender(struct MenuBuilder* menuBuilder, struct RenderState* renderState);
 
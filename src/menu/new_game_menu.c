@@ -47,7 +47,7 @@ static void chapterMenuItemInit(struct ChapterMenuItem* chapterMenuItem, int x,
         CHAPTER_IMAGE_WIDTH, CHAPTER_IMAGE_HEIGHT
     );
 
-    chapterMenuItem->imageBuffer = malloc(CHAPTER_IMAGE_SIZE);
+    chapterMenuItem->imageBuffer = mallocTagged(CHAPTER_IMAGE_SIZE, MemoryTagUI);
     zeroMemory(chapterMenuItem->imageBuffer, CHAPTER_IMAGE_SIZE);
 
     chapterMenuItem->chapter = NULL;
@@ -55,23 +55,20 @@ static void chapterMenuItemInit(struct ChapterMenuItem* chapterMenuItem, int x,
     chapterMenuItem->y = y;
 }
 
-static void chapterMenuItemSetChapter(struct ChapterMenuItem* chapterMenuItem, int chapterIndex) {
-    struct Chapter* chapter = &gChapters[chapterIndex];
-
-    menuFreePrerenderedDeferred(chapterMenuItem->chapterText);
-    menuFreePrerenderedDeferred(chapterMenuItem->testChamberText);
-
+static struct PrerenderedText* chapterMenuItemBuildChapterText(struct ChapterMenuItem* chapterMenuItem, int chapterIndex) {
     char chapterText[64];
     sprintf(chapterText, "%s %d", translationsGet(GAMEUI_CHAPTER), chapterIndex + 1);
-    chapterMenuItem->chapterText = menuBuildPrerenderedText(&gDejaVuSansFont, chapterText, chapterMenuItem->x, chapterMenuItem->y, SCREEN_WD);
-
-    textManipTestChamberMessage(chapterText, gChapters[chapterIndex].testChamberNumber);
-    chapterMenuItem->testChamberText = menuBuildPrerenderedText(&gDejaVuSansFont, chapterText, chapterMenuItem->x, chapterMenuItem->y + 14, 100);
+    return menuBuildPrerenderedText(&gDejaVuSansFont, chapterText, chapterMenuItem->x, chapterMenuItem->y, SCREEN_WD);
+}
 
-    if (chapter->testChamberLevelIndex >= 0) {
-        romCopy(chapter->imageData, chapterMenuItem->imageBuffer, CHAPTER_IMAGE_SIZE);
-    }
+static struct PrerenderedText* chapterMenuItemBuildTestChamberText(struct ChapterMenuItem* chapterMenuItem, int chapterIndex) {
+    char testChamberText[64];
+    textManipTestChamberMessage(testChamberText, gChapters[chapterIndex].testChamberNumber);
+    return menuBuildPrerenderedText(&gDejaVuSansFont, testChamberText, chapterMenuItem->x, chapterMenuItem->y + 14, 100);
+}
 
+// the image border sits below the test chamber text
+static void chapterMenuItemLayout(struct ChapterMenuItem* chapterMenuItem) {
     int x = chapterMenuItem->x;
     int y = chapterMenuItem->testChamberText->y + chapterMenuItem->testChamberText->height;
 
@@ -83,10 +80,37 @@ static void chapterMenuItemSetChapter(struct ChapterMenuItem* chapterMenuItem, i
         chapterMenuItem->border
     );
     gSPEndDisplayList(gfx);
+}
+
+static void chapterMenuItemSetChapter(struct ChapterMenuItem* chapterMenuItem, int chapterIndex) {
+    struct Chapter* chapter = &gChapters[chapterIndex];
+
+    menuFreePrerenderedDeferred(chapterMenuItem->chapterText);
+    menuFreePrerenderedDeferred(chapterMenuItem->testChamberText);
+
+    chapterMenuItem->chapterText = chapterMenuItemBuildChapterText(chapterMenuItem, chapterIndex);
+    chapterMenuItem->testChamberText = chapterMenuItemBuildTestChamberText(chapterMenuItem, chapterIndex);
+
+    if (chapter->testChamberLevelIndex >= 0) {
+        romCopy(chapter->imageData, chapterMenuItem->imageBuffer, CHAPTER_IMAGE_SIZE);
+    }
+
+    chapterMenuItemLayout(chapterMenuItem);
 
     chapterMenuItem->chapter = chapter;
 }
 
+static void chapterMenuItemStageText(struct ChapterMenuItem* chapterMenuItem) {
+    if (!chapterMenuItem->chapter) {
+        return;
+    }
+
+    int chapterIndex = chapterMenuItem->chapter - gChapters;
+
+    menuStageText(&chapterMenuItem->chapterText, chapterMenuItemBuildChapterText(chapterMenuItem, chapterIndex));
+    menuStageText(&chapterMenuItem->testChamberText, chapterMenuItemBuildTestChamberText(chapterMenuItem, chapterIndex));
+}
+
 void newGameInit(struct NewGameMenu* newGameMenu) {
     newGameMenu->newGameText = menuBuildPrerenderedText(&gDejaVuSansFont, translationsGet(GAMEUI_NEWGAME), 48, 48, SCREEN_WD);
     newGameMenu->menuOutline = menuBuildBorder(NEW_GAME_X, NEW_GAME_Y, SCREEN_WD - (NEW_GAME_X * 2), SCREEN_HT - (NEW_GAME_Y) * 2);
@@ -106,14 +130,18 @@ void newGameInit(struct NewGameMenu* newGameMenu) {
 }
 
 void newGameRebuildText(struct NewGameMenu* newGameMenu) {
-    chapterMenuItemSetChapter(&newGameMenu->leftChapter, newGameMenu->leftChapterIndex);
+    chapterMenuItemStageText(&newGameMenu->leftChapter);
+    chapterMenuItemStageText(&newGameMenu->rightChapter);
 
-    if ((newGameMenu->leftChapterIndex + 1) < TOTAL_CHAPTER_COUNT) {
-        chapterMenuItemSetChapter(&newGameMenu->rightChapter, newGameMenu->leftChapterIndex + 1);
-    }
+    menuStageText(
+        &newGameMenu->newGameText,
+        menuBuildPrerenderedText(&gDejaVuSansFont, translationsGet(GAMEUI_NEWGAME), 48, 48, SCREEN_WD)
+    );
+}
 
-    prerenderedTextFree(newGameMenu->newGameText);
-    newGameMenu->newGameText = menuBuildPrerenderedText(&gDejaVuSansFont, translationsGet(GAMEUI_NEWGAME), 48, 48, SCREEN_WD);
+void newGameLayoutText(struct NewGameMenu* newGameMenu) {
+    chapterMenuItemLayout(&newGameMenu->leftChapter);
+    chapterMenuItemLayout(&newGameMenu->rightChapter);
 }
 
 static void newGameStartSelectedChapter(struct NewGameMenu* newGameMenu) {
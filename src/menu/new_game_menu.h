@@ -43,7 +43,9 @@ struct NewGameMenu {
 };
 
 void newGameInit(struct NewGameMenu* newGameMenu);
+// Stages the menu text, call newGameLayoutText once it is committed
 void newGameRebuildText(struct NewGameMenu* newGameMenu);
+void newGameLayoutText(struct NewGameMenu* newGameMenu);
 enum InputCapture newGameUpdate(struct NewGameMenu* newGameMenu);
 void newGameRender(struct NewGameMenu* newGameMenu, struct RenderState* renderState, struct GraphicsTask* task);
 
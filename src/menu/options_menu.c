@@ -56,13 +56,32 @@ void optionsMenuInit(struct OptionsMenu* options) {
     gameplayOptionsInit(&options->gameplayOptions);
 }
 
-void optionsMenuRebuildText(struct OptionsMenu* options) {
-    controlsMenuRebuildText(&options->controlsMenu);
-    joystickOptionsRebuildText(&options->joystickOptions);
-    audioOptionsRebuildtext(&options->audioOptions);
-    videoOptionsRebuildtext(&options->videoOptions);
-    gameplayOptionsRebuildText(&options->gameplayOptions);
-    tabsRebuildText(&options->tabs);
+void optionsMenuRebuildTextStep(struct OptionsMenu* options, int step) {
+    switch (step) {
+        case 0:
+            controlsMenuRebuildText(&options->controlsMenu);
+            break;
+        case 1:
+            joystickOptionsRebuildText(&options->joystickOptions);
+            break;
+        case 2:
+            audioOptionsRebuildtext(&options->audioOptions);
+            break;
+        case 3:
+            videoOptionsRebuildtext(&options->videoOptions);
+            break;
+        case 4:
+            gameplayOptionsRebuildText(&options->gameplayOptions);
+            break;
+        case 5:
+            tabsRebuildText(&options->tabs);
+            break;
+    }
+}
+
+void optionsMenuLayoutText(struct OptionsMenu* options) {
+    controlsMenuLayoutText(&options->controlsMenu);
+    tabsLayoutText(&options->tabs);
 }
 
 enum InputCapture optionsMenuUpdate(struct OptionsMenu* options) {
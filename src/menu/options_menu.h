@@ -33,7 +33,12 @@ struct OptionsMenu {
 };
 
 void optionsMenuInit(struct OptionsMenu* options);
-void optionsMenuRebuildText(struct OptionsMenu* options);
+#define OPTIONS_MENU_REBUILD_STEPS  6
+
+// Stages the text of one sub menu so the work can be split across
+// frames, call optionsMenuLayoutText once it is committed
+void optionsMenuRebuildTextStep(struct OptionsMenu* options, int step);
+void optionsMenuLayoutText(struct OptionsMenu* options);
 enum InputCapture optionsMenuUpdate(struct OptionsMenu* options);
 void optionsMenuRender(struct OptionsMenu* options, struct RenderState* renderState, struct GraphicsTask* task);
 
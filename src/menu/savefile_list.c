@@ -71,7 +71,7 @@ void savefileListSlotInit(struct SavefileListSlot* savefileListSlot, int x, int
 
     savefileListSlot->x = x;
     savefileListSlot->y = y;
-    savefileListSlot->imageData = malloc(SAVE_SLOT_IMAGE_SIZE);
+    savefileListSlot->imageData = mallocTagged(SAVE_SLOT_IMAGE_SIZE, MemoryTagUI);
     savefileListSlot->slotIndex = -1;
 }
 
@@ -72,6 +72,16 @@ void tabsSetSelectedTab(struct Tabs* tabs, int index) {
     tabs->prevOffset = tabOffset;
 }
 
+static struct PrerenderedText* tabsBuildText(struct Tabs* tabs, int index) {
+    return menuBuildPrerenderedText(
+        tabs->font, 
+        translationsGet(tabs->tabs[index].messageId), 
+        0, 
+        tabs->y + TOP_TEXT_PADDING,
+        SCREEN_WD
+    );
+}
+
 void tabsInit(struct Tabs* tabs, struct Tab* tabList, int tabCount, struct Font* font, int x, int y, int width, int height) {
     tabs->tabs = tabList;
     tabs->tabCount = tabCount;
@@ -81,16 +91,16 @@ void tabsInit(struct Tabs* tabs, struct Tab* tabList, int tabCount, struct Font*
     tabs->x = x;
     tabs->y = y;
     tabs->prevOffset = 0;
-    tabs->tabOutline = malloc(sizeof(Gfx) * (10 + 3 * tabCount));
+    tabs->tabOutline = mallocTagged(sizeof(Gfx) * (10 + 3 * tabCount), MemoryTagUI);
 
-    tabs->tabRenderData = malloc(sizeof(struct TabRenderData) * tabCount);
+    tabs->tabRenderData = mallocTagged(sizeof(struct TabRenderData) * tabCount, MemoryTagUI);
 
     for (int i = 0; i < tabCount; ++i) {
-        tabs->tabRenderData[i].text = NULL;
+        tabs->tabRenderData[i].text = tabsBuildText(tabs, i);
     }
 
     tabs->selectedTab = 0;
-    tabsRebuildText(tabs);
+    tabsLayoutText(tabs);
 }
 
 void tabsRenderText(struct Tabs* tabs, struct PrerenderedTextBatch* batch) {
@@ -100,17 +110,16 @@ void tabsRenderText(struct Tabs* tabs, struct PrerenderedTextBatch* batch) {
 }
 
 void tabsRebuildText(struct Tabs* tabs) {
+    for (int i = 0; i < tabs->tabCount; ++i) {
+        menuStageText(&tabs->tabRenderData[i].text, tabsBuildText(tabs, i));
+    }
+}
+
+void tabsLayoutText(struct Tabs* tabs) {
     int currentX = tabs->x;
 
     for (int i = 0; i < tabs->tabCount; ++i) {
-        prerenderedTextFree(tabs->tabRenderData[i].text);
-        tabs->tabRenderData[i].text = menuBuildPrerenderedText(
-            tabs->font, 
-            translationsGet(tabs->tabs[i].messageId), 
-            currentX + LEFT_TEXT_PADDING, 
-            tabs->y + TOP_TEXT_PADDING,
-            SCREEN_WD
-        );
+        prerenderedTextRelocate(tabs->tabRenderData[i].text, currentX + LEFT_TEXT_PADDING, tabs->y + TOP_TEXT_PADDING);
         tabs->tabRenderData[i].width = tabs->tabRenderData[i].text->width + LEFT_TEXT_PADDING + RIGHT_TEXT_PADDING;
         tabs->tabRenderData[i].x = currentX;
 
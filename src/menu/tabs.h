@@ -32,6 +32,8 @@ struct Tabs {
 void tabsInit(struct Tabs* tabs, struct Tab* tabList, int tabCount, struct Font* font, int x, int y, int width, int height);
 void tabsSetSelectedTab(struct Tabs* tabs, int index);
 void tabsRenderText(struct Tabs* tabs, struct PrerenderedTextBatch* batch);
+// Stages the tab text, call tabsLayoutText once it is committed
 void tabsRebuildText(struct Tabs* tabs);
+void tabsLayoutText(struct Tabs* tabs);
 
 #endif
\ No newline at end of file
@@ -7,8 +7,41 @@
 #include "serializer.h"
 #include "util/memory.h"
 
+// Checkpoints are compared a block at a time against the last one
+// saved so only the blocks that changed are written to SRAM
+#define CHECKPOINT_BLOCK_SIZE           64
+#define CHECKPOINT_BLOCK_COUNT          (MAX_CHECKPOINT_SIZE / CHECKPOINT_BLOCK_SIZE)
+// Every SRAM write waits for the SRAM to settle, past this many
+// separate runs of changes the whole checkpoint is written instead
+#define CHECKPOINT_MAX_DELTA_RUNS       4
+// Rewrite the whole checkpoint every so often in case a write was dropped
+#define CHECKPOINT_FULL_SAVE_INTERVAL   8
+// Saves alternate between a slot's checkpoint buffer and the spare one
+#define CHECKPOINT_BASE_COUNT           2
+#define CHECKPOINT_NO_BUFFER            -1
+
+struct CheckpointRun {
+    short start;
+    short end;
+};
+
 static int sCheckpointCurrentSlot = SAVEFILE_NO_SLOT;
 
+// What is in SRAM for a checkpoint buffer. Queued saves are
+// written straight from here so it can't change until they finish
+struct CheckpointBase {
+    u64 data[MAX_CHECKPOINT_SIZE / sizeof(u64)];
+    int checkpointBuffer;
+    int deltaSaveCount;
+};
+
+static struct CheckpointBase sCheckpointBases[CHECKPOINT_BASE_COUNT] = {
+    { .checkpointBuffer = CHECKPOINT_NO_BUFFER },
+    { .checkpointBuffer = CHECKPOINT_NO_BUFFER },
+};
+
+static struct CheckpointStats sLastSaveStats;
+
 static void checkpointSerialize(struct Serializer* serializer, SerializeAction action, struct Scene* scene) {
     signalsSerializeRW(serializer, action);
     cutsceneSerializeWrite(serializer, action);
@@ -21,25 +54,115 @@ static void checkpointDeserialize(struct Serializer* serializer, struct Scene* s
     sceneDeserialize(serializer, scene);
 }
 
-static int checkpointCalculateSize(struct Scene* scene) {
-    struct Serializer serializer = { NULL };
-    checkpointSerialize(&serializer, serializeCount, scene);
-    return (int)serializer.curr;
-}
-
 static int checkpointSaveInto(struct Scene* scene, Checkpoint into) {
-    int size = checkpointCalculateSize(scene);
+    struct Serializer serializer = { into, (char*)into + MAX_CHECKPOINT_SIZE };
+    checkpointSerialize(&serializer, serializeWrite, scene);
+
+    int size = (char*)serializer.curr - (char*)into;
 
     if (size > MAX_CHECKPOINT_SIZE) {
         return 0;
     }
 
-    struct Serializer serializer = { into };
-    checkpointSerialize(&serializer, serializeWrite, scene);
+    // keep the unused end stable so it never shows up as a change
+    zeroMemory((char*)into + size, MAX_CHECKPOINT_SIZE - size);
 
     return 1;
 }
 
+// Finds the base holding checkpointBuffer, or else replaces
+// whichever base isn't holding the buffer in keepBuffer
+static struct CheckpointBase* checkpointFindBase(int checkpointBuffer, int keepBuffer) {
+    for (int i = 0; i < CHECKPOINT_BASE_COUNT; ++i) {
+        if (sCheckpointBases[i].checkpointBuffer == checkpointBuffer) {
+            return &sCheckpointBases[i];
+        }
+    }
+
+    struct CheckpointBase* result = &sCheckpointBases[0];
+
+    if (result->checkpointBuffer == keepBuffer) {
+        result = &sCheckpointBases[1];
+    }
+
+    result->checkpointBuffer = CHECKPOINT_NO_BUFFER;
+    return result;
+}
+
+static int checkpointBlockChanged(struct CheckpointBase* checkpointBase, Checkpoint checkpoint, int blockIndex) {
+    u64* curr = (u64*)checkpoint + blockIndex * (CHECKPOINT_BLOCK_SIZE / sizeof(u64));
+    u64* base = checkpointBase->data + blockIndex * (CHECKPOINT_BLOCK_SIZE / sizeof(u64));
+
+    for (int i = 0; i < CHECKPOINT_BLOCK_SIZE / sizeof(u64); ++i) {
+        if (curr[i] != base[i]) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+// Returns the number of runs of changed blocks, or -1 if there
+// are too many for writing only the changes to be worth it
+static int checkpointFindChanges(struct CheckpointBase* base, Checkpoint checkpoint, struct CheckpointRun* runs) {
+    int runCount = 0;
+
+    for (int blockIndex = 0; blockIndex < CHECKPOINT_BLOCK_COUNT; ++blockIndex) {
+        if (!checkpointBlockChanged(base, checkpoint, blockIndex)) {
+            continue;
+        }
+
+        if (runCount && runs[runCount - 1].end == blockIndex) {
+            runs[runCount - 1].end = blockIndex + 1;
+            continue;
+        }
+
+        if (runCount == CHECKPOINT_MAX_DELTA_RUNS) {
+            return -1;
+        }
+
+        runs[runCount].start = blockIndex;
+        runs[runCount].end = blockIndex + 1;
+        ++runCount;
+    }
+
+    return runCount;
+}
+
+static void checkpointWrite(int slotIndex, Checkpoint checkpoint) {
+    int checkpointBuffer = savefileSpareCheckpointBuffer();
+    struct CheckpointBase* base = checkpointFindBase(checkpointBuffer, savefileSlotCheckpointBuffer(slotIndex));
+    struct CheckpointRun runs[CHECKPOINT_MAX_DELTA_RUNS];
+    int runCount = -1;
+
+    if (base->checkpointBuffer == checkpointBuffer && base->deltaSaveCount < CHECKPOINT_FULL_SAVE_INTERVAL) {
+        runCount = checkpointFindChanges(base, checkpoint, runs);
+    }
+
+    memCopy(base->data, checkpoint, MAX_CHECKPOINT_SIZE);
+    base->checkpointBuffer = checkpointBuffer;
+
+    sLastSaveStats.bytesWritten = 0;
+    sLastSaveStats.isFullSave = runCount == -1;
+
+    if (runCount == -1) {
+        savefileQueueSlotCheckpoint(base->data, 0, MAX_CHECKPOINT_SIZE);
+        sLastSaveStats.bytesWritten = MAX_CHECKPOINT_SIZE;
+        base->deltaSaveCount = 0;
+        return;
+    }
+
+    for (int i = 0; i < runCount; ++i) {
+        int offset = runs[i].start * CHECKPOINT_BLOCK_SIZE;
+        int size = (runs[i].end - runs[i].start) * CHECKPOINT_BLOCK_SIZE;
+
+        savefileQueueSlotCheckpoint(base->data, offset, size);
+        sLastSaveStats.bytesWritten += size;
+    }
+
+    ++base->deltaSaveCount;
+}
+
 static void checkpointLoadFrom(struct Scene* scene, Checkpoint from) {
     struct Serializer serializer = { from };
     checkpointDeserialize(&serializer, scene);
@@ -92,14 +215,20 @@ int checkpointExists() {
 
 int checkpointSave(struct Scene* scene, int slotIndex) {
     Checkpoint* save = stackMalloc(MAX_CHECKPOINT_SIZE);
+
+    Time startTime = timeGetTime();
     int success = checkpointSaveInto(scene, save);
+    sLastSaveStats.serializeTime = timeGetTime() - startTime;
 
     if (success) {
-        savefileSaveSlot(
+        // The spare buffer and bases can't change while a save is being written
+        savefileFlush();
+        checkpointWrite(slotIndex, save);
+
+        sLastSaveStats.bytesWritten += savefileQueueSlotSave(
             slotIndex,
             getChamberIndexFromLevelIndex(gCurrentLevelIndex, scene->player.body.currentRoom),
-            gCurrentTestSubject,
-            save
+            gCurrentTestSubject
         );
 
         sCheckpointCurrentSlot = slotIndex;
@@ -127,6 +256,17 @@ void checkpointLoadCurrent(struct Scene* scene) {
     Checkpoint* save = stackMalloc(MAX_CHECKPOINT_SIZE);
     if (savefileLoadSlot(sCheckpointCurrentSlot, save)) {
         checkpointLoadFrom(scene, save);
+
+        // saving back into this buffer only needs to write what changed
+        int checkpointBuffer = savefileSlotCheckpointBuffer(sCheckpointCurrentSlot);
+        struct CheckpointBase* base = checkpointFindBase(checkpointBuffer, CHECKPOINT_NO_BUFFER);
+        memCopy(base->data, save, MAX_CHECKPOINT_SIZE);
+        base->checkpointBuffer = checkpointBuffer;
+        base->deltaSaveCount = 0;
     }
     stackMallocFree(save);
 }
+
+struct CheckpointStats* checkpointLastSaveStats() {
+    return &sLastSaveStats;
+}
@@ -2,11 +2,20 @@
 #define __SAVEFILE_CHECKPOINT_H__
 
 #include "scene/scene.h"
+#include "system/time.h"
 
 #define MAX_CHECKPOINT_SIZE 2048
 
 typedef void* Checkpoint;
 
+struct CheckpointStats {
+    Time serializeTime;
+    // includes the slot image and save header
+    int bytesWritten;
+    // only the changed parts are written when saving over the last checkpoint
+    short isFullSave;
+};
+
 int checkpointExists();
 void checkpointClear();
 
@@ -14,4 +23,6 @@ int checkpointSave(struct Scene* scene, int slotIndex);
 void checkpointQueueLoad(int slotIndex);
 void checkpointLoadCurrent(struct Scene* scene);
 
+struct CheckpointStats* checkpointLastSaveStats();
+
 #endif
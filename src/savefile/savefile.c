@@ -6,10 +6,23 @@
 #include "util/memory.h"
 #include "util/sort.h"
 
-#define SAVEFILE_MAGIC                      0xDF06
+#define SAVEFILE_MAGIC                      0xDF07
+// before slots owned a checkpoint buffer
+#define SAVEFILE_MAGIC_SLOT_BUFFERS         0xDF06
 
 #define SAVE_SLOT_OFFSET(index)             (((index) + 1) * SAVE_SLOT_SIZE)
 #define SAVE_SLOT_IMAGE_OFFSET(index)       (SAVE_SLOT_OFFSET(index) + MAX_CHECKPOINT_SIZE)
+// The spare checkpoint buffer shares the first slot's worth of space
+// with gSaveData, which has to stay smaller than MAX_CHECKPOINT_SIZE
+#define SPARE_CHECKPOINT_OFFSET             (SAVE_SLOT_SIZE - MAX_CHECKPOINT_SIZE)
+#define CHECKPOINT_BUFFER_OFFSET(buffer)    ((buffer) == MAX_SAVE_SLOTS ? SPARE_CHECKPOINT_OFFSET : SAVE_SLOT_OFFSET(buffer))
+
+_Static_assert(sizeof(struct SaveData) <= SPARE_CHECKPOINT_OFFSET, "gSaveData overlaps the spare checkpoint buffer");
+
+// Each write waits for the SRAM to settle afterwards, so large
+// writes are split up to avoid stalling any one frame for long
+#define SAVE_WRITE_CHUNK_SIZE               512
+#define MAX_PENDING_SAVE_WRITES             8
 
 #define NO_TEST_CHAMBER                     0xFF
 #define TEST_SUBJECT_MAX                    99
@@ -22,6 +35,27 @@ uint8_t gCurrentTestSubject = 0;
 
 static uint16_t sSlotImage[SAVE_SLOT_IMAGE_W * SAVE_SLOT_IMAGE_H];
 
+struct PendingSaveWrite {
+    char* ramAddr;
+    int sramAddr;
+    int size;
+};
+
+struct PendingSlotSave {
+    struct PendingSaveWrite writes[MAX_PENDING_SAVE_WRITES];
+    short writeCount;
+    short currentWrite;
+    short isQueued;
+    uint8_t slotIndex;
+    uint8_t testChamberNumber;
+    uint8_t subjectNumber;
+    uint8_t checkpointBuffer;
+};
+
+static struct PendingSlotSave sPendingSave;
+// the header is built here so gSaveData only changes once it is being written
+static struct SaveData __attribute__((aligned(8))) sPendingHeader;
+
 static void savefileUpdateSlot(uint8_t slotIndex, uint8_t testChamber, uint8_t subjectNumber, uint8_t slotOrder) {
     struct SaveSlotMetadata* metadata = &gSaveData.saveSlotMetadata[slotIndex];
 
@@ -36,6 +70,7 @@ static void savefileNew() {
 
     for (int i = 0; i < MAX_SAVE_SLOTS; ++i) {
         savefileUpdateSlot(i, NO_TEST_CHAMBER, 0xFF, 0xFF);
+        gSaveData.saveSlotMetadata[i].checkpointBuffer = i;
     }
 
     controllerActionSetDefaultSources();
@@ -50,11 +85,39 @@ static void savefileNew() {
     gSaveData.gameplay.flags |= GameplaySaveFlagsPortalFunneling;
 }
 
+struct SaveSlotMetadataNoBuffer {
+    uint8_t testChamberNumber;
+    uint8_t testSubjectNumber;
+    uint8_t saveSlotOrder;
+};
+
+// Everything before the slot metadata kept its layout and each slot's
+// checkpoint is still where the slot used to keep it, in its own buffer
+static void savefileMigrateSlotBuffers() {
+    struct SaveSlotMetadataNoBuffer oldMetadata[MAX_SAVE_SLOTS];
+    memCopy(oldMetadata, gSaveData.saveSlotMetadata, sizeof(oldMetadata));
+
+    for (int i = 0; i < MAX_SAVE_SLOTS; ++i) {
+        struct SaveSlotMetadata* metadata = &gSaveData.saveSlotMetadata[i];
+        metadata->testChamberNumber = oldMetadata[i].testChamberNumber;
+        metadata->testSubjectNumber = oldMetadata[i].testSubjectNumber;
+        metadata->saveSlotOrder = oldMetadata[i].saveSlotOrder;
+        metadata->checkpointBuffer = i;
+    }
+
+    gSaveData.header.magic = SAVEFILE_MAGIC;
+    savefileSave();
+}
+
 void savefileLoad() {
     if (!sramRead(0, &gSaveData, sizeof(gSaveData))) {
         savefileNew();
     }
 
+    if (gSaveData.header.magic == SAVEFILE_MAGIC_SLOT_BUFFERS) {
+        savefileMigrateSlotBuffers();
+    }
+
     if (gSaveData.header.magic != SAVEFILE_MAGIC) {
         savefileNew();
     }
@@ -74,14 +137,72 @@ void savefileMarkChapterProgress(int testChamberNumber) {
 }
 
 int savefileLoadSlot(int slot, Checkpoint checkpoint) {
-    return sramRead((void*)SAVE_SLOT_OFFSET(slot), checkpoint, MAX_CHECKPOINT_SIZE);
+    savefileFlush();
+
+    return sramRead((void*)CHECKPOINT_BUFFER_OFFSET(savefileSlotCheckpointBuffer(slot)), checkpoint, MAX_CHECKPOINT_SIZE);
 }
 
-void savefileSaveSlot(int slotIndex, int testChamberNumber, int subjectNumber, Checkpoint checkpoint) {
-    sramWrite((void*)SAVE_SLOT_OFFSET(slotIndex), checkpoint, MAX_CHECKPOINT_SIZE);
-    sramWrite((void*)SAVE_SLOT_IMAGE_OFFSET(slotIndex), sSlotImage, SAVE_SLOT_IMAGE_SIZE);
+int savefileSpareCheckpointBuffer() {
+    int usedBuffers = 0;
 
-    uint8_t prevSortOrder = gSaveData.saveSlotMetadata[slotIndex].saveSlotOrder;
+    for (int i = 0; i < MAX_SAVE_SLOTS; ++i) {
+        usedBuffers |= 1 << gSaveData.saveSlotMetadata[i].checkpointBuffer;
+    }
+
+    for (int buffer = 0; buffer < CHECKPOINT_BUFFER_COUNT; ++buffer) {
+        if (!(usedBuffers & (1 << buffer))) {
+            return buffer;
+        }
+    }
+
+    return MAX_SAVE_SLOTS;
+}
+
+int savefileSlotCheckpointBuffer(int slotIndex) {
+    return gSaveData.saveSlotMetadata[slotIndex].checkpointBuffer;
+}
+
+static void savefileQueueWrite(void* ramAddr, int sramAddr, int size) {
+    if (sPendingSave.writeCount == MAX_PENDING_SAVE_WRITES) {
+        return;
+    }
+
+    struct PendingSaveWrite* write = &sPendingSave.writes[sPendingSave.writeCount];
+    write->ramAddr = ramAddr;
+    write->sramAddr = sramAddr;
+    write->size = size;
+    ++sPendingSave.writeCount;
+}
+
+void savefileQueueSlotCheckpoint(Checkpoint checkpoint, int offset, int size) {
+    savefileQueueWrite(
+        (char*)checkpoint + offset,
+        CHECKPOINT_BUFFER_OFFSET(savefileSpareCheckpointBuffer()) + offset,
+        size
+    );
+}
+
+int savefileQueueSlotSave(int slotIndex, int testChamberNumber, int subjectNumber) {
+    savefileQueueWrite(sSlotImage, SAVE_SLOT_IMAGE_OFFSET(slotIndex), SAVE_SLOT_IMAGE_SIZE);
+
+    sPendingSave.currentWrite = 0;
+    sPendingSave.isQueued = 1;
+    sPendingSave.slotIndex = slotIndex;
+    sPendingSave.testChamberNumber = testChamberNumber;
+    sPendingSave.subjectNumber = subjectNumber;
+    sPendingSave.checkpointBuffer = savefileSpareCheckpointBuffer();
+
+    return SAVE_SLOT_IMAGE_SIZE + sizeof(gSaveData);
+}
+
+// Writing the header is what switches the slot over to the new
+// checkpoint, until then the slot still uses the old one
+static void savefileCommitSlotSave() {
+    memCopy(&sPendingHeader, &gSaveData, sizeof(gSaveData));
+
+    int slotIndex = sPendingSave.slotIndex;
+    struct SaveSlotMetadata* slotMetadata = sPendingHeader.saveSlotMetadata;
+    uint8_t prevSortOrder = slotMetadata[slotIndex].saveSlotOrder;
 
     // Shift existing slot sort orders
     for (int i = 0; i < MAX_SAVE_SLOTS; ++i) {
@@ -89,17 +210,72 @@ void savefileSaveSlot(int slotIndex, int testChamberNumber, int subjectNumber, C
             continue;
         }
 
-        uint8_t* currSlotOrder = &gSaveData.saveSlotMetadata[i].saveSlotOrder;
+        uint8_t* currSlotOrder = &slotMetadata[i].saveSlotOrder;
         if (*currSlotOrder < prevSortOrder) {
             ++*currSlotOrder;
         }
     }
 
-    savefileUpdateSlot(slotIndex, testChamberNumber, subjectNumber, 0);
-    savefileSave();
+    slotMetadata[slotIndex].testChamberNumber = sPendingSave.testChamberNumber;
+    slotMetadata[slotIndex].testSubjectNumber = sPendingSave.subjectNumber;
+    slotMetadata[slotIndex].saveSlotOrder = 0;
+    slotMetadata[slotIndex].checkpointBuffer = sPendingSave.checkpointBuffer;
+
+    if (!sramWriteAsync(0, &sPendingHeader, sizeof(sPendingHeader))) {
+        // the save stays queued and the header is tried again next update
+        return;
+    }
+
+    memCopy(&gSaveData, &sPendingHeader, sizeof(gSaveData));
+
+    sPendingSave.writeCount = 0;
+    sPendingSave.isQueued = 0;
+}
+
+void savefileUpdate() {
+    if (!sPendingSave.isQueued || sramIsBusy()) {
+        return;
+    }
+
+    if (sPendingSave.currentWrite == sPendingSave.writeCount) {
+        savefileCommitSlotSave();
+        return;
+    }
+
+    struct PendingSaveWrite* write = &sPendingSave.writes[sPendingSave.currentWrite];
+    int size = write->size;
+
+    if (size > SAVE_WRITE_CHUNK_SIZE) {
+        size = SAVE_WRITE_CHUNK_SIZE;
+    }
+
+    if (!sramWriteAsync((void*)write->sramAddr, write->ramAddr, size)) {
+        return;
+    }
+
+    write->ramAddr += size;
+    write->sramAddr += size;
+    write->size -= size;
+
+    if (!write->size) {
+        ++sPendingSave.currentWrite;
+    }
+}
+
+int savefileIsSaving() {
+    return sPendingSave.isQueued;
+}
+
+void savefileFlush() {
+    while (sPendingSave.isQueued) {
+        sramWaitIdle();
+        savefileUpdate();
+    }
 }
 
 void savefileClearSlot(int slotIndex) {
+    savefileFlush();
+
     uint8_t prevSortOrder = gSaveData.saveSlotMetadata[slotIndex].saveSlotOrder;
 
     // Shift existing slot sort orders
@@ -247,6 +423,7 @@ void savefileCopySlotImage(int slotIndex, void* dest) {
         // TODO: "new slot" image (not screenshot)
         memCopy(dest, sSlotImage, SAVE_SLOT_IMAGE_SIZE);
     } else {
+        savefileFlush();
         sramRead((void*)SAVE_SLOT_IMAGE_OFFSET(slotIndex), dest, SAVE_SLOT_IMAGE_SIZE);
     }
 }
@@ -14,9 +14,12 @@
 
 #define SAVE_SLOT_SIZE          (MAX_CHECKPOINT_SIZE + SAVE_SLOT_IMAGE_SPACE)
 
-// One slot's worth of space is reserved for global data
+// One slot's worth of space is reserved for global data and a spare checkpoint
 // The first checkpoint slot is used for autosave
 #define MAX_SAVE_SLOTS          ((int)(SRAM_SIZE / SAVE_SLOT_SIZE) - 1)
+// Each slot owns one checkpoint buffer and the one left over is written
+// to when saving, so the previous checkpoint survives an interrupted save
+#define CHECKPOINT_BUFFER_COUNT (MAX_SAVE_SLOTS + 1)
 #define AUTOSAVE_SLOT           0
 #define SAVEFILE_NO_SLOT        -1
 
@@ -75,6 +78,7 @@ struct SaveSlotMetadata {
     uint8_t testChamberNumber;
     uint8_t testSubjectNumber;
     uint8_t saveSlotOrder;
+    uint8_t checkpointBuffer;
 };
 
 struct SaveData {
@@ -103,9 +107,24 @@ void savefileSave();
 void savefileMarkChapterProgress(int testChamberNumber);
 
 int savefileLoadSlot(int slotIndex, Checkpoint checkpoint);
-void savefileSaveSlot(int slotIndex, int testChamberNumber, int subjectNumber, Checkpoint checkpoint);
 void savefileClearSlot(int slotIndex);
 
+// Slot saves are written in the background a chunk at a time
+// and the slot only switches to the new checkpoint at the end
+int savefileSpareCheckpointBuffer();
+int savefileSlotCheckpointBuffer(int slotIndex);
+// Queues writing size bytes of a checkpoint starting at offset into the
+// spare checkpoint buffer. The checkpoint can't change until the save is done
+void savefileQueueSlotCheckpoint(Checkpoint checkpoint, int offset, int size);
+// Queues the slot image and the header that makes the slot use the spare
+// checkpoint buffer. Returns how many bytes of SRAM will be written
+int savefileQueueSlotSave(int slotIndex, int testChamberNumber, int subjectNumber);
+// Called once a frame to keep a queued save going
+void savefileUpdate();
+int savefileIsSaving();
+// Blocks until a queued save is done
+void savefileFlush();
+
 void savefileGetSlotInfo(int slotIndex, struct SaveSlotInfo* info);
 int savefileGetAllSlotInfo(struct SaveSlotInfo* slots, int includeAuto);
 
@@ -780,6 +780,10 @@ void sceneDeserialize(struct Serializer* serializer, struct Scene* scene) {
         incineratorOnDeserialize(&scene->incinerators[i]);
     }
 
+    for (int i = 0; i < SceneUpdateGroupCount; ++i) {
+        updateSchedulerWakeAll(&scene->updateSchedulers[i]);
+    }
+
     if (scene->player.flags & (PlayerHasFirstPortalGun | PlayerHasSecondPortalGun)) {
         scene->portalGun.rotation = scene->player.lookTransform.rotation;
     }
@@ -7,7 +7,10 @@ void serializeCount(struct Serializer* serializer, void* src, int size) {
 }
 
 void serializeWrite(struct Serializer* serializer, void* src, int size) {
-    memCopy(serializer->curr, src, size);
+    if ((char*)serializer->curr + size <= (char*)serializer->end) {
+        memCopy(serializer->curr, src, size);
+    }
+
     serializer->curr = (char*)serializer->curr + size;
 }
 
@@ -3,6 +3,9 @@
 
 struct Serializer {
     void* curr;
+    // serializeWrite skips anything that doesn't fit before end but
+    // still advances curr, so overflowing can be checked afterwards
+    void* end;
 };
 
 typedef void (*SerializeAction)(struct Serializer* serializer, void* target, int size);
@@ -191,3 +191,15 @@ void buttonUpdate(struct Button* button) {
         collisionObjectUpdateBB(&button->collisionObject);
     }
 }
+
+int buttonSleepFrames(struct Button* button) {
+    if (button->state != ButtonStateUnpressed ||
+        (button->flags & ButtonFlagsFirstUpdate) ||
+        button->activatingObjectCount > 0 ||
+        button->rigidBody.transform.position.y != button->originalPos.y) {
+        return UPDATE_SCHEDULER_AWAKE;
+    }
+
+    // woken by contacts or the player standing on it
+    return UPDATE_SCHEDULER_SLEEP_UNTIL_WOKEN;
+}
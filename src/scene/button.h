@@ -34,5 +34,6 @@ struct Button {
 
 void buttonInit(struct Button* button, struct ButtonDefinition* definition);
 void buttonUpdate(struct Button* button);
+int buttonSleepFrames(struct Button* button);
 
 #endif
@@ -5,11 +5,16 @@
 #include "dynamic_scene.h"
 #include "font/font.h"
 #include "font/liberation_mono.h"
+#include "levels/cutscene_runner.h"
 #include "levels/levels.h"
 #include "physics/collision_scene.h"
 #include "player/player.h"
+#include "portal_surface_generator.h"
+#include "savefile/checkpoint.h"
+#include "system/cartridge.h"
 #include "system/controller.h"
 #include "system/display.h"
+#include "util/dynamic_asset_loader.h"
 #include "util/frame_time.h"
 #include "util/memory.h"
 
@@ -115,6 +120,16 @@ static int debugSceneMaxRenderPartCount(struct RenderPlan* renderPlan) {
     return maxRenderPartCount;
 }
 
+static int debugSceneTextureLoadCount(struct RenderPlan* renderPlan) {
+    int textureLoadCount = 0;
+
+    for (int i = 0; i < renderPlan->stageCount; ++i) {
+        textureLoadCount += renderPlan->stageProps[i].textureLoadCount;
+    }
+
+    return textureLoadCount;
+}
+
 // Average time-based metrics over 2 frames for more stable output
 static float debugSceneAveragedTimeMs(Time value, float* prevValue) {
     float ms = timeMicroseconds(value) / 1000.0f;
@@ -170,7 +185,7 @@ static void debugSceneRenderMetrics(struct Scene* scene, struct RenderState* ren
     gDPPipeSync(renderState->dl++);
 
     struct FontRenderer* fontRenderer = stackMalloc(sizeof(struct FontRenderer));
-    char metricText[20];
+    char metricText[32];
     int textY = SCREEN_HT - PERF_METRICS_MARGIN;
 
     float dt = debugSceneAveragedTimeMs(gLastFrameTime, &lastFrameTimeMs);
@@ -178,7 +193,27 @@ static void debugSceneRenderMetrics(struct Scene* scene, struct RenderState* ren
     uint64_t visibleRooms = debugSceneVisibleRooms(renderPlan);
     int roomCount = debugSceneVisibleRoomCount(visibleRooms);
 
-    sprintf(metricText, "SND: %d/%d", soundPlayerSoundCount(), MAX_ACTIVE_SOUNDS);
+    // voices in use and sounds waiting without one
+    struct SoundPlayerStats* soundStats = soundPlayerStats();
+    sprintf(metricText, "SND: %d/%d V%d", soundStats->voiceCount, audioVoiceBudget(), soundStats->virtualCount);
+    debugSceneRenderTextMetric(fontRenderer, metricText, textY, renderState);
+
+    // audio task time, DMA buffer hit rate, DMAs last audio frame
+    // and buffers read ahead
+    textY -= fontRenderer->height - PERF_METRIC_ROW_PADDING;
+    struct AudioStats* audioLoad = audioStats();
+    int dmaLookups = audioLoad->dmaHits + audioLoad->dmaMisses;
+    sprintf(metricText, "AUD: %2.2f %d%% %d P%d",
+        timeMicroseconds(audioLoad->taskTime) / 1000.0f,
+        dmaLookups ? (100 * audioLoad->dmaHits) / dmaLookups : 100,
+        audioLoad->dmaCount,
+        audioLoad->dmaPrefetches
+    );
+    debugSceneRenderTextMetric(fontRenderer, metricText, textY, renderState);
+
+    // samples queued ahead of the DAC, underruns and whether quality is reduced
+    textY -= fontRenderer->height - PERF_METRIC_ROW_PADDING;
+    sprintf(metricText, "AUB: %d %d %d", audioLoad->sampleSlack, audioLoad->underrunCount, audioLoad->isReduced);
     debugSceneRenderTextMetric(fontRenderer, metricText, textY, renderState);
 
     textY -= fontRenderer->height - PERF_METRIC_ROW_PADDING;
@@ -196,10 +231,89 @@ static void debugSceneRenderMetrics(struct Scene* scene, struct RenderState* ren
     sprintf(metricText, "OBJ: %d/%d", dynamicSceneObjectCount(), MAX_DYNAMIC_SCENE_OBJECTS);
     debugSceneRenderTextMetric(fontRenderer, metricText, textY, renderState);
 
+    textY -= fontRenderer->height - PERF_METRIC_ROW_PADDING;
+    sprintf(metricText, "PAR: %d/%d", effectsActiveParticleCount(&scene->effects), PARTICLE_POOL_SIZE);
+    debugSceneRenderTextMetric(fontRenderer, metricText, textY, renderState);
+
+    // scheduled entities updated this frame and how long it took
+    textY -= fontRenderer->height - PERF_METRIC_ROW_PADDING;
+    struct UpdateSchedulerStats schedulerStats = {0};
+    for (int i = 0; i < SceneUpdateGroupCount; ++i) {
+        struct UpdateSchedulerStats* groupStats = &scene->updateSchedulers[i].lastFrameStats;
+        schedulerStats.updateTime += groupStats->updateTime;
+        schedulerStats.updateCount += groupStats->updateCount;
+        schedulerStats.entityCount += groupStats->entityCount;
+    }
+    sprintf(metricText, "ENT: %d/%d %2.2f",
+        schedulerStats.updateCount, schedulerStats.entityCount,
+        timeMicroseconds(schedulerStats.updateTime) / 1000.0f
+    );
+    debugSceneRenderTextMetric(fontRenderer, metricText, textY, renderState);
+
+    // cutscene update time and cutscenes asleep in a wait queue out of those running
+    textY -= fontRenderer->height - PERF_METRIC_ROW_PADDING;
+    struct CutsceneStats* cutsceneStats = cutscenesStats();
+    sprintf(metricText, "CUT: %2.2f %d/%d",
+        timeMicroseconds(cutsceneStats->updateTime) / 1000.0f,
+        cutsceneStats->waitingCount, cutsceneStats->runningCount
+    );
+    debugSceneRenderTextMetric(fontRenderer, metricText, textY, renderState);
+
     textY -= fontRenderer->height - PERF_METRIC_ROW_PADDING;
     sprintf(metricText, "GEO: %d/%d", debugSceneMaxRenderPartCount(renderPlan), MAX_RENDER_PART_COUNT);
     debugSceneRenderTextMetric(fontRenderer, metricText, textY, renderState);
 
+    textY -= fontRenderer->height - PERF_METRIC_ROW_PADDING;
+    sprintf(metricText, "TEX: %d", debugSceneTextureLoadCount(renderPlan));
+    debugSceneRenderTextMetric(fontRenderer, metricText, textY, renderState);
+
+    textY -= fontRenderer->height - PERF_METRIC_ROW_PADDING;
+    struct RomCopyAsyncStats* dmaStats = romCopyAsyncLastFrameStats();
+    sprintf(metricText, "DMA: %d %2.2f", dmaStats->copyCount, timeMicroseconds(dmaStats->stallTime) / 1000.0f);
+    debugSceneRenderTextMetric(fontRenderer, metricText, textY, renderState);
+
+    textY -= fontRenderer->height - PERF_METRIC_ROW_PADDING;
+    sprintf(metricText, "HEP: %dK %d%%", calculateBytesFree() >> 10, calculateFragmentationPercent());
+    debugSceneRenderTextMetric(fontRenderer, metricText, textY, renderState);
+
+    // per tag usage in KB
+    textY -= fontRenderer->height - PERF_METRIC_ROW_PADDING;
+    sprintf(metricText, "LV:%d AS:%d", calculateTagBytes(MemoryTagLevel) >> 10, calculateTagBytes(MemoryTagAssets) >> 10);
+    debugSceneRenderTextMetric(fontRenderer, metricText, textY, renderState);
+
+    textY -= fontRenderer->height - PERF_METRIC_ROW_PADDING;
+    sprintf(metricText, "UI:%d FR:%d", calculateTagBytes(MemoryTagUI) >> 10, stackMallocPeakBytes() >> 10);
+    debugSceneRenderTextMetric(fontRenderer, metricText, textY, renderState);
+
+    // dynamic model cache KB, misses and evictions
+    textY -= fontRenderer->height - PERF_METRIC_ROW_PADDING;
+    struct DynamicAssetStats* assetStats = dynamicAssetsStats();
+    sprintf(metricText, "MDL: %d %d/%d", assetStats->cacheBytes >> 10, assetStats->misses, assetStats->evictions);
+    debugSceneRenderTextMetric(fontRenderer, metricText, textY, renderState);
+
+    // portal hole cache hit rate and evictions this level
+    textY -= fontRenderer->height - PERF_METRIC_ROW_PADDING;
+    struct PortalSurfaceCacheStats* holeStats = portalSurfaceCacheStats();
+    int holeLookups = holeStats->hits + holeStats->misses;
+    sprintf(metricText, "HOL: %d%% %d", holeLookups ? (100 * holeStats->hits) / holeLookups : 0, holeStats->evictions);
+    debugSceneRenderTextMetric(fontRenderer, metricText, textY, renderState);
+
+    // last portal hole's cut time, failures and why the last one failed
+    textY -= fontRenderer->height - PERF_METRIC_ROW_PADDING;
+    struct PortalSurfaceGeneratorStats* generatorStats = portalSurfaceGeneratorStats();
+    sprintf(metricText, "GEN: %2.2f %d %d", timeMicroseconds(generatorStats->lastTime) / 1000.0f, generatorStats->failureCount, generatorStats->lastFailure);
+    debugSceneRenderTextMetric(fontRenderer, metricText, textY, renderState);
+
+    // last checkpoint's serialize time and SRAM bytes written
+    textY -= fontRenderer->height - PERF_METRIC_ROW_PADDING;
+    struct CheckpointStats* checkpointStats = checkpointLastSaveStats();
+    sprintf(metricText, "SAV: %2.2f %d", timeMicroseconds(checkpointStats->serializeTime) / 1000.0f, checkpointStats->bytesWritten);
+    debugSceneRenderTextMetric(fontRenderer, metricText, textY, renderState);
+
+    textY -= fontRenderer->height - PERF_METRIC_ROW_PADDING;
+    sprintf(metricText, "LVL: %2.2f", timeMicroseconds(levelLastTransitionTime()) / 1000.0f);
+    debugSceneRenderTextMetric(fontRenderer, metricText, textY, renderState);
+
     textY -= fontRenderer->height - PERF_METRIC_ROW_PADDING;
     sprintf(metricText, "RMS: %d %llx", roomCount, visibleRooms);
     debugSceneRenderTextMetric(fontRenderer, metricText, textY, renderState);
@@ -162,6 +162,14 @@ void doorUpdate(struct Door* door) {
     }
 }
 
+int doorSleepFrames(struct Door* door) {
+    if (skAnimatorIsRunning(&door->animator) || signalsRead(door->signalIndex) != door->isOpen) {
+        return UPDATE_SCHEDULER_AWAKE;
+    }
+
+    return UPDATE_SCHEDULER_SLEEP_UNTIL_WOKEN;
+}
+
 void doorOnDeserialize(struct Door* door) {
     struct DoorTypeDefinition* typeDefinition = &sDoorTypeDefinitions[door->doorDefinition->doorType];
 
@@ -25,6 +25,7 @@ struct Door {
 
 void doorInit(struct Door* door, struct DoorDefinition* doorDefinition, struct World* world);
 void doorUpdate(struct Door* door);
+int doorSleepFrames(struct Door* door);
 void doorOnDeserialize(struct Door* door);
 
 #endif
@@ -4,6 +4,7 @@
 #include "audio/soundplayer.h"
 #include "controls/rumble_pak_clip.h"
 #include "levels/cutscene_runner.h"
+#include "levels/levels.h"
 #include "math/mathf.h"
 #include "physics/collision_scene.h"
 #include "physics/mesh_collider.h"
@@ -171,7 +172,13 @@ int elevatorUpdate(struct Elevator* elevator, struct Player* player) {
         }
 
         if (elevator->flags & ElevatorFlagsIsLocked) {
-            int cutscenePreventingMovement = (elevator->targetElevator >= gScene.elevatorCount) && cutsceneIsDialogueQueued();
+            int leavesLevel = elevator->targetElevator >= gScene.elevatorCount;
+            int cutscenePreventingMovement = leavesLevel && cutsceneIsDialogueQueued();
+
+            if (isClosed && leavesLevel) {
+                // load the next level during the ride
+                levelPrefetch(NEXT_LEVEL);
+            }
 
             if (isClosed && !cutscenePreventingMovement && elevator->timer > 0.0f) {
                 elevator->timer -= FIXED_DELTA_TIME;
@@ -363,13 +363,14 @@ static void hudRenderCrosshairs(struct Hud* hud, struct Player* player, struct R
     }
 }
 
-static void hudRenderSubtitle(char* message, float textOpacity, float backgroundOpacity, struct RenderState* renderState, enum SubtitleType subtitleType) {
+static void hudRenderSubtitle(enum StringId subtitleId, float textOpacity, float backgroundOpacity, struct RenderState* renderState, enum SubtitleType subtitleType) {
+    char* message = translationsGet(subtitleId);
+
     if (message == NULL || *message == '\0') {
         return;
     }
 
-    struct FontRenderer* fontRender = stackMalloc(sizeof(struct FontRenderer));
-    fontRendererLayout(fontRender, &gDejaVuSansFont, message, SCREEN_WD - (SUBTITLE_MARGIN_X + SUBTITLE_PADDING) * 2);
+    struct FontRenderer* fontRender = fontRendererLayoutString(&gDejaVuSansFont, subtitleId, SCREEN_WD - (SUBTITLE_MARGIN_X + SUBTITLE_PADDING) * 2);
 
     int textPositionX = (SUBTITLE_MARGIN_X + SUBTITLE_PADDING);
     int textPositionY = (SCREEN_HT - SUBTITLE_MARGIN_Y - SUBTITLE_PADDING) - fontRender->height;
@@ -400,8 +401,6 @@ static void hudRenderSubtitle(char* message, float textOpacity, float background
     renderState->dl = fontRendererBuildGfx(fontRender, gDejaVuSansImages, textPositionX, textPositionY, &textColor, renderState->dl);
 
     gSPDisplayList(renderState->dl++, ui_material_revert_list[DEJAVU_SANS_0_INDEX]);
-
-    stackMallocFree(fontRender);
 }
 
 void hudRender(struct Hud* hud, struct Player* player, struct RenderState* renderState) {
@@ -409,10 +408,10 @@ void hudRender(struct Hud* hud, struct Player* player, struct RenderState* rende
     hudRenderCrosshairs(hud, player, renderState);
 
     if (hud->subtitleOpacity > 0.0f && (gSaveData.video.flags & (VideoSaveFlagsSubtitlesEnabled | VideoSaveFlagsCaptionsEnabled)) && hud->subtitleId != StringIdNone) {
-        hudRenderSubtitle(translationsGet(hud->subtitleId), hud->subtitleOpacity, hud->backgroundOpacity, renderState, hud->subtitleType);
+        hudRenderSubtitle(hud->subtitleId, hud->subtitleOpacity, hud->backgroundOpacity, renderState, hud->subtitleType);
     }
 
     if (hud->promptOpacity > 0.0f && hud->promptType != CutscenePromptTypeNone) {
-        controlsRenderPrompt(sPromptActions[hud->promptType], translationsGet(sPromptText[hud->promptType]), hud->promptOpacity, renderState);
+        controlsRenderPrompt(sPromptActions[hud->promptType], sPromptText[hud->promptType], hud->promptOpacity, renderState);
     }
 }
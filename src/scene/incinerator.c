@@ -168,6 +168,28 @@ void incineratorUpdate(struct Incinerator* incinerator) {
     }
 }
 
+int incineratorSleepFrames(struct Incinerator* incinerator) {
+    if (skAnimatorIsRunning(&incinerator->animator) || signalsRead(incinerator->signalIndex) != incinerator->isOpen) {
+        return UPDATE_SCHEDULER_AWAKE;
+    }
+
+    if (!incinerator->isOpen) {
+        return UPDATE_SCHEDULER_SLEEP_UNTIL_WOKEN;
+    }
+
+    // While open only the smoke timer runs. Take the frames skipped
+    // off of it now so the next puff plays on the frame it wakes
+    int skippedFrames = (int)(incinerator->smokeTimer * (1.0f / FIXED_DELTA_TIME));
+
+    if (skippedFrames <= 0) {
+        return UPDATE_SCHEDULER_AWAKE;
+    }
+
+    incinerator->smokeTimer -= skippedFrames * FIXED_DELTA_TIME;
+
+    return skippedFrames + 1;
+}
+
 void incineratorOnDeserialize(struct Incinerator* incinerator) {
     if (signalsRead(incinerator->signalIndex)) {
         struct SKAnimationClip* clip = dynamicAssetClip(
@@ -20,6 +20,7 @@ struct Incinerator {
 
 void incineratorInit(struct Incinerator* incinerator, struct IncineratorDefinition* definition);
 void incineratorUpdate(struct Incinerator* incinerator);
+int incineratorSleepFrames(struct Incinerator* incinerator);
 void incineratorOnDeserialize(struct Incinerator* incinerator);
 
 #endif
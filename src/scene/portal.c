@@ -164,11 +164,15 @@ int portalSurfaceCutNewHole(struct Portal* portal, int portalIndex) {
         scaledLoop[i].y = ((portal->originCentertedLoop[i].y * fixedPointScale) >> 16) + portal->fullSizeLoopCenter.y;
     }
 
-    struct PortalSurface* currentSurface = &gCurrentLevel->portalSurfaces[portal->portalSurfaceIndex];
-
     struct PortalSurface newSurface;
 
-    if (!portalSurfacePokeHole(currentSurface, scaledLoop, &newSurface)) {
+    // each frame of the opening animation cuts a differently sized hole
+    // that won't come up again, so only full size holes are cached
+    if (portal->scale >= 1.0f) {
+        if (!portalSurfacePokeHoleCached(portal->portalSurfaceIndex, scaledLoop, &newSurface)) {
+            return 0;
+        }
+    } else if (!portalSurfacePokeHole(&gCurrentLevel->portalSurfaces[portal->portalSurfaceIndex], scaledLoop, &newSurface)) {
         return 0;
     }
     
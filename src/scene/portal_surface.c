@@ -9,6 +9,7 @@
 #include "../util/memory.h"
 
 #define MAX_PENDING_PORTAL_CLEANUP  4
+#define PORTAL_SURFACE_CACHE_SIZE   4
 
 #define PORTAL_HOLE_SCALE_X  0.945f
 #define PORTAL_HOLE_SCALE_Y  0.795f
@@ -27,6 +28,19 @@ struct Vector3 gPortalOutlineWorld[PORTAL_LOOP_SIZE] = {
 struct PortalSurface gPortalSurfaceCleanupQueue[MAX_PENDING_PORTAL_CLEANUP];
 int gPortalSurfaceNextToWrite;
 
+// The cache owns the memory of the surfaces it holds, so they are
+// handed out with shouldCleanup cleared and only freed on eviction
+struct PortalSurfaceCacheEntry {
+    struct PortalSurface surface;
+    struct Vector2s16 loop[PORTAL_LOOP_SIZE];
+    short portalSurfaceIndex;
+    short lastUsed;
+};
+
+static struct PortalSurfaceCacheEntry sPortalSurfaceCache[PORTAL_SURFACE_CACHE_SIZE];
+static short sPortalSurfaceCacheClock;
+static struct PortalSurfaceCacheStats sPortalSurfaceCacheStats;
+
 void portalSurfaceCheckCleanupQueue() {
     for (int searchIterator = 0; searchIterator < MAX_PENDING_PORTAL_CLEANUP; ++searchIterator) {
         struct PortalSurface* surface = &gPortalSurfaceCleanupQueue[searchIterator];
@@ -44,14 +58,141 @@ void portalSurfaceCheckCleanupQueue() {
     }
 }
 
+static void portalSurfaceCacheInit() {
+    for (int i = 0; i < PORTAL_SURFACE_CACHE_SIZE; ++i) {
+        sPortalSurfaceCache[i].portalSurfaceIndex = -1;
+    }
+
+    sPortalSurfaceCacheClock = 0;
+    zeroMemory(&sPortalSurfaceCacheStats, sizeof(sPortalSurfaceCacheStats));
+}
+
 void portalSurfaceCleanupQueueInit() {
     for (int searchIterator = 0; searchIterator < MAX_PENDING_PORTAL_CLEANUP; ++searchIterator) {
         gPortalSurfaceCleanupQueue[searchIterator].shouldCleanup = 0;
     }
+
+    // called when the heap is reset, so there is nothing to free
+    portalSurfaceCacheInit();
 }
 
 struct PortalSurfaceReplacement gPortalSurfaceReplacements[2];
 
+static int portalSurfaceIsReplaced(int portalSurfaceIndex) {
+    for (int i = 0; i < 2; ++i) {
+        if ((gPortalSurfaceReplacements[i].flags & PortalSurfaceReplacementFlagsIsEnabled) &&
+            gPortalSurfaceReplacements[i].portalSurfaceIndex == portalSurfaceIndex) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static int portalSurfaceCacheEntryInUse(struct PortalSurfaceCacheEntry* entry) {
+    return portalSurfaceIsReplaced(entry->portalSurfaceIndex) &&
+        gCurrentLevel->portalSurfaces[entry->portalSurfaceIndex].triangles == entry->surface.triangles;
+}
+
+static struct PortalSurfaceCacheEntry* portalSurfaceCacheFind(int portalSurfaceIndex, struct Vector2s16* loop) {
+    for (int i = 0; i < PORTAL_SURFACE_CACHE_SIZE; ++i) {
+        struct PortalSurfaceCacheEntry* entry = &sPortalSurfaceCache[i];
+
+        if (entry->portalSurfaceIndex != portalSurfaceIndex) {
+            continue;
+        }
+
+        int pointIndex = 0;
+
+        while (pointIndex < PORTAL_LOOP_SIZE && entry->loop[pointIndex].equalTest == loop[pointIndex].equalTest) {
+            ++pointIndex;
+        }
+
+        if (pointIndex == PORTAL_LOOP_SIZE) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+// Frees up the least recently used entry that isn't being displayed
+static struct PortalSurfaceCacheEntry* portalSurfaceCacheEvict() {
+    struct PortalSurfaceCacheEntry* result = NULL;
+
+    for (int i = 0; i < PORTAL_SURFACE_CACHE_SIZE; ++i) {
+        struct PortalSurfaceCacheEntry* entry = &sPortalSurfaceCache[i];
+
+        if (entry->portalSurfaceIndex == -1) {
+            return entry;
+        }
+
+        if (portalSurfaceCacheEntryInUse(entry)) {
+            continue;
+        }
+
+        if (!result || (short)(sPortalSurfaceCacheClock - entry->lastUsed) > (short)(sPortalSurfaceCacheClock - result->lastUsed)) {
+            result = entry;
+        }
+    }
+
+    if (result) {
+        // the surface may have been drawn last frame so it goes
+        // through the cleanup queue instead of being freed now
+        result->surface.shouldCleanup = 1;
+        portalSurfaceCleanup(&result->surface);
+        result->portalSurfaceIndex = -1;
+        ++sPortalSurfaceCacheStats.evictions;
+    }
+
+    return result;
+}
+
+int portalSurfacePokeHoleCached(int portalSurfaceIndex, struct Vector2s16* loop, struct PortalSurface* result) {
+    struct PortalSurface* surface = &gCurrentLevel->portalSurfaces[portalSurfaceIndex];
+
+    // a hole cut next to the other portal's hole depends on both
+    if (portalSurfaceIsReplaced(portalSurfaceIndex)) {
+        return portalSurfacePokeHole(surface, loop, result);
+    }
+
+    struct PortalSurfaceCacheEntry* entry = portalSurfaceCacheFind(portalSurfaceIndex, loop);
+
+    if (entry) {
+        *result = entry->surface;
+        entry->lastUsed = ++sPortalSurfaceCacheClock;
+        ++sPortalSurfaceCacheStats.hits;
+        return 1;
+    }
+
+    ++sPortalSurfaceCacheStats.misses;
+
+    if (!portalSurfacePokeHole(surface, loop, result)) {
+        return 0;
+    }
+
+    entry = portalSurfaceCacheEvict();
+
+    if (!entry) {
+        return 1;
+    }
+
+    result->shouldCleanup = 0;
+    entry->surface = *result;
+    entry->portalSurfaceIndex = portalSurfaceIndex;
+    entry->lastUsed = ++sPortalSurfaceCacheClock;
+
+    for (int i = 0; i < PORTAL_LOOP_SIZE; ++i) {
+        entry->loop[i] = loop[i];
+    }
+
+    return 1;
+}
+
+struct PortalSurfaceCacheStats* portalSurfaceCacheStats() {
+    return &sPortalSurfaceCacheStats;
+}
+
 
 int portalSurfaceGetSurfaceIndex(int portalIndex) {
     if (gPortalSurfaceReplacements[portalIndex].flags & PortalSurfaceReplacementFlagsIsEnabled) {
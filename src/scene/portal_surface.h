@@ -46,6 +46,12 @@ enum PortalSurfaceReplacementFlags {
     PortalSurfaceReplacementFlagsIsEnabled = (1 << 0),
 };
 
+struct PortalSurfaceCacheStats {
+    int hits;
+    int misses;
+    int evictions;
+};
+
 struct PortalSurfaceReplacement {
     struct PortalSurface previousSurface;
     short flags;
@@ -62,6 +68,11 @@ int portalSurfaceStaticIndexForReplacement(int portalIndex);
 
 int portalSurfaceIsInside(struct PortalSurface* surface, struct Transform* portalAt, int portalIndex);
 
+// Cuts a full size hole into a level surface, reusing the result from
+// the last few times the same hole was cut into the same untouched surface
+int portalSurfacePokeHoleCached(int portalSurfaceIndex, struct Vector2s16* loop, struct PortalSurface* result);
+struct PortalSurfaceCacheStats* portalSurfaceCacheStats();
+
 int portalSurfaceGenerate(struct PortalSurface* surface, int surfaceIndex, struct Transform* portalAt, int portalIndex, struct Transform* otherPortalAt, struct PortalSurface* newSurface);
 
 void portalSurfaceCleanup(struct PortalSurface* portalSurface);
@@ -4,6 +4,7 @@
 #include "math/vector2.h"
 #include "portal.h"
 #include "portal_surface_gfx.h"
+#include "system/time.h"
 #include "util/memory.h"
 
 #define IS_ORIGINAL_VERTEX_INDEX(surfaceBuilder, vertexIndex) ((vertexIndex) < (surfaceBuilder)->original->vertexCount)
@@ -982,8 +983,33 @@ int portalSurfaceTriangulate(struct PortalSurfaceBuilder* surfaceBuilder) {
     return 1;
 }
 
+static struct PortalSurfaceGeneratorStats sGeneratorStats;
+
+static void portalSurfaceRecordPokeHole(Time startTime, enum PortalSurfaceFailure failure) {
+    Time duration = timeGetTime() - startTime;
+
+    sGeneratorStats.lastTime = duration;
+
+    if (duration > sGeneratorStats.maxTime) {
+        sGeneratorStats.maxTime = duration;
+    }
+
+    ++sGeneratorStats.pokeCount;
+
+    if (failure != PortalSurfaceFailureNone) {
+        ++sGeneratorStats.failureCount;
+        sGeneratorStats.lastFailure = failure;
+    }
+}
+
+struct PortalSurfaceGeneratorStats* portalSurfaceGeneratorStats() {
+    return &sGeneratorStats;
+}
+
 int portalSurfacePokeHole(struct PortalSurface* surface, struct Vector2s16* loop, struct PortalSurface* result) {
     struct PortalSurfaceBuilder surfaceBuilder;
+    enum PortalSurfaceFailure failure;
+    Time startTime = timeGetTime();
 
     int edgeCapacity = surface->edgeCount + ADDITIONAL_EDGE_CAPACITY;
 
@@ -1014,10 +1040,12 @@ int portalSurfacePokeHole(struct PortalSurface* surface, struct Vector2s16* loop
     surfaceBuilder.edgeOnSearchLoop = portalSurfaceFindEnclosingFace(surface, prev);
 
     if (surfaceBuilder.edgeOnSearchLoop == -1) {
+        failure = PortalSurfaceFailureNoEnclosingFace;
         goto error;
     }
 
     if (!portalSurfaceFindStartingPoint(&surfaceBuilder, prev)) {
+        failure = PortalSurfaceFailureNoStartingPoint;
         goto error;
     }
 
@@ -1025,12 +1053,14 @@ int portalSurfacePokeHole(struct PortalSurface* surface, struct Vector2s16* loop
         struct Vector2s16* next = &loop[index == PORTAL_LOOP_SIZE ? 0 : index];
 
         if (!portalSurfaceFindNextLoop(&surfaceBuilder, next)) {
+            failure = PortalSurfaceFailureNextLoop;
             goto error;
         }
 
         struct Vector2s16* newPoint = portalSurfaceIntersectEdgeWithLoop(&surfaceBuilder, prev, next, index == PORTAL_LOOP_SIZE);
 
         if (!newPoint) {
+            failure = PortalSurfaceFailureLoopIntersect;
             goto error;
         }
 
@@ -1044,6 +1074,7 @@ int portalSurfacePokeHole(struct PortalSurface* surface, struct Vector2s16* loop
             struct SurfaceEdge* lastEdge = portalSurfaceGetEdge(&surfaceBuilder, lastEdgeIndex);
 
             if (firstEdge->reverseEdge == NO_EDGE_CONNECTION || lastEdge->reverseEdge == NO_EDGE_CONNECTION) {
+                failure = PortalSurfaceFailureContainedLoop;
                 goto error;
             }
 
@@ -1059,6 +1090,7 @@ int portalSurfacePokeHole(struct PortalSurface* surface, struct Vector2s16* loop
             --surfaceBuilder.currentVertex;
 
             if (!portalSurfaceJoinInnerLoopToOuterLoop(&surfaceBuilder)) {
+                failure = PortalSurfaceFailureJoinLoops;
                 goto error;
             }
         }
@@ -1074,6 +1106,7 @@ int portalSurfacePokeHole(struct PortalSurface* surface, struct Vector2s16* loop
     portalSurfaceMarkHoleAsUsed(&surfaceBuilder);
 
     if (!portalSurfaceTriangulate(&surfaceBuilder)) {
+        failure = PortalSurfaceFailureTriangulate;
         goto error;
     }
 
@@ -1101,6 +1134,7 @@ int portalSurfacePokeHole(struct PortalSurface* surface, struct Vector2s16* loop
     stackMallocFree(surfaceBuilder.edges);
     stackMallocFree(surfaceBuilder.vertices);
 
+    portalSurfaceRecordPokeHole(startTime, PortalSurfaceFailureNone);
     return 1;
 
 error:
@@ -1110,5 +1144,7 @@ error:
     stackMallocFree(surfaceBuilder.isLoopEdge);
     stackMallocFree(surfaceBuilder.edges);
     stackMallocFree(surfaceBuilder.vertices);
+
+    portalSurfaceRecordPokeHole(startTime, failure);
     return 0;
 };
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define __PORTAL_SURFACE_GENERATOR_H__
 
 #include "portal_surface.h"
+#include "system/time.h"
 
 #define PORTAL_SURFACE_OVERLAP  0x10000
 
@@ -11,6 +12,26 @@ enum SurfaceEdgeFlags {
     SurfaceEdgeFlagsFilled = (1 << 2),
 };
 
+// Which step of cutting a hole gave up on the input
+enum PortalSurfaceFailure {
+    PortalSurfaceFailureNone,
+    PortalSurfaceFailureNoEnclosingFace,
+    PortalSurfaceFailureNoStartingPoint,
+    PortalSurfaceFailureNextLoop,
+    PortalSurfaceFailureLoopIntersect,
+    PortalSurfaceFailureContainedLoop,
+    PortalSurfaceFailureJoinLoops,
+    PortalSurfaceFailureTriangulate,
+};
+
+struct PortalSurfaceGeneratorStats {
+    Time lastTime;
+    Time maxTime;
+    int pokeCount;
+    int failureCount;
+    enum PortalSurfaceFailure lastFailure;
+};
+
 struct PortalSurfaceBuilder {
     struct PortalSurface* original;
 
@@ -39,6 +60,7 @@ struct PortalSurfaceBuilder {
 };
 
 int portalSurfacePokeHole(struct PortalSurface* surface, struct Vector2s16* loop, struct PortalSurface* result);
+struct PortalSurfaceGeneratorStats* portalSurfaceGeneratorStats();
 int portalSurfaceHasFlag(struct PortalSurfaceBuilder* surfaceBuilder, int edgeIndex, enum SurfaceEdgeFlags value);
 void portalSurfaceSetFlag(struct PortalSurfaceBuilder* surfaceBuilder, int edgeIndex, enum SurfaceEdgeFlags value);
 struct SurfaceEdge* portalSurfaceGetEdge(struct PortalSurfaceBuilder* surfaceBuilder, int edgeIndex);
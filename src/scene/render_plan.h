@@ -42,6 +42,7 @@ struct RenderProps {
 
     u64 visiblerooms;
     u16 renderPartCount;
+    u16 textureLoadCount;
 
     struct RenderProps* previousProperties;
     struct RenderProps* nextProperites[2];
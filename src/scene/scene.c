@@ -28,6 +28,7 @@
 #include "shadow_map.h"
 #include "signals.h"
 #include "system/controller.h"
+#include "util/dynamic_asset_loader.h"
 #include "util/frame_time.h"
 #include "util/memory.h"
 
@@ -69,12 +70,44 @@ static void dynamicColliderHandleCollideStartEnd(struct CollisionObject* object,
     }
 }
 
+static void sceneDoorUpdate(void* data) {
+    doorUpdate((struct Door*)data);
+}
+
+static int sceneDoorSleepFrames(void* data) {
+    return doorSleepFrames((struct Door*)data);
+}
+
+static void sceneIncineratorUpdate(void* data) {
+    incineratorUpdate((struct Incinerator*)data);
+}
+
+static int sceneIncineratorSleepFrames(void* data) {
+    return incineratorSleepFrames((struct Incinerator*)data);
+}
+
+static void sceneButtonUpdate(void* data) {
+    buttonUpdate((struct Button*)data);
+}
+
+static int sceneButtonSleepFrames(void* data) {
+    return buttonSleepFrames((struct Button*)data);
+}
+
+static void sceneSwitchUpdate(void* data) {
+    switchUpdate((struct Switch*)data);
+}
+
+static int sceneSwitchSleepFrames(void* data) {
+    return switchSleepFrames((struct Switch*)data);
+}
+
 void sceneInitDynamicColliders(struct Scene* scene) {
     int boxCount = gCurrentLevel->dynamicBoxCount;
 
-    struct CollisionObject* colliders = malloc(sizeof(struct CollisionObject) * boxCount);
-    struct ColliderTypeData* colliderType = malloc(sizeof(struct ColliderTypeData) * boxCount);
-    struct RigidBody* body = malloc(sizeof(struct RigidBody) * boxCount);
+    struct CollisionObject* colliders = arenaMalloc(&gLevelArena, sizeof(struct CollisionObject) * boxCount);
+    struct ColliderTypeData* colliderType = arenaMalloc(&gLevelArena, sizeof(struct ColliderTypeData) * boxCount);
+    struct RigidBody* body = arenaMalloc(&gLevelArena, sizeof(struct RigidBody) * boxCount);
 
     for (int i = 0; i < boxCount; ++i) {
         colliderType[i].type = CollisionShapeTypeBox;
@@ -120,6 +153,9 @@ void sceneInit(struct Scene* scene) {
 }
 
 void sceneInitNoPauseMenu(struct Scene* scene, int mainMenuMode) {
+    // start streaming models in while the rest of the scene is set up
+    dynamicAssetsPreloadHints(gCurrentLevel->dynamicModelHints, gCurrentLevel->dynamicModelHintCount);
+
     signalsInit(1);
 
     cameraInit(&scene->camera, DEFAULT_CAMERA_FOV, DEFAULT_NEAR_PLANE * SCENE_SCALE, DEFAULT_FAR_PLANE * SCENE_SCALE);
@@ -154,11 +190,28 @@ void sceneInitNoPauseMenu(struct Scene* scene, int mainMenuMode) {
     portalInit(&scene->portals[0], 0);
     portalInit(&scene->portals[1], PortalFlagsOddParity);
 
+    updateSchedulerInit(
+        &scene->updateSchedulers[SceneUpdateGroupSignalSources],
+        gCurrentLevel->buttonCount + gCurrentLevel->switchCount
+    );
+    updateSchedulerInit(&scene->updateSchedulers[SceneUpdateGroupDoors], gCurrentLevel->doorCount);
+    updateSchedulerInit(&scene->updateSchedulers[SceneUpdateGroupIncinerators], gCurrentLevel->incineratorCount);
+
     scene->buttonCount = gCurrentLevel->buttonCount;
-    scene->buttons = malloc(sizeof(struct Button) * scene->buttonCount);
+    scene->buttons = arenaMalloc(&gLevelArena, sizeof(struct Button) * scene->buttonCount);
 
     for (int i = 0; i < scene->buttonCount; ++i) {
-        buttonInit(&scene->buttons[i], &gCurrentLevel->buttons[i]);
+        struct Button* button = &scene->buttons[i];
+        buttonInit(button, &gCurrentLevel->buttons[i]);
+        updateSchedulerAdd(
+            &scene->updateSchedulers[SceneUpdateGroupSignalSources],
+            button,
+            sceneButtonUpdate,
+            sceneButtonSleepFrames,
+            -1,
+            &button->collisionObject,
+            COLLISION_OBJECT_HAS_CONTACTS | COLLISION_OBJECT_PLAYER_STANDING
+        );
     }
 
     if (checkpointExists()) {
@@ -174,7 +227,7 @@ void sceneInitNoPauseMenu(struct Scene* scene, int mainMenuMode) {
         }
 
         scene->decorCount = gCurrentLevel->decorCount;
-        scene->decor = malloc(sizeof(struct DecorObject*) * scene->decorCount);
+        scene->decor = arenaMalloc(&gLevelArena, sizeof(struct DecorObject*) * scene->decorCount);
 
         for (int i = 0; i < scene->decorCount; ++i) {
             struct DecorDefinition* decorDef = &gCurrentLevel->decor[i];
@@ -196,14 +249,14 @@ void sceneInitNoPauseMenu(struct Scene* scene, int mainMenuMode) {
         }
 
         scene->turretCount = gCurrentLevel->turretCount;
-        scene->turrets = malloc(sizeof(struct Turret*) * scene->turretCount);
+        scene->turrets = arenaMalloc(&gLevelArena, sizeof(struct Turret*) * scene->turretCount);
         for (int i = 0; i < scene->turretCount; ++i) {
             scene->turrets[i] = turretNew(&gCurrentLevel->turrets[i]);
         }
     }
 
     scene->triggerListenerCount = gCurrentLevel->triggerCount;
-    scene->triggerListeners = malloc(sizeof(struct TriggerListener) * scene->triggerListenerCount);
+    scene->triggerListeners = arenaMalloc(&gLevelArena, sizeof(struct TriggerListener) * scene->triggerListenerCount);
     int triggerOffset = 0;
     for (int i = 0; i < scene->triggerListenerCount; ++i) {
         triggerInit(&scene->triggerListeners[i], &gCurrentLevel->triggers[i], triggerOffset);
@@ -212,19 +265,29 @@ void sceneInitNoPauseMenu(struct Scene* scene, int mainMenuMode) {
     }
 
     scene->doorCount = gCurrentLevel->doorCount;
-    scene->doors = malloc(sizeof(struct Door) * scene->doorCount);
+    scene->doors = arenaMalloc(&gLevelArena, sizeof(struct Door) * scene->doorCount);
     for (int i = 0; i < scene->doorCount; ++i) {
-        doorInit(&scene->doors[i], &gCurrentLevel->doors[i], &gCurrentLevel->world);
+        struct Door* door = &scene->doors[i];
+        doorInit(door, &gCurrentLevel->doors[i], &gCurrentLevel->world);
+        updateSchedulerAdd(
+            &scene->updateSchedulers[SceneUpdateGroupDoors],
+            door,
+            sceneDoorUpdate,
+            sceneDoorSleepFrames,
+            door->signalIndex,
+            NULL,
+            0
+        );
     }
 
     scene->doorwayCoverCount = gCurrentLevel->doorwayCoverCount;
-    scene->doorwayCovers = malloc(sizeof(struct DoorwayCover) * scene->doorwayCoverCount);
+    scene->doorwayCovers = arenaMalloc(&gLevelArena, sizeof(struct DoorwayCover) * scene->doorwayCoverCount);
     for (int i = 0; i < scene->doorwayCoverCount; ++i) {
         doorwayCoverInit(&scene->doorwayCovers[i], &gCurrentLevel->doorwayCovers[i], &gCurrentLevel->world);
     }
 
     scene->fizzlerCount = gCurrentLevel->fizzlerCount;
-    scene->fizzlers = malloc(sizeof(struct Fizzler) * scene->fizzlerCount);
+    scene->fizzlers = arenaMalloc(&gLevelArena, sizeof(struct Fizzler) * scene->fizzlerCount);
     for (int i = 0; i < scene->fizzlerCount; ++i) {
         struct FizzlerDefinition* fizzlerDef = &gCurrentLevel->fizzlers[i];
 
@@ -237,65 +300,85 @@ void sceneInitNoPauseMenu(struct Scene* scene, int mainMenuMode) {
     }
 
     scene->elevatorCount = gCurrentLevel->elevatorCount;
-    scene->elevators = malloc(sizeof(struct Elevator) * scene->elevatorCount);
+    scene->elevators = arenaMalloc(&gLevelArena, sizeof(struct Elevator) * scene->elevatorCount);
     for (int i = 0; i < scene->elevatorCount; ++i) {
         elevatorInit(&scene->elevators[i], &gCurrentLevel->elevators[i]);
     }
 
     scene->pedestalCount = gCurrentLevel->pedestalCount;
-    scene->pedestals = malloc(sizeof(struct Pedestal) * scene->pedestalCount);
+    scene->pedestals = arenaMalloc(&gLevelArena, sizeof(struct Pedestal) * scene->pedestalCount);
     for (int i = 0; i < scene->pedestalCount; ++i) {
         pedestalInit(&scene->pedestals[i], &gCurrentLevel->pedestals[i]);
     }
 
     scene->signageCount = gCurrentLevel->signageCount;
-    scene->signage = malloc(sizeof(struct Signage) * scene->signageCount);
+    scene->signage = arenaMalloc(&gLevelArena, sizeof(struct Signage) * scene->signageCount);
     for (int i = 0; i < scene->signageCount; ++i) {
         signageInit(&scene->signage[i], &gCurrentLevel->signage[i]);
     }
 
     scene->boxDropperCount = gCurrentLevel->boxDropperCount;
-    scene->boxDroppers = malloc(sizeof(struct BoxDropper) * scene->boxDropperCount);
+    scene->boxDroppers = arenaMalloc(&gLevelArena, sizeof(struct BoxDropper) * scene->boxDropperCount);
     for (int i = 0; i < scene->boxDropperCount; ++i) {
         boxDropperInit(&scene->boxDroppers[i], &gCurrentLevel->boxDroppers[i]);
     }
 
     scene->switchCount = gCurrentLevel->switchCount;
-    scene->switches = malloc(sizeof(struct Switch) * scene->switchCount);
+    scene->switches = arenaMalloc(&gLevelArena, sizeof(struct Switch) * scene->switchCount);
     for (int i = 0; i < scene->switchCount; ++i) {
-        switchInit(&scene->switches[i], &gCurrentLevel->switches[i]);
+        struct Switch* switchObj = &scene->switches[i];
+        switchInit(switchObj, &gCurrentLevel->switches[i]);
+        updateSchedulerAdd(
+            &scene->updateSchedulers[SceneUpdateGroupSignalSources],
+            switchObj,
+            sceneSwitchUpdate,
+            sceneSwitchSleepFrames,
+            -1,
+            &switchObj->collisionObject,
+            COLLISION_OBJECT_INTERACTED
+        );
     }
 
     ballBurnMarkInit();
 
     scene->ballLauncherCount = gCurrentLevel->ballLauncherCount;
-    scene->ballLaunchers = malloc(sizeof(struct BallLauncher) * scene->ballLauncherCount);
+    scene->ballLaunchers = arenaMalloc(&gLevelArena, sizeof(struct BallLauncher) * scene->ballLauncherCount);
     for (int i = 0; i < scene->ballLauncherCount; ++i) {
         ballLauncherInit(&scene->ballLaunchers[i], &gCurrentLevel->ballLaunchers[i]);
     }
 
     scene->ballCatcherCount = gCurrentLevel->ballCatcherCount;
-    scene->ballCatchers = malloc(sizeof(struct BallCatcher) * scene->ballCatcherCount);
+    scene->ballCatchers = arenaMalloc(&gLevelArena, sizeof(struct BallCatcher) * scene->ballCatcherCount);
     for (int i = 0; i < scene->ballCatcherCount; ++i) {
         ballCatcherInit(&scene->ballCatchers[i], &gCurrentLevel->ballCatchers[i]);
     }
 
     scene->clockCount = gCurrentLevel->clockCount;
-    scene->clocks = malloc(sizeof(struct Clock) * scene->clockCount);
+    scene->clocks = arenaMalloc(&gLevelArena, sizeof(struct Clock) * scene->clockCount);
     for (int i = 0; i < scene->clockCount; ++i) {
         clockInit(&scene->clocks[i], &gCurrentLevel->clocks[i]);
     }
 
     scene->securityCameraCount = gCurrentLevel->securityCameraCount;
-    scene->securityCameras = malloc(sizeof(struct SecurityCamera) * scene->securityCameraCount);
+    scene->securityCameras = arenaMalloc(&gLevelArena, sizeof(struct SecurityCamera) * scene->securityCameraCount);
     for (int i = 0 ; i < scene->securityCameraCount; ++i) {
         securityCameraInit(&scene->securityCameras[i], &gCurrentLevel->securityCameras[i]);
     }
 
     scene->incineratorCount = gCurrentLevel->incineratorCount;
-    scene->incinerators = malloc(sizeof(struct Incinerator) * scene->incineratorCount);
+    scene->incinerators = arenaMalloc(&gLevelArena, sizeof(struct Incinerator) * scene->incineratorCount);
     for (int i = 0 ; i < scene->incineratorCount; ++i) {
-        incineratorInit(&scene->incinerators[i], &gCurrentLevel->incinerators[i]);
+        struct Incinerator* incinerator = &scene->incinerators[i];
+        incineratorInit(incinerator, &gCurrentLevel->incinerators[i]);
+        updateSchedulerAdd(
+            &scene->updateSchedulers[SceneUpdateGroupIncinerators],
+            incinerator,
+            sceneIncineratorUpdate,
+            sceneIncineratorSleepFrames,
+            incinerator->signalIndex,
+            NULL,
+            0
+        );
     }
 
     scene->continuouslyAttemptingPortalOpen = 0;
@@ -757,13 +840,8 @@ void sceneUpdate(struct Scene* scene) {
         levelQueueReload();
     }
 
-    for (int i = 0; i < scene->buttonCount; ++i) {
-        buttonUpdate(&scene->buttons[i]);
-    }
-
-    for (int i = 0; i < scene->switchCount; ++i) {
-        switchUpdate(&scene->switches[i]);
-    }
+    // Buttons and switches sleep until something touches them
+    updateSchedulerUpdate(&scene->updateSchedulers[SceneUpdateGroupSignalSources]);
 
     for (int i = 0; i < scene->ballCatcherCount; ++i) {
         ballCatcherUpdate(&scene->ballCatchers[i], scene->ballLaunchers, scene->ballLauncherCount);
@@ -775,9 +853,8 @@ void sceneUpdate(struct Scene* scene) {
 
     signalsEvaluateSignals(gCurrentLevel->signalOperators, gCurrentLevel->signalOperatorCount);
 
-    for (int i = 0; i < scene->doorCount; ++i) {
-        doorUpdate(&scene->doors[i]);
-    }
+    // Doors only change when their signal does
+    updateSchedulerUpdate(&scene->updateSchedulers[SceneUpdateGroupDoors]);
 
     for (int i = 0; i < scene->fizzlerCount; ++i) {
         fizzlerUpdate(&scene->fizzlers[i]);
@@ -799,9 +876,8 @@ void sceneUpdate(struct Scene* scene) {
         ballLauncherUpdate(&scene->ballLaunchers[i]);
     }
 
-    for (int i = 0; i < scene->incineratorCount; ++i) {
-        incineratorUpdate(&scene->incinerators[i]);
-    }
+    // Incinerators change with their signal and wake for smoke while open
+    updateSchedulerUpdate(&scene->updateSchedulers[SceneUpdateGroupIncinerators]);
 
     for (int i = 0; i < scene->elevatorCount; ++i) {
         int teleportTo = elevatorUpdate(&scene->elevators[i], &scene->player);
@@ -837,6 +913,8 @@ void sceneUpdate(struct Scene* scene) {
         }
     }
 
+    levelPrefetchUpdate();
+
     sceneAnimatorUpdate(&scene->animator);
     sceneUpdatePortalVelocity(scene);
     sceneUpdateAnimatedObjects(scene);
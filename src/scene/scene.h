@@ -30,6 +30,7 @@
 #include "switch.h"
 #include "trigger_listener.h"
 #include "turret.h"
+#include "update_scheduler.h"
 
 struct SavedPortal {
     struct Ray ray;
@@ -38,6 +39,15 @@ struct SavedPortal {
     int roomIndex;
 };
 
+// Scheduled entities run in groups so each keeps its place in sceneUpdate
+enum SceneUpdateGroup {
+    // buttons and switches send signals before they are evaluated
+    SceneUpdateGroupSignalSources,
+    SceneUpdateGroupDoors,
+    SceneUpdateGroupIncinerators,
+    SceneUpdateGroupCount,
+};
+
 enum SceneCheckpointState {
     SceneCheckpointStateSaved,
     SceneCheckpointStatePendingRender,
@@ -72,6 +82,7 @@ struct Scene {
     struct SavedPortal savedPortal;
     struct Effects effects;
     struct Hud hud;
+    struct UpdateScheduler updateSchedulers[SceneUpdateGroupCount];
     Time cpuTime;
     Time updateTime;
     u8 buttonCount;
@@ -25,9 +25,9 @@ static struct AnimatedAudioInfo sAnimatedAudioInfo[] = {
 };
 
 void sceneAnimatorInit(struct SceneAnimator* sceneAnimator, struct AnimationInfo* animationInfo, int animatorCount) {
-    sceneAnimator->armatures = malloc(sizeof(struct SKArmature) * animatorCount);
-    sceneAnimator->animators = malloc(sizeof(struct SKAnimator) * animatorCount);
-    sceneAnimator->state = malloc(sizeof(struct SceneAnimatorState) * animatorCount);
+    sceneAnimator->armatures = arenaMalloc(&gLevelArena, sizeof(struct SKArmature) * animatorCount);
+    sceneAnimator->animators = arenaMalloc(&gLevelArena, sizeof(struct SKAnimator) * animatorCount);
+    sceneAnimator->state = arenaMalloc(&gLevelArena, sizeof(struct SceneAnimatorState) * animatorCount);
 
     sceneAnimator->animationInfo = animationInfo;
     sceneAnimator->animatorCount = animatorCount;
@@ -38,7 +38,7 @@ void sceneAnimatorInit(struct SceneAnimator* sceneAnimator, struct AnimationInfo
         sceneAnimator->boneCount += animationInfo[i].armature.numberOfBones;
     }
 
-    sceneAnimator->transforms = malloc(sizeof(struct Transform) * sceneAnimator->boneCount);
+    sceneAnimator->transforms = arenaMalloc(&gLevelArena, sizeof(struct Transform) * sceneAnimator->boneCount);
 
     struct Transform* pose = sceneAnimator->transforms;
 
@@ -16,9 +16,9 @@ void signalsInit(unsigned signalCount) {
     }
 
     int binCount = SIGNAL_BIN_COUNT(signalCount);
-    gSignals = malloc(sizeof(unsigned long long) * binCount);
-    gPrevSignals = malloc(sizeof(unsigned long long) * binCount);
-    gDefaultSignals = malloc(sizeof(unsigned long long) * binCount);
+    gSignals = arenaMalloc(&gLevelArena, sizeof(unsigned long long) * binCount);
+    gPrevSignals = arenaMalloc(&gLevelArena, sizeof(unsigned long long) * binCount);
+    gDefaultSignals = arenaMalloc(&gLevelArena, sizeof(unsigned long long) * binCount);
     gSignalCount = signalCount;
 
     for (int i = 0; i < binCount; ++i) {
@@ -67,6 +67,43 @@ int signalCount() {
     return gSignalCount;
 }
 
+int signalsNextChanged(int signalIndex) {
+    unsigned startIndex = signalIndex + 1;
+
+    if (startIndex >= gSignalCount) {
+        return -1;
+    }
+
+    unsigned bin;
+    unsigned long long mask;
+
+    DETERMINE_BIN_AND_MASK(bin, mask, startIndex);
+
+    unsigned binCount = SIGNAL_BIN_COUNT(gSignalCount);
+    // only the bits at or after startIndex
+    unsigned long long changed = (gSignals[bin] ^ gPrevSignals[bin]) & ~(mask - 1);
+
+    // whole bins that didn't change are skipped at once
+    while (!changed) {
+        ++bin;
+
+        if (bin >= binCount) {
+            return -1;
+        }
+
+        changed = gSignals[bin] ^ gPrevSignals[bin];
+    }
+
+    unsigned result = bin << 6;
+
+    while (!(changed & 1)) {
+        changed >>= 1;
+        ++result;
+    }
+
+    return result < gSignalCount ? (int)result : -1;
+}
+
 void signalsSend(unsigned signalIndex) {
     unsigned bin;
     unsigned long long mask;
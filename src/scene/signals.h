@@ -27,8 +27,13 @@ void signalsReset();
 int signalsRead(unsigned signalIndex);
 int signalsReadPrevious(unsigned signalIndex);
 int signalCount();
+// Returns the first signal after signalIndex that isn't the same as last
+// frame, or -1 if there are no more. Pass -1 to start from the beginning
+int signalsNextChanged(int signalIndex);
 void signalsSend(unsigned signalIndex);
 void signalsSetDefault(unsigned signalIndex, int value);
+// Operators are sorted by the level exporter so that a single pass
+// evaluates every operator after the operators feeding into it
 void signalsEvaluateSignals(struct SignalOperator* operator, unsigned count);
 
 void signalsSerializeRW(struct Serializer* serializer, SerializeAction action);
@@ -174,3 +174,15 @@ void switchUpdate(struct Switch* switchObj) {
         signalsSend(switchObj->signalIndex);
     }
 }
+
+int switchSleepFrames(struct Switch* switchObj) {
+    if (skAnimatorIsRunning(&switchObj->animator) ||
+        switchObj->isDepressed ||
+        switchObj->timeLeft > 0.0f ||
+        (switchObj->collisionObject.flags & COLLISION_OBJECT_INTERACTED)) {
+        return UPDATE_SCHEDULER_AWAKE;
+    }
+
+    // woken when the player presses it
+    return UPDATE_SCHEDULER_SLEEP_UNTIL_WOKEN;
+}
@@ -29,5 +29,6 @@ struct Switch {
 
 void switchInit(struct Switch* switchObj, struct SwitchDefinition* definition);
 void switchUpdate(struct Switch* switchObj);
+int switchSleepFrames(struct Switch* switchObj);
 
 #endif
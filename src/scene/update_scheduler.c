@@ -0,0 +1,84 @@
+#include "update_scheduler.h"
+
+#include "signals.h"
+#include "util/memory.h"
+
+void updateSchedulerInit(struct UpdateScheduler* scheduler, int capacity) {
+    scheduler->entities = capacity ? arenaMalloc(&gLevelArena, sizeof(struct ScheduledEntity) * capacity) : NULL;
+    scheduler->entityCount = 0;
+    scheduler->entityCapacity = capacity;
+    zeroMemory(&scheduler->lastFrameStats, sizeof(scheduler->lastFrameStats));
+}
+
+void updateSchedulerAdd(
+    struct UpdateScheduler* scheduler,
+    void* data,
+    ScheduledUpdate update,
+    ScheduledSleepFrames sleepFrames,
+    int wakeSignal,
+    struct CollisionObject* wakeCollider,
+    int wakeColliderFlags
+) {
+    if (scheduler->entityCount == scheduler->entityCapacity) {
+        return;
+    }
+
+    struct ScheduledEntity* entity = &scheduler->entities[scheduler->entityCount];
+    entity->data = data;
+    entity->update = update;
+    entity->sleepFrames = sleepFrames;
+    entity->wakeCollider = wakeCollider;
+    entity->wakeColliderFlags = wakeColliderFlags;
+    entity->wakeSignal = wakeSignal;
+    // everything updates at least once so state loaded
+    // from a checkpoint is applied before sleeping
+    entity->sleepFramesLeft = UPDATE_SCHEDULER_AWAKE;
+
+    ++scheduler->entityCount;
+}
+
+void updateSchedulerWakeAll(struct UpdateScheduler* scheduler) {
+    for (int i = 0; i < scheduler->entityCount; ++i) {
+        scheduler->entities[i].sleepFramesLeft = UPDATE_SCHEDULER_AWAKE;
+    }
+}
+
+static int updateSchedulerShouldWake(struct ScheduledEntity* entity) {
+    if (entity->wakeSignal != -1 && signalsRead(entity->wakeSignal) != signalsReadPrevious(entity->wakeSignal)) {
+        return 1;
+    }
+
+    // trigger callbacks and the player set these flags on overlap
+    // and the entity clears them in its update
+    if (entity->wakeCollider && (entity->wakeCollider->flags & entity->wakeColliderFlags)) {
+        return 1;
+    }
+
+    if (entity->sleepFramesLeft > 0) {
+        --entity->sleepFramesLeft;
+        return entity->sleepFramesLeft == 0;
+    }
+
+    return 0;
+}
+
+void updateSchedulerUpdate(struct UpdateScheduler* scheduler) {
+    Time start = timeGetTime();
+    int updateCount = 0;
+
+    for (int i = 0; i < scheduler->entityCount; ++i) {
+        struct ScheduledEntity* entity = &scheduler->entities[i];
+
+        if (entity->sleepFramesLeft != UPDATE_SCHEDULER_AWAKE && !updateSchedulerShouldWake(entity)) {
+            continue;
+        }
+
+        entity->update(entity->data);
+        entity->sleepFramesLeft = entity->sleepFrames(entity->data);
+        ++updateCount;
+    }
+
+    scheduler->lastFrameStats.updateTime = timeGetTime() - start;
+    scheduler->lastFrameStats.updateCount = updateCount;
+    scheduler->lastFrameStats.entityCount = scheduler->entityCount;
+}
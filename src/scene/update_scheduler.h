@@ -0,0 +1,55 @@
+#ifndef __SCENE_UPDATE_SCHEDULER_H__
+#define __SCENE_UPDATE_SCHEDULER_H__
+
+#include "physics/collision_object.h"
+#include "system/time.h"
+
+#define UPDATE_SCHEDULER_AWAKE              0
+#define UPDATE_SCHEDULER_SLEEP_UNTIL_WOKEN  -1
+
+typedef void (*ScheduledUpdate)(void* data);
+// called after each update, returns UPDATE_SCHEDULER_AWAKE to keep
+// updating, the number of frames until the next update or
+// UPDATE_SCHEDULER_SLEEP_UNTIL_WOKEN
+typedef int (*ScheduledSleepFrames)(void* data);
+
+// A sleeping entity is skipped until its frames run out, its wake
+// signal changes or its wake collider has any of wakeColliderFlags set
+struct ScheduledEntity {
+    void* data;
+    ScheduledUpdate update;
+    ScheduledSleepFrames sleepFrames;
+    struct CollisionObject* wakeCollider;
+    short wakeColliderFlags;
+    short wakeSignal;
+    short sleepFramesLeft;
+};
+
+struct UpdateSchedulerStats {
+    Time updateTime;
+    short updateCount;
+    short entityCount;
+};
+
+struct UpdateScheduler {
+    struct ScheduledEntity* entities;
+    short entityCount;
+    short entityCapacity;
+    struct UpdateSchedulerStats lastFrameStats;
+};
+
+void updateSchedulerInit(struct UpdateScheduler* scheduler, int capacity);
+// wakeSignal and wakeCollider can be -1 and NULL for entities that don't use them
+void updateSchedulerAdd(
+    struct UpdateScheduler* scheduler,
+    void* data,
+    ScheduledUpdate update,
+    ScheduledSleepFrames sleepFrames,
+    int wakeSignal,
+    struct CollisionObject* wakeCollider,
+    int wakeColliderFlags
+);
+void updateSchedulerWakeAll(struct UpdateScheduler* scheduler);
+void updateSchedulerUpdate(struct UpdateScheduler* scheduler);
+
+#endif
@@ -13,15 +13,28 @@ void skAnimatorInit(struct SKAnimator* animator, int nBones) {
     animator->currentClip = NULL;
     animator->currentTime = 0.0f;
     animator->blendLerp = 0.0f;
-    animator->boneState[0] = malloc(sizeof(struct SKAnimationBoneFrame) * nBones);
-    animator->boneState[1] = malloc(sizeof(struct SKAnimationBoneFrame) * nBones);
+    animator->boneState[0] = malloc(sizeof(struct SKAnimationBoneFrame) * nBones * SK_ANIMATOR_PREFETCH_FRAMES);
+    animator->boneState[1] = malloc(sizeof(struct SKAnimationBoneFrame) * nBones * SK_ANIMATOR_PREFETCH_FRAMES);
+    animator->boneStateClip[0] = NULL;
+    animator->boneStateClip[1] = NULL;
+    animator->boneStateTicket[0] = 0;
+    animator->boneStateTicket[1] = 0;
     animator->boneStateFrames[0] = -1;
     animator->boneStateFrames[1] = -1;
+    animator->boneStateFrameCount[0] = 0;
+    animator->boneStateFrameCount[1] = 0;
+    animator->prevFrame = 0;
+    animator->nextFrame = 0;
+    animator->prevFrameStateIndex = -1;
     animator->nextFrameStateIndex = -1;
     animator->nBones = nBones;
 }
 
 void skAnimatorCleanup(struct SKAnimator* animator) {
+    // make sure no DMA lands in freed memory
+    romCopyAsyncWait(animator->boneStateTicket[0]);
+    romCopyAsyncWait(animator->boneStateTicket[1]);
+
     free(animator->boneState[0]);
     free(animator->boneState[1]);
 
@@ -29,55 +42,163 @@ void skAnimatorCleanup(struct SKAnimator* animator) {
     animator->boneState[1] = NULL;
 }
 
-void skAnimatorRequestFrame(struct SKAnimator* animator, int nextFrame) {
+int skAnimatorCompressedSize(struct SKAnimationCompression* compression, int boneCount) {
+    int result = 0;
+
+    for (int i = 0; i < boneCount; ++i) {
+        int flags = compression->boneFlags[i];
+
+        if (!(flags & SKBoneTrackFlagsConstantPosition)) {
+            result += sizeof(struct SKU16Vector3);
+        }
+
+        if (!(flags & SKBoneTrackFlagsConstantRotation)) {
+            result += sizeof(uint32_t);
+        }
+    }
+
+    return result;
+}
+
+int skAnimatorFrameCount(struct SKAnimationClip* clip) {
+    return clip->compression ? clip->compression->nKeyframes : clip->nFrames;
+}
+
+// distance between frames in rom
+int skAnimatorFrameStride(struct SKAnimationClip* clip) {
+    return clip->compression ? clip->compression->keyframeSize : clip->nBones * sizeof(struct SKAnimationBoneFrame);
+}
+
+// bytes of a single frame the animator needs
+int skAnimatorFrameSize(struct SKAnimator* animator, struct SKAnimationClip* clip) {
+    int boneCount = MIN(animator->nBones, clip->nBones);
+    return clip->compression ? skAnimatorCompressedSize(clip->compression, boneCount) : boneCount * sizeof(struct SKAnimationBoneFrame);
+}
+
+int skAnimatorBoneStateIndexOfFrame(struct SKAnimator* animator, int frame) {
+    for (int i = 0; i < 2; ++i) {
+        int firstFrame = animator->boneStateFrames[i];
+
+        if (animator->boneStateClip[i] == animator->currentClip && 
+            firstFrame != -1 && 
+            frame >= firstFrame && 
+            frame < firstFrame + animator->boneStateFrameCount[i]) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+// streams a window of frames containing frame into the bone state
+// the window extends in the direction of playback and contiguous frames
+// are coalesced into a single DMA
+void skAnimatorRequestFrame(struct SKAnimator* animator, int frame, int stateIndex, int isReversed) {
     struct SKAnimationClip* currentClip = animator->currentClip;
 
     if (!currentClip) {
         return;
     }
 
-    if (nextFrame < 0 || nextFrame >= currentClip->nFrames) {
+    int frameCount = skAnimatorFrameCount(currentClip);
+
+    if (frame < 0 || frame >= frameCount) {
         return;
     }
 
-    if (animator->nextFrameStateIndex == -1) {
-        animator->nextFrameStateIndex = 0;
-    }
+    int stride = skAnimatorFrameStride(currentClip);
+    int frameSize = skAnimatorFrameSize(animator, currentClip);
+    int capacity = sizeof(struct SKAnimationBoneFrame) * animator->nBones * SK_ANIMATOR_PREFETCH_FRAMES;
 
-    if (animator->boneStateFrames[animator->nextFrameStateIndex] == nextFrame) {
-        return;
+    int windowSize = stride ? MIN(SK_ANIMATOR_PREFETCH_FRAMES, 1 + (capacity - frameSize) / stride) : 1;
+    windowSize = MIN(windowSize, frameCount);
+
+    int firstFrame = isReversed ? frame - windowSize + 1 : frame;
+    firstFrame = MIN(firstFrame, frameCount - windowSize);
+
+    if (firstFrame < 0) {
+        firstFrame = 0;
     }
 
-    animator->boneStateFrames[animator->nextFrameStateIndex] = nextFrame;
+    animator->boneStateFrames[stateIndex] = firstFrame;
+    animator->boneStateFrameCount[stateIndex] = windowSize;
+    animator->boneStateClip[stateIndex] = currentClip;
 
-    int boneCount = MIN(animator->nBones, currentClip->nBones);
+    // clips where every track is constant have nothing to stream
+    if (!frameSize) {
+        return;
+    }
 
-    int frameSize = currentClip->nBones * sizeof(struct SKAnimationBoneFrame);
+    uint32_t address = (uint32_t)(currentClip->compression ? (void*)currentClip->compression->keyframes : (void*)currentClip->frames);
+    address += stride * firstFrame;
 
-    uint32_t address = (uint32_t)currentClip->frames + frameSize * nextFrame;
-    romCopyAsync(
+    animator->boneStateTicket[stateIndex] = romCopyAsync(
         CALC_SEGMENT_POINTER(address, _animation_segmentSegmentRomStart),
-        animator->boneState[animator->nextFrameStateIndex],
-        sizeof(struct SKAnimationBoneFrame) * boneCount
+        animator->boneState[stateIndex],
+        stride * (windowSize - 1) + frameSize
     );
 }
 
-void skAnimatorExtractBone(struct SKAnimationBoneFrame* bone, struct Transform* result) {
-    result->position.x = (float)bone->position.x;
-    result->position.y = (float)bone->position.y;
-    result->position.z = (float)bone->position.z;
-
-    result->rotation.x = bone->rotation.x * (1.0f / 32767.0f);
-    result->rotation.y = bone->rotation.y * (1.0f / 32767.0f);
-    result->rotation.z = bone->rotation.z * (1.0f / 32767.0f);
-    float wSqrd = 1.0f - (result->rotation.x * result->rotation.x + result->rotation.y * result->rotation.y + result->rotation.z * result->rotation.z);
+int skAnimatorEnsureFrame(struct SKAnimator* animator, int frame, int keepStateIndex, int isReversed) {
+    int result = skAnimatorBoneStateIndexOfFrame(animator, frame);
+
+    if (result != -1) {
+        return result;
+    }
+
+    result = keepStateIndex == -1 ? 0 : keepStateIndex ^ 1;
+    skAnimatorRequestFrame(animator, frame, result, isReversed);
+    return result;
+}
+
+void skAnimatorExtractPosition(struct SKU16Vector3* position, struct Vector3* result) {
+    result->x = (float)position->x;
+    result->y = (float)position->y;
+    result->z = (float)position->z;
+}
+
+void skAnimatorExtractRotation(struct SKU16Vector3* rotation, struct Quaternion* result) {
+    result->x = rotation->x * (1.0f / 32767.0f);
+    result->y = rotation->y * (1.0f / 32767.0f);
+    result->z = rotation->z * (1.0f / 32767.0f);
+    float wSqrd = 1.0f - (result->x * result->x + result->y * result->y + result->z * result->z);
     if (wSqrd <= 0.0f) {
-        result->rotation.w = 0.0f;
+        result->w = 0.0f;
+    } else {
+        result->w = sqrtf(wSqrd);
+    }
+}
+
+void skAnimatorUnpackRotation(uint32_t packed, struct Quaternion* result) {
+    float* components = &result->x;
+    int largestIndex = packed >> 30;
+    int shift = SK_PACKED_ROTATION_BITS * 2;
+    float lengthSqrd = 0.0f;
+
+    for (int i = 0; i < 4; ++i) {
+        if (i == largestIndex) {
+            continue;
+        }
+
+        int quantized = (int)((packed >> shift) & SK_PACKED_ROTATION_MASK) - SK_PACKED_ROTATION_CENTER;
+        float value = quantized * (SK_PACKED_ROTATION_RANGE / SK_PACKED_ROTATION_CENTER);
+        components[i] = value;
+        lengthSqrd += value * value;
+        shift -= SK_PACKED_ROTATION_BITS;
+    }
+
+    if (lengthSqrd >= 1.0f) {
+        components[largestIndex] = 0.0f;
     } else {
-        result->rotation.w = sqrtf(wSqrd);
+        components[largestIndex] = sqrtf(1.0f - lengthSqrd);
     }
 }
 
+void skAnimatorExtractBone(struct SKAnimationBoneFrame* bone, struct Transform* result) {
+    skAnimatorExtractPosition(&bone->position, &result->position);
+    skAnimatorExtractRotation(&bone->rotation, &result->rotation);
+}
+
 void skAnimatorInitZeroTransform(struct SKAnimator* animator, struct Transform* transforms) {
     if (animator->nextFrameStateIndex == -1) {
         return;
@@ -96,36 +217,91 @@ void skAnimatorNormalize(struct SKAnimator* animator, struct Transform* transfor
     }
 }
 
+void skAnimatorBlendBone(struct Transform* boneTransform, struct Transform* transform, float weight) {
+    vector3AddScaled(&transform->position, &boneTransform->position, weight, &transform->position);
+
+    if (quatDot(&transform->rotation, &boneTransform->rotation) < 0) {
+        transform->rotation.x -= boneTransform->rotation.x * weight;
+        transform->rotation.y -= boneTransform->rotation.y * weight;
+        transform->rotation.z -= boneTransform->rotation.z * weight;
+        transform->rotation.w -= boneTransform->rotation.w * weight;
+    } else {
+        transform->rotation.x += boneTransform->rotation.x * weight;
+        transform->rotation.y += boneTransform->rotation.y * weight;
+        transform->rotation.z += boneTransform->rotation.z * weight;
+        transform->rotation.w += boneTransform->rotation.w * weight;
+    }
+}
+
 void skAnimatorBlendTransform(struct SKAnimationBoneFrame* frame, struct Transform* transforms, int nBones, float weight) {
     for (int i = 0; i < nBones; ++i) {
         struct Transform boneTransform;
         skAnimatorExtractBone(&frame[i], &boneTransform);
-        
-        vector3AddScaled(&transforms[i].position, &boneTransform.position, weight, &transforms[i].position);
-
-        if (quatDot(&transforms[i].rotation, &boneTransform.rotation) < 0) {
-            transforms[i].rotation.x -= boneTransform.rotation.x * weight;
-            transforms[i].rotation.y -= boneTransform.rotation.y * weight;
-            transforms[i].rotation.z -= boneTransform.rotation.z * weight;
-            transforms[i].rotation.w -= boneTransform.rotation.w * weight;
+        skAnimatorBlendBone(&boneTransform, &transforms[i], weight);
+    }
+}
+
+void skAnimatorBlendCompressedTransform(struct SKAnimationCompression* compression, unsigned short* keyframe, struct Transform* transforms, int nBones, float weight) {
+    for (int i = 0; i < nBones; ++i) {
+        struct SKAnimationBoneFrame* constantBone = &compression->constantPose[i];
+        int flags = compression->boneFlags[i];
+        struct Transform boneTransform;
+
+        if (flags & SKBoneTrackFlagsConstantPosition) {
+            skAnimatorExtractPosition(&constantBone->position, &boneTransform.position);
+        } else {
+            skAnimatorExtractPosition((struct SKU16Vector3*)keyframe, &boneTransform.position);
+            keyframe += 3;
+        }
+
+        if (flags & SKBoneTrackFlagsConstantRotation) {
+            skAnimatorExtractRotation(&constantBone->rotation, &boneTransform.rotation);
         } else {
-            transforms[i].rotation.x += boneTransform.rotation.x * weight;
-            transforms[i].rotation.y += boneTransform.rotation.y * weight;
-            transforms[i].rotation.z += boneTransform.rotation.z * weight;
-            transforms[i].rotation.w += boneTransform.rotation.w * weight;
+            // keyframes are only 2 byte aligned
+            skAnimatorUnpackRotation(((uint32_t)keyframe[0] << 16) | keyframe[1], &boneTransform.rotation);
+            keyframe += 2;
         }
-        
+
+        skAnimatorBlendBone(&boneTransform, &transforms[i], weight);
+    }
+}
+
+void skAnimatorBlendFrame(struct SKAnimator* animator, int stateIndex, int frame, struct Transform* transforms, float weight) {
+    struct SKAnimationClip* clip = animator->boneStateClip[stateIndex];
+
+    int frameOffset = frame - animator->boneStateFrames[stateIndex];
+
+    if (!clip || animator->boneStateFrames[stateIndex] == -1 || frameOffset < 0 || frameOffset >= animator->boneStateFrameCount[stateIndex]) {
+        return;
     }
+
+    // only stalls when playback outran the prefetch
+    romCopyAsyncWait(animator->boneStateTicket[stateIndex]);
+
+    char* frameData = (char*)animator->boneState[stateIndex] + skAnimatorFrameStride(clip) * frameOffset;
+
+    if (clip->compression) {
+        skAnimatorBlendCompressedTransform(
+            clip->compression, 
+            (unsigned short*)frameData, 
+            transforms, 
+            MIN(animator->nBones, clip->nBones), 
+            weight
+        );
+        return;
+    }
+
+    skAnimatorBlendTransform((struct SKAnimationBoneFrame*)frameData, transforms, animator->nBones, weight);
 }
 
 void skAnimatorReadTransformWithWeight(struct SKAnimator* animator, struct Transform* transforms, float weight) {
     if (animator->blendLerp >= 1.0f) {
-        skAnimatorBlendTransform(animator->boneState[animator->nextFrameStateIndex], transforms, animator->nBones, weight);
+        skAnimatorBlendFrame(animator, animator->nextFrameStateIndex, animator->nextFrame, transforms, weight);
         return;
     }
 
-    skAnimatorBlendTransform(animator->boneState[animator->nextFrameStateIndex], transforms, animator->nBones, animator->blendLerp * weight);
-    skAnimatorBlendTransform(animator->boneState[animator->nextFrameStateIndex ^ 1], transforms, animator->nBones, (1.0f - animator->blendLerp) * weight);
+    skAnimatorBlendFrame(animator, animator->nextFrameStateIndex, animator->nextFrame, transforms, animator->blendLerp * weight);
+    skAnimatorBlendFrame(animator, animator->prevFrameStateIndex, animator->prevFrame, transforms, (1.0f - animator->blendLerp) * weight);
 }
 
 void skAnimatorReadTransform(struct SKAnimator* animator, struct Transform* transforms) {
@@ -138,18 +314,6 @@ void skAnimatorReadTransform(struct SKAnimator* animator, struct Transform* tran
     skAnimatorNormalize(animator, transforms);
 }
 
-int skAnimatorBoneStateIndexOfFrame(struct SKAnimator* animator, int frame) {
-    if (animator->boneStateFrames[0] == frame) {
-        return 0;
-    }
-
-    if (animator->boneStateFrames[1] == frame) {
-        return 1;
-    }
-
-    return -1;
-}
-
 int skAnimatorClampFrame(struct SKAnimator* animator, int frame) {
     if (frame < animator->currentClip->nFrames) {
         return frame;
@@ -162,6 +326,55 @@ int skAnimatorClampFrame(struct SKAnimator* animator, int frame) {
     return animator->currentClip->nFrames - 1;
 }
 
+// finds the pair of stored frames surrounding frameFractional
+void skAnimatorFindFrames(struct SKAnimator* animator, float frameFractional, int* prevFrame, int* nextFrame, float* lerpValue) {
+    struct SKAnimationCompression* compression = animator->currentClip->compression;
+
+    if (!compression) {
+        *prevFrame = (int)floorf(frameFractional);
+        *nextFrame = (int)ceilf(frameFractional);
+        *lerpValue = frameFractional - *prevFrame;
+
+        *prevFrame = skAnimatorClampFrame(animator, *prevFrame);
+        *nextFrame = skAnimatorClampFrame(animator, *nextFrame);
+        return;
+    }
+
+    unsigned short* keyframeTimes = compression->keyframeTimes;
+    int lastKeyframe = compression->nKeyframes - 1;
+    int low = 0;
+    int high = lastKeyframe;
+
+    while (low < high) {
+        int mid = (low + high + 1) >> 1;
+
+        if (keyframeTimes[mid] <= frameFractional) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+
+    if (low < lastKeyframe) {
+        *prevFrame = low;
+        *nextFrame = low + 1;
+        *lerpValue = (frameFractional - keyframeTimes[low]) / (keyframeTimes[low + 1] - keyframeTimes[low]);
+        return;
+    }
+
+    *prevFrame = lastKeyframe;
+
+    // the last keyframe is always the last frame so looping 
+    // blends into the first keyframe over a single frame
+    if ((animator->flags & SKAnimatorFlagsLoop) && frameFractional > keyframeTimes[lastKeyframe]) {
+        *nextFrame = 0;
+        *lerpValue = frameFractional - keyframeTimes[lastKeyframe];
+    } else {
+        *nextFrame = lastKeyframe;
+        *lerpValue = 0.0f;
+    }
+}
+
 void skAnimatorStep(struct SKAnimator* animator, float deltaTime) {
     struct SKAnimationClip* currentClip = animator->currentClip;
 
@@ -183,48 +396,45 @@ void skAnimatorStep(struct SKAnimator* animator, float deltaTime) {
     }
 
     float currentFrameFractional = animator->currentTime * currentClip->fps;
-    int prevFrame = (int)floorf(currentFrameFractional);
-    int nextFrame = (int)ceilf(currentFrameFractional);
-    float lerpValue = currentFrameFractional - prevFrame;
+    int prevFrame;
+    int nextFrame;
+    float lerpValue;
 
-    prevFrame = skAnimatorClampFrame(animator, prevFrame);
-    nextFrame = skAnimatorClampFrame(animator, nextFrame);
+    skAnimatorFindFrames(animator, currentFrameFractional, &prevFrame, &nextFrame, &lerpValue);
 
     if (nextFrame == prevFrame) {
         lerpValue = 1.0f;
     }
 
-    int existingPrevFrame = skAnimatorBoneStateIndexOfFrame(animator, prevFrame);
-    int existingNextFrame = skAnimatorBoneStateIndexOfFrame(animator, nextFrame);
+    int isReversed = deltaTime < 0.0f;
+
+    // request the frame played first so its window also covers the frame after it
+    int firstFrame = isReversed ? nextFrame : prevFrame;
+    int secondFrame = isReversed ? prevFrame : nextFrame;
 
-    if (existingPrevFrame == -1 && existingNextFrame == -1) {
-        // Both frames need to be requested
-        animator->blendLerp = lerpValue;
-        if (prevFrame != nextFrame) {
-            animator->nextFrameStateIndex = 0;
-            skAnimatorRequestFrame(animator, prevFrame);
+    int firstStateIndex = skAnimatorEnsureFrame(animator, firstFrame, skAnimatorBoneStateIndexOfFrame(animator, secondFrame), isReversed);
+    int secondStateIndex = skAnimatorEnsureFrame(animator, secondFrame, firstStateIndex, isReversed);
+
+    if (firstStateIndex == secondStateIndex) {
+        // the other window is free so prefetch the frames that come next
+        int windowStart = animator->boneStateFrames[firstStateIndex];
+        int aheadFrame = isReversed ? windowStart - 1 : windowStart + animator->boneStateFrameCount[firstStateIndex];
+        int frameCount = skAnimatorFrameCount(currentClip);
+
+        if (aheadFrame < 0 || aheadFrame >= frameCount) {
+            aheadFrame = (animator->flags & SKAnimatorFlagsLoop) ? (isReversed ? frameCount - 1 : 0) : -1;
+        }
+
+        if (aheadFrame != -1 && skAnimatorBoneStateIndexOfFrame(animator, aheadFrame) == -1) {
+            skAnimatorRequestFrame(animator, aheadFrame, firstStateIndex ^ 1, isReversed);
         }
-        animator->nextFrameStateIndex = 1;
-        skAnimatorRequestFrame(animator, nextFrame);
-    } else if (existingNextFrame == -1) {
-        // Only the next frame needs to be requested
-        animator->blendLerp = lerpValue;
-        animator->nextFrameStateIndex = existingPrevFrame ^ 1;
-        skAnimatorRequestFrame(animator, nextFrame);
-    } else if (existingPrevFrame == -1) {
-        // Only the previous frame needs to be requested
-        animator->blendLerp = 1.0f - lerpValue;
-        animator->nextFrameStateIndex = existingNextFrame ^ 1;
-        skAnimatorRequestFrame(animator, prevFrame);
-    } else if (existingNextFrame == existingPrevFrame) {
-        // Only one frame is needed and is already present
-        animator->blendLerp = 1.0f;
-        animator->nextFrameStateIndex = existingNextFrame;
-    } else {
-        // Both frames are needed and present
-        animator->blendLerp = lerpValue;
-        animator->nextFrameStateIndex = existingNextFrame;
     }
+
+    animator->prevFrame = prevFrame;
+    animator->nextFrame = nextFrame;
+    animator->prevFrameStateIndex = isReversed ? secondStateIndex : firstStateIndex;
+    animator->nextFrameStateIndex = isReversed ? firstStateIndex : secondStateIndex;
+    animator->blendLerp = lerpValue;
 }
 
 void skAnimatorUpdate(struct SKAnimator* animator, struct Transform* transforms, float deltaTime) {
@@ -251,10 +461,6 @@ void skAnimatorRunClip(struct SKAnimator* animator, struct SKAnimationClip* clip
         return;
     }
 
-    if (animator->nextFrameStateIndex != -1) {
-        animator->nextFrameStateIndex ^= 1;
-    }
-    
     animator->boneStateFrames[0] = -1;
     animator->boneStateFrames[1] = -1;
 
@@ -9,12 +9,21 @@ enum SKAnimatorFlags {
     SKAnimatorFlagsDone = (1 << 1),
 };
 
+// number of frames each bone state window streams in with a single DMA
+#define SK_ANIMATOR_PREFETCH_FRAMES 4
+
 struct SKAnimator {
     struct SKAnimationClip* currentClip;
     float currentTime;
     float blendLerp;
     struct SKAnimationBoneFrame* boneState[2];
+    struct SKAnimationClip* boneStateClip[2];
+    unsigned boneStateTicket[2];
     short boneStateFrames[2];
+    short boneStateFrameCount[2];
+    short prevFrame;
+    short nextFrame;
+    short prevFrameStateIndex;
     short nextFrameStateIndex;
     short flags;
     short nBones;
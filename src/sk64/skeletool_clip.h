@@ -4,6 +4,14 @@
 #define SK_ANIMATION_CLIP_DURATION(clip) ((clip)->nFrames / (clip)->fps)
 #define SK_ANIMATION_CLIP_START(clip, isReversed) ((isReversed) ? SK_ANIMATION_CLIP_DURATION(clip) : 0.0f)
 
+// packed rotations store the index of the largest quaternion
+// component in the top 2 bits followed by the other three
+// components quantized to 10 bits each
+#define SK_PACKED_ROTATION_BITS         10
+#define SK_PACKED_ROTATION_MASK         ((1 << SK_PACKED_ROTATION_BITS) - 1)
+#define SK_PACKED_ROTATION_CENTER       (SK_PACKED_ROTATION_MASK >> 1)
+#define SK_PACKED_ROTATION_RANGE        0.70710678f
+
 struct SKU16Vector3 {
     short x;
     short y;
@@ -15,11 +23,31 @@ struct SKAnimationBoneFrame {
     struct SKU16Vector3 rotation;
 };
 
+enum SKBoneTrackFlags {
+    SKBoneTrackFlagsConstantPosition = (1 << 0),
+    SKBoneTrackFlagsConstantRotation = (1 << 1),
+};
+
+// Only keyframes are stored and each keyframe only contains
+// tracks that aren't constant. For each bone in order the
+// keyframe has 3 shorts for an animated position followed by
+// 2 shorts holding a packed rotation if the rotation is animated
+struct SKAnimationCompression {
+    short nKeyframes;
+    short keyframeSize;
+    unsigned short* keyframes;
+    unsigned short* keyframeTimes;
+    unsigned char* boneFlags;
+    struct SKAnimationBoneFrame* constantPose;
+};
+
 struct SKAnimationClip {
     short nFrames;
     short nBones;
     struct SKAnimationBoneFrame* frames;
     float fps;
+    // NULL when every frame is stored in frames
+    struct SKAnimationCompression* compression;
 };
 
 #endif
@@ -3,15 +3,37 @@
 
 #include <stdint.h>
 
+#include "system/time.h"
+
 #define AUDIO_OUTPUT_HZ 22050
 #define VOICE_ID_NONE   -1
 
 typedef int16_t VoiceId;
 
+struct AudioStats {
+    // includes time spent waiting behind graphics tasks for the RSP
+    Time taskTime;
+    // DMA buffer lookups over the last AUDIO_STATS_FRAMES audio frames
+    unsigned short dmaHits;
+    unsigned short dmaMisses;
+    unsigned short dmaPrefetches;
+    // PI DMAs started while mixing the last audio frame
+    unsigned short dmaCount;
+    // samples still queued in the DAC when the audio thread woke up
+    short sampleSlack;
+    short underrunCount;
+    short isReduced;
+};
+
 void* audioInit(void* memoryEnd, int maxVoices);
 void audioUpdate();
 void audioDestroy();
+struct AudioStats* audioStats();
+// Voices the mixer can keep up with right now. Lower than maxVoices
+// while the RSP is too busy for the full mix
+int audioVoiceBudget();
 
+int audioIsSoundClipLooped(int soundClipId);
 VoiceId audioPlaySound(int soundClipId, float volume, float pitch, float pan, float echo);
 void audioSetSoundParams(VoiceId voiceId, float volume, float pitch, float pan, float echo);
 int audioIsSoundPlaying(VoiceId voiceId);
@@ -1,16 +1,39 @@
 #ifndef __CARTRIDGE_H__
 #define __CARTRIDGE_H__
 
+#include "system/time.h"
+
 #define SRAM_SIZE 0x8000
 #define CALC_SEGMENT_POINTER(segmentedAddress, baseAddress) (void*)(((unsigned)(segmentedAddress) & 0xFFFFFF) + (baseAddress))
 
+struct RomCopyAsyncStats {
+    unsigned short copyCount;
+    unsigned int byteCount;
+    Time stallTime;
+};
+
 void cartridgeInit();
 
 void romCopy(const void* romAddr, void* ramAddr, const int size);
-void romCopyAsync(const void* romAddr, void* ramAddr, const int size);
+
+// Async copies finish in the order they are started. The returned
+// ticket can be passed to romCopyAsyncWait before reading ramAddr
+unsigned romCopyAsync(const void* romAddr, void* ramAddr, const int size);
+int romCopyAsyncIsDone(unsigned ticket);
+void romCopyAsyncWait(unsigned ticket);
 void romCopyAsyncDrain();
 
+// Collects finished copies without blocking and starts a new frame of stats
+void romCopyAsyncUpdate();
+struct RomCopyAsyncStats* romCopyAsyncLastFrameStats();
+
 void sramWrite(void* sramAddr, const void* ramAddr, const int size);
 int sramRead(const void* sramAddr, void* ramAddr, const int size);
 
+// Starts an SRAM write without waiting for it. ramAddr can't change
+// until sramIsBusy returns false. Returns 0 if the SRAM is still busy
+int sramWriteAsync(void* sramAddr, const void* ramAddr, const int size);
+int sramIsBusy();
+void sramWaitIdle();
+
 #endif
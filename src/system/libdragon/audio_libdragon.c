@@ -2,7 +2,11 @@
 
 // TODO
 
+static int sMaxVoices;
+
 void* audioInit(void* memoryEnd, int maxVoices) {
+    sMaxVoices = maxVoices;
+    return memoryEnd;
 }
 
 void audioUpdate() {
@@ -11,6 +15,19 @@ void audioUpdate() {
 void audioDestroy() {
 }
 
+struct AudioStats* audioStats() {
+    static struct AudioStats stats;
+    return &stats;
+}
+
+int audioVoiceBudget() {
+    return sMaxVoices;
+}
+
+int audioIsSoundClipLooped(int soundClipId) {
+    return 0;
+}
+
 VoiceId audioPlaySound(int soundClipId, float volume, float pitch, float pan, float echo) {
     return VOICE_ID_NONE;
 }
@@ -8,15 +8,42 @@ void cartridgeInit() {
 void romCopy(const void* romAddr, void* ramAddr, const int size) {
 }
 
-void romCopyAsync(const void* romAddr, void* ramAddr, const int size) {
+unsigned romCopyAsync(const void* romAddr, void* ramAddr, const int size) {
+    return 0;
+}
+
+int romCopyAsyncIsDone(unsigned ticket) {
+    return 1;
+}
+
+void romCopyAsyncWait(unsigned ticket) {
 }
 
 void romCopyAsyncDrain() {
 }
 
+void romCopyAsyncUpdate() {
+}
+
+struct RomCopyAsyncStats* romCopyAsyncLastFrameStats() {
+    static struct RomCopyAsyncStats stats;
+    return &stats;
+}
+
 void sramWrite(void* sramAddr, const void* ramAddr, const int size) {
 }
 
 int sramRead(const void* sramAddr, void* ramAddr, const int size) {
     return 0;
 }
+
+int sramWriteAsync(void* sramAddr, const void* ramAddr, const int size) {
+    return 1;
+}
+
+int sramIsBusy() {
+    return 0;
+}
+
+void sramWaitIdle() {
+}
@@ -0,0 +1,290 @@
+#include "audio_dma_libultra.h"
+
+struct DmaBufferMetadata {
+    u32 address;
+    u32 framesOld;
+    // Read into this frame but not started yet, see audioDmaFlush
+    u8 isPending;
+};
+
+// Allocated as one block so neighboring buffers are back to back in RAM
+static u8*                      sDmaBuffers[AUDIO_DMA_BUFFER_COUNT];
+static struct DmaBufferMetadata sDmaBufferMetadata[AUDIO_DMA_BUFFER_COUNT];
+
+static OSPiHandle*              sCartHandle;
+static OSMesgQueue              sAudioDmaMessageQueue;
+static OSMesg                   sAudioDmaMessages[AUDIO_MAX_DMA_TRANSFERS];
+static OSIoMesg                 sAudioDmaMessageReqs[AUDIO_MAX_DMA_TRANSFERS];
+static int                      sNextDmaSlot;
+static int                      sActiveDmaCount;
+static int                      sPendingDmaCount;
+
+static struct AudioDmaCounters  sDmaCounters;
+
+void audioDmaInit(OSPiHandle* cartHandle, ALHeap* heap) {
+    sCartHandle = cartHandle;
+    osCreateMesgQueue(&sAudioDmaMessageQueue, sAudioDmaMessages, AUDIO_MAX_DMA_TRANSFERS);
+
+    u8* buffers = alHeapAlloc(heap, AUDIO_DMA_BUFFER_COUNT, AUDIO_DMA_SIZE);
+
+    for (int i = 0; i < AUDIO_DMA_BUFFER_COUNT; ++i) {
+        sDmaBuffers[i] = buffers + i * AUDIO_DMA_SIZE;
+        sDmaBufferMetadata[i].address = 0;
+        sDmaBufferMetadata[i].framesOld = 0;
+        sDmaBufferMetadata[i].isPending = 0;
+    }
+
+    sNextDmaSlot = 0;
+    sActiveDmaCount = 0;
+    sPendingDmaCount = 0;
+
+    sDmaCounters.hits = 0;
+    sDmaCounters.misses = 0;
+    sDmaCounters.prefetches = 0;
+    sDmaCounters.frameCount = 0;
+}
+
+// The buffer after this one holds the rest of the clip so
+// reads can run off the end of this one into it
+static int audioIsDmaBufferLinked(int bufferIndex) {
+    return bufferIndex + 1 < AUDIO_DMA_BUFFER_COUNT &&
+        sDmaBufferMetadata[bufferIndex + 1].address == sDmaBufferMetadata[bufferIndex].address + AUDIO_DMA_SIZE;
+}
+
+static int audioFindDmaBuffer(u32 addr, u32 endAddr) {
+    for (int i = 0; i < AUDIO_DMA_BUFFER_COUNT; ++i) {
+        struct DmaBufferMetadata* bufInfo = &sDmaBufferMetadata[i];
+
+        if (bufInfo->address > addr || addr >= bufInfo->address + AUDIO_DMA_SIZE) {
+            continue;
+        }
+
+        if (endAddr <= bufInfo->address + AUDIO_DMA_SIZE) {
+            return i;
+        }
+
+        if (endAddr <= bufInfo->address + AUDIO_DMA_SIZE * 2 && audioIsDmaBufferLinked(i)) {
+            sDmaBufferMetadata[i + 1].framesOld = 0;
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+// Buffers nothing has read for a while are as good as each other to
+// replace, so take the one in the middle of the longest run of them.
+// That leaves room after it for a clip streamed into it to link into
+static int audioFindUnusedDmaBuffer() {
+    int result = -1;
+    int longestRun = 0;
+    int runStart = 0;
+
+    for (int i = 0; i <= AUDIO_DMA_BUFFER_COUNT; ++i) {
+        if (i < AUDIO_DMA_BUFFER_COUNT && sDmaBufferMetadata[i].framesOld >= AUDIO_LINK_MIN_FRAMES_OLD) {
+            continue;
+        }
+
+        if (i - runStart > longestRun) {
+            longestRun = i - runStart;
+            result = runStart + longestRun / 2;
+        }
+
+        runStart = i + 1;
+    }
+
+    return result;
+}
+
+// Least recently used buffer that has gone unused for minFramesOld
+static int audioFindEvictableDmaBuffer(u32 minFramesOld) {
+    int result = -1;
+    u32 oldest = minFramesOld - 1;
+
+    for (int i = 0; i < AUDIO_DMA_BUFFER_COUNT; ++i) {
+        if (sDmaBufferMetadata[i].framesOld > oldest) {
+            result = i;
+            oldest = sDmaBufferMetadata[i].framesOld;
+        }
+    }
+
+    return result;
+}
+
+// The buffer a read of address would be linked into, if the
+// buffer in front of it holds the bytes right before address
+static int audioFindLinkableDmaBuffer(u32 address, u32 minFramesOld) {
+    for (int i = 0; i + 1 < AUDIO_DMA_BUFFER_COUNT; ++i) {
+        if (sDmaBufferMetadata[i].address + AUDIO_DMA_SIZE == address) {
+            return sDmaBufferMetadata[i + 1].framesOld >= minFramesOld ? i + 1 : -1;
+        }
+    }
+
+    return -1;
+}
+
+static int audioIsStreamingFrom(u32 addr) {
+    for (int i = 0; i < AUDIO_DMA_BUFFER_COUNT; ++i) {
+        struct DmaBufferMetadata* bufInfo = &sDmaBufferMetadata[i];
+
+        if (bufInfo->address < addr && addr <= bufInfo->address + AUDIO_DMA_SIZE) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+// Transfers wait for audioDmaFlush so ones that end up
+// back to back can go out together
+static u8* audioQueueDma(int bufferIndex, u32 address) {
+    struct DmaBufferMetadata* bufInfo = &sDmaBufferMetadata[bufferIndex];
+    bufInfo->address = address;
+    bufInfo->framesOld = 0;
+    bufInfo->isPending = 1;
+    ++sPendingDmaCount;
+
+    return sDmaBuffers[bufferIndex];
+}
+
+static int audioDmaTransfersInUse() {
+    return sActiveDmaCount + sPendingDmaCount;
+}
+
+static void audioPrefetchDma(int bufferIndex) {
+    u32 nextAddress = sDmaBufferMetadata[bufferIndex].address + AUDIO_DMA_SIZE;
+
+    if (audioFindDmaBuffer(nextAddress, nextAddress + AUDIO_DMA_SIZE - AUDIO_PREFETCH_OVERLAP) != -1 ||
+        audioDmaTransfersInUse() >= AUDIO_MAX_DMA_TRANSFERS - AUDIO_DEMAND_DMA_TRANSFERS) {
+        return;
+    }
+
+    // read straight after this buffer when the next ones are free so
+    // they go out in one transfer and reads run across them
+    int prefetchIndex = audioFindLinkableDmaBuffer(nextAddress, AUDIO_LINK_MIN_FRAMES_OLD);
+
+    if (prefetchIndex != -1) {
+        for (int i = 0; i < AUDIO_PREFETCH_LINKED_BUFFERS && prefetchIndex != -1; ++i) {
+            audioQueueDma(prefetchIndex, nextAddress);
+            ++sDmaCounters.prefetches;
+
+            nextAddress += AUDIO_DMA_SIZE;
+            prefetchIndex = audioFindLinkableDmaBuffer(nextAddress, AUDIO_LINK_MIN_FRAMES_OLD);
+        }
+
+        return;
+    }
+
+    prefetchIndex = audioFindUnusedDmaBuffer();
+
+    if (prefetchIndex == -1) {
+        prefetchIndex = audioFindEvictableDmaBuffer(AUDIO_PREFETCH_MIN_FRAMES_OLD);
+    }
+
+    if (prefetchIndex != -1) {
+        audioQueueDma(prefetchIndex, nextAddress - AUDIO_PREFETCH_OVERLAP);
+        ++sDmaCounters.prefetches;
+    }
+}
+
+s32 audioDmaRequest(s32 addr, s32 len, void* state) {
+    s32 endAddr = addr + len;
+
+    // If the data already exists in a buffer we can avoid a DMA
+    int bufferIndex = audioFindDmaBuffer(addr, endAddr);
+
+    if (bufferIndex != -1) {
+        struct DmaBufferMetadata* bufInfo = &sDmaBufferMetadata[bufferIndex];
+        s32 offset = addr - bufInfo->address;
+        bufInfo->framesOld = 0;
+        ++sDmaCounters.hits;
+
+        // keep a streamed clip one buffer ahead of where the read ended
+        int lastBufferIndex = endAddr > bufInfo->address + AUDIO_DMA_SIZE ? bufferIndex + 1 : bufferIndex;
+
+        if (endAddr > sDmaBufferMetadata[lastBufferIndex].address + AUDIO_DMA_SIZE - AUDIO_PREFETCH_OVERLAP) {
+            audioPrefetchDma(lastBufferIndex);
+        }
+
+        return K0_TO_PHYS(sDmaBuffers[bufferIndex] + offset);
+    }
+
+    ++sDmaCounters.misses;
+
+    bufferIndex = audioFindEvictableDmaBuffer(1);
+    if (bufferIndex == -1 || audioDmaTransfersInUse() >= AUDIO_MAX_DMA_TRANSFERS) {
+        // No free buffers! This will cause audio glitching.
+        return K0_TO_PHYS(sDmaBuffers[0]);
+    }
+
+    int isStreaming = audioIsStreamingFrom(addr);
+
+    // DMA source must be 2-byte aligned
+    u32 address = addr & ~1;
+    u8* dramAddr = audioQueueDma(bufferIndex, address);
+
+    if (isStreaming) {
+        audioPrefetchDma(bufferIndex);
+    }
+
+    // Add back offset if needed to round down for 2-byte alignment
+    return K0_TO_PHYS(dramAddr + (addr & 1));
+}
+
+static void audioStartDma(int firstBuffer, int bufferCount) {
+    OSIoMesg* msgReq = &sAudioDmaMessageReqs[sNextDmaSlot];
+    msgReq->hdr.pri = OS_MESG_PRI_NORMAL;
+    msgReq->hdr.retQueue = &sAudioDmaMessageQueue;
+    msgReq->dramAddr = sDmaBuffers[firstBuffer];
+    msgReq->devAddr = sDmaBufferMetadata[firstBuffer].address;
+    msgReq->size = AUDIO_DMA_SIZE * bufferCount;
+
+    // RSP will read memory directly so no need to invalidate data cache
+    osEPiStartDma(sCartHandle, msgReq, OS_READ);
+    sNextDmaSlot = (sNextDmaSlot + 1) % AUDIO_MAX_DMA_TRANSFERS;
+    ++sActiveDmaCount;
+    ++sDmaCounters.frameCount;
+}
+
+void audioDmaFlush() {
+    int runStart = -1;
+
+    for (int i = 0; i <= AUDIO_DMA_BUFFER_COUNT; ++i) {
+        int isPending = i < AUDIO_DMA_BUFFER_COUNT && sDmaBufferMetadata[i].isPending;
+
+        if (runStart != -1 && (!isPending || !audioIsDmaBufferLinked(i - 1))) {
+            audioStartDma(runStart, i - runStart);
+            runStart = -1;
+        }
+
+        if (isPending) {
+            sDmaBufferMetadata[i].isPending = 0;
+
+            if (runStart == -1) {
+                runStart = i;
+            }
+        }
+    }
+
+    sPendingDmaCount = 0;
+}
+
+void audioDmaUpdate() {
+    u32 activeDmas = sActiveDmaCount;
+    for (u32 i = 0; i < AUDIO_DMA_BUFFER_COUNT; ++i) {
+        ++sDmaBufferMetadata[i].framesOld;
+
+        if (i < activeDmas) {
+            if (osRecvMesg(&sAudioDmaMessageQueue, NULL, OS_MESG_NOBLOCK) != 0) {
+                // DMA not done! This will cause audio glitching.
+                continue;
+            }
+
+            --sActiveDmaCount;
+        }
+    }
+}
+
+struct AudioDmaCounters* audioDmaCounters() {
+    return &sDmaCounters;
+}
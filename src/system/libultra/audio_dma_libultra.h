@@ -0,0 +1,53 @@
+#ifndef __AUDIO_DMA_LIBULTRA_H__
+#define __AUDIO_DMA_LIBULTRA_H__
+
+#include <ultra64.h>
+
+// Sound samples are requested during audio command list generation.
+//
+// Those not in a buffer are DMAed in. Otherwise a previous buffer is re-used.
+// A higher DMA size increases the likelihood of re-use, which reduces the
+// number of DMAs.
+#define AUDIO_DMA_BUFFER_COUNT      30
+#define AUDIO_MAX_DMA_TRANSFERS     30
+#define AUDIO_DMA_SIZE              2048
+
+// Once a clip reads near the end of a buffer, or misses right after one,
+// the following buffer is read ahead so it is ready next frame. It goes
+// in the buffer right after the current one when that is free, so reads
+// can straddle the two. Otherwise it overlaps the current one so reads
+// that straddle the boundary still hit
+#define AUDIO_PREFETCH_OVERLAP      256
+// Buffers read last frame are likely to be read again so read ahead
+// only replaces older ones, and leaves some transfers for misses
+#define AUDIO_PREFETCH_MIN_FRAMES_OLD   2
+#define AUDIO_DEMAND_DMA_TRANSFERS      4
+// The buffer after the current one is only taken over for read ahead
+// once nothing has read it for this long, so short clips played every
+// few frames keep their buffers
+#define AUDIO_LINK_MIN_FRAMES_OLD       16
+// Linked buffers read ahead in one transfer
+#define AUDIO_PREFETCH_LINKED_BUFFERS   2
+
+struct AudioDmaCounters {
+    unsigned short hits;
+    unsigned short misses;
+    unsigned short prefetches;
+    // PI DMAs started since the counter was last cleared, each can
+    // fill several buffers
+    unsigned short frameCount;
+};
+
+void audioDmaInit(OSPiHandle* cartHandle, ALHeap* heap);
+// The ALDMAproc handed to the synthesizer
+s32 audioDmaRequest(s32 addr, s32 len, void* state);
+// Starts the transfers requested while building the command list.
+// Back to back reads into neighboring buffers go out as one transfer
+void audioDmaFlush();
+// Call once the frame's command list has run. Ages the buffers
+// and collects the transfers that have finished
+void audioDmaUpdate();
+// Cleared by whoever reports them
+struct AudioDmaCounters* audioDmaCounters();
+
+#endif
@@ -1,5 +1,6 @@
 #include "system/audio.h"
 
+#include "audio_dma_libultra.h"
 #include "math/mathf.h"
 #include "rsp_scheduler_libultra.h"
 #include "system/cartridge.h"
@@ -41,15 +42,6 @@
 // Each command list entry uses 8 bytes of the audio heap.
 #define AUDIO_MAX_COMMAND_LIST_SIZE 2048
 
-// Sound samples are requested during audio command list generation.
-//
-// Those not in a buffer are DMAed in. Otherwise a previous buffer is re-used.
-// A higher DMA size increases the likelihood of re-use, which reduces the
-// number of DMAs.
-#define AUDIO_DMA_BUFFER_COUNT      30
-#define AUDIO_MAX_DMA_TRANSFERS     30
-#define AUDIO_DMA_SIZE              2048
-
 // The N64 DAC can queue up to 2 sample buffers (16-bit stereo).
 // Use 3 so another can be written while 2 are queued.
 #define AUDIO_SAMPLE_BUFFER_COUNT   3
@@ -63,6 +55,16 @@
 // Stack size for the audio thread
 #define AUDIO_STACK_SIZE_BYTES      2048
 
+#define AUDIO_STATS_FRAMES          30
+
+// When the audio task keeps taking longer than the budget to come back
+// from the RSP, or the DAC runs dry, echo is turned off and fewer voices
+// are mixed until the task time stays well under budget for a while
+#define AUDIO_TASK_BUDGET_USECS     4000
+#define AUDIO_REDUCE_FRAMES         8
+#define AUDIO_RESTORE_FRAMES        120
+#define AUDIO_REDUCED_VOICES        16
+
 // Format of sfz2n64 output
 struct SoundArray {
     u32 soundCount;
@@ -74,11 +76,7 @@ struct VoiceState {
     float pitch;
     s16 volume;
     u8 flags;
-};
-
-struct DmaBufferMetadata {
-    u32 address;
-    u32 framesOld;
+    u8 echo;
 };
 
 static ALHeap                   sAudioHeap;
@@ -93,16 +91,6 @@ static int                      sMaxVoices;
 static ALGlobals                sAudioGlobals;
 static ALSndPlayer              sSoundPlayer;
 
-static u8*                      sDmaBuffers[AUDIO_DMA_BUFFER_COUNT];
-static struct DmaBufferMetadata sDmaBufferMetadata[AUDIO_DMA_BUFFER_COUNT];
-
-static OSPiHandle*              sCartHandle;
-static OSMesgQueue              sAudioDmaMessageQueue;
-static OSMesg                   sAudioDmaMessages[AUDIO_MAX_DMA_TRANSFERS];
-static OSIoMesg                 sAudioDmaMessageReqs[AUDIO_MAX_DMA_TRANSFERS];
-static int                      sNextDmaSlot;
-static int                      sActiveDmaCount;
-
 static OSMesgQueue*             sSchedulerTaskQueue;
 static OSMesgQueue              sSchedulerTaskDoneQueue;
 static OSScMsg                  sSchedulerTaskDoneMsg;
@@ -110,6 +98,15 @@ static OSScMsg                  sSchedulerTaskDoneMsg;
 static OSThread                 sAudioThread;
 static u64                      sAudioThreadStack[AUDIO_STACK_SIZE_BYTES / sizeof(u64)];
 
+// Written by the audio thread
+static struct AudioStats        sAudioStats;
+static short                    sStatsFrame;
+static short                    sOverBudgetFrames;
+static short                    sUnderBudgetFrames;
+static volatile short           sShouldReduce;
+// Only touched by the game thread
+static short                    sAppliedReduce;
+
 #define OFFSET_POINTER(base, offset) (void*)((unsigned)(base) + (unsigned)(offset))
 #define OFFSET_POINTER_NULLABLE(base, offset) ((offset) ? OFFSET_POINTER(base, offset) : NULL)
 
@@ -150,54 +147,8 @@ struct SoundArray* audioLoadSounds() {
     return soundArray;
 }
 
-static s32 audioRequestDma(s32 addr, s32 len, void*) {
-    s32 endAddr = addr + len;
-    u32 bufferIndex = 0;
-
-    for (int i = 0; i < AUDIO_DMA_BUFFER_COUNT; ++i) {
-        struct DmaBufferMetadata* bufInfo = &sDmaBufferMetadata[i];
-
-        // If the data already exists in a buffer we can avoid a DMA
-        if (bufInfo->address <= addr && endAddr <= (bufInfo->address + AUDIO_DMA_SIZE)) {
-            s32 offset = addr - bufInfo->address;
-            bufInfo->framesOld = 0;
-            return K0_TO_PHYS(sDmaBuffers[i] + offset);
-        }
-
-        // Evict least recently used buffer
-        if (bufInfo->framesOld > sDmaBufferMetadata[bufferIndex].framesOld) {
-            bufferIndex = i;
-        }
-    }
-
-    struct DmaBufferMetadata* bufInfo = &sDmaBufferMetadata[bufferIndex];
-    if (bufInfo->framesOld == 0 || sActiveDmaCount >= AUDIO_MAX_DMA_TRANSFERS) {
-        // No free buffers! This will cause audio glitching.
-        return K0_TO_PHYS(sDmaBuffers[0]);
-    }
-
-    // DMA source must be 2-byte aligned
-    bufInfo->address = addr & ~1;
-    bufInfo->framesOld = 0;
-
-    OSIoMesg* msgReq = &sAudioDmaMessageReqs[sNextDmaSlot];
-    msgReq->hdr.pri = OS_MESG_PRI_NORMAL;
-    msgReq->hdr.retQueue = &sAudioDmaMessageQueue;
-    msgReq->dramAddr = sDmaBuffers[bufferIndex];
-    msgReq->devAddr = bufInfo->address;
-    msgReq->size = AUDIO_DMA_SIZE;
-
-    // RSP will read memory directly so no need to invalidate data cache
-    osEPiStartDma(sCartHandle, msgReq, OS_READ);
-    sNextDmaSlot = (sNextDmaSlot + 1) % AUDIO_MAX_DMA_TRANSFERS;
-    ++sActiveDmaCount;
-
-    // Add back offset if needed to round down for 2-byte alignment
-    return K0_TO_PHYS(msgReq->dramAddr + (addr & 1));
-}
-
 static ALDMAproc audioCreateDmaCallback(void*) {
-    return audioRequestDma;
+    return audioDmaRequest;
 }
 
 static void audioExecuteCommandList(Acmd* commandList, u32 commandListSize) {
@@ -230,22 +181,6 @@ static void audioExecuteCommandList(Acmd* commandList, u32 commandListSize) {
     osRecvMesg(&sSchedulerTaskDoneQueue, NULL, OS_MESG_BLOCK);
 }
 
-static void audioUpdateDma() {
-    u32 activeDmas = sActiveDmaCount;
-    for (u32 i = 0; i < AUDIO_DMA_BUFFER_COUNT; ++i) {
-        ++sDmaBufferMetadata[i].framesOld;
-
-        if (i < activeDmas) {
-            if (osRecvMesg(&sAudioDmaMessageQueue, NULL, OS_MESG_NOBLOCK) != 0) {
-                // DMA not done! This will cause audio glitching.
-                continue;
-            }
-
-            --sActiveDmaCount;
-        }
-    }
-}
-
 static int audioGenerateSamples(Acmd* commandListBuffer, u8* sampleBuffer, int sampleCount) {
     // RSP will read memory directly so no need to invalidate data cache
     s32 cmdListSize = 0;
@@ -255,19 +190,69 @@ static int audioGenerateSamples(Acmd* commandListBuffer, u8* sampleBuffer, int s
         (s16*)K0_TO_PHYS(sampleBuffer),
         sampleCount
     );
+    audioDmaFlush();
 
     assert(cmdListSize <= AUDIO_MAX_COMMAND_LIST_SIZE);
 
     if (cmdListSize == 0) {
         // Nothing to write. Must not run the RSP task or the game will hang.
+        sAudioStats.taskTime = 0;
         return 0;
     }
 
+    Time taskStart = timeGetTime();
     audioExecuteCommandList(commandListBuffer, cmdListSize);
-    audioUpdateDma();
+    sAudioStats.taskTime = timeGetTime() - taskStart;
+
+    audioDmaUpdate();
     return 1;
 }
 
+static void audioUpdateLoad(int sampleSlack, int didUnderrun) {
+    sAudioStats.sampleSlack = sampleSlack;
+
+    struct AudioDmaCounters* dmaCounters = audioDmaCounters();
+    sAudioStats.dmaCount = dmaCounters->frameCount;
+    dmaCounters->frameCount = 0;
+
+    if (++sStatsFrame == AUDIO_STATS_FRAMES) {
+        sAudioStats.dmaHits = dmaCounters->hits;
+        sAudioStats.dmaMisses = dmaCounters->misses;
+        sAudioStats.dmaPrefetches = dmaCounters->prefetches;
+        dmaCounters->hits = 0;
+        dmaCounters->misses = 0;
+        dmaCounters->prefetches = 0;
+        sStatsFrame = 0;
+    }
+
+    int taskUsecs = timeMicroseconds(sAudioStats.taskTime);
+
+    if (didUnderrun) {
+        ++sAudioStats.underrunCount;
+        sOverBudgetFrames = AUDIO_REDUCE_FRAMES;
+    } else if (taskUsecs > AUDIO_TASK_BUDGET_USECS) {
+        ++sOverBudgetFrames;
+    } else {
+        sOverBudgetFrames = 0;
+    }
+
+    if (taskUsecs < AUDIO_TASK_BUDGET_USECS / 2) {
+        ++sUnderBudgetFrames;
+    } else {
+        sUnderBudgetFrames = 0;
+    }
+
+    if (sOverBudgetFrames >= AUDIO_REDUCE_FRAMES) {
+        sShouldReduce = 1;
+        sOverBudgetFrames = 0;
+        sUnderBudgetFrames = 0;
+    } else if (sShouldReduce && sUnderBudgetFrames >= AUDIO_RESTORE_FRAMES) {
+        sShouldReduce = 0;
+    }
+
+    sAudioStats.isReduced = sShouldReduce;
+}
+
 static void audioThreadEntry(void* arg) {
     OSMesgQueue frameQueue;
     OSMesg frameMsgBuf[AUDIO_FRAME_QUEUE_SIZE];
@@ -311,6 +296,11 @@ static void audioThreadEntry(void* arg) {
             continue;
         }
 
+        // Anything still queued is how far ahead of the DAC we were.
+        // Nothing left after queueing samples last frame means it ran dry
+        int sampleSlack = osAiGetLength() / AUDIO_SAMPLE_SIZE;
+        audioUpdateLoad(sampleSlack, nextSampleCount > 0 && sampleSlack == 0);
+
         // If the DAC is full, we either generated too many samples or
         // are catching up after being behind. Just skip in both cases.
         //
@@ -362,16 +352,14 @@ void* audioInit(void* heapEnd, int maxVoices) {
     alSndpNew(&sSoundPlayer, &soundPlayerConfig);
 
     // DMA
-    sCartHandle = osCartRomInit();
-    osCreateMesgQueue(&sAudioDmaMessageQueue, sAudioDmaMessages, AUDIO_MAX_DMA_TRANSFERS);
-    for (int i = 0; i < AUDIO_DMA_BUFFER_COUNT; ++i) {
-        sDmaBuffers[i] = alHeapAlloc(&sAudioHeap, 1, AUDIO_DMA_SIZE);
-        sDmaBufferMetadata[i].address = 0;
-        sDmaBufferMetadata[i].framesOld = 0;
-    }
+    audioDmaInit(osCartRomInit(), &sAudioHeap);
 
-    sNextDmaSlot = 0;
-    sActiveDmaCount = 0;
+    zeroMemory(&sAudioStats, sizeof(sAudioStats));
+    sStatsFrame = 0;
+    sOverBudgetFrames = 0;
+    sUnderBudgetFrames = 0;
+    sShouldReduce = 0;
+    sAppliedReduce = 0;
 
     // Thread
     sSchedulerTaskQueue = osScGetCmdQ(rspSchedulerGet());
@@ -390,7 +378,32 @@ void* audioInit(void* heapEnd, int maxVoices) {
     return heapStart;
 }
 
+// Sound player calls have to come from the game thread so the audio
+// thread only flags the change and it is applied here
+static void audioApplyReduce() {
+    int shouldReduce = sShouldReduce;
+
+    if (shouldReduce == sAppliedReduce) {
+        return;
+    }
+
+    sAppliedReduce = shouldReduce;
+
+    for (int i = 0; i < sMaxVoices; ++i) {
+        struct VoiceState* voiceState = &sVoiceStates[i];
+
+        if (!(voiceState->flags & AUDIO_VOICE_FLAG_PLAYING)) {
+            continue;
+        }
+
+        alSndpSetSound(&sSoundPlayer, i);
+        alSndpSetFXMix(&sSoundPlayer, shouldReduce ? 0 : voiceState->echo);
+    }
+}
+
 void audioUpdate() {
+    audioApplyReduce();
+
     for (int i = 0; i < sMaxVoices; ++i) {
         struct VoiceState* voiceState = &sVoiceStates[i];
         if ((voiceState->flags & (AUDIO_VOICE_FLAG_PLAYING | AUDIO_VOICE_FLAG_PAUSED)) != AUDIO_VOICE_FLAG_PLAYING) {
@@ -425,7 +438,19 @@ void audioDestroy() {
     osDestroyThread(&sAudioThread);
 }
 
-static int audioIsSoundClipLooped(int soundClipId) {
+struct AudioStats* audioStats() {
+    return &sAudioStats;
+}
+
+int audioVoiceBudget() {
+    if (sAppliedReduce && sMaxVoices > AUDIO_REDUCED_VOICES) {
+        return AUDIO_REDUCED_VOICES;
+    }
+
+    return sMaxVoices;
+}
+
+int audioIsSoundClipLooped(int soundClipId) {
     if (soundClipId < 0 || soundClipId >= sSoundClipArray->soundCount) {
         return 0;
     }
@@ -482,6 +507,7 @@ VoiceId audioPlaySound(int soundClipId, float volume, float pitch, float pan, fl
     voiceState->pitch = 0.0f;
     voiceState->volume = 0;
     voiceState->flags = AUDIO_VOICE_FLAG_PLAYING;
+    voiceState->echo = 0;
 
     audioSetSoundParams(voiceId, volume, pitch, pan, echo);
     alSndpPlay(&sSoundPlayer);
@@ -514,7 +540,11 @@ void audioSetSoundParams(VoiceId voiceId, float volume, float pitch, float pan,
     }
 
     if (echo >= 0.0f) {
-        alSndpSetFXMix(&sSoundPlayer, 127 * echo);
+        voiceState->echo = 127 * echo;
+
+        if (!sAppliedReduce) {
+            alSndpSetFXMix(&sSoundPlayer, voiceState->echo);
+        }
     }
 }
 
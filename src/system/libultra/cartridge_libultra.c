@@ -28,11 +28,21 @@ static OSMesgQueue           sAsyncDmaMessageQ;
 static OSMesg                sAsyncDmaMessages[DMA_ASYNC_QUEUE_SIZE];
 static OSIoMesg              sAsyncDmaMessageReqs[DMA_ASYNC_QUEUE_SIZE];
 static int                   sNextAsyncDmaSlot;
-static int                   sPendingAsyncDmaCount;
+static unsigned              sStartedAsyncDmaCount;
+static unsigned              sFinishedAsyncDmaCount;
+
+static struct RomCopyAsyncStats sAsyncDmaStats;
+static struct RomCopyAsyncStats sLastFrameAsyncDmaStats;
 
 static OSMesgQueue           sSleepTimerQ;
 static OSMesg                sSleepTimerMsg;
 
+static OSMesgQueue           sSramAsyncMessageQ;
+static OSMesg                sSramAsyncMessage;
+static OSIoMesg              sSramAsyncMessageReq;
+static int                   sSramAsyncPending;
+static OSTime                sSramReadyTime;
+
 static void sramHandleInit() {
     sSramHandle.type = DEVICE_TYPE_SRAM;
     sSramHandle.latency = SRAM_LATENCY;
@@ -71,8 +81,14 @@ void cartridgeInit() {
     osCreateMesgQueue(&sDmaMessageQ, sDmaMessages, DMA_QUEUE_SIZE);
     osCreateMesgQueue(&sAsyncDmaMessageQ, sAsyncDmaMessages, DMA_ASYNC_QUEUE_SIZE);
     osCreateMesgQueue(&sSleepTimerQ, &sSleepTimerMsg, 1);
+    osCreateMesgQueue(&sSramAsyncMessageQ, &sSramAsyncMessage, 1);
+    sSramAsyncPending = 0;
+    sSramReadyTime = 0;
     sNextAsyncDmaSlot = 0;
-    sPendingAsyncDmaCount = 0;
+    sStartedAsyncDmaCount = 0;
+    sFinishedAsyncDmaCount = 0;
+    zeroMemory(&sAsyncDmaStats, sizeof(sAsyncDmaStats));
+    zeroMemory(&sLastFrameAsyncDmaStats, sizeof(sLastFrameAsyncDmaStats));
 }
 
 void romCopy(const void* romAddr, void* ramAddr, const int size) {
@@ -89,11 +105,25 @@ void romCopy(const void* romAddr, void* ramAddr, const int size) {
     osRecvMesg(&sDmaMessageQ, NULL, OS_MESG_BLOCK);
 }
 
-void romCopyAsync(const void* romAddr, void* ramAddr, const int size) {
-    if (sPendingAsyncDmaCount == DMA_ASYNC_QUEUE_SIZE) {
+static int romCopyAsyncReceive(s32 flags) {
+    if (osRecvMesg(&sAsyncDmaMessageQ, NULL, flags) == -1) {
+        return 0;
+    }
+
+    ++sFinishedAsyncDmaCount;
+    return 1;
+}
+
+static void romCopyAsyncWaitForOne() {
+    Time start = timeGetTime();
+    romCopyAsyncReceive(OS_MESG_BLOCK);
+    sAsyncDmaStats.stallTime += timeGetTime() - start;
+}
+
+unsigned romCopyAsync(const void* romAddr, void* ramAddr, const int size) {
+    if (sStartedAsyncDmaCount - sFinishedAsyncDmaCount == DMA_ASYNC_QUEUE_SIZE) {
         // Free up a slot
-        osRecvMesg(&sAsyncDmaMessageQ, NULL, OS_MESG_BLOCK);
-        --sPendingAsyncDmaCount;
+        romCopyAsyncWaitForOne();
     }
 
     OSIoMesg* msgReq = &sAsyncDmaMessageReqs[sNextAsyncDmaSlot];
@@ -107,17 +137,94 @@ void romCopyAsync(const void* romAddr, void* ramAddr, const int size) {
 
     osInvalDCache(ramAddr, size);
     osEPiStartDma(sCartHandle, msgReq, OS_READ);
-    ++sPendingAsyncDmaCount;
+    ++sStartedAsyncDmaCount;
+
+    ++sAsyncDmaStats.copyCount;
+    sAsyncDmaStats.byteCount += size;
+
+    return sStartedAsyncDmaCount;
+}
+
+int romCopyAsyncIsDone(unsigned ticket) {
+    while (romCopyAsyncReceive(OS_MESG_NOBLOCK));
+
+    return (int)(sFinishedAsyncDmaCount - ticket) >= 0;
+}
+
+void romCopyAsyncWait(unsigned ticket) {
+    while (!romCopyAsyncIsDone(ticket)) {
+        romCopyAsyncWaitForOne();
+    }
 }
 
 void romCopyAsyncDrain() {
-    while (sPendingAsyncDmaCount) {
-        osRecvMesg(&sAsyncDmaMessageQ, NULL, OS_MESG_BLOCK);
-        --sPendingAsyncDmaCount;
+    while (sStartedAsyncDmaCount != sFinishedAsyncDmaCount) {
+        romCopyAsyncReceive(OS_MESG_BLOCK);
     }
 }
 
+void romCopyAsyncUpdate() {
+    while (romCopyAsyncReceive(OS_MESG_NOBLOCK));
+
+    sLastFrameAsyncDmaStats = sAsyncDmaStats;
+    zeroMemory(&sAsyncDmaStats, sizeof(sAsyncDmaStats));
+}
+
+struct RomCopyAsyncStats* romCopyAsyncLastFrameStats() {
+    return &sLastFrameAsyncDmaStats;
+}
+
+static void sramAsyncFinished() {
+    sSramAsyncPending = 0;
+    // the SRAM needs time to settle after a write
+    sSramReadyTime = osGetTime() + OS_USEC_TO_CYCLES(SRAM_DELAY_USECS);
+}
+
+int sramIsBusy() {
+    if (sSramAsyncPending && osRecvMesg(&sSramAsyncMessageQ, NULL, OS_MESG_NOBLOCK) != -1) {
+        sramAsyncFinished();
+    }
+
+    return sSramAsyncPending || osGetTime() < sSramReadyTime;
+}
+
+void sramWaitIdle() {
+    if (sSramAsyncPending) {
+        osRecvMesg(&sSramAsyncMessageQ, NULL, OS_MESG_BLOCK);
+        sramAsyncFinished();
+    }
+
+    OSTime now = osGetTime();
+
+    if (now < sSramReadyTime) {
+        usleep(OS_CYCLES_TO_USEC(sSramReadyTime - now));
+    }
+}
+
+int sramWriteAsync(void* sramAddr, const void* ramAddr, const int size) {
+    if (sramIsBusy()) {
+        return 0;
+    }
+
+    sSramAsyncMessageReq.hdr.pri = OS_MESG_PRI_HIGH;
+    sSramAsyncMessageReq.hdr.retQueue = &sSramAsyncMessageQ;
+    sSramAsyncMessageReq.dramAddr = (void*)ramAddr;
+    sSramAsyncMessageReq.devAddr = (u32)sramAddr;
+    sSramAsyncMessageReq.size = size;
+
+    osWritebackDCache((void*)ramAddr, size);
+    if (osEPiStartDma(&sSramHandle, &sSramAsyncMessageReq, OS_WRITE) == -1) {
+        // Queue is full. Failing to write save file is non-fatal.
+        return 0;
+    }
+
+    sSramAsyncPending = 1;
+    return 1;
+}
+
 void sramWrite(void* sramAddr, const void* ramAddr, const int size) {
+    sramWaitIdle();
+
     OSIoMesg msgReq = {
         .hdr.pri      = OS_MESG_PRI_HIGH,
         .hdr.retQueue = &sDmaMessageQ,
@@ -138,6 +245,8 @@ void sramWrite(void* sramAddr, const void* ramAddr, const int size) {
 }
 
 int sramRead(const void* sramAddr, void* ramAddr, const int size) {
+    sramWaitIdle();
+
     OSIoMesg msgReq = {
         .hdr.pri      = OS_MESG_PRI_HIGH,
         .hdr.retQueue = &sDmaMessageQ,
@@ -0,0 +1,166 @@
+#include "compressed_segment.h"
+
+#include "system/cartridge.h"
+
+#define HEADER_SIZE     sizeof(struct CompressedSegmentHeader)
+// a flag byte followed by the longest back reference
+#define MAX_ITEM_SIZE   4
+
+#ifdef PORTAL64_COMPRESS_SEGMENTS
+
+static struct CompressedSegmentHeader __attribute__((aligned(16))) sHeader;
+static char* sHeaderRomStart;
+
+// loads ask for the memory size before starting the stream, ROM
+// doesn't change so both only need to read the header once
+static struct CompressedSegmentHeader* compressedSegmentReadHeader(char* romStart) {
+    if (romStart != sHeaderRomStart) {
+        romCopy(romStart, &sHeader, sizeof(sHeader));
+        sHeaderRomStart = romStart;
+    }
+
+    return &sHeader;
+}
+
+// The compressed data sits at the end of the work buffer and the
+// compressor guarantees the output never overtakes the input, so
+// only bytes that have already arrived are read or overwritten
+static void compressedSegmentDecode(struct CompressedSegmentStream* stream, int maxBytes) {
+    u8* src = stream->src;
+    u8* dst = stream->dst;
+    u8* dstLimit = stream->dstEnd - dst > maxBytes ? dst + maxBytes : stream->dstEnd;
+    u8* srcLimit = (u8*)stream->input + stream->arrivedBytes -
+        (stream->arrivedBytes == stream->romSize ? 1 : MAX_ITEM_SIZE);
+    u8 flags = stream->flags;
+    u8 flagBit = stream->flagBit;
+
+    while (dst < dstLimit && src <= srcLimit) {
+        if (!flagBit) {
+            flags = *src++;
+            flagBit = 0x80;
+        }
+
+        if (flags & flagBit) {
+            *dst++ = *src++;
+        } else {
+            int first = *src++;
+            int second = *src++;
+            u8* copyFrom = dst - ((((first & 0xF) << 8) | second) + 1);
+            int length = (first >> 4) ? (first >> 4) + 2 : *src++ + 0x12;
+
+            // may overlap with the output so copy a byte at a time
+            while (length > 0) {
+                *dst++ = *copyFrom++;
+                --length;
+            }
+        }
+
+        flagBit >>= 1;
+    }
+
+    stream->src = src;
+    stream->dst = dst;
+    stream->flags = flags;
+    stream->flagBit = flagBit;
+
+    if (dst == stream->dstEnd) {
+        // the RSP reads the display lists straight from memory
+        osWritebackDCache(stream->memory, stream->dstEnd - (u8*)stream->memory);
+    }
+}
+
+#endif
+
+static void compressedSegmentCopyNextChunk(struct CompressedSegmentStream* stream) {
+    int chunkSize = stream->romSize - stream->copiedBytes;
+
+    if (chunkSize > COMPRESSED_SEGMENT_CHUNK_SIZE) {
+        chunkSize = COMPRESSED_SEGMENT_CHUNK_SIZE;
+    }
+
+    stream->ticket = romCopyAsync(
+        stream->romStart + stream->copiedBytes,
+        stream->input + stream->copiedBytes,
+        chunkSize
+    );
+    stream->copiedBytes += chunkSize;
+}
+
+int compressedSegmentMemorySize(char* romStart, char* romEnd, int* size) {
+#ifdef PORTAL64_COMPRESS_SEGMENTS
+    struct CompressedSegmentHeader* header = compressedSegmentReadHeader(romStart);
+
+    if (size) {
+        *size = header->uncompressedSize;
+    }
+
+    return header->workSize;
+#else
+    if (size) {
+        *size = romEnd - romStart;
+    }
+
+    return romEnd - romStart;
+#endif
+}
+
+void compressedSegmentLoad(char* romStart, char* romEnd, void* memory) {
+#ifdef PORTAL64_COMPRESS_SEGMENTS
+    struct CompressedSegmentStream stream;
+    compressedSegmentStreamInit(&stream, romStart, romEnd, memory);
+    compressedSegmentStreamFinish(&stream);
+#else
+    romCopy(romStart, memory, romEnd - romStart);
+#endif
+}
+
+void compressedSegmentStreamInit(struct CompressedSegmentStream* stream, char* romStart, char* romEnd, void* memory) {
+    stream->romStart = romStart;
+    stream->memory = memory;
+    stream->romSize = romEnd - romStart;
+    stream->copiedBytes = 0;
+    stream->arrivedBytes = 0;
+
+#ifdef PORTAL64_COMPRESS_SEGMENTS
+    struct CompressedSegmentHeader* header = compressedSegmentReadHeader(romStart);
+
+    // compressedSize and workSize are both multiples of 16
+    stream->input = (char*)memory + header->workSize - header->compressedSize;
+    stream->src = (u8*)stream->input + HEADER_SIZE;
+    stream->dst = memory;
+    stream->dstEnd = (u8*)memory + header->uncompressedSize;
+    stream->flags = 0;
+    stream->flagBit = 0;
+#else
+    stream->input = memory;
+#endif
+
+    compressedSegmentCopyNextChunk(stream);
+}
+
+int compressedSegmentStreamUpdate(struct CompressedSegmentStream* stream, int maxBytes) {
+    if (stream->arrivedBytes < stream->copiedBytes && romCopyAsyncIsDone(stream->ticket)) {
+        stream->arrivedBytes = stream->copiedBytes;
+    }
+
+    // keep the next chunk copying while this one is decompressed
+    if (stream->arrivedBytes == stream->copiedBytes && stream->copiedBytes < stream->romSize) {
+        compressedSegmentCopyNextChunk(stream);
+    }
+
+#ifdef PORTAL64_COMPRESS_SEGMENTS
+    if (stream->dst < stream->dstEnd) {
+        compressedSegmentDecode(stream, maxBytes);
+    }
+
+    return stream->dst == stream->dstEnd;
+#else
+    return stream->arrivedBytes == stream->romSize;
+#endif
+}
+
+void compressedSegmentStreamFinish(struct CompressedSegmentStream* stream) {
+    while (!compressedSegmentStreamUpdate(stream, 0x7FFFFFFF)) {
+        romCopyAsyncWait(stream->ticket);
+    }
+}
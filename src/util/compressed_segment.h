@@ -0,0 +1,50 @@
+#ifndef __COMPRESSED_SEGMENT_H__
+#define __COMPRESSED_SEGMENT_H__
+
+#include <ultra64.h>
+
+// 'Yaz0', must match tools/compress_segments.js
+#define COMPRESSED_SEGMENT_MAGIC    0x59617A30
+// a multiple of 16 so chunks always start on a cache line
+#define COMPRESSED_SEGMENT_CHUNK_SIZE  (16 * 1024)
+
+struct CompressedSegmentHeader {
+    u32 magic;
+    u32 uncompressedSize;
+    // includes the header
+    u32 compressedSize;
+    // room needed to decompress in place
+    u32 workSize;
+};
+
+// Copies a segment from ROM a chunk at a time, decompressing each
+// chunk while the next one is copied when built with COMPRESS_SEGMENTS
+struct CompressedSegmentStream {
+    char* romStart;
+    char* memory;
+    char* input;
+    int romSize;
+    int copiedBytes;
+    int arrivedBytes;
+    unsigned ticket;
+#ifdef PORTAL64_COMPRESS_SEGMENTS
+    u8* src;
+    u8* dst;
+    u8* dstEnd;
+    u8 flags;
+    u8 flagBit;
+#endif
+};
+
+// How much memory loading a segment takes. This can be a little
+// more than the segment itself, whose size is written to size
+int compressedSegmentMemorySize(char* romStart, char* romEnd, int* size);
+
+void compressedSegmentLoad(char* romStart, char* romEnd, void* memory);
+
+void compressedSegmentStreamInit(struct CompressedSegmentStream* stream, char* romStart, char* romEnd, void* memory);
+// Decompresses at most maxBytes and returns true once the whole segment is loaded
+int compressedSegmentStreamUpdate(struct CompressedSegmentStream* stream, int maxBytes);
+void compressedSegmentStreamFinish(struct CompressedSegmentStream* stream);
+
+#endif
@@ -1,14 +1,41 @@
 #include "dynamic_asset_loader.h"
 
+#include "compressed_segment.h"
 #include "graphics/profile_task.h"
 #include "memory.h"
-#include "system/cartridge.h"
 
 #include "codegen/assets/models/dynamic_model_list.h"
 #include "codegen/assets/models/dynamic_animated_model_list.h"
 
-Gfx* gLoadedModels[DYNAMIC_MODEL_COUNT];
-u32 gModelPointerOffset[DYNAMIC_MODEL_COUNT];
+// soft limit, models still load when nothing can be evicted
+#define DYNAMIC_MODEL_CACHE_BUDGET      (96 * 1024)
+// a display list built with a model may still be drawing for this
+// many frames after it was requested, so it can't be evicted until then
+#define DYNAMIC_MODEL_FRAMES_IN_FLIGHT  2
+// how much of a model is decompressed each time it is polled
+#define DYNAMIC_MODEL_LOAD_BYTES        (8 * 1024)
+
+enum DynamicModelState {
+    DynamicModelStateUnloaded,
+    DynamicModelStateLoading,
+    DynamicModelStateLoaded,
+};
+
+struct DynamicModelCacheEntry {
+    struct CompressedSegmentStream stream;
+    Gfx* model;
+    void* memory;
+    u32 pointerOffset;
+    int memorySize;
+    int size;
+    u16 framesSinceUse;
+    u8 state;
+    // once a pointer into a model is handed out it has to stay put
+    u8 isPinned;
+};
+
+static struct DynamicModelCacheEntry sModelCache[DYNAMIC_MODEL_COUNT];
+static struct DynamicAssetStats sStats;
 
 struct SKArmatureWithAnimations gLoadedAnimatedModels[DYNAMIC_ANIMATED_MODEL_COUNT];
 
@@ -35,77 +62,121 @@ struct SKAnimationClip gBlankClip = {
     0,
     NULL,
     0,
+    NULL,
 };
 
 void dynamicAssetsReset() {
-    zeroMemory(gLoadedModels, sizeof(gLoadedModels));
+    // any memory went away with the heap
+    zeroMemory(sModelCache, sizeof(sModelCache));
+    zeroMemory(&sStats, sizeof(sStats));
     zeroMemory(gLoadedAnimatedModels, sizeof(gLoadedAnimatedModels));
 }
 
 #define ADJUST_POINTER_POS(ptr, offset) (void*)((ptr) ? (char*)(ptr) + (offset) : 0)
 
-Gfx* dynamicAssetFixModelPointers(Gfx* gfx, u32 pointerOffset, u32 segmentStart, u32 segmentEnd) {
-    // only adjust pointers that land within the segment
-    if ((u32)gfx < segmentStart || (u32)gfx >= segmentEnd) {
-        return gfx;
+// Adds the offset to every pointer in the table skeletool64
+// generated for the model, the table itself is in the segment
+static void dynamicAssetApplyRelocations(void** relocations, u32 pointerOffset) {
+    for (void** relocation = ADJUST_POINTER_POS(relocations, pointerOffset); *relocation; ++relocation) {
+        void** target = (void**)((char*)*relocation + pointerOffset);
+        *target = ADJUST_POINTER_POS(*target, pointerOffset);
     }
+}
+
+static void dynamicAssetFreeModel(struct DynamicModelCacheEntry* entry) {
+    free(entry->memory);
+    sStats.cacheBytes -= entry->memorySize;
+    zeroMemory(entry, sizeof(struct DynamicModelCacheEntry));
+}
+
+// Evicts the least recently used models until the cache is
+// at most targetBytes, returns false if that wasn't possible
+static int dynamicAssetEvict(int targetBytes) {
+    while (sStats.cacheBytes > targetBytes) {
+        struct DynamicModelCacheEntry* oldest = NULL;
 
-    gfx = ADJUST_POINTER_POS(gfx, pointerOffset);
+        for (int i = 0; i < DYNAMIC_MODEL_COUNT; ++i) {
+            struct DynamicModelCacheEntry* entry = &sModelCache[i];
 
-    Gfx* result = gfx;
+            if (entry->state != DynamicModelStateLoaded || entry->isPinned || entry->framesSinceUse < DYNAMIC_MODEL_FRAMES_IN_FLIGHT) {
+                continue;
+            }
 
-    // prevent an infinite loop if G_ENDL isn't found
-    Gfx* maxGfx = ADJUST_POINTER_POS(segmentEnd, pointerOffset);
-    while (gfx < maxGfx) {
-        int commandType = _SHIFTR(gfx->words.w0, 24, 8);
+            if (!oldest || entry->framesSinceUse > oldest->framesSinceUse) {
+                oldest = entry;
+            }
+        }
 
-        switch (commandType) {
-            case G_ENDDL:
-                return result;
-            case G_DL:
-                if (gfx->dma.par == G_DL_NOPUSH) {
-                    break;
-                }
-                gfx->dma.addr = (u32)dynamicAssetFixModelPointers((Gfx*)gfx->dma.addr, pointerOffset, segmentStart, segmentEnd);
-                break;
-            case G_VTX:
-            case G_SETTIMG:
-                gfx->dma.addr = (u32)ADJUST_POINTER_POS(gfx->dma.addr, pointerOffset);
-                break;
-        };
+        if (!oldest) {
+            return 0;
+        }
 
-        ++gfx;
+        dynamicAssetFreeModel(oldest);
+        ++sStats.evictions;
     }
 
-    return NULL;
+    return 1;
 }
 
-Gfx* dynamicAssetLoadModel(struct DynamicAssetModel* model, u32* pointerOffset) {
-    u32 length = (u32)model->addressEnd - (u32)model->addressStart;
-    void* assetMemoryChunk = malloc(length);
-    romCopy(model->addressStart, assetMemoryChunk, length);
-    *pointerOffset = (u32)assetMemoryChunk - (u32)model->segmentStart;
-    Gfx* result = dynamicAssetFixModelPointers(model->model, *pointerOffset, (u32)model->segmentStart, (u32)model->segmentStart + length);
+static void dynamicAssetStartLoad(int index) {
+    struct DynamicAssetModel* model = &gDynamicModels[index];
+    struct DynamicModelCacheEntry* entry = &sModelCache[index];
+
+    int size;
+    int memorySize = compressedSegmentMemorySize(model->addressStart, model->addressEnd, &size);
+
+    dynamicAssetEvict(DYNAMIC_MODEL_CACHE_BUDGET - memorySize);
+    void* memory = mallocTagged(memorySize, MemoryTagAssets);
 
-    if (!result) {
-        free(assetMemoryChunk);
-        *pointerOffset = 0;
+    if (!memory && dynamicAssetEvict(0)) {
+        memory = mallocTagged(memorySize, MemoryTagAssets);
+    }
+
+    if (!memory) {
+        // try again the next time it is requested
+        return;
     }
 
-    profileMapAddress(result, model->name);
+    entry->memory = memory;
+    entry->memorySize = memorySize;
+    entry->size = size;
+    entry->state = DynamicModelStateLoading;
+    sStats.cacheBytes += memorySize;
 
-    return result;
+    compressedSegmentStreamInit(&entry->stream, model->addressStart, model->addressEnd, memory);
+}
+
+static void dynamicAssetFinishLoad(int index) {
+    struct DynamicAssetModel* model = &gDynamicModels[index];
+    struct DynamicModelCacheEntry* entry = &sModelCache[index];
+
+    entry->pointerOffset = (u32)entry->memory - (u32)model->segmentStart;
+    entry->model = ADJUST_POINTER_POS(model->model, entry->pointerOffset);
+    dynamicAssetApplyRelocations(model->relocations, entry->pointerOffset);
+
+    osWritebackDCache(entry->memory, entry->size);
+    profileMapAddress(entry->model, model->name);
+
+    entry->state = DynamicModelStateLoaded;
+}
+
+static void dynamicAssetUpdateLoad(int index, int maxBytes) {
+    if (compressedSegmentStreamUpdate(&sModelCache[index].stream, maxBytes)) {
+        dynamicAssetFinishLoad(index);
+    }
 }
 
 void dynamicAssetLoadAnimatedModel(struct DynamicAnimatedAssetModel* model, struct SKArmatureWithAnimations* result) {
-    u32 length = (u32)model->addressEnd - (u32)model->addressStart;
-    void* assetMemoryChunk = malloc(length);
-    romCopy(model->addressStart, assetMemoryChunk, length);
+    int length;
+    void* assetMemoryChunk = arenaMalloc(&gAssetArena, compressedSegmentMemorySize(model->addressStart, model->addressEnd, &length));
+    compressedSegmentLoad(model->addressStart, model->addressEnd, assetMemoryChunk);
     u32 pointerOffset = (u32)assetMemoryChunk - (u32)model->segmentStart;
 
+    dynamicAssetApplyRelocations(model->relocations, pointerOffset);
+
     result->armature = ADJUST_POINTER_POS(model->armature, pointerOffset);
 
-    result->armature->displayList = dynamicAssetFixModelPointers(result->armature->displayList, pointerOffset, (u32)model->segmentStart, (u32)model->segmentStart + length);
+    result->armature->displayList = ADJUST_POINTER_POS(result->armature->displayList, pointerOffset);
     result->armature->pose = ADJUST_POINTER_POS(result->armature->pose, pointerOffset);
     result->armature->boneParentIndex = ADJUST_POINTER_POS(result->armature->boneParentIndex, pointerOffset);
 
@@ -113,35 +184,110 @@ void dynamicAssetLoadAnimatedModel(struct DynamicAnimatedAssetModel* model, stru
 
     for (int i = 0; i < model->clipCount; i++) {
         result->clips[i] = ADJUST_POINTER_POS(result->clips[i], pointerOffset);
+
+        struct SKAnimationCompression* compression = ADJUST_POINTER_POS(result->clips[i]->compression, pointerOffset);
+        result->clips[i]->compression = compression;
+
+        if (compression) {
+            // keyframes stay in the animation segment
+            compression->keyframeTimes = ADJUST_POINTER_POS(compression->keyframeTimes, pointerOffset);
+            compression->boneFlags = ADJUST_POINTER_POS(compression->boneFlags, pointerOffset);
+            compression->constantPose = ADJUST_POINTER_POS(compression->constantPose, pointerOffset);
+        }
     }
 
     result->clipCount = model->clipCount;
 
+    osWritebackDCache(assetMemoryChunk, length);
     profileMapAddress(result->armature->displayList, model->name);
 }
 
 void dynamicAssetModelPreload(int index) {
-    if (index < 0 || index >= DYNAMIC_MODEL_COUNT || gLoadedModels[index] ) {
+    if (index < 0 || index >= DYNAMIC_MODEL_COUNT || sModelCache[index].state != DynamicModelStateUnloaded) {
         return;
     }
 
-    gLoadedModels[index] = dynamicAssetLoadModel(&gDynamicModels[index], &gModelPointerOffset[index]);
+    dynamicAssetStartLoad(index);
+}
+
+void dynamicAssetsPreloadHints(short* modelIndices, int count) {
+    for (int i = 0; i < count; ++i) {
+        dynamicAssetModelPreload(modelIndices[i]);
+    }
 }
 
 Gfx* dynamicAssetModel(int index) {
-    if (index < 0 || index >= DYNAMIC_MODEL_COUNT || !gLoadedModels[index]) {
+    if (index < 0 || index >= DYNAMIC_MODEL_COUNT) {
         return gBlankGfx;
     }
 
-    return gLoadedModels[index];
+    struct DynamicModelCacheEntry* entry = &sModelCache[index];
+    entry->framesSinceUse = 0;
+
+    if (entry->state == DynamicModelStateLoaded) {
+        ++sStats.hits;
+        return entry->model;
+    }
+
+    if (entry->state == DynamicModelStateUnloaded) {
+        ++sStats.misses;
+        dynamicAssetStartLoad(index);
+    }
+
+    if (entry->state == DynamicModelStateLoading) {
+        dynamicAssetUpdateLoad(index, DYNAMIC_MODEL_LOAD_BYTES);
+    }
+
+    // drawn as nothing until it finishes loading
+    return entry->state == DynamicModelStateLoaded ? entry->model : gBlankGfx;
 }
 
 void* dynamicAssetFixPointer(int index, void* ptr) {
-    if (index < 0 || index >= DYNAMIC_MODEL_COUNT || !gLoadedModels[index]) {
+    if (index < 0 || index >= DYNAMIC_MODEL_COUNT) {
+        return NULL;
+    }
+
+    struct DynamicModelCacheEntry* entry = &sModelCache[index];
+
+    if (entry->state == DynamicModelStateUnloaded) {
+        dynamicAssetStartLoad(index);
+    }
+
+    // callers expect the data to be there right away
+    if (entry->state == DynamicModelStateLoading) {
+        compressedSegmentStreamFinish(&entry->stream);
+        dynamicAssetFinishLoad(index);
+    }
+
+    if (entry->state != DynamicModelStateLoaded) {
         return NULL;
     }
 
-    return (void*)ADJUST_POINTER_POS(ptr, gModelPointerOffset[index]);
+    entry->isPinned = 1;
+
+    return (void*)ADJUST_POINTER_POS(ptr, entry->pointerOffset);
+}
+
+void dynamicAssetsUpdate() {
+    for (int i = 0; i < DYNAMIC_MODEL_COUNT; ++i) {
+        if (sModelCache[i].state == DynamicModelStateLoading) {
+            dynamicAssetUpdateLoad(i, DYNAMIC_MODEL_LOAD_BYTES);
+        }
+    }
+}
+
+void dynamicAssetsFrameDone() {
+    for (int i = 0; i < DYNAMIC_MODEL_COUNT; ++i) {
+        struct DynamicModelCacheEntry* entry = &sModelCache[i];
+
+        if (entry->framesSinceUse < 0xFFFF) {
+            ++entry->framesSinceUse;
+        }
+    }
+}
+
+struct DynamicAssetStats* dynamicAssetsStats() {
+    return &sStats;
 }
 
 struct SKArmatureWithAnimations* dynamicAssetAnimatedModel(int index) {
@@ -13,13 +13,32 @@ struct SKArmatureWithAnimations {
     short clipCount;
 };
 
+struct DynamicAssetStats {
+    // requests for a model that was already loaded
+    int hits;
+    // requests that had to start loading a model
+    int misses;
+    int evictions;
+    int cacheBytes;
+};
+
 void dynamicAssetsReset();
 
+// Static models are loaded in the background on first use and
+// evicted when unused once the cache is over budget
 void dynamicAssetModelPreload(int index);
+void dynamicAssetsPreloadHints(short* modelIndices, int count);
+// Returns gBlankGfx until the model has loaded
 Gfx* dynamicAssetModel(int index);
 
+// Loads the model right away and keeps it loaded for the rest of the level
 void* dynamicAssetFixPointer(int index, void* ptr);
 
+void dynamicAssetsUpdate();
+// Called once a frame has finished drawing
+void dynamicAssetsFrameDone();
+struct DynamicAssetStats* dynamicAssetsStats();
+
 struct SKArmatureWithAnimations* dynamicAssetAnimatedModel(int index);
 struct SKAnimationClip* dynamicAssetClip(int index, int clipIndex);
 
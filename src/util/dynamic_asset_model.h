@@ -11,6 +11,8 @@ struct DynamicAssetModel {
     void* addressEnd;
     void* segmentStart;
     Gfx* model;
+    // NULL terminated list of pointers to adjust once loaded
+    void** relocations;
     char* name;
 };
 
@@ -21,6 +23,7 @@ struct DynamicAnimatedAssetModel {
     struct SKArmatureDefinition* armature;
     struct SKAnimationClip** clips;
     short clipCount;
+    void** relocations;
     char* name;
 };
 
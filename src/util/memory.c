@@ -1,9 +1,23 @@
 #include "memory.h"
 
+#include <stdint.h>
+
 struct HeapSegment* gFirstFreeSegment;
 void* gHeapStart;
 void* gHeapEnd;
 
+static const unsigned short gSlabClassSizes[SLAB_CLASS_COUNT] = {16, 32, 64, 128};
+
+// pages with at least one free slot
+struct SlabPage* gSlabPages[SLAB_CLASS_COUNT];
+int gSlabPageCount;
+int gSlabBytesUsed;
+
+int gMemoryTagBytes[MemoryTagCount];
+
+struct MemoryArena gLevelArena;
+struct MemoryArena gAssetArena;
+
 
 void heapInitBlock(struct HeapSegment* segment, void* end, int type)
 {
@@ -23,11 +37,19 @@ void heapInitBlock(struct HeapSegment* segment, void* end, int type)
 
 void heapInit(void* heapStart, void* heapEnd)
 {
-    gFirstFreeSegment = (struct HeapSegment*)(((int)heapStart + 7) & ~0x7);
+    gFirstFreeSegment = (struct HeapSegment*)ALIGN_8((uintptr_t)heapStart);
     heapInitBlock(gFirstFreeSegment, heapEnd, MALLOC_FREE_BLOCK);
 
     gHeapStart = gFirstFreeSegment;
     gHeapEnd = heapEnd;
+
+    zeroMemory(gSlabPages, sizeof(gSlabPages));
+    gSlabPageCount = 0;
+    gSlabBytesUsed = 0;
+
+    zeroMemory(gMemoryTagBytes, sizeof(gMemoryTagBytes));
+    arenaInit(&gLevelArena, MemoryTagLevel);
+    arenaInit(&gAssetArena, MemoryTagAssets);
 }
 
 void heapReset() {
@@ -36,7 +58,7 @@ void heapReset() {
 
 void *cacheFreePointer(void* target)
 {
-    return (void*)(((int)target & 0x0FFFFFFF) | 0xA0000000);
+    return (void*)(((uintptr_t)target & 0x0FFFFFFF) | 0xA0000000);
 }
 
 void removeHeapSegment(struct HeapSegment* segment)
@@ -92,6 +114,57 @@ void insertHeapSegment(struct HeapSegment* at, struct HeapSegment* segment)
     }
 }
 
+void heapInitKeep(void* heapStart, void* heapEnd, void* keep)
+{
+    struct HeapUsedSegment* segment = (struct HeapUsedSegment*)keep - 1;
+
+    // checked before heapInit since a block at either end of the
+    // heap shares its header or footer with the new free block
+    if (!keep || (void*)segment < heapStart || (void*)keep >= heapEnd || segment->header != (MALLOC_BLOCK_HEAD | MALLOC_USED_BLOCK) || segment->segmentEnd > heapEnd)
+    {
+        heapInit(heapStart, heapEnd);
+        return;
+    }
+
+    void* segmentEnd = segment->segmentEnd;
+    struct HeapSegmentFooter* footer = (struct HeapSegmentFooter*)segmentEnd - 1;
+    int tag = MALLOC_FOOT_GET_TAG(footer->footer);
+
+    heapInit(heapStart, heapEnd);
+    removeHeapSegment(gFirstFreeSegment);
+
+    // a gap too small to be a free block is lost until the next init. It
+    // is cleared so stale block markers from the old heap can't be
+    // mistaken for a neighbor when the kept block is freed
+    int gapBefore = (char*)segment - (char*)gHeapStart;
+
+    if (gapBefore >= MIN_HEAP_BLOCK_SIZE)
+    {
+        heapInitBlock(gHeapStart, segment, MALLOC_FREE_BLOCK);
+        insertHeapSegment(0, gHeapStart);
+    }
+    else
+    {
+        zeroMemory(gHeapStart, gapBefore);
+    }
+
+    int gapAfter = (char*)gHeapEnd - (char*)segmentEnd;
+
+    if (gapAfter >= MIN_HEAP_BLOCK_SIZE)
+    {
+        heapInitBlock(segmentEnd, gHeapEnd, MALLOC_FREE_BLOCK);
+        insertHeapSegment(0, segmentEnd);
+    }
+    else
+    {
+        zeroMemory(segmentEnd, gapAfter);
+    }
+
+    heapInitBlock((struct HeapSegment*)segment, segmentEnd, MALLOC_USED_BLOCK);
+    footer->footer |= MALLOC_FOOT_TAG(tag);
+    gMemoryTagBytes[tag] += (char*)segmentEnd - (char*)segment;
+}
+
 struct HeapSegment* getPrevBlock(struct HeapSegment* at, int type)
 {
     struct HeapSegmentFooter* prevFooter = (struct HeapSegmentFooter*)at - 1;
@@ -126,7 +199,7 @@ struct HeapSegment* getNextBlock(struct HeapSegment* at, int type)
     return (struct HeapSegment*)nextHeader;
 }
 
-void *malloc(unsigned int size)
+void *heapMalloc(unsigned int size, enum MemoryTag tag)
 {
     struct HeapSegment* currentSegment;
     int segmentSize;
@@ -140,7 +213,7 @@ void *malloc(unsigned int size)
 
     while (currentSegment)
     {
-        segmentSize = (int)currentSegment->segmentEnd - (int)currentSegment;
+        segmentSize = (char*)currentSegment->segmentEnd - (char*)currentSegment;
 
         if (segmentSize >= size)
         {
@@ -164,6 +237,7 @@ void *malloc(unsigned int size)
             }
 
             heapInitBlock((struct HeapSegment*)newSegment, newEnd, MALLOC_USED_BLOCK);
+            ((struct HeapSegmentFooter*)newEnd - 1)->footer |= MALLOC_FOOT_TAG(tag);
 
             return newSegment + 1;
         }
@@ -240,13 +314,8 @@ void *realloc(void* target, unsigned int size)
     return result;
 }
 
-void free(void* target)
+void heapFree(void* target)
 {
-    if ((void*)target < gHeapStart || (void*)target >= gHeapEnd)
-    {
-        return;
-    }
-
     struct HeapUsedSegment* segment = (struct HeapUsedSegment*)target - 1;  
 
     struct HeapSegment* prev = getPrevBlock((struct HeapSegment*)segment, MALLOC_FREE_BLOCK);
@@ -270,6 +339,288 @@ void free(void* target)
     insertHeapSegment(0, (struct HeapSegment*)segment);
 }
 
+// slots are 16 byte aligned so slab memory can hold anything the
+// heap can, including matrices and DMA targets
+#define SLAB_SLOT_SIZE(classIndex) ALIGN_16(gSlabClassSizes[classIndex] + sizeof(struct SlabObject))
+
+void slabUnlinkPage(struct SlabPage* page)
+{
+    if (page->prevPage)
+    {
+        page->prevPage->nextPage = page->nextPage;
+    }
+    else
+    {
+        gSlabPages[page->classIndex] = page->nextPage;
+    }
+
+    if (page->nextPage)
+    {
+        page->nextPage->prevPage = page->prevPage;
+    }
+}
+
+void slabLinkPage(struct SlabPage* page)
+{
+    page->prevPage = 0;
+    page->nextPage = gSlabPages[page->classIndex];
+
+    if (page->nextPage)
+    {
+        page->nextPage->prevPage = page;
+    }
+
+    gSlabPages[page->classIndex] = page;
+}
+
+// free slots keep the next free slot where the caller's data would be
+#define SLAB_NEXT_FREE(object) (*(struct SlabObject**)((object) + 1))
+
+struct SlabPage* slabAllocPage(int classIndex)
+{
+    // pages aren't counted towards a tag, their slots are
+    struct SlabPage* page = heapMalloc(SLAB_PAGE_SIZE, MemoryTagGeneral);
+
+    if (!page)
+    {
+        return 0;
+    }
+
+    int slotSize = SLAB_SLOT_SIZE(classIndex);
+    // the heap only aligns the page to 8 bytes
+    char* slot = (char*)ALIGN_16((uintptr_t)(page + 1) + sizeof(struct SlabObject)) - sizeof(struct SlabObject);
+    char* pageEnd = (char*)page + SLAB_PAGE_SIZE;
+
+    page->classIndex = classIndex;
+    page->usedCount = 0;
+    page->freeList = 0;
+
+    while (slot + slotSize <= pageEnd)
+    {
+        struct SlabObject* object = (struct SlabObject*)slot;
+        object->header = 0;
+        object->page = page;
+        SLAB_NEXT_FREE(object) = page->freeList;
+        page->freeList = object;
+
+        slot += slotSize;
+    }
+
+    slabLinkPage(page);
+    ++gSlabPageCount;
+
+    return page;
+}
+
+void *slabMalloc(int classIndex, enum MemoryTag tag)
+{
+    struct SlabPage* page = gSlabPages[classIndex];
+
+    if (!page)
+    {
+        page = slabAllocPage(classIndex);
+
+        if (!page)
+        {
+            return 0;
+        }
+    }
+
+    struct SlabObject* object = page->freeList;
+    page->freeList = SLAB_NEXT_FREE(object);
+    ++page->usedCount;
+
+    if (!page->freeList)
+    {
+        slabUnlinkPage(page);
+    }
+
+    object->header = MALLOC_SLAB_HEAD | tag;
+    gSlabBytesUsed += gSlabClassSizes[classIndex];
+    gMemoryTagBytes[tag] += gSlabClassSizes[classIndex];
+
+    return object + 1;
+}
+
+void slabFree(struct SlabObject* object)
+{
+    struct SlabPage* page = object->page;
+    int wasFull = !page->freeList;
+
+    gMemoryTagBytes[object->header & ~MALLOC_HEAD_MASK] -= gSlabClassSizes[page->classIndex];
+    object->header = 0;
+    SLAB_NEXT_FREE(object) = page->freeList;
+    page->freeList = object;
+    --page->usedCount;
+    gSlabBytesUsed -= gSlabClassSizes[page->classIndex];
+
+    if (page->usedCount == 0)
+    {
+        // give empty pages back so the heap can reuse them for any size
+        if (!wasFull)
+        {
+            slabUnlinkPage(page);
+        }
+
+        heapFree(page);
+        --gSlabPageCount;
+    }
+    else if (wasFull)
+    {
+        slabLinkPage(page);
+    }
+}
+
+void *mallocTagged(unsigned int size, enum MemoryTag tag)
+{
+    if (size <= SLAB_MAX_SIZE)
+    {
+        for (int classIndex = 0; classIndex < SLAB_CLASS_COUNT; ++classIndex)
+        {
+            if (size <= gSlabClassSizes[classIndex])
+            {
+                void* result = slabMalloc(classIndex, tag);
+
+                if (result)
+                {
+                    return result;
+                }
+
+                break;
+            }
+        }
+    }
+
+    struct HeapUsedSegment* result = heapMalloc(size, tag);
+
+    if (result)
+    {
+        gMemoryTagBytes[tag] += (char*)result[-1].segmentEnd - (char*)(result - 1);
+    }
+
+    return result;
+}
+
+void *malloc(unsigned int size)
+{
+    return mallocTagged(size, MemoryTagGeneral);
+}
+
+void free(void* target)
+{
+    if ((void*)target < gHeapStart || (void*)target >= gHeapEnd)
+    {
+        return;
+    }
+
+    struct SlabObject* object = (struct SlabObject*)target - 1;
+
+    if ((object->header & MALLOC_HEAD_MASK) == MALLOC_SLAB_HEAD)
+    {
+        slabFree(object);
+        return;
+    }
+
+    struct HeapUsedSegment* segment = (struct HeapUsedSegment*)target - 1;
+    struct HeapSegmentFooter* footer = (struct HeapSegmentFooter*)segment->segmentEnd - 1;
+    gMemoryTagBytes[MALLOC_FOOT_GET_TAG(footer->footer)] -= (char*)segment->segmentEnd - (char*)segment;
+
+    heapFree(target);
+}
+
+void arenaInit(struct MemoryArena* arena, enum MemoryTag tag)
+{
+    arena->chunk = 0;
+    arena->current = 0;
+    arena->end = 0;
+    arena->tag = tag;
+}
+
+struct MemoryArenaChunk* arenaAllocChunk(struct MemoryArena* arena, int size)
+{
+    struct MemoryArenaChunk* chunk = heapMalloc(size, arena->tag);
+
+    if (!chunk)
+    {
+        return 0;
+    }
+
+    chunk->size = size;
+    gMemoryTagBytes[arena->tag] += size;
+
+    return chunk;
+}
+
+void* arenaMalloc(struct MemoryArena* arena, unsigned int size)
+{
+    // 8 byte align for DMA
+    size = ALIGN_8(size);
+
+    if (arena->current + size <= arena->end)
+    {
+        void* result = arena->current;
+        arena->current += size;
+        return result;
+    }
+
+    int chunkHeaderSize = ALIGN_8(sizeof(struct MemoryArenaChunk));
+
+    if (size > MEMORY_ARENA_CHUNK_SIZE / 2)
+    {
+        // large allocations get their own chunk so the
+        // space left in the current chunk isn't wasted
+        struct MemoryArenaChunk* chunk = arenaAllocChunk(arena, size + chunkHeaderSize);
+
+        if (!chunk)
+        {
+            return 0;
+        }
+
+        if (arena->chunk)
+        {
+            chunk->prevChunk = arena->chunk->prevChunk;
+            arena->chunk->prevChunk = chunk;
+        }
+        else
+        {
+            chunk->prevChunk = 0;
+            arena->chunk = chunk;
+            arena->current = arena->end;
+        }
+
+        return (char*)chunk + chunkHeaderSize;
+    }
+
+    struct MemoryArenaChunk* chunk = arenaAllocChunk(arena, MEMORY_ARENA_CHUNK_SIZE);
+
+    if (!chunk)
+    {
+        return 0;
+    }
+
+    chunk->prevChunk = arena->chunk;
+    arena->chunk = chunk;
+    arena->current = (char*)chunk + chunkHeaderSize + size;
+    arena->end = (char*)chunk + MEMORY_ARENA_CHUNK_SIZE;
+
+    return (char*)chunk + chunkHeaderSize;
+}
+
+void arenaReset(struct MemoryArena* arena)
+{
+    struct MemoryArenaChunk* chunk = arena->chunk;
+
+    while (chunk)
+    {
+        struct MemoryArenaChunk* prevChunk = chunk->prevChunk;
+        gMemoryTagBytes[arena->tag] -= chunk->size;
+        heapFree(chunk);
+        chunk = prevChunk;
+    }
+
+    arenaInit(arena, arena->tag);
+}
+
 int calculateHeapSize() {
     return (char*)gHeapEnd - (char*)gHeapStart;
 }
@@ -283,7 +634,7 @@ int calculateBytesFree()
     result = 0;
 
     while (currentSegment != 0) {
-        result += (int)currentSegment->segmentEnd - (int)currentSegment;
+        result += (char*)currentSegment->segmentEnd - (char*)currentSegment;
         currentSegment = currentSegment->nextSegment;
     }
 
@@ -300,7 +651,7 @@ int calculateLargestFreeChunk()
     result = 0;
 
     while (currentSegment != 0) {
-        current = (int)currentSegment->segmentEnd - (int)currentSegment;
+        current = (char*)currentSegment->segmentEnd - (char*)currentSegment;
 
         if (current > result)
         {
@@ -313,10 +664,64 @@ int calculateLargestFreeChunk()
     return result;
 }
 
+// How much of the free memory can't be used by the largest allocation
+int calculateFragmentationPercent()
+{
+    int bytesFree = calculateBytesFree();
+
+    if (!bytesFree)
+    {
+        return 0;
+    }
+
+    return 100 - (calculateLargestFreeChunk() * 100) / bytesFree;
+}
+
+int calculateSlabBytesReserved()
+{
+    return gSlabPageCount * SLAB_PAGE_SIZE;
+}
+
+int calculateSlabBytesUsed()
+{
+    return gSlabBytesUsed;
+}
+
+int calculateTagBytes(enum MemoryTag tag)
+{
+    return gMemoryTagBytes[tag];
+}
+
 void zeroMemory(void* memory, int size)
 {
     unsigned char* asChar = (unsigned char*)memory;
-    
+
+    // head, until the pointer is 8 byte aligned
+    while (size > 0 && ((uintptr_t)asChar & 0x7)) {
+        *asChar = 0;
+        ++asChar;
+        --size;
+    }
+
+    unsigned long long* asLong = (unsigned long long*)asChar;
+
+    while (size >= 32) {
+        asLong[0] = 0;
+        asLong[1] = 0;
+        asLong[2] = 0;
+        asLong[3] = 0;
+        asLong += 4;
+        size -= 32;
+    }
+
+    while (size >= 8) {
+        *asLong = 0;
+        ++asLong;
+        size -= 8;
+    }
+
+    asChar = (unsigned char*)asLong;
+
     while (size > 0) {
         *asChar = 0;
         ++asChar;
@@ -327,10 +732,60 @@ void zeroMemory(void* memory, int size)
 void memCopy(void* target, const void* src, int size)
 {
     unsigned char* targetAsChar;
-    unsigned char* srcAsChar;
+    const unsigned char* srcAsChar;
 
     targetAsChar = (unsigned char*)target;
-    srcAsChar = (unsigned char*)src;
+    srcAsChar = (const unsigned char*)src;
+
+    // the wide loops need both pointers to share alignment
+    if (size >= 16 && (((uintptr_t)targetAsChar ^ (uintptr_t)srcAsChar) & 0x3) == 0) {
+        int alignMask = (((uintptr_t)targetAsChar ^ (uintptr_t)srcAsChar) & 0x7) ? 0x3 : 0x7;
+
+        while (size > 0 && ((uintptr_t)targetAsChar & alignMask)) {
+            *targetAsChar = *srcAsChar;
+            ++targetAsChar;
+            ++srcAsChar;
+            --size;
+        }
+
+        if (alignMask == 0x7) {
+            unsigned long long* targetAsLong = (unsigned long long*)targetAsChar;
+            const unsigned long long* srcAsLong = (const unsigned long long*)srcAsChar;
+
+            while (size >= 32) {
+                targetAsLong[0] = srcAsLong[0];
+                targetAsLong[1] = srcAsLong[1];
+                targetAsLong[2] = srcAsLong[2];
+                targetAsLong[3] = srcAsLong[3];
+                targetAsLong += 4;
+                srcAsLong += 4;
+                size -= 32;
+            }
+
+            while (size >= 8) {
+                *targetAsLong = *srcAsLong;
+                ++targetAsLong;
+                ++srcAsLong;
+                size -= 8;
+            }
+
+            targetAsChar = (unsigned char*)targetAsLong;
+            srcAsChar = (const unsigned char*)srcAsLong;
+        } else {
+            unsigned int* targetAsInt = (unsigned int*)targetAsChar;
+            const unsigned int* srcAsInt = (const unsigned int*)srcAsChar;
+
+            while (size >= 4) {
+                *targetAsInt = *srcAsInt;
+                ++targetAsInt;
+                ++srcAsInt;
+                size -= 4;
+            }
+
+            targetAsChar = (unsigned char*)targetAsInt;
+            srcAsChar = (const unsigned char*)srcAsInt;
+        }
+    }
     
     while (size > 0) {
         *targetAsChar = *srcAsChar;
@@ -344,6 +799,7 @@ void memCopy(void* target, const void* src, int size)
 #define STACK_MALLOC_SIZE_WORDS (STACK_MALLOC_SIZE_BYTES >> 3)
 
 int gStackMallocAt;
+int gStackMallocPeak;
 long long gStackMalloc[STACK_MALLOC_SIZE_WORDS];
 
 void stackMallocReset() {
@@ -362,5 +818,19 @@ void* stackMalloc(int size) {
     int nWords = (size + 7) >> 3;
     void* result = &gStackMalloc[gStackMallocAt];
     gStackMallocAt += nWords;
+
+    if (gStackMallocAt > gStackMallocPeak) {
+        gStackMallocPeak = gStackMallocAt;
+    }
+
     return result;
+}
+
+// called on level load so the peak reflects the current level
+void stackMallocResetPeak() {
+    gStackMallocPeak = gStackMallocAt;
+}
+
+int stackMallocPeakBytes() {
+    return gStackMallocPeak << 3;
 }
\ No newline at end of file
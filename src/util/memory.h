@@ -17,6 +17,21 @@ extern struct HeapSegment* gFirstHeapSegment;
 
 #define MALLOC_BLOCK_HEAD 0xEEAD0000
 #define MALLOC_BLOCK_FOOT 0xF0000000
+#define MALLOC_SLAB_HEAD  0xEE5B0000
+#define MALLOC_HEAD_MASK  0xFFFF0000
+
+// used blocks keep their tag in the unused bits of the footer
+#define MALLOC_FOOT_TAG(tag)        ((tag) << 16)
+#define MALLOC_FOOT_GET_TAG(footer) (((footer) >> 16) & 0xFF)
+
+// Who owns an allocation, only used for accounting
+enum MemoryTag {
+    MemoryTagGeneral,
+    MemoryTagLevel,
+    MemoryTagAssets,
+    MemoryTagUI,
+    MemoryTagCount,
+};
 
 struct HeapUsedSegment
 {
@@ -40,20 +55,80 @@ struct HeapSegmentFooter
 
 #define MIN_HEAP_BLOCK_SIZE (sizeof(struct HeapSegment) + sizeof(struct HeapSegmentFooter))
 
+// Small allocations are served from fixed size slots in slab pages
+// that are themselves allocated from the heap
+#define SLAB_PAGE_SIZE      2048
+#define SLAB_CLASS_COUNT    4
+#define SLAB_MAX_SIZE       128
+
+// Sits right before the memory returned from malloc, laid out
+// like HeapUsedSegment so free can tell the two apart. The header
+// is MALLOC_SLAB_HEAD combined with the allocation's tag
+struct SlabObject
+{
+    unsigned int header;
+    struct SlabPage* page;
+};
+
+struct SlabPage
+{
+    struct SlabPage* nextPage;
+    struct SlabPage* prevPage;
+    struct SlabObject* freeList;
+    short classIndex;
+    short usedCount;
+};
+
+// Bump allocator for memory that lives until the heap is reset.
+// Memory from an arena must not be passed to free
+#define MEMORY_ARENA_CHUNK_SIZE (4 * 1024)
+
+struct MemoryArenaChunk
+{
+    struct MemoryArenaChunk* prevChunk;
+    int size;
+};
+
+struct MemoryArena
+{
+    struct MemoryArenaChunk* chunk;
+    char* current;
+    char* end;
+    enum MemoryTag tag;
+};
+
+// cleared whenever the heap is initialized, so a level
+// change tears them down without walking allocations
+extern struct MemoryArena gLevelArena;
+extern struct MemoryArena gAssetArena;
+
 void heapInit(void* heapStart, void* heapEnd);
+// like heapInit but the block keep was allocated from survives
+void heapInitKeep(void* heapStart, void* heapEnd, void* keep);
 void heapReset();
 void *cacheFreePointer(void* target);
 void *malloc(unsigned int size);
+void *mallocTagged(unsigned int size, enum MemoryTag tag);
 void *realloc(void* target, unsigned int size);
 void free(void* target);
 int calculateBytesFree();
 int calculateHeapSize();
 int calculateLargestFreeChunk();
+int calculateFragmentationPercent();
+int calculateSlabBytesReserved();
+int calculateSlabBytesUsed();
+int calculateTagBytes(enum MemoryTag tag);
+
+void arenaInit(struct MemoryArena* arena, enum MemoryTag tag);
+void* arenaMalloc(struct MemoryArena* arena, unsigned int size);
+void arenaReset(struct MemoryArena* arena);
 extern void zeroMemory(void* memory, int size);
 extern void memCopy(void* target, const void* src, int size);
 
 void stackMallocReset();
 void stackMallocFree(void* ptr);
 void* stackMalloc(int size);
+void stackMallocResetPeak();
+int stackMallocPeakBytes();
 
 #endif
\ No newline at end of file
@@ -0,0 +1,393 @@
+#include "test.h"
+
+#include "system/libultra/audio_dma_libultra.h"
+
+TEST_DEFINE_FAILURES
+
+#define TEST_ROM_SIZE       (1024 * 1024)
+#define TEST_HEAP_SIZE      (AUDIO_DMA_BUFFER_COUNT * AUDIO_DMA_SIZE)
+#define TEST_MAX_READS      64
+
+// bytes a voice reads each audio frame, 368 samples at 22050hz
+// and 60fps with ADPCM packing 16 samples into 9 bytes
+#define TEST_FRAME_READ     208
+
+static u8 gRom[TEST_ROM_SIZE];
+static u8 gHeap[TEST_HEAP_SIZE];
+static int gHeapUsed;
+
+static OSPiHandle gCartHandle;
+static ALHeap gAudioHeap;
+
+// Mock PI. Transfers copy from the mock ROM straight away but aren't
+// reported done until the test lets them finish
+static int gPendingDmas;
+static int gHoldDmas;
+static int gPiDmaCount;
+static OSIoMesg gLastDma;
+
+struct TestRead {
+    s32 addr;
+    s32 len;
+    s32 phys;
+};
+
+// reads made this frame, checked once the transfers are started
+static struct TestRead gReads[TEST_MAX_READS];
+static int gReadCount;
+
+s32 mockK0ToPhys(void* address) {
+    return (u8*)address - gHeap;
+}
+
+void* alHeapAlloc(ALHeap* hp, s32 num, s32 size) {
+    void* result = &gHeap[gHeapUsed];
+    gHeapUsed += num * size;
+    TEST_CHECK(gHeapUsed <= TEST_HEAP_SIZE);
+    return result;
+}
+
+void osCreateMesgQueue(OSMesgQueue* mq, OSMesg* msg, s32 count) {
+    mq->validCount = 0;
+    mq->first = 0;
+    mq->msgCount = count;
+    mq->msg = msg;
+}
+
+s32 osRecvMesg(OSMesgQueue* mq, OSMesg* msg, s32 flag) {
+    TEST_CHECK(flag == OS_MESG_NOBLOCK);
+
+    if (gHoldDmas || gPendingDmas == 0) {
+        return -1;
+    }
+
+    --gPendingDmas;
+    return 0;
+}
+
+s32 osEPiStartDma(OSPiHandle* pihandle, OSIoMesg* mb, s32 direction) {
+    TEST_CHECK(pihandle == &gCartHandle);
+    TEST_CHECK(direction == OS_READ);
+    TEST_CHECK((mb->devAddr & 1) == 0);
+    TEST_CHECK(mb->devAddr + mb->size <= TEST_ROM_SIZE);
+    TEST_CHECK((u8*)mb->dramAddr >= gHeap && (u8*)mb->dramAddr + mb->size <= gHeap + TEST_HEAP_SIZE);
+    // the message queue only has room for this many
+    TEST_CHECK(gPendingDmas < AUDIO_MAX_DMA_TRANSFERS);
+
+    for (u32 i = 0; i < mb->size && mb->devAddr + i < TEST_ROM_SIZE; ++i) {
+        ((u8*)mb->dramAddr)[i] = gRom[mb->devAddr + i];
+    }
+
+    gLastDma = *mb;
+    ++gPendingDmas;
+    ++gPiDmaCount;
+    return 0;
+}
+
+static int testIsReadValid(struct TestRead* read) {
+    if (read->phys < 0 || read->phys + read->len > TEST_HEAP_SIZE) {
+        return 0;
+    }
+
+    for (int i = 0; i < read->len; ++i) {
+        if (gHeap[read->phys + i] != gRom[read->addr + i]) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static void testRequest(s32 addr, s32 len) {
+    struct TestRead* read = &gReads[gReadCount++];
+    read->addr = addr;
+    read->len = len;
+    read->phys = audioDmaRequest(addr, len, NULL);
+}
+
+// Does what the audio thread does once the command list is built
+// and returns how many reads got the wrong bytes
+static int testEndFrame() {
+    int result = 0;
+
+    audioDmaFlush();
+
+    for (int i = 0; i < gReadCount; ++i) {
+        if (!testIsReadValid(&gReads[i])) {
+            ++result;
+        }
+    }
+
+    gReadCount = 0;
+    audioDmaUpdate();
+
+    return result;
+}
+
+static void testInit() {
+    for (int i = 0; i < TEST_ROM_SIZE; ++i) {
+        gRom[i] = (u8)(i ^ (i >> 8) ^ (i >> 16));
+    }
+
+    gHeapUsed = 0;
+    gPendingDmas = 0;
+    gHoldDmas = 0;
+    gPiDmaCount = 0;
+    gReadCount = 0;
+
+    audioDmaInit(&gCartHandle, &gAudioHeap);
+
+    // the synthesizer has run a while before a sound plays
+    for (int i = 0; i < AUDIO_LINK_MIN_FRAMES_OLD; ++i) {
+        testEndFrame();
+    }
+}
+
+static void testMissThenHit() {
+    testInit();
+
+    testRequest(0x10000, 200);
+    // anything inside the same buffer is served without a transfer
+    testRequest(0x10000 + 1000, 200);
+    testRequest(0x10000 + 1500, 200);
+    TEST_CHECK(testEndFrame() == 0);
+
+    TEST_CHECK(gPiDmaCount == 1);
+    TEST_CHECK(gLastDma.devAddr == 0x10000);
+    TEST_CHECK(gLastDma.size == AUDIO_DMA_SIZE);
+
+    struct AudioDmaCounters* counters = audioDmaCounters();
+    TEST_CHECK(counters->misses == 1);
+    TEST_CHECK(counters->hits == 2);
+    TEST_CHECK(counters->prefetches == 0);
+    TEST_CHECK(counters->frameCount == 1);
+    TEST_CHECK(gPendingDmas == 0);
+}
+
+static void testOddAddress() {
+    testInit();
+
+    // the PI needs an even address so the odd byte is added back after
+    testRequest(0x20001, 101);
+    testRequest(0x20000, 1);
+    TEST_CHECK(testEndFrame() == 0);
+    TEST_CHECK(gLastDma.devAddr == 0x20000);
+    TEST_CHECK(gPiDmaCount == 1);
+}
+
+static void testLeastRecentlyUsed() {
+    testInit();
+
+    for (int i = 0; i < AUDIO_DMA_BUFFER_COUNT; ++i) {
+        testRequest(0x10000 + i * 0x1000, 100);
+        TEST_CHECK(testEndFrame() == 0);
+    }
+
+    TEST_CHECK(gPiDmaCount == AUDIO_DMA_BUFFER_COUNT);
+
+    // the first buffer was used most recently now so the second goes
+    testRequest(0x10000, 100);
+    TEST_CHECK(testEndFrame() == 0);
+    testRequest(0x80000, 100);
+    TEST_CHECK(testEndFrame() == 0);
+    TEST_CHECK(gPiDmaCount == AUDIO_DMA_BUFFER_COUNT + 1);
+
+    testRequest(0x10000, 100);
+    TEST_CHECK(testEndFrame() == 0);
+    TEST_CHECK(gPiDmaCount == AUDIO_DMA_BUFFER_COUNT + 1);
+    testRequest(0x11000, 100);
+    TEST_CHECK(testEndFrame() == 0);
+    TEST_CHECK(gPiDmaCount == AUDIO_DMA_BUFFER_COUNT + 2);
+}
+
+static void testNoFreeBuffer() {
+    testInit();
+
+    // buffers used this frame can't be replaced until the
+    // command list that reads them has run
+    for (int i = 0; i < AUDIO_DMA_BUFFER_COUNT; ++i) {
+        testRequest(0x10000 + i * 0x1000, 100);
+    }
+
+    testRequest(0x80000, 100);
+    TEST_CHECK(testEndFrame() == 1);
+    TEST_CHECK(gPiDmaCount == AUDIO_DMA_BUFFER_COUNT);
+    TEST_CHECK(audioDmaCounters()->misses == AUDIO_DMA_BUFFER_COUNT + 1);
+
+    testRequest(0x80000, 100);
+    TEST_CHECK(testEndFrame() == 0);
+}
+
+static void testTransfersInFlight() {
+    testInit();
+
+    // transfers that haven't finished keep their message slot
+    gHoldDmas = 1;
+
+    for (int i = 0; i < AUDIO_MAX_DMA_TRANSFERS; ++i) {
+        testRequest(0x10000 + i * 0x1000, 100);
+        TEST_CHECK(testEndFrame() == 0);
+    }
+
+    testRequest(0x80000, 100);
+    TEST_CHECK(testEndFrame() == 1);
+    TEST_CHECK(gPiDmaCount == AUDIO_MAX_DMA_TRANSFERS);
+
+    gHoldDmas = 0;
+    TEST_CHECK(testEndFrame() == 0);
+    TEST_CHECK(gPendingDmas == 0);
+
+    testRequest(0x80000, 100);
+    TEST_CHECK(testEndFrame() == 0);
+}
+
+static void testCoalesce() {
+    testInit();
+
+    // the read ahead lands in the buffers after the miss
+    // and they all go out as one transfer
+    testRequest(0x40000, TEST_FRAME_READ);
+    testRequest(0x40000 + AUDIO_DMA_SIZE - 100, 100);
+    TEST_CHECK(testEndFrame() == 0);
+
+    TEST_CHECK(gPiDmaCount == 1);
+    TEST_CHECK(gLastDma.devAddr == 0x40000);
+    TEST_CHECK(gLastDma.size == AUDIO_DMA_SIZE * (1 + AUDIO_PREFETCH_LINKED_BUFFERS));
+    TEST_CHECK(audioDmaCounters()->prefetches == AUDIO_PREFETCH_LINKED_BUFFERS);
+    TEST_CHECK(audioDmaCounters()->frameCount == 1);
+
+    // reads across the two buffers are served from both
+    testRequest(0x40000 + AUDIO_DMA_SIZE - 100, TEST_FRAME_READ);
+    testRequest(0x40000 + AUDIO_DMA_SIZE + 500, TEST_FRAME_READ);
+    TEST_CHECK(testEndFrame() == 0);
+    TEST_CHECK(audioDmaCounters()->misses == 1);
+    TEST_CHECK(gPiDmaCount == 1);
+
+    // a read running off the end of a cached buffer reads
+    // the one after it too, in a single transfer
+    testInit();
+
+    testRequest(0x60000, TEST_FRAME_READ);
+    TEST_CHECK(testEndFrame() == 0);
+    testRequest(0x60000 + AUDIO_DMA_SIZE - 50, TEST_FRAME_READ);
+    TEST_CHECK(testEndFrame() == 0);
+
+    TEST_CHECK(gPiDmaCount == 2);
+    TEST_CHECK(gLastDma.devAddr == 0x60000 + AUDIO_DMA_SIZE - 50);
+    TEST_CHECK(gLastDma.size == AUDIO_DMA_SIZE * (1 + AUDIO_PREFETCH_LINKED_BUFFERS));
+}
+
+static void testPrefetchSkipsRecentBuffers() {
+    testInit();
+
+    for (int i = 0; i < AUDIO_DMA_BUFFER_COUNT; ++i) {
+        testRequest(0x10000 + i * 0x1000, 100);
+    }
+
+    TEST_CHECK(testEndFrame() == 0);
+
+    // every buffer was read last frame so none are given up
+    testRequest(0x10000 + AUDIO_DMA_SIZE - 100, 100);
+    TEST_CHECK(testEndFrame() == 0);
+    TEST_CHECK(audioDmaCounters()->prefetches == 0);
+
+    for (int i = 1; i < AUDIO_DMA_BUFFER_COUNT; ++i) {
+        testRequest(0x10000 + i * 0x1000, 100);
+        TEST_CHECK(testEndFrame() == 0);
+        TEST_CHECK(audioDmaCounters()->misses == AUDIO_DMA_BUFFER_COUNT);
+    }
+}
+
+static void testDemandTransfersReserved() {
+    testInit();
+
+    gHoldDmas = 1;
+
+    for (int i = 0; i < AUDIO_MAX_DMA_TRANSFERS - AUDIO_DEMAND_DMA_TRANSFERS; ++i) {
+        testRequest(0x10000 + i * 0x1000, 100);
+        TEST_CHECK(testEndFrame() == 0);
+    }
+
+    // read ahead waits for transfers to finish
+    testRequest(0x10000 + AUDIO_DMA_SIZE - 100, 100);
+    TEST_CHECK(testEndFrame() == 0);
+    TEST_CHECK(audioDmaCounters()->prefetches == 0);
+
+    // but misses still get one
+    for (int i = 0; i < AUDIO_DEMAND_DMA_TRANSFERS; ++i) {
+        testRequest(0x80000 + i * 0x1000, 100);
+        TEST_CHECK(testEndFrame() == 0);
+    }
+
+    TEST_CHECK(gPiDmaCount == AUDIO_MAX_DMA_TRANSFERS);
+}
+
+static void testStreamReadAhead() {
+    testInit();
+
+    u32 address = 0x40000;
+    int frames = (AUDIO_DMA_SIZE * 8) / TEST_FRAME_READ;
+
+    for (int frame = 0; frame < frames; ++frame) {
+        testRequest(address, TEST_FRAME_READ);
+        address += TEST_FRAME_READ;
+        TEST_CHECK(testEndFrame() == 0);
+    }
+
+    // only the first read of the clip waits on the PI
+    TEST_CHECK(audioDmaCounters()->misses == 1);
+    TEST_CHECK(audioDmaCounters()->hits == frames - 1);
+    TEST_CHECK(gPiDmaCount <= 9);
+}
+
+static void testBusyScene() {
+    testInit();
+
+    // music and dialog streaming while effects play
+    u32 music = 0x10000;
+    u32 voice = 0x30001;
+    int piDmaCount = 0;
+    int streamMisses = 0;
+
+    for (int frame = 0; frame < 200; ++frame) {
+        int missesBefore = audioDmaCounters()->misses;
+
+        testRequest(music + frame * TEST_FRAME_READ, TEST_FRAME_READ);
+        testRequest(voice + frame * TEST_FRAME_READ, TEST_FRAME_READ);
+        streamMisses += audioDmaCounters()->misses - missesBefore;
+
+        testRequest(0x50000 + (frame % 7) * 0x1000, 200);
+
+        TEST_CHECK(testEndFrame() == 0);
+
+        piDmaCount += audioDmaCounters()->frameCount;
+        audioDmaCounters()->frameCount = 0;
+    }
+
+    struct AudioDmaCounters* counters = audioDmaCounters();
+    printf("busy scene: %d hits %d misses %d prefetches %d PI DMAs\n",
+        counters->hits, counters->misses, counters->prefetches, piDmaCount);
+
+    // one miss to start each stream and one for each effect
+    TEST_CHECK(streamMisses == 2);
+    TEST_CHECK(counters->misses == 2 + 7);
+    // both streams read 200 * 208 bytes, about 21 buffers each,
+    // which should mostly be read ahead two at a time. The cache
+    // before read ahead was coalesced took 55 transfers here
+    TEST_CHECK(piDmaCount <= 21 + 7 + 2 + 6);
+}
+
+int main() {
+    TEST_RUN(testMissThenHit);
+    TEST_RUN(testOddAddress);
+    TEST_RUN(testLeastRecentlyUsed);
+    TEST_RUN(testNoFreeBuffer);
+    TEST_RUN(testTransfersInFlight);
+    TEST_RUN(testCoalesce);
+    TEST_RUN(testPrefetchSkipsRecentBuffers);
+    TEST_RUN(testDemandTransfersReserved);
+    TEST_RUN(testStreamReadAhead);
+    TEST_RUN(testBusyScene);
+
+    return gTestFailures ? 1 : 0;
+}
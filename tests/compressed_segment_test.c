@@ -0,0 +1,293 @@
+#include "test.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "util/compressed_segment.h"
+
+TEST_DEFINE_FAILURES
+
+#define TEST_MAX_FIXTURES       64
+#define TEST_MAX_COPIES         8
+#define TEST_POISON             0xCD
+#define TEST_GUARD_SIZE         64
+#define TEST_BENCHMARK_RUNS     5
+
+struct TestFixture {
+    const char* name;
+    u8* data;
+    int size;
+    // the compressed file as it would sit in ROM
+    u8* rom;
+    int romSize;
+    struct CompressedSegmentHeader header;
+};
+
+// segment headers are cached by ROM address so every
+// fixture keeps its own ROM image for the whole run
+static struct TestFixture gFixtures[TEST_MAX_FIXTURES];
+static int gFixtureCount;
+
+// Mock ROM copies. An async copy only lands in memory once the test
+// lets it arrive, until then the destination keeps the poison value
+struct TestCopy {
+    const void* romAddr;
+    void* ramAddr;
+    int size;
+};
+
+static struct TestCopy gCopies[TEST_MAX_COPIES];
+static unsigned gStartedCopies;
+static unsigned gArrivedCopies;
+
+static void* gWritebackAddr;
+static int gWritebackSize;
+static int gWritebackCount;
+
+void romCopy(const void* romAddr, void* ramAddr, const int size) {
+    memcpy(ramAddr, romAddr, size);
+}
+
+unsigned romCopyAsync(const void* romAddr, void* ramAddr, const int size) {
+    TEST_CHECK(gStartedCopies - gArrivedCopies < TEST_MAX_COPIES);
+    // the PI moves whole 16 byte lines
+    TEST_CHECK(((uintptr_t)ramAddr & 0xF) == 0);
+
+    ++gStartedCopies;
+    gCopies[gStartedCopies % TEST_MAX_COPIES] = (struct TestCopy){romAddr, ramAddr, size};
+    return gStartedCopies;
+}
+
+static void testArriveCopies(unsigned ticket) {
+    while (gArrivedCopies < ticket) {
+        ++gArrivedCopies;
+        struct TestCopy* copy = &gCopies[gArrivedCopies % TEST_MAX_COPIES];
+        memcpy(copy->ramAddr, copy->romAddr, copy->size);
+    }
+}
+
+int romCopyAsyncIsDone(unsigned ticket) {
+    return ticket <= gArrivedCopies;
+}
+
+void romCopyAsyncWait(unsigned ticket) {
+    testArriveCopies(ticket);
+}
+
+void osWritebackDCache(void* vaddr, s32 nbytes) {
+    gWritebackAddr = vaddr;
+    gWritebackSize = nbytes;
+    ++gWritebackCount;
+}
+
+static u8* testReadFile(const char* filename, int* size) {
+    FILE* file = fopen(filename, "rb");
+
+    if (!file) {
+        fprintf(stderr, "could not open %s\n", filename);
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    *size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    // aligned so the ROM image can be copied like a segment
+    u8* result = aligned_alloc(16, (*size + 15) & ~15);
+
+    if (fread(result, 1, *size, file) != (size_t)*size) {
+        fprintf(stderr, "could not read %s\n", filename);
+        free(result);
+        result = NULL;
+    }
+
+    fclose(file);
+    return result;
+}
+
+static u32 testReadBigEndian(u8* bytes) {
+    return ((u32)bytes[0] << 24) | ((u32)bytes[1] << 16) | ((u32)bytes[2] << 8) | bytes[3];
+}
+
+static int testLoadFixture(struct TestFixture* fixture, const char* uncompressedFile, const char* compressedFile) {
+    const char* name = strrchr(uncompressedFile, '/');
+    fixture->name = name ? name + 1 : uncompressedFile;
+    fixture->data = testReadFile(uncompressedFile, &fixture->size);
+    fixture->rom = testReadFile(compressedFile, &fixture->romSize);
+
+    if (!fixture->data || !fixture->rom || fixture->romSize < (int)sizeof(struct CompressedSegmentHeader)) {
+        return 0;
+    }
+
+    // the header is big endian on the cart, swap it to what
+    // compressedSegmentReadHeader would read on the host
+    u32* words = (u32*)fixture->rom;
+
+    for (unsigned i = 0; i < sizeof(struct CompressedSegmentHeader) / sizeof(u32); ++i) {
+        words[i] = testReadBigEndian(fixture->rom + i * sizeof(u32));
+    }
+
+    fixture->header = *(struct CompressedSegmentHeader*)fixture->rom;
+    return 1;
+}
+
+static u8* testAllocWork(struct TestFixture* fixture) {
+    int workSize = compressedSegmentMemorySize((char*)fixture->rom, (char*)fixture->rom + fixture->romSize, NULL);
+    u8* result = aligned_alloc(16, workSize + TEST_GUARD_SIZE);
+    memset(result, TEST_POISON, workSize + TEST_GUARD_SIZE);
+    return result;
+}
+
+static int testGuardIntact(u8* work, int workSize) {
+    for (int i = 0; i < TEST_GUARD_SIZE; ++i) {
+        if (work[workSize + i] != TEST_POISON) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static void testResetCopies() {
+    gStartedCopies = 0;
+    gArrivedCopies = 0;
+    gWritebackCount = 0;
+}
+
+// Streams one fixture with copies arriving every arriveEvery updates
+// and at most maxBytes decompressed per update
+static void testStream(struct TestFixture* fixture, int maxBytes, int arriveEvery) {
+    u8* work = testAllocWork(fixture);
+    struct CompressedSegmentStream stream;
+    int updates = 0;
+    int inPlace = 1;
+    // every update either decompresses maxBytes or waits on a copy
+    int maxUpdates = (fixture->size / maxBytes + 2 + fixture->romSize / COMPRESSED_SEGMENT_CHUNK_SIZE) * arriveEvery + 16;
+
+    testResetCopies();
+    compressedSegmentStreamInit(&stream, (char*)fixture->rom, (char*)fixture->rom + fixture->romSize, work);
+
+    while (!compressedSegmentStreamUpdate(&stream, maxBytes)) {
+        // the output never runs into compressed bytes not read yet
+        inPlace = inPlace && stream.dst <= stream.src;
+
+        ++updates;
+
+        if (updates % arriveEvery == 0) {
+            testArriveCopies(gStartedCopies);
+        }
+
+        if (updates > maxUpdates) {
+            fprintf(stderr, "%s: stuck after %d updates\n", fixture->name, updates);
+            TEST_CHECK(0);
+            break;
+        }
+    }
+
+    TEST_CHECK(inPlace);
+    TEST_CHECK((int)fixture->header.uncompressedSize == fixture->size);
+    TEST_CHECK(memcmp(work, fixture->data, fixture->size) == 0);
+    TEST_CHECK(testGuardIntact(work, fixture->header.workSize));
+    // written back once, after the last byte
+    TEST_CHECK(gWritebackCount == 1);
+    TEST_CHECK(gWritebackAddr == work && gWritebackSize == fixture->size);
+
+    free(work);
+}
+
+static void testStreamSchedules() {
+    for (int i = 0; i < gFixtureCount; ++i) {
+        struct TestFixture* fixture = &gFixtures[i];
+
+        // single bytes and odd sizes stop partway through back references
+        testStream(fixture, 1, 1);
+        testStream(fixture, 7, 3);
+        testStream(fixture, 333, 1);
+        // chunks that arrive a few updates apart stall the decoder at
+        // the end of what has arrived
+        testStream(fixture, 4096, 5);
+        testStream(fixture, 0x7FFFFFFF, 2);
+    }
+}
+
+static void testLoad() {
+    for (int i = 0; i < gFixtureCount; ++i) {
+        struct TestFixture* fixture = &gFixtures[i];
+        u8* work = testAllocWork(fixture);
+
+        testResetCopies();
+        compressedSegmentLoad((char*)fixture->rom, (char*)fixture->rom + fixture->romSize, work);
+
+        TEST_CHECK(memcmp(work, fixture->data, fixture->size) == 0);
+        TEST_CHECK(testGuardIntact(work, fixture->header.workSize));
+        TEST_CHECK(gArrivedCopies == gStartedCopies);
+
+        free(work);
+    }
+}
+
+static double testSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static void testBenchmark() {
+    int totalSize = 0;
+    int totalRomSize = 0;
+
+    for (int i = 0; i < gFixtureCount; ++i) {
+        struct TestFixture* fixture = &gFixtures[i];
+        u8* work = testAllocWork(fixture);
+        double best = 0.0;
+
+        for (int run = 0; run < TEST_BENCHMARK_RUNS; ++run) {
+            testResetCopies();
+            double start = testSeconds();
+            compressedSegmentLoad((char*)fixture->rom, (char*)fixture->rom + fixture->romSize, work);
+            double time = testSeconds() - start;
+            best = run == 0 || time < best ? time : best;
+        }
+
+        TEST_CHECK(memcmp(work, fixture->data, fixture->size) == 0);
+        free(work);
+
+        printf("%s: %.1fK -> %.1fK saved %.1fK of ROM, decoded in %.2fms on the host\n",
+            fixture->name,
+            fixture->size / 1024.0f,
+            fixture->romSize / 1024.0f,
+            (fixture->size - fixture->romSize) / 1024.0f,
+            best * 1000.0
+        );
+
+        totalSize += fixture->size;
+        totalRomSize += fixture->romSize;
+    }
+
+    printf("total: saved %.1fK of ROM\n", (totalSize - totalRomSize) / 1024.0f);
+}
+
+// arguments are pairs of an uncompressed segment and the
+// file tools/compress_segments.js made from it
+int main(int argc, char** argv) {
+    if (argc < 3 || (argc - 1) % 2 != 0 || (argc - 1) / 2 > TEST_MAX_FIXTURES) {
+        fprintf(stderr, "usage: %s uncompressed compressed [uncompressed compressed ...]\n", argv[0]);
+        return 1;
+    }
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!testLoadFixture(&gFixtures[gFixtureCount], argv[i], argv[i + 1])) {
+            return 1;
+        }
+
+        TEST_CHECK(gFixtures[gFixtureCount].header.magic == COMPRESSED_SEGMENT_MAGIC);
+        ++gFixtureCount;
+    }
+
+    TEST_RUN(testStreamSchedules);
+    TEST_RUN(testLoad);
+    TEST_RUN(testBenchmark);
+
+    return gTestFailures ? 1 : 0;
+}
@@ -0,0 +1,430 @@
+#include "test.h"
+
+#include <string.h>
+#include <time.h>
+
+#include "font/dejavu_sans.h"
+#include "util/memory.h"
+
+TEST_DEFINE_FAILURES
+
+#define TEST_HEAP_SIZE          (512 * 1024)
+#define TEST_MAX_LANGUAGES      32
+#define TEST_MAX_STRINGS        64
+#define TEST_MAX_TOKENS         (TEST_MAX_STRINGS * 2 + 8)
+#define TEST_MAX_FILE_SIZE      (16 * 1024)
+#define TEST_BENCHMARK_RUNS     20
+#define TEST_CACHE_HITS         1000
+
+// must match GAME_MENU_REBUILD_STEPS in src/menu/game_menu.c
+#define TEST_MENU_REBUILD_STEPS 8
+// the widths the hud subtitle and the menus lay text out at
+#define TEST_SUBTITLE_WIDTH     (SCREEN_WD - (17 + 6) * 2)
+#define TEST_MENU_WIDTH         SCREEN_WD
+// where the rebuilt menu text goes, accents reach above the line
+#define TEST_MENU_X             16
+#define TEST_MENU_Y(index)      (16 + (index) * 14)
+
+static long long gTestHeap[TEST_HEAP_SIZE / sizeof(long long)];
+
+struct TestLanguage {
+    const char* name;
+    char* strings[TEST_MAX_STRINGS];
+};
+
+// string ids are the order keys appear in the first file, every
+// other language is matched to them by key
+static char* gKeys[TEST_MAX_STRINGS];
+static int gStringCount;
+
+static struct TestLanguage gLanguages[TEST_MAX_LANGUAGES];
+static int gLanguageCount;
+
+static int gCurrentLanguage;
+static int gTranslationsGetCount;
+
+static char gEmptyString[] = "";
+
+// the translation files stay loaded since the strings point into them,
+// malloc and free here are the game's so they can't be used
+static char gFileText[TEST_MAX_LANGUAGES][TEST_MAX_FILE_SIZE];
+
+int translationsCurrentLanguage() {
+    return gCurrentLanguage;
+}
+
+char* translationsGet(int message) {
+    ++gTranslationsGetCount;
+
+    if (message < 0 || message >= gStringCount) {
+        return gEmptyString;
+    }
+
+    return gLanguages[gCurrentLanguage].strings[message];
+}
+
+void osWritebackDCache(void* vaddr, s32 nbytes) {
+
+}
+
+static char* testReadFile(const char* filename, char* result) {
+    FILE* file = fopen(filename, "rb");
+
+    if (!file) {
+        fprintf(stderr, "could not open %s\n", filename);
+        return NULL;
+    }
+
+    size_t size = fread(result, 1, TEST_MAX_FILE_SIZE, file);
+    fclose(file);
+
+    if (size == TEST_MAX_FILE_SIZE) {
+        fprintf(stderr, "%s is too big\n", filename);
+        return NULL;
+    }
+
+    result[size] = '\0';
+    return result;
+}
+
+// The translation files are Valve's key values format. Every quoted
+// string after "Tokens" is a key followed by its value
+static int testLoadLanguage(struct TestLanguage* language, const char* filename, char* fileText) {
+    char* text = testReadFile(filename, fileText);
+
+    if (!text) {
+        return 0;
+    }
+
+    char* tokens[TEST_MAX_TOKENS];
+    int tokenCount = 0;
+    char* curr = text;
+
+    while ((curr = strchr(curr, '"')) && tokenCount < TEST_MAX_TOKENS) {
+        char* end = strchr(curr + 1, '"');
+
+        if (!end) {
+            break;
+        }
+
+        *end = '\0';
+        tokens[tokenCount++] = curr + 1;
+        curr = end + 1;
+    }
+
+    int first = 0;
+
+    while (first < tokenCount && strcmp(tokens[first], "Tokens") != 0) {
+        ++first;
+    }
+
+    const char* name = strrchr(filename, '/');
+    language->name = name ? name + 1 : filename;
+
+    for (int i = 0; i < TEST_MAX_STRINGS; ++i) {
+        language->strings[i] = gEmptyString;
+    }
+
+    for (int i = first + 1; i + 1 < tokenCount; i += 2) {
+        int stringId = 0;
+
+        while (stringId < gStringCount && strcmp(gKeys[stringId], tokens[i]) != 0) {
+            ++stringId;
+        }
+
+        if (stringId == gStringCount) {
+            if (gStringCount == TEST_MAX_STRINGS) {
+                continue;
+            }
+
+            gKeys[gStringCount++] = tokens[i];
+        }
+
+        language->strings[stringId] = tokens[i + 1];
+    }
+
+    return 1;
+}
+
+static double testSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static struct FontRenderer gRenderer;
+
+// what menuBuildPrerenderedText does for every menu string
+static struct PrerenderedText* testBuildText(char* message, int x, int y) {
+    fontRendererLayout(&gRenderer, &gDejaVuSansFont, message, TEST_MENU_WIDTH);
+    struct PrerenderedText* result = prerenderedTextNew(&gRenderer);
+    fontRendererFillPrerender(&gRenderer, result, x, y, NULL);
+    return result;
+}
+
+// Checks every texture rectangle in the prerendered display lists
+// lands where the layout put its symbol
+static int testPrerenderMatches(struct FontRenderer* renderer, struct PrerenderedText* prerender, int x, int y) {
+    int imageMask = prerender->usedImageIndices;
+    int imageIndex = 0;
+
+    while (imageMask) {
+        if (imageMask & 0x1) {
+            Gfx* gfx = prerender->displayLists[imageIndex] + 2;
+
+            for (int i = 0; i < renderer->currentSymbol; ++i) {
+                struct SymbolLocation* symbol = &renderer->symbols[i];
+
+                if (symbol->imageIndex != imageIndex) {
+                    continue;
+                }
+
+                if (_SHIFTR(gfx->words.w0, 24, 8) != G_TEXRECT ||
+                    _SHIFTR(gfx->words.w1, 12, 12) != (u32)((symbol->x + x) << 2) ||
+                    _SHIFTR(gfx->words.w1, 0, 12) != (u32)((symbol->y + y) << 2) ||
+                    _SHIFTR(gfx->words.w0, 12, 12) != (u32)((symbol->x + symbol->width + x) << 2) ||
+                    _SHIFTR(gfx->words.w0, 0, 12) != (u32)((symbol->y + symbol->height + y) << 2)) {
+                    return 0;
+                }
+
+                gfx += 3;
+            }
+
+            if (_SHIFTR(gfx->words.w0, 24, 8) != G_ENDDL) {
+                return 0;
+            }
+        }
+
+        imageMask >>= 1;
+        ++imageIndex;
+    }
+
+    return 1;
+}
+
+static void testPrerender() {
+    heapInit(gTestHeap, (char*)gTestHeap + sizeof(gTestHeap));
+    int uiBytes = calculateTagBytes(MemoryTagUI);
+    struct Coloru8 color = {255, 156, 0, 255};
+
+    for (int language = 0; language < gLanguageCount; ++language) {
+        for (int stringId = 0; stringId < gStringCount; ++stringId) {
+            fontRendererLayout(&gRenderer, &gDejaVuSansFont, gLanguages[language].strings[stringId], TEST_MENU_WIDTH);
+            TEST_CHECK(gRenderer.width <= TEST_MENU_WIDTH);
+
+            struct PrerenderedText* prerender = prerenderedTextNew(&gRenderer);
+            fontRendererFillPrerender(&gRenderer, prerender, 40, 30, &color);
+            TEST_CHECK(testPrerenderMatches(&gRenderer, prerender, 40, 30));
+
+            struct PrerenderedText* copy = prerenderedTextCopy(prerender);
+            prerenderedTextRelocate(copy, 60, 100);
+            TEST_CHECK(testPrerenderMatches(&gRenderer, copy, 60, 100));
+            TEST_CHECK(testPrerenderMatches(&gRenderer, prerender, 40, 30));
+
+            prerenderedTextFree(copy);
+            prerenderedTextFree(prerender);
+        }
+    }
+
+    TEST_CHECK(calculateTagBytes(MemoryTagUI) == uiBytes);
+}
+
+static void testLayoutStringCache() {
+    gCurrentLanguage = 0;
+    gTranslationsGetCount = 0;
+
+    struct FontRenderer* first = fontRendererLayoutString(&gDejaVuSansFont, 0, TEST_SUBTITLE_WIDTH);
+    int symbolCount = first->currentSymbol;
+
+    // the same string keeps the layout
+    for (int i = 0; i < 10; ++i) {
+        TEST_CHECK(fontRendererLayoutString(&gDejaVuSansFont, 0, TEST_SUBTITLE_WIDTH) == first);
+    }
+
+    TEST_CHECK(gTranslationsGetCount == 1);
+    TEST_CHECK(first->currentSymbol == symbolCount);
+
+    // a different width or string is laid out again
+    fontRendererLayoutString(&gDejaVuSansFont, 0, TEST_MENU_WIDTH);
+    TEST_CHECK(gTranslationsGetCount == 2);
+    fontRendererLayoutString(&gDejaVuSansFont, 1, TEST_MENU_WIDTH);
+    TEST_CHECK(gTranslationsGetCount == 3);
+
+    // so is the same string after the language changes
+    for (int language = 1; language < gLanguageCount; ++language) {
+        gCurrentLanguage = language;
+        struct FontRenderer* renderer = fontRendererLayoutString(&gDejaVuSansFont, 1, TEST_MENU_WIDTH);
+
+        fontRendererLayout(&gRenderer, &gDejaVuSansFont, gLanguages[language].strings[1], TEST_MENU_WIDTH);
+        TEST_CHECK(renderer->currentSymbol == gRenderer.currentSymbol);
+        TEST_CHECK(renderer->width == gRenderer.width && renderer->height == gRenderer.height);
+    }
+
+    TEST_CHECK(gTranslationsGetCount == 2 + gLanguageCount);
+    gCurrentLanguage = 0;
+}
+
+struct TestRebuildTiming {
+    double frame;
+    double worstStep;
+    // UI memory the staged text holds on top of the old text
+    int stagedBytes;
+};
+
+// Switches the menu text from one language to another all in one
+// frame, then the way gameMenuRebuildText spreads it over frames,
+// staging new text while the old text is still drawn
+static void testRebuild(int from, int to, struct TestRebuildTiming* timing) {
+    struct PrerenderedText* text[TEST_MAX_STRINGS];
+    struct PrerenderedText* staged[TEST_MAX_STRINGS];
+
+    timing->frame = 0.0;
+    timing->worstStep = 0.0;
+
+    for (int run = 0; run < TEST_BENCHMARK_RUNS; ++run) {
+        heapInit(gTestHeap, (char*)gTestHeap + sizeof(gTestHeap));
+
+        for (int i = 0; i < gStringCount; ++i) {
+            text[i] = testBuildText(gLanguages[from].strings[i], TEST_MENU_X, TEST_MENU_Y(i));
+        }
+
+        int uiBytes = calculateTagBytes(MemoryTagUI);
+        double start = testSeconds();
+
+        for (int i = 0; i < gStringCount; ++i) {
+            prerenderedTextFree(text[i]);
+            text[i] = testBuildText(gLanguages[to].strings[i], TEST_MENU_X, TEST_MENU_Y(i));
+        }
+
+        double frame = testSeconds() - start;
+        timing->frame = run == 0 || frame < timing->frame ? frame : timing->frame;
+
+        // back to the old language to rebuild it again in steps
+        for (int i = 0; i < gStringCount; ++i) {
+            prerenderedTextFree(text[i]);
+            text[i] = testBuildText(gLanguages[from].strings[i], TEST_MENU_X, TEST_MENU_Y(i));
+        }
+
+        uiBytes = calculateTagBytes(MemoryTagUI);
+        int stagedBytes = 0;
+        double worstStep = 0.0;
+
+        for (int step = 0; step <= TEST_MENU_REBUILD_STEPS; ++step) {
+            start = testSeconds();
+
+            if (step < TEST_MENU_REBUILD_STEPS) {
+                for (int i = step; i < gStringCount; i += TEST_MENU_REBUILD_STEPS) {
+                    staged[i] = testBuildText(gLanguages[to].strings[i], TEST_MENU_X, TEST_MENU_Y(i));
+                }
+            } else {
+                // menuCommitStagedText
+                for (int i = 0; i < gStringCount; ++i) {
+                    prerenderedTextFree(text[i]);
+                    text[i] = staged[i];
+                }
+            }
+
+            double time = testSeconds() - start;
+            worstStep = time > worstStep ? time : worstStep;
+            stagedBytes = MAX(stagedBytes, calculateTagBytes(MemoryTagUI) - uiBytes);
+        }
+
+        timing->worstStep = run == 0 || worstStep < timing->worstStep ? worstStep : timing->worstStep;
+        timing->stagedBytes = stagedBytes;
+
+        for (int i = 0; i < gStringCount; ++i) {
+            TEST_CHECK(text[i]->y == TEST_MENU_Y(i));
+            prerenderedTextFree(text[i]);
+        }
+    }
+}
+
+static void testBenchmark() {
+    double totalLayout = 0.0;
+    int totalCharacters = 0;
+
+    for (int language = 0; language < gLanguageCount; ++language) {
+        struct TestLanguage* current = &gLanguages[language];
+        double layout = 0.0;
+        double longest = 0.0;
+        int characters = 0;
+
+        for (int stringId = 0; stringId < gStringCount; ++stringId) {
+            double best = 0.0;
+
+            for (int run = 0; run < TEST_BENCHMARK_RUNS; ++run) {
+                double start = testSeconds();
+                fontRendererLayout(&gRenderer, &gDejaVuSansFont, current->strings[stringId], TEST_MENU_WIDTH);
+                double time = testSeconds() - start;
+                best = run == 0 || time < best ? time : best;
+            }
+
+            layout += best;
+            longest = best > longest ? best : longest;
+            characters += strlen(current->strings[stringId]);
+        }
+
+        // the subtitle cache hits every frame the same string is shown
+        gCurrentLanguage = language;
+        fontRendererLayoutString(&gDejaVuSansFont, 0, TEST_SUBTITLE_WIDTH);
+        double start = testSeconds();
+
+        for (int i = 0; i < TEST_CACHE_HITS; ++i) {
+            fontRendererLayoutString(&gDejaVuSansFont, 0, TEST_SUBTITLE_WIDTH);
+        }
+
+        double cacheHit = (testSeconds() - start) / TEST_CACHE_HITS;
+
+        struct TestRebuildTiming rebuild;
+        testRebuild(language == 0 ? 1 : 0, language, &rebuild);
+
+        printf("%s: %d strings %d bytes laid out in %.1fus, longest %.2fus, cache hit %.3fus\n",
+            current->name,
+            gStringCount,
+            characters,
+            layout * 1e6,
+            longest * 1e6,
+            cacheHit * 1e6
+        );
+        printf("    rebuild in one frame %.1fus, over %d frames worst %.1fus holding %d more bytes of UI memory\n",
+            rebuild.frame * 1e6,
+            TEST_MENU_REBUILD_STEPS + 1,
+            rebuild.worstStep * 1e6,
+            rebuild.stagedBytes
+        );
+
+        totalLayout += layout;
+        totalCharacters += characters;
+    }
+
+    gCurrentLanguage = 0;
+
+    printf("total: %d bytes laid out in %.1fus on the host\n", totalCharacters, totalLayout * 1e6);
+}
+
+// arguments are the assets/translations files, the first
+// one decides the string ids
+int main(int argc, char** argv) {
+    if (argc < 3 || argc - 1 > TEST_MAX_LANGUAGES) {
+        fprintf(stderr, "usage: %s translation translation [translation ...]\n", argv[0]);
+        return 1;
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        if (!testLoadLanguage(&gLanguages[gLanguageCount], argv[i], gFileText[gLanguageCount])) {
+            return 1;
+        }
+
+        ++gLanguageCount;
+    }
+
+    TEST_CHECK(gStringCount > 1);
+
+    heapInit(gTestHeap, (char*)gTestHeap + sizeof(gTestHeap));
+
+    TEST_RUN(testPrerender);
+    TEST_RUN(testLayoutStringCache);
+    TEST_RUN(testBenchmark);
+
+    return gTestFailures ? 1 : 0;
+}
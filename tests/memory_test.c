@@ -0,0 +1,331 @@
+#include "test.h"
+
+#include <stdint.h>
+#include "../src/util/memory.h"
+
+extern void* gHeapStart;
+extern void* gHeapEnd;
+
+TEST_DEFINE_FAILURES
+
+#define TEST_HEAP_SIZE  (256 * 1024)
+#define SLAB_TEST_COUNT 200
+
+// the extra word lets the heap start off of a 16 byte boundary
+static long long gTestHeap[TEST_HEAP_SIZE / sizeof(long long) + 1];
+
+static void testHeapInit(int offset) {
+    heapInit((char*)gTestHeap + offset, (char*)gTestHeap + offset + TEST_HEAP_SIZE);
+}
+
+static int testFillCheck(unsigned char* memory, int size, unsigned char value) {
+    for (int i = 0; i < size; ++i) {
+        if (memory[i] != value) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static void testSlabAlignment() {
+    for (int offset = 0; offset <= 8; offset += 8) {
+        testHeapInit(offset);
+
+        for (int size = 1; size <= SLAB_MAX_SIZE; ++size) {
+            void* memory = malloc(size);
+            TEST_CHECK(memory != 0);
+            TEST_CHECK(((uintptr_t)memory & 0xF) == 0);
+        }
+    }
+}
+
+static void testSlabNoOverlap() {
+    testHeapInit(8);
+
+    int freeBefore = calculateBytesFree();
+    unsigned char* allocations[SLAB_TEST_COUNT];
+    int sizes[SLAB_TEST_COUNT];
+    int expectedUsed = 0;
+
+    for (int i = 0; i < SLAB_TEST_COUNT; ++i) {
+        sizes[i] = 1 + (i * 37) % SLAB_MAX_SIZE;
+        allocations[i] = malloc(sizes[i]);
+        TEST_CHECK(allocations[i] != 0);
+
+        for (int j = 0; j < sizes[i]; ++j) {
+            allocations[i][j] = (unsigned char)i;
+        }
+
+        int classSize = 16;
+
+        while (classSize < sizes[i]) {
+            classSize <<= 1;
+        }
+
+        expectedUsed += classSize;
+    }
+
+    TEST_CHECK(calculateSlabBytesUsed() == expectedUsed);
+    TEST_CHECK(calculateSlabBytesReserved() > 0);
+
+    for (int i = 0; i < SLAB_TEST_COUNT; ++i) {
+        TEST_CHECK(testFillCheck(allocations[i], sizes[i], (unsigned char)i));
+    }
+
+    for (int i = 0; i < SLAB_TEST_COUNT; i += 2) {
+        free(allocations[i]);
+    }
+
+    // freed slots are reused
+    for (int i = 0; i < SLAB_TEST_COUNT; i += 2) {
+        allocations[i] = malloc(sizes[i]);
+        TEST_CHECK(allocations[i] != 0);
+
+        for (int j = 0; j < sizes[i]; ++j) {
+            allocations[i][j] = (unsigned char)i;
+        }
+    }
+
+    for (int i = 0; i < SLAB_TEST_COUNT; ++i) {
+        TEST_CHECK(testFillCheck(allocations[i], sizes[i], (unsigned char)i));
+        free(allocations[i]);
+    }
+
+    // empty pages go back to the heap
+    TEST_CHECK(calculateSlabBytesUsed() == 0);
+    TEST_CHECK(calculateSlabBytesReserved() == 0);
+    TEST_CHECK(calculateBytesFree() == freeBefore);
+    TEST_CHECK(calculateLargestFreeChunk() == freeBefore);
+}
+
+static void testSlabLargeAllocations() {
+    testHeapInit(0);
+
+    void* memory = malloc(SLAB_MAX_SIZE + 1);
+    TEST_CHECK(memory != 0);
+    TEST_CHECK(calculateSlabBytesReserved() == 0);
+    free(memory);
+
+    TEST_CHECK(calculateBytesFree() == calculateHeapSize());
+}
+
+static void testArena() {
+    testHeapInit(0);
+
+    int freeBefore = calculateBytesFree();
+    int sizes[] = {1, 24, 300, MEMORY_ARENA_CHUNK_SIZE / 2 + 1, 7, MEMORY_ARENA_CHUNK_SIZE * 2, 1000, 1000, 1000, 9};
+    unsigned char* allocations[sizeof(sizes) / sizeof(*sizes)];
+    int count = sizeof(sizes) / sizeof(*sizes);
+    int total = 0;
+
+    for (int i = 0; i < count; ++i) {
+        allocations[i] = arenaMalloc(&gLevelArena, sizes[i]);
+        TEST_CHECK(allocations[i] != 0);
+        TEST_CHECK(((uintptr_t)allocations[i] & 0x7) == 0);
+
+        for (int j = 0; j < sizes[i]; ++j) {
+            allocations[i][j] = (unsigned char)i;
+        }
+
+        total += sizes[i];
+    }
+
+    for (int i = 0; i < count; ++i) {
+        TEST_CHECK(testFillCheck(allocations[i], sizes[i], (unsigned char)i));
+    }
+
+    TEST_CHECK(calculateTagBytes(MemoryTagLevel) >= total);
+    TEST_CHECK(calculateTagBytes(MemoryTagAssets) == 0);
+
+    arenaReset(&gLevelArena);
+
+    TEST_CHECK(calculateTagBytes(MemoryTagLevel) == 0);
+    TEST_CHECK(calculateBytesFree() == freeBefore);
+    TEST_CHECK(calculateLargestFreeChunk() == freeBefore);
+
+    // the arena is usable again after a reset
+    TEST_CHECK(arenaMalloc(&gLevelArena, 64) != 0);
+}
+
+static void testTagAccounting() {
+    testHeapInit(0);
+
+    void* small = mallocTagged(20, MemoryTagUI);
+    void* large = mallocTagged(1000, MemoryTagUI);
+    void* general = malloc(1000);
+
+    TEST_CHECK(calculateTagBytes(MemoryTagUI) >= 32 + 1000);
+    TEST_CHECK(calculateTagBytes(MemoryTagGeneral) >= 1000);
+    TEST_CHECK(calculateTagBytes(MemoryTagLevel) == 0);
+
+    free(small);
+    TEST_CHECK(calculateTagBytes(MemoryTagUI) >= 1000);
+    free(large);
+    TEST_CHECK(calculateTagBytes(MemoryTagUI) == 0);
+    free(general);
+    TEST_CHECK(calculateTagBytes(MemoryTagGeneral) == 0);
+
+    mallocTagged(100, MemoryTagAssets);
+    testHeapInit(0);
+    TEST_CHECK(calculateTagBytes(MemoryTagAssets) == 0);
+}
+
+static void testStackMallocPeak() {
+    void* first = stackMalloc(100);
+    void* second = stackMalloc(20);
+    TEST_CHECK((char*)second - (char*)first == 104);
+    TEST_CHECK(stackMallocPeakBytes() >= 128);
+
+    stackMallocFree(first);
+    TEST_CHECK(stackMallocPeakBytes() >= 128);
+
+    stackMallocResetPeak();
+    TEST_CHECK(stackMallocPeakBytes() == 0);
+
+    stackMallocFree(stackMalloc(16));
+    TEST_CHECK(stackMallocPeakBytes() == 16);
+}
+
+static void testMemCopy() {
+    unsigned char source[128];
+    unsigned char target[128];
+
+    for (int i = 0; i < (int)sizeof(source); ++i) {
+        source[i] = (unsigned char)(i * 7 + 1);
+    }
+
+    // every mix of alignments takes the byte, word and double word paths
+    for (int targetOffset = 0; targetOffset < 8; ++targetOffset) {
+        for (int sourceOffset = 0; sourceOffset < 8; ++sourceOffset) {
+            for (int size = 0; size <= 70; size += 3) {
+                for (int i = 0; i < (int)sizeof(target); ++i) {
+                    target[i] = 0xCC;
+                }
+
+                memCopy(target + targetOffset, source + sourceOffset, size);
+
+                int isMatch = 1;
+
+                for (int i = 0; i < (int)sizeof(target); ++i) {
+                    int copyIndex = i - targetOffset;
+                    unsigned char expected = (copyIndex >= 0 && copyIndex < size) ? source[sourceOffset + copyIndex] : 0xCC;
+
+                    if (target[i] != expected) {
+                        isMatch = 0;
+                    }
+                }
+
+                TEST_CHECK(isMatch);
+            }
+        }
+    }
+}
+
+static void testZeroMemory() {
+    unsigned char memory[128];
+
+    for (int offset = 0; offset < 8; ++offset) {
+        for (int size = 0; size <= 70; size += 3) {
+            for (int i = 0; i < (int)sizeof(memory); ++i) {
+                memory[i] = 0xCC;
+            }
+
+            zeroMemory(memory + offset, size);
+
+            int isMatch = 1;
+
+            for (int i = 0; i < (int)sizeof(memory); ++i) {
+                unsigned char expected = (i >= offset && i < offset + size) ? 0 : 0xCC;
+
+                if (memory[i] != expected) {
+                    isMatch = 0;
+                }
+            }
+
+            TEST_CHECK(isMatch);
+        }
+    }
+}
+
+static void testHeapInitKeepBlock(int blocksBefore) {
+    testHeapInit(0);
+
+    // the heap allocates from the end, so blocksBefore picks where
+    // the kept block lands and the size of the gaps around it
+    for (int i = 0; i < blocksBefore; ++i) {
+        malloc(3000);
+    }
+
+    unsigned char* keep = mallocTagged(5000, MemoryTagLevel);
+    TEST_CHECK(keep != 0);
+    int keepBytes = calculateTagBytes(MemoryTagLevel);
+
+    for (int i = 0; i < 5000; ++i) {
+        keep[i] = (unsigned char)i;
+    }
+
+    malloc(3000);
+
+    heapInitKeep(gHeapStart, gHeapEnd, keep);
+
+    TEST_CHECK(testFillCheck(keep, 1, 0));
+    TEST_CHECK(keep[4999] == (unsigned char)4999);
+    TEST_CHECK(calculateTagBytes(MemoryTagLevel) == keepBytes);
+    TEST_CHECK(calculateTagBytes(MemoryTagGeneral) == 0);
+    TEST_CHECK(calculateBytesFree() == calculateHeapSize() - keepBytes);
+
+    // nothing allocated after the reset may land on the kept block
+    for (;;) {
+        unsigned char* memory = malloc(1000);
+
+        if (!memory) {
+            break;
+        }
+
+        TEST_CHECK(memory + 1000 <= keep || memory >= keep + 5000);
+    }
+
+    for (int i = 0; i < 5000; ++i) {
+        if (keep[i] != (unsigned char)i) {
+            TEST_CHECK(keep[i] == (unsigned char)i);
+            break;
+        }
+    }
+
+    heapInitKeep(gHeapStart, gHeapEnd, keep);
+    free(keep);
+
+    TEST_CHECK(calculateTagBytes(MemoryTagLevel) == 0);
+    TEST_CHECK(calculateBytesFree() == calculateHeapSize());
+    TEST_CHECK(calculateLargestFreeChunk() == calculateHeapSize());
+}
+
+static void testHeapInitKeep() {
+    testHeapInitKeepBlock(0);
+    testHeapInitKeepBlock(4);
+
+    // no block or a pointer that isn't a heap block acts like heapInit
+    testHeapInit(0);
+    void* memory = malloc(1000);
+    heapInitKeep(gHeapStart, gHeapEnd, 0);
+    TEST_CHECK(calculateBytesFree() == calculateHeapSize());
+
+    memory = malloc(1000);
+    heapInitKeep(gHeapStart, gHeapEnd, (char*)memory + 8);
+    TEST_CHECK(calculateBytesFree() == calculateHeapSize());
+}
+
+int main() {
+    TEST_RUN(testSlabAlignment);
+    TEST_RUN(testSlabNoOverlap);
+    TEST_RUN(testSlabLargeAllocations);
+    TEST_RUN(testArena);
+    TEST_RUN(testTagAccounting);
+    TEST_RUN(testStackMallocPeak);
+    TEST_RUN(testMemCopy);
+    TEST_RUN(testZeroMemory);
+    TEST_RUN(testHeapInitKeep);
+
+    return gTestFailures ? 1 : 0;
+}
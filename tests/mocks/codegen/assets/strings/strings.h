@@ -0,0 +1,9 @@
+#ifndef __STRINGS_H__
+#define __STRINGS_H__
+
+// Stands in for the header tools/text/generate_strings.py writes.
+// Tests provide their own strings so only the limits are needed
+
+#define MAX_STRING_LENGTH      512
+
+#endif
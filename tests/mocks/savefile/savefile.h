@@ -0,0 +1,21 @@
+#ifndef __TESTS_MOCKS_SAVEFILE_H__
+#define __TESTS_MOCKS_SAVEFILE_H__
+
+// The real savefile.h pulls in the whole scene. Sound code only
+// reads the volume settings
+
+#include <stdint.h>
+
+struct AudioSettingsSaveState {
+    uint16_t soundVolume;
+    uint16_t musicVolume;
+    uint8_t audioLanguage;
+};
+
+struct SaveData {
+    struct AudioSettingsSaveState audio;
+};
+
+extern struct SaveData gSaveData;
+
+#endif
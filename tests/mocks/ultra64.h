@@ -0,0 +1,242 @@
+#ifndef __TESTS_MOCKS_ULTRA64_H__
+#define __TESTS_MOCKS_ULTRA64_H__
+
+// Just enough of libultra for game code that builds display lists
+// without touching the hardware. Commands are kept unpacked so tests
+// can read them back, unless MOCK_GBI_WORDS asks for them packed into
+// words like libultra does for code that reads its own display lists.
+
+#include <stdint.h>
+
+#ifndef NULL
+#define NULL 0
+#endif
+
+typedef uint8_t u8;
+typedef int8_t s8;
+typedef uint16_t u16;
+typedef int16_t s16;
+typedef uint32_t u32;
+typedef int32_t s32;
+typedef uint64_t u64;
+typedef int64_t s64;
+typedef float f32;
+typedef double f64;
+
+typedef struct {
+    short ob[3];
+    unsigned short flag;
+    short tc[2];
+    unsigned char cn[4];
+} Vtx_t;
+
+typedef union {
+    Vtx_t v;
+    long long force_structure_alignment;
+} Vtx;
+
+typedef struct {
+    long m[4][4];
+} Mtx;
+
+typedef struct {
+    short vscale[4];
+    short vtrans[4];
+} Vp_t;
+
+typedef union {
+    Vp_t vp;
+    long long force_structure_alignment;
+} Vp;
+
+typedef struct {
+    u8 col[3];
+    s8 dir[3];
+} Light_t;
+
+typedef union {
+    Light_t l;
+    long long force_structure_alignment[2];
+} Light;
+
+typedef struct {
+    Light l[2];
+} LookAt;
+
+#ifndef MOCK_GBI_WORDS
+
+enum MockGfxCommand {
+    MockGfxCommandVertex = 1,
+    MockGfxCommandTriangle,
+    MockGfxCommandEndDisplayList,
+};
+
+typedef struct {
+    u8 command;
+    u8 args[7];
+    const void* pointer;
+} Gfx;
+
+#else
+
+typedef struct {
+    u32 w0;
+    u32 w1;
+} Gwords;
+
+typedef union {
+    Gwords words;
+    long long force_structure_alignment;
+} Gfx;
+
+#endif
+
+#ifndef MIN
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+
+#ifndef MAX
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
+#endif
+
+#define SCREEN_WD   320
+#define SCREEN_HT   240
+
+#ifndef MOCK_GBI_WORDS
+
+#define gSPVertex(pkt, v, n, v0) do { \
+    Gfx* _g = (Gfx*)(pkt); \
+    _g->command = MockGfxCommandVertex; \
+    _g->args[0] = (n); \
+    _g->args[1] = (v0); \
+    _g->pointer = (v); \
+} while (0)
+
+#define gSP2Triangles(pkt, v00, v01, v02, flag0, v10, v11, v12, flag1) do { \
+    Gfx* _g = (Gfx*)(pkt); \
+    _g->command = MockGfxCommandTriangle; \
+    _g->args[0] = 2; \
+    _g->args[1] = (v00); \
+    _g->args[2] = (v01); \
+    _g->args[3] = (v02); \
+    _g->args[4] = (v10); \
+    _g->args[5] = (v11); \
+    _g->args[6] = (v12); \
+    _g->pointer = 0; \
+} while (0)
+
+#define gSP1Triangle(pkt, v0, v1, v2, flag) do { \
+    Gfx* _g = (Gfx*)(pkt); \
+    _g->command = MockGfxCommandTriangle; \
+    _g->args[0] = 1; \
+    _g->args[1] = (v0); \
+    _g->args[2] = (v1); \
+    _g->args[3] = (v2); \
+    _g->pointer = 0; \
+} while (0)
+
+#define gSPEndDisplayList(pkt) do { \
+    Gfx* _g = (Gfx*)(pkt); \
+    _g->command = MockGfxCommandEndDisplayList; \
+    _g->pointer = 0; \
+} while (0)
+
+#else
+
+#define _SHIFTL(v, s, w) ((u32)(((u32)(v) & ((0x01 << (w)) - 1)) << (s)))
+#define _SHIFTR(v, s, w) ((u32)(((u32)(v) >> (s)) & ((0x01 << (w)) - 1)))
+
+#define G_NOOP          0x00
+#define G_DL            0xde
+#define G_ENDDL         0xdf
+#define G_RDPHALF_1     0xe1
+#define G_TEXRECT       0xe4
+#define G_RDPPIPESYNC   0xe7
+#define G_RDPHALF_2     0xf1
+#define G_SETENVCOLOR   0xfb
+
+#define G_TX_RENDERTILE 0
+
+// Host pointers don't fit in w1, display list addresses are truncated
+#define gMockWords(pkt, word0, word1) do { \
+    Gfx* _g = (Gfx*)(pkt); \
+    _g->words.w0 = (word0); \
+    _g->words.w1 = (word1); \
+} while (0)
+
+#define gSPDisplayList(pkt, dl) gMockWords(pkt, _SHIFTL(G_DL, 24, 8), (u32)(uintptr_t)(dl))
+#define gSPEndDisplayList(pkt)  gMockWords(pkt, _SHIFTL(G_ENDDL, 24, 8), 0)
+#define gDPNoOp(pkt)            gMockWords(pkt, _SHIFTL(G_NOOP, 24, 8), 0)
+#define gDPPipeSync(pkt)        gMockWords(pkt, _SHIFTL(G_RDPPIPESYNC, 24, 8), 0)
+
+#define gDPSetEnvColor(pkt, r, g, b, a) gMockWords(pkt, \
+    _SHIFTL(G_SETENVCOLOR, 24, 8), \
+    _SHIFTL(r, 24, 8) | _SHIFTL(g, 16, 8) | _SHIFTL(b, 8, 8) | _SHIFTL(a, 0, 8) \
+)
+
+// pkt is used once per command like libultra, so gfx++ advances 3 times
+#define gSPTextureRectangle(pkt, xl, yl, xh, yh, tile, s, t, dsdx, dtdy) do { \
+    gMockWords(pkt, \
+        _SHIFTL(G_TEXRECT, 24, 8) | _SHIFTL(xh, 12, 12) | _SHIFTL(yh, 0, 12), \
+        _SHIFTL(tile, 24, 3) | _SHIFTL(xl, 12, 12) | _SHIFTL(yl, 0, 12) \
+    ); \
+    gMockWords(pkt, _SHIFTL(G_RDPHALF_1, 24, 8), _SHIFTL(s, 16, 16) | _SHIFTL(t, 0, 16)); \
+    gMockWords(pkt, _SHIFTL(G_RDPHALF_2, 24, 8), _SHIFTL(dsdx, 16, 16) | _SHIFTL(dtdy, 0, 16)); \
+} while (0)
+
+#endif
+
+// PI DMA and the audio heap. Tests that use them provide the definitions
+typedef void* OSMesg;
+
+typedef struct {
+    s32 validCount;
+    s32 first;
+    s32 msgCount;
+    OSMesg* msg;
+} OSMesgQueue;
+
+typedef struct {
+    u16 type;
+    u8 pri;
+    u8 status;
+    OSMesgQueue* retQueue;
+} OSIoMesgHdr;
+
+typedef struct {
+    OSIoMesgHdr hdr;
+    void* dramAddr;
+    u32 devAddr;
+    u32 size;
+} OSIoMesg;
+
+typedef struct {
+    u32 baseAddress;
+} OSPiHandle;
+
+typedef struct {
+    u8* base;
+    u8* cur;
+    s32 len;
+    s32 count;
+} ALHeap;
+
+#define OS_READ             0
+#define OS_WRITE            1
+#define OS_MESG_NOBLOCK     0
+#define OS_MESG_BLOCK       1
+#define OS_MESG_PRI_NORMAL  0
+
+// Host pointers don't fit in 32 bits so the test maps them
+s32 mockK0ToPhys(void* address);
+#define K0_TO_PHYS(x) mockK0ToPhys(x)
+
+void osCreateMesgQueue(OSMesgQueue* mq, OSMesg* msg, s32 count);
+s32 osRecvMesg(OSMesgQueue* mq, OSMesg* msg, s32 flag);
+s32 osEPiStartDma(OSPiHandle* pihandle, OSIoMesg* mb, s32 direction);
+void* alHeapAlloc(ALHeap* hp, s32 num, s32 size);
+
+// Data cache, tests that use it provide the definition
+void osWritebackDCache(void* vaddr, s32 nbytes);
+
+#endif
@@ -0,0 +1,316 @@
+#include "test.h"
+
+#include "../src/effects/particle_pool.h"
+
+TEST_DEFINE_FAILURES
+
+#define TEST_FRAME_TIME     (1.0f / 30.0f)
+#define TEST_SCENE_FRAMES   (60 * 30)
+
+// must match MAX_ACTIVE_PARTICLE_EFFECTS in effects.h
+#define TEST_MAX_EFFECTS    32
+// the layout the pool replaced, 16 effects each with 16 particles
+#define TEST_OLD_MAX_EFFECTS    16
+#define TEST_OLD_MAX_PARTICLES  16
+
+static struct ParticlePool gPool;
+
+static int testSpansValid(struct ParticlePool* pool) {
+    int freeCount = 0;
+
+    for (int i = 0; i < pool->freeSpanCount; ++i) {
+        struct ParticlePoolSpan* span = &pool->freeSpans[i];
+
+        if (span->count <= 0 || span->firstParticle < 0 || span->firstParticle + span->count > PARTICLE_POOL_SIZE) {
+            return 0;
+        }
+
+        // sorted and never touching, touching spans should have merged
+        if (i > 0 && pool->freeSpans[i - 1].firstParticle + pool->freeSpans[i - 1].count >= span->firstParticle) {
+            return 0;
+        }
+
+        freeCount += span->count;
+    }
+
+    return freeCount + pool->usedCount == PARTICLE_POOL_SIZE;
+}
+
+static void testAllocFree() {
+    particlePoolInit(&gPool);
+
+    int a = particlePoolAlloc(&gPool, 16);
+    int b = particlePoolAlloc(&gPool, 4);
+    int c = particlePoolAlloc(&gPool, 8);
+
+    TEST_CHECK(a == 0);
+    TEST_CHECK(b == 16);
+    TEST_CHECK(c == 20);
+    TEST_CHECK(gPool.usedCount == 28);
+    TEST_CHECK(testSpansValid(&gPool));
+
+    // a hole between two used ranges gets reused first fit
+    particlePoolFree(&gPool, b, 4);
+    TEST_CHECK(gPool.freeSpanCount == 2);
+    TEST_CHECK(particlePoolAlloc(&gPool, 2) == 16);
+    TEST_CHECK(particlePoolAlloc(&gPool, 4) == 28);
+    TEST_CHECK(testSpansValid(&gPool));
+
+    particlePoolFree(&gPool, 16, 2);
+    particlePoolFree(&gPool, 28, 4);
+    TEST_CHECK(testSpansValid(&gPool));
+
+    // freeing the range between two free spans joins all three
+    particlePoolFree(&gPool, a, 16);
+    TEST_CHECK(gPool.freeSpanCount == 2);
+    particlePoolFree(&gPool, c, 8);
+    TEST_CHECK(gPool.freeSpanCount == 1);
+    TEST_CHECK(gPool.usedCount == 0);
+    TEST_CHECK(testSpansValid(&gPool));
+}
+
+static void testFull() {
+    particlePoolInit(&gPool);
+
+    TEST_CHECK(particlePoolAlloc(&gPool, PARTICLE_POOL_SIZE) == 0);
+    TEST_CHECK(gPool.freeSpanCount == 0);
+    TEST_CHECK(particlePoolAlloc(&gPool, 1) == PARTICLE_POOL_NONE);
+
+    particlePoolFree(&gPool, 0, PARTICLE_POOL_SIZE);
+    TEST_CHECK(gPool.freeSpanCount == 1);
+    TEST_CHECK(particlePoolAlloc(&gPool, PARTICLE_POOL_SIZE + 1) == PARTICLE_POOL_NONE);
+}
+
+static void testMostFragmented() {
+    particlePoolInit(&gPool);
+
+    // every other single particle used leaves the most free spans
+    // one range per effect can make
+    for (int i = 0; i < TEST_MAX_EFFECTS * 2; ++i) {
+        TEST_CHECK(particlePoolAlloc(&gPool, 1) == i);
+    }
+
+    for (int i = 0; i < TEST_MAX_EFFECTS * 2; i += 2) {
+        particlePoolFree(&gPool, i, 1);
+    }
+
+    TEST_CHECK(gPool.freeSpanCount == TEST_MAX_EFFECTS + 1);
+    TEST_CHECK(gPool.freeSpanCount <= PARTICLE_POOL_MAX_SPANS);
+    TEST_CHECK(testSpansValid(&gPool));
+}
+
+struct TestEffectType {
+    const char* name;
+    int count;
+    float lifetime;
+    // how often the scene plays it
+    float interval;
+    float phase;
+};
+
+// particle counts and lifetimes from effect_definitions.c with a
+// rate for each from a busy test chamber, a turret firing at the
+// player, a ball bouncing between catchers, the player shooting
+// portals at a fizzler
+static struct TestEffectType gSceneEffects[] = {
+    {"muzzle_flash", 4, 0.1f, 0.1f, 0.0f},
+    {"spark", 8, 1.0f, 0.1f, 0.05f},
+    {"ball_bounce", 16, 0.75f, 0.6f, 0.2f},
+    {"ball_burst", 16, 2.0f, 4.0f, 1.0f},
+    {"fail_portal_splash", 16, 0.5f, 0.7f, 0.3f},
+    {"smoke", 2, 2.0f, 0.25f, 0.1f},
+    {"smoke_fast", 2, 1.0f, 0.2f, 0.15f},
+};
+
+#define TEST_SCENE_EFFECT_TYPES (sizeof(gSceneEffects) / sizeof(*gSceneEffects))
+
+struct TestEffect {
+    struct TestEffectType* type;
+    int firstParticle;
+    float time;
+};
+
+struct TestSceneResult {
+    int played;
+    // effects stopped before their lifetime ran out
+    int cutShort;
+    int dropped;
+    int peakParticles;
+    int peakEffects;
+    int peakSpans;
+};
+
+static int testActiveEffects(struct TestEffect* effects, int count) {
+    int result = 0;
+
+    for (int i = 0; i < count; ++i) {
+        if (effects[i].type) {
+            ++result;
+        }
+    }
+
+    return result;
+}
+
+static void testEffectStop(struct TestEffect* effect, int usePool) {
+    if (!effect->type) {
+        return;
+    }
+
+    if (usePool) {
+        particlePoolFree(&gPool, effect->firstParticle, effect->type->count);
+    }
+
+    effect->type = 0;
+}
+
+static struct TestEffect* testOldestEffect(struct TestEffect* effects, int maxEffects, struct TestEffect* exclude) {
+    struct TestEffect* result = 0;
+
+    for (int i = 0; i < maxEffects; ++i) {
+        struct TestEffect* effect = &effects[i];
+
+        if (effect == exclude || !effect->type) {
+            continue;
+        }
+
+        if (!result || effect->time > result->time) {
+            result = effect;
+        }
+    }
+
+    return result;
+}
+
+// the old effectsParticlePlay, each effect took the next slot
+static void testFixedEffectPlay(struct TestEffect* effects, int* next, struct TestEffectType* type, struct TestSceneResult* result) {
+    struct TestEffect* effect = &effects[*next];
+    *next = (*next + 1) % TEST_OLD_MAX_EFFECTS;
+
+    ++result->played;
+
+    if (effect->type) {
+        ++result->cutShort;
+    }
+
+    effect->type = type;
+    effect->time = 0.0f;
+}
+
+// mirrors effectsParticlePlay
+static void testPooledEffectPlay(struct TestEffect* effects, struct TestEffectType* type, struct TestSceneResult* result) {
+    struct TestEffect* effect = 0;
+
+    ++result->played;
+
+    for (int i = 0; i < TEST_MAX_EFFECTS && !effect; ++i) {
+        if (!effects[i].type) {
+            effect = &effects[i];
+        }
+    }
+
+    if (!effect) {
+        effect = testOldestEffect(effects, TEST_MAX_EFFECTS, 0);
+        ++result->cutShort;
+        testEffectStop(effect, 1);
+    }
+
+    while ((effect->firstParticle = particlePoolAlloc(&gPool, type->count)) == PARTICLE_POOL_NONE) {
+        struct TestEffect* oldest = testOldestEffect(effects, TEST_MAX_EFFECTS, effect);
+
+        if (!oldest) {
+            ++result->dropped;
+            return;
+        }
+
+        ++result->cutShort;
+        testEffectStop(oldest, 1);
+    }
+
+    effect->type = type;
+    effect->time = 0.0f;
+}
+
+static void testRunScene(int maxEffects, int usePool, struct TestSceneResult* result) {
+    struct TestEffect effects[TEST_MAX_EFFECTS] = {0};
+    float nextPlay[TEST_SCENE_EFFECT_TYPES];
+    int next = 0;
+
+    *result = (struct TestSceneResult){0};
+    particlePoolInit(&gPool);
+
+    for (unsigned i = 0; i < TEST_SCENE_EFFECT_TYPES; ++i) {
+        nextPlay[i] = gSceneEffects[i].phase;
+    }
+
+    for (int frame = 0; frame < TEST_SCENE_FRAMES; ++frame) {
+        float time = frame * TEST_FRAME_TIME;
+
+        for (unsigned i = 0; i < TEST_SCENE_EFFECT_TYPES; ++i) {
+            while (nextPlay[i] <= time) {
+                if (usePool) {
+                    testPooledEffectPlay(effects, &gSceneEffects[i], result);
+                } else {
+                    testFixedEffectPlay(effects, &next, &gSceneEffects[i], result);
+                }
+                nextPlay[i] += gSceneEffects[i].interval;
+            }
+        }
+
+        int particles = 0;
+
+        for (int i = 0; i < maxEffects; ++i) {
+            struct TestEffect* effect = &effects[i];
+
+            if (!effect->type) {
+                continue;
+            }
+
+            particles += usePool ? effect->type->count : TEST_OLD_MAX_PARTICLES;
+
+            effect->time += TEST_FRAME_TIME;
+
+            if (effect->time >= effect->type->lifetime) {
+                testEffectStop(effect, usePool);
+            }
+        }
+
+        result->peakParticles = particles > result->peakParticles ? particles : result->peakParticles;
+
+        int activeEffects = testActiveEffects(effects, maxEffects);
+        result->peakEffects = activeEffects > result->peakEffects ? activeEffects : result->peakEffects;
+
+        if (usePool) {
+            TEST_CHECK(testSpansValid(&gPool));
+            result->peakSpans = gPool.freeSpanCount > result->peakSpans ? gPool.freeSpanCount : result->peakSpans;
+        }
+    }
+}
+
+static void testBusyScene() {
+    struct TestSceneResult old;
+    struct TestSceneResult pooled;
+
+    testRunScene(TEST_OLD_MAX_EFFECTS, 0, &old);
+    testRunScene(TEST_MAX_EFFECTS, 1, &pooled);
+
+    printf("fixed slots: %d played %d cut short peak %d effects %d particles reserved\n",
+        old.played, old.cutShort, old.peakEffects, old.peakParticles);
+    printf("shared pool: %d played %d cut short %d dropped peak %d effects %d particles %d free spans\n",
+        pooled.played, pooled.cutShort, pooled.dropped, pooled.peakEffects, pooled.peakParticles, pooled.peakSpans);
+
+    TEST_CHECK(pooled.played == old.played);
+    TEST_CHECK(pooled.cutShort < old.cutShort);
+    TEST_CHECK(pooled.dropped == 0);
+    TEST_CHECK(pooled.peakParticles <= PARTICLE_POOL_SIZE);
+    TEST_CHECK(pooled.peakSpans <= PARTICLE_POOL_MAX_SPANS);
+}
+
+int main() {
+    TEST_RUN(testAllocFree);
+    TEST_RUN(testFull);
+    TEST_RUN(testMostFragmented);
+    TEST_RUN(testBusyScene);
+
+    return gTestFailures ? 1 : 0;
+}
@@ -0,0 +1,520 @@
+#include "test.h"
+
+#include <stdint.h>
+#include "../src/scene/portal.h"
+#include "../src/scene/portal_surface_generator.h"
+#include "../src/util/memory.h"
+
+// Cuts portal holes into generated level surfaces with portalSurfacePokeHole
+// and checks the edges and display list that come out
+//
+// Input layout, anything missing is read as zero
+//   u8 columns, u8 rows, u8 cell size
+//   then up to PORTAL_FUZZ_MAX_HOLES holes of
+//   s16 x, s16 y (little endian), u8 scale, u8 flags
+// scale is (64 + scale) / 128 of a full size portal, the low three bits of
+// flags pick the first point of the loop and PortalFuzzHoleFlagsSideways
+// swaps the width and height
+//
+// Built with PORTAL64_LIBFUZZER this is a libFuzzer target, otherwise main
+// replays each file given on the command line or stdin, which is what AFL
+// and the seed corpus in corpus/portal_surface use
+
+extern int gStackMallocAt;
+
+TEST_DEFINE_FAILURES
+
+#define TEST_HEAP_SIZE  (256 * 1024)
+
+#define PORTAL_FUZZ_MAX_GRID    4
+#define PORTAL_FUZZ_MAX_HOLES   2
+
+#define PORTAL_FUZZ_MAX_VERTICES    ((PORTAL_FUZZ_MAX_GRID + 1) * (PORTAL_FUZZ_MAX_GRID + 1))
+#define PORTAL_FUZZ_MAX_EDGES       (PORTAL_FUZZ_MAX_GRID * PORTAL_FUZZ_MAX_GRID * 6)
+
+// PORTAL_HOLE_SCALE_X and PORTAL_HOLE_SCALE_Y in surface units
+#define PORTAL_FUZZ_HOLE_X          242
+#define PORTAL_FUZZ_HOLE_Y          204
+
+#define GFX_VERTEX_CACHE_SIZE       32
+
+// from portal_surface.c and memory.c
+#define PORTAL_EDGE_PADDING         3
+#define STACK_MALLOC_SIZE_BYTES     (8 * 1024)
+
+enum PortalFuzzHoleFlags {
+    PortalFuzzHoleFlagsStartMask = 0x7,
+    PortalFuzzHoleFlagsSideways = (1 << 3),
+};
+
+static long long gTestHeap[TEST_HEAP_SIZE / sizeof(long long)];
+
+struct FuzzInput {
+    const uint8_t* data;
+    size_t size;
+    size_t at;
+};
+
+static int fuzzReadU8(struct FuzzInput* input) {
+    if (input->at >= input->size) {
+        ++input->at;
+        return 0;
+    }
+
+    return input->data[input->at++];
+}
+
+static int fuzzReadS16(struct FuzzInput* input) {
+    int low = fuzzReadU8(input);
+    int high = fuzzReadU8(input);
+    return (short)(low | (high << 8));
+}
+
+Time timeGetTime() {
+    static Time currentTime;
+    return ++currentTime;
+}
+
+struct FuzzSurface {
+    struct Vector2s16 vertices[PORTAL_FUZZ_MAX_VERTICES];
+    struct SurfaceEdge edges[PORTAL_FUZZ_MAX_EDGES];
+    Vtx gfxVertices[PORTAL_FUZZ_MAX_VERTICES];
+};
+
+static void fuzzAddTriangle(struct PortalSurface* surface, int a, int b, int c) {
+    int first = surface->edgeCount;
+    int points[3] = {a, b, c};
+
+    for (int i = 0; i < 3; ++i) {
+        struct SurfaceEdge* edge = &surface->edges[first + i];
+        edge->pointIndex = points[i];
+        edge->nextEdge = first + (i + 1) % 3;
+        edge->prevEdge = first + (i + 2) % 3;
+        edge->reverseEdge = NO_EDGE_CONNECTION;
+    }
+
+    surface->edgeCount += 3;
+}
+
+// a grid of triangles wound the same way the level exporter winds them
+static void fuzzBuildSurface(struct FuzzSurface* storage, int columns, int rows, int cellSize, struct PortalSurface* surface) {
+    zeroMemory(surface, sizeof(struct PortalSurface));
+    surface->vertices = storage->vertices;
+    surface->edges = storage->edges;
+    surface->gfxVertices = storage->gfxVertices;
+
+    for (int y = 0; y <= rows; ++y) {
+        for (int x = 0; x <= columns; ++x) {
+            int index = surface->vertexCount++;
+            storage->vertices[index].x = x * cellSize;
+            storage->vertices[index].y = y * cellSize;
+
+            Vtx* vtx = &storage->gfxVertices[index];
+            zeroMemory(vtx, sizeof(Vtx));
+            vtx->v.ob[0] = x * cellSize;
+            vtx->v.ob[2] = -y * cellSize;
+            vtx->v.tc[0] = x << 10;
+            vtx->v.tc[1] = y << 10;
+            vtx->v.cn[1] = 127;
+        }
+    }
+
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < columns; ++x) {
+            int a = y * (columns + 1) + x;
+            int b = a + 1;
+            int c = b + columns + 1;
+            int d = a + columns + 1;
+
+            fuzzAddTriangle(surface, a, b, c);
+            fuzzAddTriangle(surface, a, c, d);
+        }
+    }
+
+    for (int i = 0; i < surface->edgeCount; ++i) {
+        struct SurfaceEdge* edge = &surface->edges[i];
+        int from = edge->pointIndex;
+        int to = surface->edges[edge->nextEdge].pointIndex;
+
+        for (int j = 0; j < surface->edgeCount; ++j) {
+            struct SurfaceEdge* other = &surface->edges[j];
+
+            if (other->pointIndex == to && surface->edges[other->nextEdge].pointIndex == from) {
+                edge->reverseEdge = j;
+                break;
+            }
+        }
+    }
+}
+
+static void fuzzBuildLoop(struct FuzzInput* input, struct Vector2s16* loop) {
+    int x = fuzzReadS16(input);
+    int y = fuzzReadS16(input);
+    int scale = fuzzReadU8(input) + 64;
+    int flags = fuzzReadU8(input);
+
+    int holeX = PORTAL_FUZZ_HOLE_X * scale / 128;
+    int holeY = PORTAL_FUZZ_HOLE_Y * scale / 128;
+
+    if (flags & PortalFuzzHoleFlagsSideways) {
+        int tmp = holeX;
+        holeX = holeY;
+        holeY = tmp;
+    }
+
+    // same shape as gPortalOutlineWorld
+    int outline[PORTAL_LOOP_SIZE][2] = {
+        {-holeX * 354 / 1000, holeY * 707 / 1000},
+        {-holeX / 2, 0},
+        {-holeX * 354 / 1000, -holeY * 707 / 1000},
+        {0, -holeY},
+        {holeX * 354 / 1000, -holeY * 707 / 1000},
+        {holeX / 2, 0},
+        {holeX * 354 / 1000, holeY * 707 / 1000},
+        {0, holeY},
+    };
+
+    // portalSurfaceAdjustPosition hands over the outline clockwise in
+    // surface space whichever way the portal faces
+    int start = flags & PortalFuzzHoleFlagsStartMask;
+
+    for (int i = 0; i < PORTAL_LOOP_SIZE; ++i) {
+        int source = (PORTAL_LOOP_SIZE - 1) - (start + i) % PORTAL_LOOP_SIZE;
+        loop[i].x = (short)(x + outline[source][0]);
+        loop[i].y = (short)(y + outline[source][1]);
+    }
+}
+
+struct FuzzBounds {
+    struct Vector2s16 min;
+    struct Vector2s16 max;
+};
+
+static void fuzzLoopBounds(struct Vector2s16* loop, struct FuzzBounds* bounds) {
+    bounds->min = loop[0];
+    bounds->max = loop[0];
+
+    for (int i = 1; i < PORTAL_LOOP_SIZE; ++i) {
+        bounds->min.x = MIN(bounds->min.x, loop[i].x);
+        bounds->min.y = MIN(bounds->min.y, loop[i].y);
+        bounds->max.x = MAX(bounds->max.x, loop[i].x);
+        bounds->max.y = MAX(bounds->max.y, loop[i].y);
+    }
+
+    bounds->min.x -= PORTAL_EDGE_PADDING * 2;
+    bounds->min.y -= PORTAL_EDGE_PADDING * 2;
+    bounds->max.x += PORTAL_EDGE_PADDING * 2;
+    bounds->max.y += PORTAL_EDGE_PADDING * 2;
+}
+
+static int fuzzBoundsOverlap(struct FuzzBounds* a, struct FuzzBounds* b) {
+    return a->max.x > b->min.x && a->min.x < b->max.x &&
+        a->max.y > b->min.y && a->min.y < b->max.y;
+}
+
+// portalSurfaceAdjustPosition only lets a portal through once it is
+// clear of every one sided edge, including the ones around another portal
+static int fuzzIsPlacementValid(struct PortalSurface* surface, struct Vector2s16* loop, struct FuzzBounds* bounds, int boundsCount, struct FuzzBounds* surfaceBounds) {
+    struct FuzzBounds loopBounds;
+    fuzzLoopBounds(loop, &loopBounds);
+
+    if (loopBounds.min.x <= surfaceBounds->min.x || loopBounds.max.x >= surfaceBounds->max.x ||
+        loopBounds.min.y <= surfaceBounds->min.y || loopBounds.max.y >= surfaceBounds->max.y) {
+        return 0;
+    }
+
+    for (int i = 0; i < boundsCount; ++i) {
+        if (fuzzBoundsOverlap(&loopBounds, &bounds[i])) {
+            return 0;
+        }
+    }
+
+    for (int i = 0; i < surface->edgeCount; ++i) {
+        struct SurfaceEdge* edge = &surface->edges[i];
+
+        if (edge->nextEdge == NO_EDGE_CONNECTION || edge->reverseEdge != NO_EDGE_CONNECTION) {
+            continue;
+        }
+
+        struct Vector2s16 a = surface->vertices[edge->pointIndex];
+        struct Vector2s16 b = surface->vertices[surface->edges[edge->nextEdge].pointIndex];
+        struct FuzzBounds edgeBounds = {
+            {{{MIN(a.x, b.x), MIN(a.y, b.y)}}},
+            {{{MAX(a.x, b.x), MAX(a.y, b.y)}}},
+        };
+
+        if (fuzzBoundsOverlap(&loopBounds, &edgeBounds)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static int fuzzTriangleArea(struct PortalSurface* surface, int a, int b, int c) {
+    struct Vector2s16 ab;
+    struct Vector2s16 ac;
+    vector2s16Sub(&surface->vertices[b], &surface->vertices[a], &ab);
+    vector2s16Sub(&surface->vertices[c], &surface->vertices[a], &ac);
+    return vector2s16Cross(&ab, &ac);
+}
+
+static void fuzzCheckDisplayList(struct PortalSurface* surface, int triangleCount) {
+    int loaded[GFX_VERTEX_CACHE_SIZE];
+    int commandCount = 0;
+    int emittedTriangles = 0;
+
+    for (int i = 0; i < GFX_VERTEX_CACHE_SIZE; ++i) {
+        loaded[i] = -1;
+    }
+
+    for (Gfx* gfx = surface->triangles;; ++gfx) {
+        ++commandCount;
+
+        if (gfx->command == MockGfxCommandEndDisplayList) {
+            break;
+        }
+
+        if (gfx->command == MockGfxCommandVertex) {
+            int count = gfx->args[0];
+            int start = gfx->args[1];
+            int firstVertex = (int)((const Vtx*)gfx->pointer - surface->gfxVertices);
+
+            TEST_CHECK(count > 0 && start + count <= GFX_VERTEX_CACHE_SIZE);
+            TEST_CHECK(firstVertex >= 0 && firstVertex + count <= surface->vertexCount);
+
+            if (start + count > GFX_VERTEX_CACHE_SIZE) {
+                return;
+            }
+
+            for (int i = 0; i < count; ++i) {
+                loaded[start + i] = firstVertex + i;
+            }
+
+            continue;
+        }
+
+        TEST_CHECK(gfx->command == MockGfxCommandTriangle);
+
+        if (gfx->command != MockGfxCommandTriangle) {
+            return;
+        }
+
+        for (int triangle = 0; triangle < gfx->args[0]; ++triangle) {
+            int vertices[3];
+
+            for (int i = 0; i < 3; ++i) {
+                int cacheIndex = gfx->args[1 + triangle * 3 + i];
+                TEST_CHECK(cacheIndex < GFX_VERTEX_CACHE_SIZE && loaded[cacheIndex] != -1);
+
+                if (cacheIndex >= GFX_VERTEX_CACHE_SIZE || loaded[cacheIndex] == -1) {
+                    return;
+                }
+
+                vertices[i] = loaded[cacheIndex];
+            }
+
+            TEST_CHECK(fuzzTriangleArea(surface, vertices[0], vertices[1], vertices[2]) >= 0);
+            ++emittedTriangles;
+        }
+    }
+
+    TEST_CHECK(emittedTriangles == triangleCount);
+    // newGfxFromSurfaceBuilder builds the list in a buffer of one command per triangle
+    TEST_CHECK(commandCount <= triangleCount);
+}
+
+static void fuzzCheckSurface(struct PortalSurface* original, struct PortalSurface* surface) {
+    int liveEdges = 0;
+
+    TEST_CHECK(surface->vertexCount >= original->vertexCount);
+    TEST_CHECK(surface->edgeCount >= original->edgeCount);
+
+    for (int i = 0; i < original->vertexCount && i < surface->vertexCount; ++i) {
+        TEST_CHECK(surface->vertices[i].equalTest == original->vertices[i].equalTest);
+    }
+
+    for (int i = 0; i < surface->edgeCount; ++i) {
+        struct SurfaceEdge* edge = &surface->edges[i];
+
+        if (edge->nextEdge == NO_EDGE_CONNECTION) {
+            continue;
+        }
+
+        ++liveEdges;
+
+        TEST_CHECK(edge->pointIndex < surface->vertexCount);
+        TEST_CHECK(edge->nextEdge < surface->edgeCount);
+        TEST_CHECK(edge->prevEdge < surface->edgeCount);
+
+        if (edge->pointIndex >= surface->vertexCount || edge->nextEdge >= surface->edgeCount || edge->prevEdge >= surface->edgeCount) {
+            return;
+        }
+
+        struct SurfaceEdge* next = &surface->edges[edge->nextEdge];
+
+        TEST_CHECK(next->prevEdge == i);
+        TEST_CHECK(surface->edges[edge->prevEdge].nextEdge == i);
+        // every face is a triangle once the hole is cut
+        TEST_CHECK(next->nextEdge < surface->edgeCount && surface->edges[next->nextEdge].nextEdge == i);
+
+        if (edge->reverseEdge != NO_EDGE_CONNECTION) {
+            TEST_CHECK(edge->reverseEdge < surface->edgeCount);
+
+            if (edge->reverseEdge >= surface->edgeCount) {
+                return;
+            }
+
+            struct SurfaceEdge* reverse = &surface->edges[edge->reverseEdge];
+            TEST_CHECK(reverse->reverseEdge == i);
+            TEST_CHECK(reverse->pointIndex == next->pointIndex);
+        }
+    }
+
+    TEST_CHECK(liveEdges % 3 == 0);
+
+    fuzzCheckDisplayList(surface, liveEdges / 3);
+}
+
+// twice the area covered by the triangles of surface
+static long long fuzzSurfaceArea(struct PortalSurface* surface) {
+    long long result = 0;
+
+    for (int i = 0; i < surface->edgeCount; ++i) {
+        struct SurfaceEdge* edge = &surface->edges[i];
+
+        if (edge->nextEdge == NO_EDGE_CONNECTION) {
+            continue;
+        }
+
+        struct SurfaceEdge* next = &surface->edges[edge->nextEdge];
+
+        // count each triangle from its lowest edge
+        if (i < edge->nextEdge && i < next->nextEdge) {
+            result += fuzzTriangleArea(surface, edge->pointIndex, next->pointIndex, surface->edges[next->nextEdge].pointIndex);
+        }
+    }
+
+    return result;
+}
+
+// the new surface should cover what the old one did minus the hole
+static void fuzzCheckArea(struct PortalSurface* original, struct PortalSurface* surface, struct Vector2s16* loop) {
+    long long loopArea = 0;
+    long long perimeter = 0;
+
+    for (int i = 0; i < PORTAL_LOOP_SIZE; ++i) {
+        struct Vector2s16* a = &loop[i];
+        struct Vector2s16* b = &loop[(i + 1) % PORTAL_LOOP_SIZE];
+        loopArea += (long long)a->x * b->y - (long long)b->x * a->y;
+        perimeter += abs(b->x - a->x) + abs(b->y - a->y);
+    }
+
+    // the loop is clockwise so loopArea is negative
+    long long difference = fuzzSurfaceArea(original) + loopArea - fuzzSurfaceArea(surface);
+
+    // points where the loop crosses an edge are rounded to
+    // the nearest unit, moving the edge of the hole slightly
+    TEST_CHECK(difference <= perimeter * 3 && difference >= -perimeter * 3);
+}
+
+static void fuzzCleanupSurface(struct PortalSurface* surface) {
+    free(surface->vertices);
+    free(surface->edges);
+    free(surface->gfxVertices);
+    free(surface->triangles);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    struct FuzzInput input = {data, size, 0};
+    struct FuzzSurface storage;
+    struct PortalSurface surfaces[PORTAL_FUZZ_MAX_HOLES + 1];
+    int failuresBefore = gTestFailures;
+
+    heapInit(gTestHeap, (char*)gTestHeap + sizeof(gTestHeap));
+    stackMallocReset();
+
+    int columns = 1 + fuzzReadU8(&input) % PORTAL_FUZZ_MAX_GRID;
+    int rows = 1 + fuzzReadU8(&input) % PORTAL_FUZZ_MAX_GRID;
+    int cellSize = 32 + fuzzReadU8(&input) * 4;
+
+    fuzzBuildSurface(&storage, columns, rows, cellSize, &surfaces[0]);
+
+    struct FuzzBounds surfaceBounds = {{{{0, 0}}}, {{{columns * cellSize, rows * cellSize}}}};
+    struct FuzzBounds holeBounds[PORTAL_FUZZ_MAX_HOLES];
+    int surfaceCount = 1;
+
+    // the second portal is cut into the surface the first one left
+    for (int hole = 0; hole < PORTAL_FUZZ_MAX_HOLES && input.at < input.size; ++hole) {
+        struct Vector2s16 loop[PORTAL_LOOP_SIZE];
+        fuzzBuildLoop(&input, loop);
+
+        struct PortalSurface* current = &surfaces[surfaceCount - 1];
+        struct PortalSurface* result = &surfaces[surfaceCount];
+
+        if (!fuzzIsPlacementValid(current, loop, holeBounds, surfaceCount - 1, &surfaceBounds)) {
+            continue;
+        }
+
+        int stackBefore = gStackMallocAt;
+        stackMallocResetPeak();
+
+        if (portalSurfacePokeHole(current, loop, result)) {
+            fuzzCheckSurface(current, result);
+            fuzzCheckArea(current, result, loop);
+            fuzzLoopBounds(loop, &holeBounds[surfaceCount - 1]);
+            ++surfaceCount;
+        }
+
+        TEST_CHECK(gStackMallocAt == stackBefore);
+        TEST_CHECK(stackMallocPeakBytes() <= STACK_MALLOC_SIZE_BYTES);
+    }
+
+    for (int i = 1; i < surfaceCount; ++i) {
+        fuzzCleanupSurface(&surfaces[i]);
+    }
+
+#ifdef PORTAL64_LIBFUZZER
+    if (gTestFailures != failuresBefore) {
+        __builtin_trap();
+    }
+#endif
+
+    return gTestFailures != failuresBefore;
+}
+
+#ifndef PORTAL64_LIBFUZZER
+
+static int fuzzRunFile(FILE* file, const char* name) {
+    static uint8_t data[4096];
+    size_t size = fread(data, 1, sizeof(data), file);
+
+    int failed = LLVMFuzzerTestOneInput(data, size);
+    printf("%s %s\n", failed ? "FAIL" : "pass", name);
+    return failed;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fuzzRunFile(stdin, "stdin");
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        FILE* file = fopen(argv[i], "rb");
+
+        if (!file) {
+            fprintf(stderr, "could not open %s\n", argv[i]);
+            ++gTestFailures;
+            continue;
+        }
+
+        fuzzRunFile(file, argv[i]);
+        fclose(file);
+    }
+
+    printf("portalSurfacePokeHole called %d times, %d failed\n", portalSurfaceGeneratorStats()->pokeCount, portalSurfaceGeneratorStats()->failureCount);
+
+    return gTestFailures ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,307 @@
+#include "test.h"
+
+#include "audio/soundplayer.h"
+#include "savefile/savefile.h"
+#include "system/time.h"
+
+TEST_DEFINE_FAILURES
+
+// must match MAX_ACTIVE_SOUNDS in soundplayer.h
+#define TEST_VOICE_COUNT    24
+
+#define TEST_CLIP_LOOP      1
+#define TEST_CLIP_ONE_SHOT  2
+
+struct SaveData gSaveData = {{0xFFFF, 0xFFFF, 0}};
+float gFixedDeltaTime = 1.0f / 30.0f;
+
+// A stub of audio.h that hands out voices from a fixed table
+// and checks that the sound player only touches voices it owns
+
+struct TestVoice {
+    short isAllocated;
+    short isPlaying;
+    short isPaused;
+    short isLooped;
+    float volume;
+};
+
+static struct TestVoice gVoices[TEST_VOICE_COUNT];
+static int gVoiceBudget;
+
+static int testIsVoiceValid(VoiceId voiceId) {
+    return voiceId >= 0 && voiceId < TEST_VOICE_COUNT && gVoices[voiceId].isAllocated;
+}
+
+int clipsCheckSoundSkippable(unsigned short soundId) {
+    return 0;
+}
+
+void* audioInit(void* memoryEnd, int maxVoices) {
+    for (int i = 0; i < TEST_VOICE_COUNT; ++i) {
+        gVoices[i] = (struct TestVoice){0};
+    }
+
+    gVoiceBudget = maxVoices;
+    return memoryEnd;
+}
+
+void audioUpdate() {}
+
+void audioDestroy() {}
+
+struct AudioStats* audioStats() {
+    return NULL;
+}
+
+int audioVoiceBudget() {
+    return gVoiceBudget;
+}
+
+int audioIsSoundClipLooped(int soundClipId) {
+    return soundClipId == TEST_CLIP_LOOP;
+}
+
+VoiceId audioPlaySound(int soundClipId, float volume, float pitch, float pan, float echo) {
+    for (int i = 0; i < TEST_VOICE_COUNT; ++i) {
+        if (!gVoices[i].isAllocated) {
+            gVoices[i] = (struct TestVoice){1, 1, 0, audioIsSoundClipLooped(soundClipId), volume};
+            return i;
+        }
+    }
+
+    return VOICE_ID_NONE;
+}
+
+void audioSetSoundParams(VoiceId voiceId, float volume, float pitch, float pan, float echo) {
+    TEST_CHECK(testIsVoiceValid(voiceId));
+
+    if (testIsVoiceValid(voiceId) && volume >= 0.0f) {
+        gVoices[voiceId].volume = volume;
+    }
+}
+
+int audioIsSoundPlaying(VoiceId voiceId) {
+    TEST_CHECK(testIsVoiceValid(voiceId));
+    return testIsVoiceValid(voiceId) && gVoices[voiceId].isPlaying;
+}
+
+int audioIsSoundLooped(VoiceId voiceId) {
+    return testIsVoiceValid(voiceId) && gVoices[voiceId].isLooped;
+}
+
+void audioPauseSound(VoiceId voiceId) {
+    TEST_CHECK(testIsVoiceValid(voiceId));
+
+    if (testIsVoiceValid(voiceId)) {
+        gVoices[voiceId].isPaused = 1;
+    }
+}
+
+int audioIsSoundPaused(VoiceId voiceId) {
+    TEST_CHECK(testIsVoiceValid(voiceId));
+    return testIsVoiceValid(voiceId) && gVoices[voiceId].isPaused;
+}
+
+void audioResumeSound(VoiceId voiceId) {
+    TEST_CHECK(testIsVoiceValid(voiceId));
+
+    if (testIsVoiceValid(voiceId)) {
+        gVoices[voiceId].isPaused = 0;
+    }
+}
+
+void audioStopSound(VoiceId voiceId) {
+    TEST_CHECK(testIsVoiceValid(voiceId));
+
+    if (testIsVoiceValid(voiceId)) {
+        gVoices[voiceId].isPlaying = 0;
+    }
+}
+
+void audioReleaseVoice(VoiceId voiceId) {
+    // only stopped voices should be released
+    TEST_CHECK(testIsVoiceValid(voiceId) && !gVoices[voiceId].isPlaying);
+
+    if (testIsVoiceValid(voiceId)) {
+        gVoices[voiceId] = (struct TestVoice){0};
+    }
+}
+
+static int testAllocatedVoices() {
+    int result = 0;
+
+    for (int i = 0; i < TEST_VOICE_COUNT; ++i) {
+        if (gVoices[i].isAllocated) {
+            ++result;
+        }
+    }
+
+    return result;
+}
+
+static struct Vector3 gZero = {0.0f, 0.0f, 0.0f};
+
+static void testInit() {
+    struct Vector3 right = {1.0f, 0.0f, 0.0f};
+
+    soundPlayerInit(NULL);
+    soundListenerUpdate(0, &gZero, &right, &gZero);
+    soundListenerSetCount(1);
+}
+
+static void testUpdate(int frames) {
+    for (int i = 0; i < frames; ++i) {
+        soundPlayerUpdate();
+        TEST_CHECK(soundPlayerStats()->voiceCount == testAllocatedVoices());
+    }
+}
+
+static SoundId testPlayLoop(float distance) {
+    struct Vector3 position = {distance, 0.0f, 0.0f};
+    return soundPlayerPlay(TEST_CLIP_LOOP, 1.0f, 1.0f, &position, &gZero, SoundTypeAll);
+}
+
+static void testFillVoices(SoundId* soundIds) {
+    for (int i = 0; i < TEST_VOICE_COUNT; ++i) {
+        soundIds[i] = testPlayLoop(20.0f);
+        TEST_CHECK(soundIds[i] != SOUND_ID_NONE);
+    }
+
+    TEST_CHECK(testAllocatedVoices() == TEST_VOICE_COUNT);
+}
+
+static void testStealVoice() {
+    SoundId quiet[TEST_VOICE_COUNT];
+
+    testInit();
+    testFillVoices(quiet);
+
+    // no voice is free so the loud loop starts virtual
+    // and takes the voice of one of the quiet loops
+    SoundId loud = testPlayLoop(1.0f);
+    TEST_CHECK(loud != SOUND_ID_NONE);
+    TEST_CHECK(soundPlayerIsPlaying(loud));
+
+    testUpdate(4);
+
+    struct SoundPlayerStats* stats = soundPlayerStats();
+    TEST_CHECK(stats->voiceCount == TEST_VOICE_COUNT);
+    TEST_CHECK(stats->virtualCount == 1);
+    TEST_CHECK(stats->virtualizeCount == 1);
+    TEST_CHECK(stats->reviveCount == 1);
+    TEST_CHECK(soundPlayerIsPlaying(loud));
+    TEST_CHECK(soundPlayerSoundCount() == TEST_VOICE_COUNT + 1);
+
+    // the loud loop keeps its voice rather than trading it back
+    testUpdate(30);
+    TEST_CHECK(stats->virtualizeCount == 1);
+    TEST_CHECK(stats->reviveCount == 1);
+}
+
+static void testOneShotDropped() {
+    SoundId quiet[TEST_VOICE_COUNT];
+
+    testInit();
+    testFillVoices(quiet);
+
+    // one shots can't start partway through so they aren't virtualized
+    TEST_CHECK(soundPlayerPlay(TEST_CLIP_ONE_SHOT, 1.0f, 1.0f, NULL, NULL, SoundTypeAll) == SOUND_ID_NONE);
+    TEST_CHECK(soundPlayerStats()->droppedCount == 1);
+    TEST_CHECK(soundPlayerSoundCount() == TEST_VOICE_COUNT);
+}
+
+static void testOutOfEarshot() {
+    testInit();
+
+    SoundId soundId = testPlayLoop(1.0f);
+    testUpdate(1);
+    TEST_CHECK(soundPlayerStats()->voiceCount == 1);
+
+    struct Vector3 far = {1000.0f, 0.0f, 0.0f};
+    soundPlayerSetPosition(soundId, &far, &gZero);
+    testUpdate(2);
+
+    TEST_CHECK(soundPlayerStats()->voiceCount == 0);
+    TEST_CHECK(soundPlayerStats()->virtualCount == 1);
+    TEST_CHECK(soundPlayerIsPlaying(soundId));
+
+    // a loop that starts out of earshot never takes a voice
+    SoundId farLoop = testPlayLoop(1000.0f);
+    TEST_CHECK(farLoop != SOUND_ID_NONE);
+    TEST_CHECK(testAllocatedVoices() == 0);
+
+    struct Vector3 near = {1.0f, 0.0f, 0.0f};
+    soundPlayerSetPosition(soundId, &near, &gZero);
+    testUpdate(2);
+
+    TEST_CHECK(soundPlayerStats()->voiceCount == 1);
+    TEST_CHECK(soundPlayerStats()->virtualCount == 1);
+    TEST_CHECK(soundPlayerStats()->reviveCount == 1);
+}
+
+static void testVoiceBudget() {
+    SoundId quiet[TEST_VOICE_COUNT];
+
+    testInit();
+    testFillVoices(quiet);
+
+    // the mixer gives up voices one loop at a time
+    gVoiceBudget = 16;
+    testUpdate(30);
+    TEST_CHECK(soundPlayerStats()->voiceCount == 16);
+    TEST_CHECK(soundPlayerStats()->virtualCount == TEST_VOICE_COUNT - 16);
+
+    gVoiceBudget = TEST_VOICE_COUNT;
+    testUpdate(30);
+    TEST_CHECK(soundPlayerStats()->voiceCount == TEST_VOICE_COUNT);
+    TEST_CHECK(soundPlayerStats()->virtualCount == 0);
+}
+
+static void testPausedVirtual() {
+    testInit();
+
+    SoundId soundId = testPlayLoop(1000.0f);
+    testUpdate(1);
+    TEST_CHECK(soundPlayerStats()->virtualCount == 1);
+
+    soundPlayerPause();
+
+    struct Vector3 near = {1.0f, 0.0f, 0.0f};
+    soundPlayerSetPosition(soundId, &near, &gZero);
+    testUpdate(2);
+
+    // paused virtual sounds stay virtual until resumed
+    TEST_CHECK(testAllocatedVoices() == 0);
+
+    soundPlayerResume();
+    testUpdate(1);
+    TEST_CHECK(testAllocatedVoices() == 1);
+}
+
+static void testStopAll() {
+    SoundId quiet[TEST_VOICE_COUNT];
+
+    testInit();
+    testFillVoices(quiet);
+    testPlayLoop(1000.0f);
+    testUpdate(1);
+
+    soundPlayerStopAll();
+    testUpdate(2);
+
+    TEST_CHECK(soundPlayerSoundCount() == 0);
+    TEST_CHECK(testAllocatedVoices() == 0);
+    TEST_CHECK(soundPlayerStats()->virtualCount == 0);
+}
+
+int main() {
+    TEST_RUN(testStealVoice);
+    TEST_RUN(testOneShotDropped);
+    TEST_RUN(testOutOfEarshot);
+    TEST_RUN(testVoiceBudget);
+    TEST_RUN(testPausedVirtual);
+    TEST_RUN(testStopAll);
+
+    return gTestFailures ? 1 : 0;
+}
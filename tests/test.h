@@ -0,0 +1,23 @@
+#ifndef __TESTS_TEST_H__
+#define __TESTS_TEST_H__
+
+#include <stdio.h>
+
+extern int gTestFailures;
+
+#define TEST_CHECK(condition) do { \
+    if (!(condition)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+        ++gTestFailures; \
+    } \
+} while (0)
+
+#define TEST_RUN(test) do { \
+    int failuresBefore = gTestFailures; \
+    test(); \
+    printf("%s %s\n", failuresBefore == gTestFailures ? "pass" : "FAIL", #test); \
+} while (0)
+
+#define TEST_DEFINE_FAILURES int gTestFailures;
+
+#endif
@@ -0,0 +1,267 @@
+const childProcess = require('child_process');
+const fs = require('fs');
+const path = require('path');
+const util = require('util');
+const { getObjectName } = require('./segment_utils');
+
+// Must match src/util/compressed_segment.h
+const HEADER_MAGIC = 'Yaz0';
+const HEADER_SIZE = 16;
+const SEGMENT_ALIGNMENT = 16;
+
+const WINDOW_SIZE = 0x1000;
+const MIN_MATCH = 3;
+const MAX_MATCH = 0x111;
+const MAX_CHAIN = 256;
+
+function align(value, alignment) {
+    return Math.ceil(value / alignment) * alignment;
+}
+
+function hashAt(input, index) {
+    return ((input[index] << 8) ^ (input[index + 1] << 4) ^ input[index + 2]) & 0xFFFF;
+}
+
+function findMatch(input, index, head, prev) {
+    const maxLength = Math.min(MAX_MATCH, input.length - index);
+    let bestLength = 0;
+    let bestDistance = 0;
+
+    if (maxLength < MIN_MATCH) {
+        return { length: 0, distance: 0 };
+    }
+
+    let candidate = head[hashAt(input, index)];
+
+    for (let chain = 0; candidate >= 0 && index - candidate <= WINDOW_SIZE && chain < MAX_CHAIN; ++chain) {
+        let length = 0;
+        while (length < maxLength && input[candidate + length] === input[index + length]) {
+            ++length;
+        }
+
+        if (length > bestLength) {
+            bestLength = length;
+            bestDistance = index - candidate;
+
+            if (length === maxLength) {
+                break;
+            }
+        }
+
+        candidate = prev[candidate];
+    }
+
+    return bestLength >= MIN_MATCH ?
+        { length: bestLength, distance: bestDistance } :
+        { length: 0, distance: 0 };
+}
+
+// Yaz0 style LZ77. Each flag byte describes the next 8 items,
+// a set bit is a literal byte and a clear bit is a back reference
+function compress(input) {
+    const output = [];
+    const head = new Int32Array(0x10000).fill(-1);
+    const prev = new Int32Array(input.length).fill(-1);
+
+    // The decompressor works in place with the compressed data at
+    // the end of the buffer, so the output must never catch up to
+    // compressed bytes that haven't been read yet
+    let inPlaceMargin = 0;
+    let flagIndex = 0;
+    let flagBit = 0;
+    let index = 0;
+
+    const insertHash = (at) => {
+        if (at + MIN_MATCH <= input.length) {
+            const hash = hashAt(input, at);
+            prev[at] = head[hash];
+            head[hash] = at;
+        }
+    };
+
+    while (index < input.length) {
+        if (flagBit === 0) {
+            flagIndex = output.length;
+            output.push(0);
+            flagBit = 0x80;
+        }
+
+        const { length, distance } = findMatch(input, index, head, prev);
+
+        if (length) {
+            const encodedDistance = distance - 1;
+
+            if (length >= 0x12) {
+                output.push(encodedDistance >> 8, encodedDistance & 0xFF, length - 0x12);
+            } else {
+                output.push(((length - 2) << 4) | (encodedDistance >> 8), encodedDistance & 0xFF);
+            }
+
+            for (let i = 0; i < length; ++i) {
+                insertHash(index + i);
+            }
+            index += length;
+        } else {
+            output[flagIndex] |= flagBit;
+            output.push(input[index]);
+            insertHash(index);
+            ++index;
+        }
+
+        flagBit >>= 1;
+        inPlaceMargin = Math.max(inPlaceMargin, index - (HEADER_SIZE + output.length));
+    }
+
+    const compressedSize = align(HEADER_SIZE + output.length, SEGMENT_ALIGNMENT);
+    const workSize = align(Math.max(input.length, inPlaceMargin + compressedSize), SEGMENT_ALIGNMENT);
+
+    const result = Buffer.alloc(compressedSize);
+    result.write(HEADER_MAGIC, 0, 'ascii');
+    result.writeUInt32BE(input.length, 4);
+    result.writeUInt32BE(compressedSize, 8);
+    result.writeUInt32BE(workSize, 12);
+    Buffer.from(output).copy(result, HEADER_SIZE);
+
+    return result;
+}
+
+// Decompresses the same way the game does to check the result and
+// that the in place margin holds
+function verify(name, input, compressed) {
+    const uncompressedSize = compressed.readUInt32BE(4);
+    const compressedSize = compressed.readUInt32BE(8);
+    const workSize = compressed.readUInt32BE(12);
+
+    const buffer = Buffer.alloc(workSize);
+    const base = workSize - compressedSize;
+    compressed.copy(buffer, base);
+
+    let src = base + HEADER_SIZE;
+    let dst = 0;
+    let flags = 0;
+    let flagBit = 0;
+
+    const check = () => {
+        if (dst > src) {
+            throw new Error(`${name}: output overran compressed data at ${dst}`);
+        }
+    };
+
+    while (dst < uncompressedSize) {
+        if (flagBit === 0) {
+            flags = buffer[src++];
+            flagBit = 0x80;
+        }
+
+        if (flags & flagBit) {
+            buffer[dst++] = buffer[src++];
+        } else {
+            const first = buffer[src++];
+            const second = buffer[src++];
+            const distance = (((first & 0xF) << 8) | second) + 1;
+            const length = (first >> 4) ? (first >> 4) + 2 : buffer[src++] + 0x12;
+
+            for (let i = 0; i < length; ++i) {
+                buffer[dst] = buffer[dst - distance];
+                ++dst;
+            }
+        }
+
+        flagBit >>= 1;
+        check();
+    }
+
+    if (!buffer.subarray(0, uncompressedSize).equals(input)) {
+        throw new Error(`${name}: round trip mismatch`);
+    }
+}
+
+function extractSection(objcopy, elfFile, sectionName, outputFile) {
+    childProcess.execFileSync(objcopy, [
+        '-O', 'binary',
+        `--only-section=${sectionName}`,
+        elfFile,
+        outputFile,
+    ]);
+
+    return fs.readFileSync(outputFile);
+}
+
+function generateAsm(segments) {
+    return segments.map(({ name, compressedFile }) => `.section .${name}.pz, "a"
+.incbin "${compressedFile}"
+`).join('\n');
+}
+
+function formatSize(bytes) {
+    return `${(bytes / 1024).toFixed(1)}K`;
+}
+
+let totalUncompressed = 0;
+let totalCompressed = 0;
+
+function compressSegment(name, input, compressedFile) {
+    const compressed = compress(input);
+    verify(name, input, compressed);
+    fs.writeFileSync(compressedFile, compressed);
+
+    totalUncompressed += input.length;
+    totalCompressed += compressed.length;
+
+    const percent = input.length ? (100 * compressed.length / input.length).toFixed(1) : '100.0';
+    console.log(`${name}: ${formatSize(input.length)} -> ${formatSize(compressed.length)} (${percent}%)`);
+}
+
+// Main
+const { values, positionals } = util.parseArgs({
+    options: {
+        'objcopy': {
+            type: 'string'
+        },
+        // compress files as they are into a directory, used
+        // for the host decompression test fixtures
+        'raw': {
+            type: 'boolean'
+        }
+    },
+    allowPositionals: true
+});
+
+if (values['raw']) {
+    const [outputDir, ...inputFiles] = positionals;
+
+    if (!fs.existsSync(outputDir)) {
+        fs.mkdirSync(outputDir, { recursive: true });
+    }
+
+    for (const inputFile of inputFiles) {
+        const name = path.basename(inputFile, path.extname(inputFile));
+        compressSegment(name, fs.readFileSync(inputFile), path.join(outputDir, `${name}.pz`));
+    }
+
+    console.log(`Compressed segments saved ${formatSize(totalUncompressed - totalCompressed)} of ROM`);
+    process.exit(0);
+}
+
+const [outputAsm, elfFile, ...objectPaths] = positionals;
+const objcopy = values['objcopy'] || 'objcopy';
+
+const outputDir = path.join(path.dirname(outputAsm), 'compressed_segments');
+if (!fs.existsSync(outputDir)) {
+    fs.mkdirSync(outputDir, { recursive: true });
+}
+
+const segments = objectPaths.map(objectPath => {
+    const name = getObjectName(objectPath);
+    const uncompressedFile = path.join(outputDir, `${name}.bin`);
+    const compressedFile = path.join(outputDir, `${name}.pz`);
+
+    const input = extractSection(objcopy, elfFile, `.${name}`, uncompressedFile);
+    compressSegment(name, input, compressedFile);
+
+    return { name, compressedFile };
+});
+
+console.log(`Compressed segments saved ${formatSize(totalUncompressed - totalCompressed)} of ROM`);
+
+fs.writeFileSync(outputAsm, generateAsm(segments));
@@ -1,17 +1,7 @@
 const fs = require('fs');
 const path = require('path');
 const util = require('util');
-
-const INVALID_TOKEN_CHARACTER = /[^A-Za-z0-9_]/gim;
-
-function sanitize(s) {
-    return s.replace(INVALID_TOKEN_CHARACTER, '_');
-}
-
-function getObjectName(objectPath) {
-    const { name } = path.parse(objectPath);
-    return sanitize(name.split('.')[0]);
-}
+const { getObjectName } = require('./segment_utils');
 
 function generateSegmentContent(objectPath) {
     // Use a wildcard so the linker script is configuration independent
@@ -29,20 +19,26 @@ function generateAlign(alignment) {
     return `__romPos = ALIGN(__romPos, ${alignment});\n`;
 }
 
-function generateSegment(segmentName, virtualAddress, alignment, objectPaths) {
+function generateSegment(segmentName, virtualAddress, alignment, compressed, objectPaths) {
     const align = alignment ? `    ${generateAlign(alignment)}` : '';
-    return `${align}    BEGIN_SEG(${segmentName}, ${virtualAddress})
+    // Compressed segments keep their addresses but take their
+    // ROM contents from tools/compress_segments.js
+    const [begin, end] = compressed ?
+        ['BEGIN_COMPRESSED_SEG', 'END_COMPRESSED_SEG'] :
+        ['BEGIN_SEG', 'END_SEG'];
+
+    return `${align}    ${begin}(${segmentName}, ${virtualAddress})
     {
         ${objectPaths.map(generateSegmentContent).join('\n        ')}
     }
-    END_SEG(${segmentName})
+    ${end}(${segmentName})
 `;
 }
 
-function generateMultiSegments(virtualAddress, alignment, objectPaths) {
+function generateMultiSegments(virtualAddress, alignment, compressed, objectPaths) {
     return objectPaths.map(objectPath => {
         const segmentName = getObjectName(objectPath);
-        return generateSegment(segmentName, virtualAddress, alignment, [objectPath]);
+        return generateSegment(segmentName, virtualAddress, alignment, compressed, [objectPath]);
     }).join('\n');
 }
 
@@ -54,6 +50,9 @@ const { values, positionals } = util.parseArgs({
         },
         'alignment': {
             type: 'string'
+        },
+        'compressed': {
+            type: 'boolean'
         }
     },
     allowPositionals: true
@@ -62,6 +61,7 @@ const { values, positionals } = util.parseArgs({
 const [outputLinkerScript, virtualAddress, ...objectPaths] = positionals;
 const singleSegmentName = values['single-segment-name'];
 const alignment = values['alignment'];
+const compressed = values['compressed'];
 
 const outputParentDir = path.dirname(outputLinkerScript);
 if (!fs.existsSync(outputParentDir)) {
@@ -69,6 +69,6 @@ if (!fs.existsSync(outputParentDir)) {
 }
 
 const output = singleSegmentName ?
-    generateSegment(singleSegmentName, virtualAddress, alignment, objectPaths) :
-    generateMultiSegments(virtualAddress, alignment, objectPaths);
+    generateSegment(singleSegmentName, virtualAddress, alignment, compressed, objectPaths) :
+    generateMultiSegments(virtualAddress, alignment, compressed, objectPaths);
 fs.writeFileSync(outputLinkerScript, output);
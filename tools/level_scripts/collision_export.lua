@@ -341,22 +341,23 @@ local function add_collider(collider, collision_layers, room_index)
     table.insert(colliders, collider)
     table.insert(quad_rooms, room_index)
 
+    -- pointers are in named fields so they end up in the relocation table
     local collider_type = {
-        sk_definition_writer.raw("CollisionShapeTypeQuad"),
-        sk_definition_writer.reference_to(collider),
-        0,
-        1,
-        sk_definition_writer.null_value,
+        type = sk_definition_writer.raw("CollisionShapeTypeQuad"),
+        data = sk_definition_writer.reference_to(collider),
+        bounce = 0,
+        friction = 1,
+        callbacks = sk_definition_writer.null_value,
     }
 
     table.insert(collider_types, collider_type)
 
     table.insert(collision_objects, {
-        sk_definition_writer.reference_to(collider_type),
-        sk_definition_writer.null_value,
-        sk_definition_writer.null_value,
-        bb,
-        sk_definition_writer.raw(table.concat(collision_layers, ' | '))
+        collider = sk_definition_writer.reference_to(collider_type),
+        body = sk_definition_writer.null_value,
+        position = sk_definition_writer.null_value,
+        boundingBox = bb,
+        collisionLayers = sk_definition_writer.raw(table.concat(collision_layers, ' | ')),
     })
 end
 
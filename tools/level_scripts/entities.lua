@@ -270,6 +270,42 @@ end
 
 sk_definition_writer.add_definition('incinerators', 'struct IncineratorDefinition[]', '_geo', incinerators)
 
+-- the model of the decor object each BoxDropperCubeType drops,
+-- see sCubeTypeToDecorId and the decor table in decor_object_list.c
+local box_dropper_cube_models = {
+    BoxDropperCubeTypeStandard = 'CUBE_CUBE_DYNAMIC_MODEL',
+    BoxDropperCubeTypeCompanion = 'CUBE_CUBE_DYNAMIC_MODEL',
+}
+
+-- Models the game code draws for each entity. Decor
+-- objects preload their own when created
+local entity_dynamic_models = {
+    {entities = box_droppers, models = function(dropper)
+        return {'PROPS_BOX_DROPPER_GLASS_DYNAMIC_MODEL', box_dropper_cube_models[dropper.cubeType.value]}
+    end},
+    {entities = clocks, models = function() return {'SIGNAGE_CLOCK_DYNAMIC_MODEL', 'SIGNAGE_CLOCK_DIGITS_DYNAMIC_MODEL'} end},
+    {entities = fizzlers, models = function() return {'PROPS_PORTAL_CLEANSER_DYNAMIC_MODEL'} end},
+    {entities = turrets, models = function() return {'PROPS_TURRET_01_EYE_DYNAMIC_MODEL'} end},
+}
+
+local dynamic_model_hints = {}
+local has_dynamic_model_hint = {}
+
+for _, entry in pairs(entity_dynamic_models) do
+    for _, entity in pairs(entry.entities) do
+        -- a dropper without a cube leaves a trailing nil that ipairs stops at
+        for _, model in ipairs(entry.models(entity)) do
+            if not has_dynamic_model_hint[model] then
+                has_dynamic_model_hint[model] = true
+                table.insert(dynamic_model_hints, sk_definition_writer.raw(model))
+            end
+        end
+    end
+end
+
+sk_definition_writer.add_definition('dynamic_model_hints', 'short[]', '_geo', dynamic_model_hints)
+sk_definition_writer.add_header('"codegen/assets/models/dynamic_model_list.h"')
+
 local function generate_static_collision_boxes()
     local collision_boxes = {}
 
@@ -313,5 +349,6 @@ return {
         incinerators = incinerators,
         turrets = turrets,
     },
+    dynamic_model_hints = dynamic_model_hints,
     static_collision_boxes = generate_static_collision_boxes(),
 }
\ No newline at end of file
@@ -11,6 +11,10 @@ local signals = require('tools.level_scripts.signals')
 local animation = require('tools.level_scripts.animation')
 local dynamic_collision = require('tools.level_scripts.dynamic_collision_export')
 
+-- every pointer inside the level segment, used to move
+-- the segment to wherever it is loaded
+local relocations = sk_definition_writer.add_relocation_table("level_relocations", "_geo")
+
 sk_definition_writer.add_definition("level", "struct LevelDefinition", "_geo", {
     collisionQuads = sk_definition_writer.reference_to(collision_export.collision_objects, 1),
     collisionQuadCount = #collision_export.collision_objects,
@@ -76,4 +80,7 @@ sk_definition_writer.add_definition("level", "struct LevelDefinition", "_geo", {
     turretCount = #entities.entities.turrets,
     incinerators = sk_definition_writer.reference_to(entities.entities.incinerators, 1),
     incineratorCount = #entities.entities.incinerators,
+    dynamicModelHints = sk_definition_writer.reference_to(entities.dynamic_model_hints, 1),
+    dynamicModelHintCount = #entities.dynamic_model_hints,
+    relocations = sk_definition_writer.reference_to(relocations, 1),
 })
@@ -135,7 +135,7 @@ local function calculate_portal_single_surface(mesh, mesh_display_list, has_deca
         up = up,
         corner = origin,
 
-        gfxVertices = sk_mesh.generate_vertex_buffer(mesh, mesh.material, "_geo"),
+        gfxVertices = sk_definition_writer.relocatable(sk_mesh.generate_vertex_buffer(mesh, mesh.material, "_geo")),
         triangles = mesh_display_list,
     };
 end
@@ -93,10 +93,55 @@ local function parse_operation(str_value)
     error('operator must be of the form not a, a and b, a or b')
 end
 
+-- Operators run once per frame in order, so any operator that
+-- outputs a signal has to come before the operators that read it.
+-- A loop like a = a or b keeps its original order since there is
+-- no order that evaluates it any differently
+local function sort_operators(parsed_operators)
+    local producers = {}
+
+    for index, operator in ipairs(parsed_operators) do
+        producers[operator.output] = producers[operator.output] or {}
+        table.insert(producers[operator.output], index)
+    end
+
+    local result = {}
+    local visit_state = {}
+
+    local function visit(index)
+        if visit_state[index] then
+            return
+        end
+
+        visit_state[index] = 'visiting'
+
+        for _, input in ipairs(parsed_operators[index].input) do
+            for _, producer in ipairs(producers[input] or {}) do
+                visit(producer)
+            end
+        end
+
+        visit_state[index] = 'done'
+        table.insert(result, parsed_operators[index])
+    end
+
+    for index = 1, #parsed_operators do
+        visit(index)
+    end
+
+    return result
+end
+
+local parsed_operators = {}
+
+for _, operation in ipairs(yaml_loader.json_contents.operators or {}) do
+    table.insert(parsed_operators, parse_operation(operation))
+end
+
 local operators = {}
 
-for _, operation in pairs(yaml_loader.json_contents.operators or {}) do
-    table.insert(operators, generate_operator_data(parse_operation(operation)))
+for _, operator in ipairs(sort_operators(parsed_operators)) do
+    table.insert(operators, generate_operator_data(operator))
 end
 
 sk_definition_writer.add_definition('signal_operations', 'struct SignalOperator[]', '_geo', operators)
@@ -254,7 +254,7 @@ local function bb_center(bb, axis_name)
     return (bb.min[axis_name] + bb.max[axis_name]) * 0.5
 end
 
-local function build_bvh_recursive(nodes) 
+local function build_bvh_midpoint(nodes)
     if #nodes <= 1 then
         return nodes
     end
@@ -309,16 +309,335 @@ local function build_bvh_recursive(nodes)
 
     return {{
         children = {
-            table.unpack(build_bvh_recursive(split_halfs[1])),
-            table.unpack(build_bvh_recursive(split_halfs[2])),
+            table.unpack(build_bvh_midpoint(split_halfs[1])),
+            table.unpack(build_bvh_midpoint(split_halfs[2])),
         },
         mesh_bb = total_bb,
     }}
 end
 
-local MAX_STATIC_INDEX_DEPTH = 4
+-- Views used to build and measure a room's BVH. Each one is a camera somewhere
+-- in the room looking in a random direction using the same field of view and
+-- clipping planes as the game camera. Seeds are fixed so the output is
+-- repeatable and the report uses a different seed than the build so the tree
+-- isn't measured against the views it was fit to
+local BUILD_VIEW_SEED = 1
+local MEASURE_VIEW_SEED = 2
+local VIEWS_PER_ROOM = 64
+local VIEW_FOV = math.rad(60)
+local VIEW_ASPECT = 4 / 3
+local VIEW_MAX_PITCH = math.rad(30)
+
+-- a plane through the camera containing edge and axis facing into the view
+local function view_plane(edge, axis, forward, position)
+    local normal = edge:cross(axis):normalized()
+
+    if normal:dot(forward) < 0 then
+        normal = -normal
+    end
+
+    return {normal = normal, d = -normal:dot(position)}
+end
+
+local function generate_room_views(room_bb, bb_scale, seed)
+    local result = {}
+
+    if not room_bb then
+        return result
+    end
+
+    local half_height = math.tan(VIEW_FOV * 0.5)
+    local half_width = half_height * VIEW_ASPECT
+
+    math.randomseed(seed)
+
+    for _ = 1, VIEWS_PER_ROOM do
+        local position = sk_math.vector3(
+            room_bb.min.x + (room_bb.max.x - room_bb.min.x) * math.random(),
+            room_bb.min.y + (room_bb.max.y - room_bb.min.y) * math.random(),
+            room_bb.min.z + (room_bb.max.z - room_bb.min.z) * math.random()
+        ) * bb_scale
+
+        local yaw = math.random() * math.pi * 2
+        local pitch = (math.random() * 2 - 1) * VIEW_MAX_PITCH
+
+        local forward = sk_math.vector3(math.cos(pitch) * math.sin(yaw), math.sin(pitch), math.cos(pitch) * math.cos(yaw))
+        local right = sk_math.vector3(math.cos(yaw), 0, -math.sin(yaw))
+        local up = right:cross(forward):normalized()
+
+        table.insert(result, {
+            view_plane(forward * half_width + right, up, forward, position),
+            view_plane(forward * half_width - right, up, forward, position),
+            view_plane(forward * half_height + up, right, forward, position),
+            view_plane(forward * half_height - up, right, forward, position),
+            {normal = forward, d = -forward:dot(position)},
+        })
+    end
+
+    return result
+end
+
+local function plane_distance(plane, x, y, z)
+    return plane.normal.x * x + plane.normal.y * y + plane.normal.z * z + plane.d
+end
+
+-- Mirrors isOutsideFrustum(). Returns 'outside', 'inside' or 'both'
+local function classify_box(view, bb)
+    local result = 'inside'
+
+    for _, plane in ipairs(view) do
+        local normal = plane.normal
+
+        if plane_distance(plane,
+            normal.x < 0 and bb.min.x or bb.max.x,
+            normal.y < 0 and bb.min.y or bb.max.y,
+            normal.z < 0 and bb.min.z or bb.max.z) < 0.00001 then
+            return 'outside'
+        end
+
+        if plane_distance(plane,
+            normal.x > 0 and bb.min.x or bb.max.x,
+            normal.y > 0 and bb.min.y or bb.max.y,
+            normal.z > 0 and bb.min.z or bb.max.z) < 0.00001 then
+            result = 'both'
+        end
+    end
+
+    return result
+end
+
+-- Relative costs used by the surface area heuristic. A box test is a call to
+-- isOutsideFrustum(), a rotated box test is the isRotatedBoxOutsideFrustum()
+-- done for elements with precise culling, an element is a renderSceneAdd()
+-- with its sort key and share of the sort plus the display list it submits
+-- and a material is the state change needed the first time that material is
+-- seen in a frame.
+local BOX_TEST_COST = 1
+local ROTATED_BOX_TEST_COST = 2
+local ELEMENT_COST = 4
+local TRIANGLE_COST = 0.05
+local MATERIAL_COST = 2
+
+local function element_cost(chunk)
+    return ELEMENT_COST + #chunk.mesh.faces * TRIANGLE_COST
+end
+
+local function nodes_bb(nodes, first, last)
+    local result = nodes[first].mesh_bb
+
+    for i = first + 1, last do
+        result = result:union(nodes[i].mesh_bb)
+    end
 
-local function build_static_index(room_static_nodes)
+    return result
+end
+
+-- Views that can see any part of bb
+local function visible_views(views, bb)
+    local result = {}
+
+    for _, view in pairs(views) do
+        if classify_box(view, bb) ~= 'outside' then
+            table.insert(result, view)
+        end
+    end
+
+    return result
+end
+
+-- The part of the scene a box is tested in. The views are the sampled views
+-- that can see the box, when there aren't any the box area is used instead
+local function cull_context(bb, views)
+    return {area = bb:area(), views = views}
+end
+
+-- Chance a child box is visible given its parent is visible
+local function visible_probability(child_views, child_bb, parent)
+    if #parent.views > 0 then
+        return #child_views / #parent.views
+    end
+
+    if parent.area <= 0 then
+        return 1
+    end
+
+    return child_bb:area() / parent.area
+end
+
+-- Elements with precise culling are tested against their own box every
+-- time their parent is visible and only submitted if that box is visible
+local function leaf_cost(node, parent)
+    if node.bounding_box_index then
+        local node_views = visible_views(parent.views, node.mesh_bb)
+        return ROTATED_BOX_TEST_COST + visible_probability(node_views, node.mesh_bb, parent) * node.display_list_cost
+    end
+
+    return node.display_list_cost
+end
+
+local function render_cost(nodes, first, last, parent)
+    local result = 0
+    local materials = {}
+
+    for i = first, last do
+        local node = nodes[i]
+        result = result + leaf_cost(node, parent)
+
+        if not materials[node.material_index.value] then
+            materials[node.material_index.value] = true
+            result = result + MATERIAL_COST
+        end
+    end
+
+    return result
+end
+
+-- Cost of either rendering the nodes directly as leaves of the parent or
+-- putting them under their own box first
+local function side_cost(nodes, first, last, bb, parent)
+    local unboxed_cost = render_cost(nodes, first, last, parent)
+    local bb_views = visible_views(parent.views, bb)
+    local boxed_cost = BOX_TEST_COST + visible_probability(bb_views, bb, parent) * render_cost(nodes, first, last, cull_context(bb, bb_views))
+
+    if boxed_cost < unboxed_cost then
+        return boxed_cost, true
+    end
+
+    return unboxed_cost, false
+end
+
+local function build_bvh_sah(nodes, views)
+    if #nodes <= 1 then
+        return nodes
+    end
+
+    local total_bb = nodes_bb(nodes, 1, #nodes)
+    local total = cull_context(total_bb, visible_views(views, total_bb))
+    local best_cost = render_cost(nodes, 1, #nodes, total)
+    local best_split = nil
+
+    for _, axis_name in pairs(axis_index_to_name) do
+        local sorted = {table.unpack(nodes)}
+
+        table.sort(sorted, function(a, b)
+            return bb_center(a.mesh_bb, axis_name) < bb_center(b.mesh_bb, axis_name)
+        end)
+
+        -- sweep from the right to find the bounds of every suffix
+        local right_bbs = {}
+        right_bbs[#sorted] = sorted[#sorted].mesh_bb
+
+        for i = #sorted - 1, 2, -1 do
+            right_bbs[i] = right_bbs[i + 1]:union(sorted[i].mesh_bb)
+        end
+
+        local left_bb = sorted[1].mesh_bb
+
+        for split = 1, #sorted - 1 do
+            if split > 1 then
+                left_bb = left_bb:union(sorted[split].mesh_bb)
+            end
+
+            local right_bb = right_bbs[split + 1]
+            local left_cost, left_boxed = side_cost(sorted, 1, split, left_bb, total)
+            local right_cost, right_boxed = side_cost(sorted, split + 1, #sorted, right_bb, total)
+
+            if left_cost + right_cost < best_cost then
+                best_cost = left_cost + right_cost
+                best_split = {
+                    {{table.unpack(sorted, 1, split)}, left_bb, left_boxed},
+                    {{table.unpack(sorted, split + 1, #sorted)}, right_bb, right_boxed},
+                }
+            end
+        end
+    end
+
+    if not best_split then
+        return nodes
+    end
+
+    local result = {}
+
+    for _, side in pairs(best_split) do
+        local side_nodes, side_bb, is_boxed = table.unpack(side)
+
+        if is_boxed then
+            table.insert(result, {
+                children = build_bvh_sah(side_nodes, total.views),
+                mesh_bb = side_bb,
+            })
+        else
+            -- the side isn't worth its own box but its nodes
+            -- can still be grouped under boxes of their own
+            for _, node in pairs(build_bvh_sah(side_nodes, total.views)) do
+                table.insert(result, node)
+            end
+        end
+    end
+
+    return result
+end
+
+-- Runs the same traversal as staticRenderTraverseIndex() for every view
+-- and averages how many boxes are tested, how many elements have their
+-- own box tested for precise culling and how many elements are submitted
+local function measure_bvh(index, views)
+    local result = {box_tests = 0, element_tests = 0, elements = 0}
+
+    if #index == 0 or #views == 0 then
+        return result
+    end
+
+    local root_bb = nodes_bb(index, 1, #index)
+
+    local function visit(view, children, is_fully_visible)
+        for _, child in pairs(children) do
+            if not child.children then
+                if child.bounding_box_index then
+                    result.element_tests = result.element_tests + 1
+                end
+
+                if is_fully_visible or not child.bounding_box_index or classify_box(view, child.mesh_bb) ~= 'outside' then
+                    result.elements = result.elements + 1
+                end
+            end
+        end
+
+        for _, child in pairs(children) do
+            if child.children then
+                if is_fully_visible then
+                    visit(view, child.children, true)
+                else
+                    result.box_tests = result.box_tests + 1
+
+                    local cull_result = classify_box(view, child.mesh_bb)
+
+                    if cull_result ~= 'outside' then
+                        visit(view, child.children, cull_result == 'inside')
+                    end
+                end
+            end
+        end
+    end
+
+    for _, view in pairs(views) do
+        result.box_tests = result.box_tests + 1
+
+        local cull_result = classify_box(view, root_bb)
+
+        if cull_result ~= 'outside' then
+            visit(view, index, cull_result == 'inside')
+        end
+    end
+
+    result.box_tests = result.box_tests / #views
+    result.element_tests = result.element_tests / #views
+    result.elements = result.elements / #views
+
+    return result
+end
+
+local function build_static_index(room_static_nodes, room_bb, bb_scale)
     local animated_nodes = {}
     local non_moving_nodes = {}
 
@@ -330,7 +649,13 @@ local function build_static_index(room_static_nodes)
         end
     end
 
-    local non_moving_nodes = build_bvh_recursive(non_moving_nodes)
+    local measure_views = generate_room_views(room_bb, bb_scale, MEASURE_VIEW_SEED)
+
+    local midpoint_quality = measure_bvh(build_bvh_midpoint(non_moving_nodes), measure_views)
+
+    local non_moving_nodes = build_bvh_sah(non_moving_nodes, generate_room_views(room_bb, bb_scale, BUILD_VIEW_SEED))
+
+    local quality = measure_bvh(non_moving_nodes, measure_views)
 
     local static_result, branch_index = serialize_static_index(non_moving_nodes)
 
@@ -347,9 +672,21 @@ local function build_static_index(room_static_nodes)
             min = animated_min,
             max = #static_result,
         },
+        quality = quality,
+        midpoint_quality = midpoint_quality,
     }
 end
 
+local function print_bvh_quality(label, midpoint_quality, quality)
+    print(string.format(
+        '    %-8s: boxes %7.2f -> %7.2f, element boxes %7.2f -> %7.2f, elements %7.2f -> %7.2f',
+        label,
+        midpoint_quality.box_tests, quality.box_tests,
+        midpoint_quality.element_tests, quality.element_tests,
+        midpoint_quality.elements, quality.elements
+    ))
+end
+
 local function process_static_nodes(nodes)
     local result = {}
     local bb_scale = sk_input.settings.fixed_point_scale
@@ -388,6 +725,7 @@ local function process_static_nodes(nodes)
             mesh = source_node.chunk.mesh,
             mesh_bb = mesh_bb,
             display_list = sk_definition_writer.raw(gfxName), 
+            display_list_cost = element_cost(source_node.chunk),
             material_index = sk_definition_writer.raw(source_node.chunk.material.macro_name),
             transform_index = source_node.transform_index,
             bounding_box_index = source_node.bounding_box_index,
@@ -409,6 +747,11 @@ local function process_static_nodes(nodes)
 
     local final_static_list = {}
 
+    local total_quality = {box_tests = 0, element_tests = 0, elements = 0}
+    local total_midpoint_quality = {box_tests = 0, element_tests = 0, elements = 0}
+
+    print('Static BVH quality (average per view: box tests, element box tests, elements submitted; midpoint split -> SAH)')
+
     for room_index = 0,room_export.room_count-1 do
         local next_boundary = last_boundary
 
@@ -417,7 +760,14 @@ local function process_static_nodes(nodes)
         end
 
         local room_elements = {table.unpack(result, last_boundary, next_boundary - 1)}
-        local room_bvh = build_static_index(room_elements)
+        local room_bvh = build_static_index(room_elements, room_export.room_bb[room_index + 1], bb_scale)
+
+        print_bvh_quality('room ' .. room_index, room_bvh.midpoint_quality, room_bvh.quality)
+
+        for key, value in pairs(room_bvh.quality) do
+            total_quality[key] = total_quality[key] + value
+            total_midpoint_quality[key] = total_midpoint_quality[key] + room_bvh.midpoint_quality[key]
+        end
 
         local animated_boxes = {}
 
@@ -451,6 +801,8 @@ local function process_static_nodes(nodes)
         last_boundary = next_boundary
     end
 
+    print_bvh_quality('total', total_midpoint_quality, total_quality)
+
     sk_definition_writer.add_definition('room_bvh', 'struct StaticIndex[]', '_geo', room_bvh_list);
 
     return final_static_list, room_bvh_list, static_bounding_boxes;
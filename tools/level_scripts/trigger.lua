@@ -342,8 +342,8 @@ local function generate_cutscenes()
         })
 
         table.insert(cutscene_data, {
-            sk_definition_writer.reference_to(steps, 1),
-            #steps,
+            steps = sk_definition_writer.reference_to(steps, 1),
+            stepCount = #steps,
         })
     end
 
@@ -395,10 +395,10 @@ local function generate_triggers(cutscenes)
             local transformed = first_mesh:transform(trigger.node.full_transformation)
     
             table.insert(result, {
-                transformed.bb,
-                sk_definition_writer.reference_to(triggers, 1),
-                #triggers,
-                trigger_type
+                box = transformed.bb,
+                triggers = sk_definition_writer.reference_to(triggers, 1),
+                triggerCount = #triggers,
+                type = trigger_type,
             })
 
             sk_definition_writer.add_definition("trigger_targets", "struct ObjectTriggerInfo[]", "_geo", triggers)
@@ -171,16 +171,16 @@ local function generate_room(room_index)
     sk_definition_writer.add_definition('room_doorways', 'short[]', '_geo', room_doorways[room_index])
 
     return {
-        sk_definition_writer.reference_to(quad_indices, 1),
-        sk_definition_writer.reference_to(cell_contents, 1),
-        room_grid and room_grid.span_x or 0,
-        room_grid and room_grid.span_z or 0,
-        room_grid and room_grid.x or 0,
-        room_grid and room_grid.z or 0,
-        room_export.room_bb[room_index] or sk_math.box3(),
-        sk_definition_writer.reference_to(room_doorways[room_index], 1),
-        #room_doorways[room_index],
-        room_export.room_non_visibility[room_index]
+        quadIndices = sk_definition_writer.reference_to(quad_indices, 1),
+        cellContents = sk_definition_writer.reference_to(cell_contents, 1),
+        spanX = room_grid and room_grid.span_x or 0,
+        spanZ = room_grid and room_grid.span_z or 0,
+        cornerX = room_grid and room_grid.x or 0,
+        cornerZ = room_grid and room_grid.z or 0,
+        boundingBox = room_export.room_bb[room_index] or sk_math.box3(),
+        doorwayIndices = sk_definition_writer.reference_to(room_doorways[room_index], 1),
+        doorwayCount = #room_doorways[room_index],
+        nonVisibleRooms = room_export.room_non_visibility[room_index],
     }
 end
 
@@ -11,6 +11,7 @@ function generateModelListEntry(outputPath, modelHeader) {
         &${util.generateRelativeModelName(outputPath, modelHeader, '_armature')},
         ${util.generateRelativeModelName(outputPath, modelHeader, '_clips')},
         ${util.generateRelativeModelName(outputPath, modelHeader, '_clip_count').toUpperCase()},
+        ${util.generateRelativeModelName(outputPath, modelHeader, '_model_relocations')},
         "${modelName}",
     },`;
 }
@@ -9,6 +9,7 @@ function generateModelListEntry(outputPath, modelHeader) {
         _${modelName}_geoSegmentRomEnd,
         _${modelName}_geoSegmentStart,
         ${util.generateRelativeModelName(outputPath, modelHeader, '_model_gfx')},
+        ${util.generateRelativeModelName(outputPath, modelHeader, '_model_relocations')},
         "${modelName}",
     },`;
 }
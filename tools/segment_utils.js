@@ -0,0 +1,18 @@
+const path = require('path');
+
+const INVALID_TOKEN_CHARACTER = /[^A-Za-z0-9_]/gim;
+
+function sanitize(s) {
+    return s.replace(INVALID_TOKEN_CHARACTER, '_');
+}
+
+// Segment and section names are derived from the object file name
+function getObjectName(objectPath) {
+    const { name } = path.parse(objectPath);
+    return sanitize(name.split('.')[0]);
+}
+
+module.exports = {
+    sanitize,
+    getObjectName,
+};